@@ -10,6 +10,7 @@ if(APPLE)
     add_definitions(-D"GL_SILENCE_DEPRECATION")
 endif()
 find_package(OpenAL REQUIRED)
+find_package(Threads REQUIRED)
 
 if(WITH_BOX2D)
     set(BOX2D_BUILD_UNIT_TESTS OFF CACHE BOOL "Skip tests")
@@ -0,0 +1,89 @@
+
+//////////////////////////////////////////////////////////////////////////
+#ifdef VERTEX_SHADER
+
+// constants
+uniform mat4 view_projection_matrix;
+uniform usampler2D tex_1; // block frames table
+uniform usampler2D tex_2; // palette indices table
+
+uniform vec3 chunk_origin; // chunks grid origin
+uniform float chunk_size;
+
+// attributes
+in uvec4 in_pos0; // chunk relative position and tile data
+in uvec4 in_texcoord0; // texture coordinate and chunk cell
+
+// pass to fragment shader
+out vec2 Texcoord;
+flat out float Transparency;
+flat out float BlockTextureIndex;
+flat out float PaletteIndex;
+
+const float MeshHeightModifier = -0.15; // shift the geometry level slightly below the sprites to remove the zfighting
+const float PositionScale = 1.0 / 64.0; // must match CityPackedVertex3D::PositionScale
+
+// entry point
+void main() 
+{
+    // unpack tile data: index 12 bits, remap 2 bits, transparency 1 bit
+    uint tileIndex = in_pos0.w & 0xFFFu;
+    uint tileRemap = (in_pos0.w >> 12u) & 3u;
+
+	Texcoord = vec2(in_texcoord0.xy);
+    Transparency = float((in_pos0.w >> 14u) & 1u);
+
+    // get real block tile index
+    BlockTextureIndex = float(texelFetch(tex_1, ivec2(int(tileIndex), 0), 0).r);
+
+    // get palette index for block tile
+    PaletteIndex = float(texelFetch(tex_2, ivec2(int(4.0 * BlockTextureIndex + float(tileRemap)), 0), 0).r);
+
+    vec3 chunkOrigin = chunk_origin + vec3(float(in_texcoord0.z), 0.0, float(in_texcoord0.w)) * chunk_size;
+    vec3 position = chunkOrigin + vec3(in_pos0.xyz) * PositionScale;
+    vec4 vertexPosition = view_projection_matrix * vec4(
+		position.x, 
+		position.y + MeshHeightModifier, 
+		position.z, 1.0);
+
+    gl_Position = vertexPosition;
+}
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+#ifdef FRAGMENT_SHADER
+
+uniform usampler2DArray tex_0; // block texture
+uniform sampler2D tex_3; // palettes table
+
+// passed from vertex shader
+in vec2 Texcoord;
+flat in float Transparency;
+flat in float BlockTextureIndex;
+flat in float PaletteIndex;
+
+// result
+out vec4 FinalColor;
+
+vec4 fetchBlockTexel(vec2 tc)
+{
+    // get color index in palette
+    float pal_color = float(texture(tex_0, vec3(tc.x, tc.y, BlockTextureIndex)).r);
+
+    if (Transparency > 0.5 && pal_color < 0.5) // transparent
+		discard;
+
+    vec4 texelColor = texelFetch(tex_3, ivec2(int(pal_color), int(PaletteIndex)), 0);
+    texelColor.a = 1.0;
+	return texelColor;
+}
+
+// entry point
+void main()
+{
+	vec4 texelColor = fetchBlockTexel(Texcoord);
+    FinalColor = clamp(texelColor, 0.0, 1.0);
+}
+
+#endif
@@ -8,13 +8,15 @@ uniform mat4 view_projection_matrix;
 // attributes
 in vec3 in_pos0;
 in vec2 in_texcoord0;
-in uint in_color0; // palette index
+in uvec4 in_color0; // palette index, deltas base, delta bits low and high parts
 in uvec2 in_textureSize; // sprite texture size in pixels
 
 // pass to fragment shader
 out vec2 Texcoord;
 out vec3 Position;
 flat out uint PaletteIndex;
+flat out uint DeltaBase;
+flat out uint DeltaBits;
 out vec2 SpriteTextureSize;
 out vec2 SpriteTexelSize;
 
@@ -23,7 +25,9 @@ void main()
 {
 	Texcoord = in_texcoord0;
     Position = in_pos0;
-    PaletteIndex = in_color0;
+    PaletteIndex = in_color0.x;
+    DeltaBase = in_color0.y;
+    DeltaBits = in_color0.z | (in_color0.w << 16u);
 	SpriteTextureSize = vec2(in_textureSize);
 	SpriteTexelSize = vec2(1.0 / SpriteTextureSize.x, 1.0 / SpriteTextureSize.y);
 
@@ -38,21 +42,58 @@ void main()
 
 uniform usampler2D tex_0;
 uniform sampler2D tex_3; // palettes table
+uniform usampler2D tex_4; // sprite deltas table
+uniform usampler2DArray tex_5; // sprite deltas pixels
 
 // passed from vertex shader
 in vec2 Texcoord;
 in vec3 Position;
 flat in uint PaletteIndex;
+flat in uint DeltaBase;
+flat in uint DeltaBits;
 in vec2 SpriteTextureSize;
 in vec2 SpriteTexelSize;
 
 // result
 out vec4 FinalColor;
 
+const uint DELTAS_TABLE_WIDTH = 512u; // entries per row
+const uint DELTA_TEXEL_COVERED = 256u;
+
+// override color index with sprite deltas that change specified spritesheet pixel
+uint applySpriteDeltas(uint pal_color, ivec2 pixel)
+{
+    uint deltaBits = DeltaBits;
+    for (uint ientry = DeltaBase; deltaBits > 0u; ++ientry, deltaBits >>= 1u)
+    {
+        if ((deltaBits & 1u) == 0u)
+            continue;
+
+        ivec2 entryCoord = ivec2(int(ientry % DELTAS_TABLE_WIDTH) * 2, int(ientry / DELTAS_TABLE_WIDTH));
+        uvec4 deltaArea = texelFetch(tex_4, entryCoord, 0); // x, y, w, h within spritesheet
+        ivec2 areaPixel = pixel - ivec2(deltaArea.xy);
+        if (any(lessThan(areaPixel, ivec2(0))) || any(greaterThanEqual(areaPixel, ivec2(deltaArea.zw))))
+            continue;
+
+        uvec4 deltaLocation = texelFetch(tex_4, entryCoord + ivec2(1, 0), 0); // x, y, layer
+        uint deltaTexel = texelFetch(tex_5, ivec3(ivec2(deltaLocation.xy) + areaPixel, int(deltaLocation.z)), 0).r;
+        if (deltaTexel >= DELTA_TEXEL_COVERED)
+        {
+            pal_color = deltaTexel - DELTA_TEXEL_COVERED;
+        }
+    }
+    return pal_color;
+}
+
 vec4 fetchSpriteTexel(vec2 tc)
 {
     // get color index in palette
-    float pal_color = float(texture(tex_0, tc).r);
+    uint pal_index = texture(tex_0, tc).r;
+    if (DeltaBits > 0u)
+    {
+        pal_index = applySpriteDeltas(pal_index, ivec2(tc * SpriteTextureSize));
+    }
+    float pal_color = float(pal_index);
 
     if (pal_color < 0.5) // transparent
 		discard;
@@ -0,0 +1,143 @@
+
+//////////////////////////////////////////////////////////////////////////
+#ifdef VERTEX_SHADER
+
+// constants
+uniform mat4 view_projection_matrix;
+uniform usampler2D tex_0;
+
+// attributes, per instance
+in vec4 in_pos0; // position xy, height, scale
+in uvec4 in_texcoord0; // texture region x, y, w, h in pixels
+in uvec4 in_color0; // rotation, palette index, draw order and flags, deltas base
+in uvec2 in_color1; // delta bits low and high parts
+
+// pass to fragment shader
+out vec2 Texcoord;
+out vec3 Position;
+flat out uint PaletteIndex;
+flat out uint DeltaBase;
+flat out uint DeltaBits;
+out vec2 SpriteTextureSize;
+out vec2 SpriteTexelSize;
+
+const uint FLAGS_ORIGIN_CENTER = 1u;
+const uint FLAGS_DEPTH_AXIS_Z = 2u;
+const float ROTATION_STEPS = 65536.0;
+
+// entry point
+void main() 
+{
+    // unit quad corner, drawn as triangle strip
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+
+    uint flags = in_color0.z >> 8;
+    vec2 regionSize = vec2(in_texcoord0.zw);
+    vec2 spriteSize = regionSize * in_pos0.w;
+    vec2 cornerPosition = corner * spriteSize;
+    if ((flags & FLAGS_ORIGIN_CENTER) > 0u)
+    {
+        cornerPosition -= spriteSize * 0.5;
+    }
+
+    float angle = (float(in_color0.x) / ROTATION_STEPS) * 6.28318530718;
+    float c = cos(angle);
+    float s = sin(angle);
+    vec2 position = in_pos0.xy + vec2(cornerPosition.x * c - cornerPosition.y * s, cornerPosition.x * s + cornerPosition.y * c);
+
+    if ((flags & FLAGS_DEPTH_AXIS_Z) > 0u)
+    {
+        Position = vec3(position.x, position.y, in_pos0.z);
+    }
+    else
+    {
+        Position = vec3(position.x, in_pos0.z, position.y);
+    }
+
+    SpriteTextureSize = vec2(textureSize(tex_0, 0));
+    SpriteTexelSize = vec2(1.0 / SpriteTextureSize.x, 1.0 / SpriteTextureSize.y);
+    Texcoord = (vec2(in_texcoord0.xy) + corner * regionSize) * SpriteTexelSize;
+    PaletteIndex = in_color0.y;
+    DeltaBase = in_color0.w;
+    DeltaBits = in_color1.x | (in_color1.y << 16u);
+
+    gl_Position = view_projection_matrix * vec4(Position, 1.0);
+}
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+#ifdef FRAGMENT_SHADER
+
+uniform usampler2D tex_0;
+uniform sampler2D tex_3; // palettes table
+uniform usampler2D tex_4; // sprite deltas table
+uniform usampler2DArray tex_5; // sprite deltas pixels
+
+// passed from vertex shader
+in vec2 Texcoord;
+in vec3 Position;
+flat in uint PaletteIndex;
+flat in uint DeltaBase;
+flat in uint DeltaBits;
+in vec2 SpriteTextureSize;
+in vec2 SpriteTexelSize;
+
+// result
+out vec4 FinalColor;
+
+const uint DELTAS_TABLE_WIDTH = 512u; // entries per row
+const uint DELTA_TEXEL_COVERED = 256u;
+
+// override color index with sprite deltas that change specified spritesheet pixel
+uint applySpriteDeltas(uint pal_color, ivec2 pixel)
+{
+    uint deltaBits = DeltaBits;
+    for (uint ientry = DeltaBase; deltaBits > 0u; ++ientry, deltaBits >>= 1u)
+    {
+        if ((deltaBits & 1u) == 0u)
+            continue;
+
+        ivec2 entryCoord = ivec2(int(ientry % DELTAS_TABLE_WIDTH) * 2, int(ientry / DELTAS_TABLE_WIDTH));
+        uvec4 deltaArea = texelFetch(tex_4, entryCoord, 0); // x, y, w, h within spritesheet
+        ivec2 areaPixel = pixel - ivec2(deltaArea.xy);
+        if (any(lessThan(areaPixel, ivec2(0))) || any(greaterThanEqual(areaPixel, ivec2(deltaArea.zw))))
+            continue;
+
+        uvec4 deltaLocation = texelFetch(tex_4, entryCoord + ivec2(1, 0), 0); // x, y, layer
+        uint deltaTexel = texelFetch(tex_5, ivec3(ivec2(deltaLocation.xy) + areaPixel, int(deltaLocation.z)), 0).r;
+        if (deltaTexel >= DELTA_TEXEL_COVERED)
+        {
+            pal_color = deltaTexel - DELTA_TEXEL_COVERED;
+        }
+    }
+    return pal_color;
+}
+
+vec4 fetchSpriteTexel(vec2 tc)
+{
+    // get color index in palette
+    uint pal_index = texture(tex_0, tc).r;
+    if (DeltaBits > 0u)
+    {
+        pal_index = applySpriteDeltas(pal_index, ivec2(tc * SpriteTextureSize));
+    }
+    float pal_color = float(pal_index);
+
+    if (pal_color < 0.5) // transparent
+		discard;
+
+    // fetch pixel color
+    vec4 texelColor = texelFetch(tex_3, ivec2(int(pal_color), int(PaletteIndex)), 0);
+    texelColor.a = 1.0;
+	return texelColor;
+}
+
+// entry point
+void main()
+{
+	vec4 texelColor = fetchSpriteTexel(Texcoord);
+    FinalColor = clamp(texelColor, 0.0, 1.0);
+}
+
+#endif
\ No newline at end of file
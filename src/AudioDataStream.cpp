@@ -1,11 +1,23 @@
 #include "stdafx.h"
 #include "AudioDataStream.h"
 #include "wave_utils.h"
+#include "flac_utils.h"
+#include "vorbis_utils.h"
 #include "FileSystem.h"
 
 //////////////////////////////////////////////////////////////////////////
 
 const char* AudioFileExtWAVE = ".wav";
+const char* AudioFileExtFLAC = ".flac";
+const char* AudioFileExtOGG = ".ogg";
+
+enum eAudioFileFormat
+{
+    eAudioFileFormat_Unknown,
+    eAudioFileFormat_Wave, // pcm or ima adpcm
+    eAudioFileFormat_Flac,
+    eAudioFileFormat_OggVorbis,
+};
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -59,6 +71,131 @@ private:
 
 //////////////////////////////////////////////////////////////////////////
 
+// flac file stream implementation
+
+class FlacFileStream: public AudioDataStream
+{
+public:
+    FlacFileStream()
+        : mFlacReader(mFileStream)
+    {
+    }
+    bool OpenFileStream(const std::string& fileName)
+    {
+        if (!gFiles.OpenBinaryFile(fileName, mFileStream))
+            return false;
+
+        return mFlacReader.parse_audio();
+    }
+
+    int GetChannelsCount() const override { return mFlacReader.mChannelsCount; }
+    int GetSampleRate() const override { return mFlacReader.mSampleRate; }
+    int GetSampleBits() const override { return mFlacReader.mSampleBits; }
+    int GetSamplesCount() const override { return mFlacReader.mSamplesCount; }
+
+    int ReadPCMSamples(int samples, void* buffer) override
+    {
+        return mFlacReader.read_pcm_samples(samples, buffer);
+    }
+    bool SeekPCMFromBeg(int samples) override
+    {
+        return mFlacReader.seek_pcm_beg(samples);
+    }
+    bool SeekPCMFromEnd(int samples) override
+    {
+        return mFlacReader.seek_pcm_end(samples);
+    }
+    bool SeekPCMFromCur(int samples) override
+    {
+        return mFlacReader.seek_pcm_cur(samples);
+    }
+    bool EndOfStream() const override
+    {
+        return mFlacReader.end_of_stream();
+    }
+
+private:
+    std::ifstream mFileStream;
+    cxx::flac_reader mFlacReader;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+// ogg vorbis file stream implementation
+
+class VorbisFileStream: public AudioDataStream
+{
+public:
+    VorbisFileStream()
+        : mVorbisReader(mFileStream)
+    {
+    }
+    bool OpenFileStream(const std::string& fileName)
+    {
+        if (!gFiles.OpenBinaryFile(fileName, mFileStream))
+            return false;
+
+        return mVorbisReader.parse_audio();
+    }
+
+    int GetChannelsCount() const override { return mVorbisReader.mChannelsCount; }
+    int GetSampleRate() const override { return mVorbisReader.mSampleRate; }
+    int GetSampleBits() const override { return mVorbisReader.mSampleBits; }
+    int GetSamplesCount() const override { return mVorbisReader.mSamplesCount; }
+
+    int ReadPCMSamples(int samples, void* buffer) override
+    {
+        return mVorbisReader.read_pcm_samples(samples, buffer);
+    }
+    bool SeekPCMFromBeg(int samples) override
+    {
+        return mVorbisReader.seek_pcm_beg(samples);
+    }
+    bool SeekPCMFromEnd(int samples) override
+    {
+        return mVorbisReader.seek_pcm_end(samples);
+    }
+    bool SeekPCMFromCur(int samples) override
+    {
+        return mVorbisReader.seek_pcm_cur(samples);
+    }
+    bool EndOfStream() const override
+    {
+        return mVorbisReader.end_of_stream();
+    }
+
+private:
+    std::ifstream mFileStream;
+    cxx::vorbis_reader mVorbisReader;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+// detect audio format by file signature
+static eAudioFileFormat DetectAudioFileFormat(const std::string& fileName)
+{
+    std::ifstream fileStream;
+    if (!gFiles.OpenBinaryFile(fileName, fileStream))
+        return eAudioFileFormat_Unknown;
+
+    unsigned char signature[12] = {};
+    if (!fileStream.read((char*) signature, sizeof(signature)))
+        return eAudioFileFormat_Unknown;
+
+    if ((::memcmp(signature, "RIFF", 4) == 0) && (::memcmp(signature + 8, "WAVE", 4) == 0))
+        return eAudioFileFormat_Wave;
+
+    if (::memcmp(signature, "fLaC", 4) == 0)
+        return eAudioFileFormat_Flac;
+
+    if (::memcmp(signature, "OggS", 4) == 0)
+        return eAudioFileFormat_OggVorbis;
+
+    return eAudioFileFormat_Unknown;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 extern AudioDataStream* OpenAudioFileStream(const char* fileName)
 {
     std::string fileNameWithExt;
@@ -68,6 +205,8 @@ extern AudioDataStream* OpenAudioFileStream(const char* fileName)
     {
         static const char* knownAudioExtensions[] =
         {
+            AudioFileExtFLAC,
+            AudioFileExtOGG,
             AudioFileExtWAVE
         };
 
@@ -92,9 +231,27 @@ extern AudioDataStream* OpenAudioFileStream(const char* fileName)
         std::transform(fileExt.begin(), fileExt.end(), fileExt.begin(), ::tolower);
     }
 
+    // file signature takes precedence over extension
+    eAudioFileFormat fileFormat = DetectAudioFileFormat(fileNameWithExt);
+    if (fileFormat == eAudioFileFormat_Unknown)
+    {
+        if (fileExt == AudioFileExtWAVE)
+        {
+            fileFormat = eAudioFileFormat_Wave;
+        }
+        else if (fileExt == AudioFileExtFLAC)
+        {
+            fileFormat = eAudioFileFormat_Flac;
+        }
+        else if (fileExt == AudioFileExtOGG)
+        {
+            fileFormat = eAudioFileFormat_OggVorbis;
+        }
+    }
+
     AudioDataStream* audioDataStream = nullptr;
 
-    if (fileExt == AudioFileExtWAVE)
+    if (fileFormat == eAudioFileFormat_Wave)
     {
         WaveFileStream* waveFileStream = new WaveFileStream;
         if (!waveFileStream->OpenFileStream(fileNameWithExt))
@@ -103,6 +260,24 @@ extern AudioDataStream* OpenAudioFileStream(const char* fileName)
         }
         audioDataStream = waveFileStream;
     }
+    else if (fileFormat == eAudioFileFormat_Flac)
+    {
+        FlacFileStream* flacFileStream = new FlacFileStream;
+        if (!flacFileStream->OpenFileStream(fileNameWithExt))
+        {
+            SafeDelete(flacFileStream);
+        }
+        audioDataStream = flacFileStream;
+    }
+    else if (fileFormat == eAudioFileFormat_OggVorbis)
+    {
+        VorbisFileStream* vorbisFileStream = new VorbisFileStream;
+        if (!vorbisFileStream->OpenFileStream(fileNameWithExt))
+        {
+            SafeDelete(vorbisFileStream);
+        }
+        audioDataStream = vorbisFileStream;
+    }
     return audioDataStream;
 }
 
@@ -92,6 +92,9 @@ void AudioDevice::Deinit()
         ::alcCloseDevice(mDevice);
         mDevice = nullptr;
     }
+    mDeferUpdatesProc = nullptr;
+    mProcessUpdatesProc = nullptr;
+    mDeviceCaps = AudioDeviceCaps();
 }
 
 bool AudioDevice::IsInitialized() const
@@ -194,6 +197,11 @@ void AudioDevice::DestroyAudioListener(AudioListener* audioListener)
     }
 }
 
+const std::vector<AudioListener*>& AudioDevice::GetAudioListeners() const
+{
+    return mAllListeners;
+}
+
 void AudioDevice::UpdateFrame()
 {
     if (IsInitialized())
@@ -204,6 +212,12 @@ void AudioDevice::UpdateFrame()
 
 void AudioDevice::UpdateSourcesPositions()
 {
+    // defer processing until all positions are set
+    if (mDeferUpdatesProc)
+    {
+        mDeferUpdatesProc();
+    }
+
     for (AudioSource* currSource: mAllSources)
     {
         if (!currSource->IsPlaying())
@@ -237,11 +251,20 @@ void AudioDevice::UpdateSourcesPositions()
         }
 
         // relative position
-        float posx = sourceLocation.x - listenerLocation.x;
-        float posz = sourceLocation.z - listenerLocation.z;
+        glm::vec3 relativeLocation { sourceLocation.x - listenerLocation.x, sourceLocation.y, sourceLocation.z - listenerLocation.z };
+        if (currSource->mLocationUploaded && (currSource->mUploadedLocation == relativeLocation))
+            continue;
 
-        ::alSource3f(currSource->mSourceID, AL_POSITION, posx, sourceLocation.y, posz);
+        ::alSource3f(currSource->mSourceID, AL_POSITION, relativeLocation.x, relativeLocation.y, relativeLocation.z);
         alCheckError();
+
+        currSource->mUploadedLocation = relativeLocation;
+        currSource->mLocationUploaded = true;
+    }
+
+    if (mProcessUpdatesProc)
+    {
+        mProcessUpdatesProc();
     }
 }
 
@@ -250,9 +273,23 @@ void AudioDevice::QueryAudioDeviceCaps()
     ::alcGetIntegerv(mDevice, ALC_MONO_SOURCES, 1, &mDeviceCaps.mMaxSourcesMono);
     ::alcGetIntegerv(mDevice, ALC_STEREO_SOURCES, 1, &mDeviceCaps.mMaxSourcesStereo);
 
+    mDeviceCaps.mDeferredUpdates = (::alIsExtensionPresent("AL_SOFT_deferred_updates") == AL_TRUE);
+    if (mDeviceCaps.mDeferredUpdates)
+    {
+        mDeferUpdatesProc = reinterpret_cast<ALDeferUpdatesProc>(::alGetProcAddress("alDeferUpdatesSOFT"));
+        mProcessUpdatesProc = reinterpret_cast<ALProcessUpdatesProc>(::alGetProcAddress("alProcessUpdatesSOFT"));
+        if ((mDeferUpdatesProc == nullptr) || (mProcessUpdatesProc == nullptr))
+        {
+            mDeferUpdatesProc = nullptr;
+            mProcessUpdatesProc = nullptr;
+            mDeviceCaps.mDeferredUpdates = false;
+        }
+    }
+
     gConsole.LogMessage(eLogMessage_Info, "Audio Device caps:");
     gConsole.LogMessage(eLogMessage_Info, " - max sources mono: %d", mDeviceCaps.mMaxSourcesMono);
     gConsole.LogMessage(eLogMessage_Info, " - max sources stereo: %d", mDeviceCaps.mMaxSourcesStereo);
+    gConsole.LogMessage(eLogMessage_Info, " - deferred updates: %s", mDeviceCaps.mDeferredUpdates ? "yes" : "no");
 }
 
 AudioSampleBuffer* AudioDevice::GetSampleBufferWithID(unsigned int bufferID) const
@@ -37,6 +37,9 @@ public:
     // Create audio source instance
     AudioSource* CreateAudioSource();
 
+    // Get all active audio listeners
+    const std::vector<AudioListener*>& GetAudioListeners() const;
+
     // Free virtual audio listener instance
     void DestroyAudioListener(AudioListener* audioListener);
 
@@ -61,6 +64,8 @@ private:
 private:
     ALCcontext* mContext = nullptr;
     ALCdevice* mDevice = nullptr;
+    ALDeferUpdatesProc mDeferUpdatesProc = nullptr;
+    ALProcessUpdatesProc mProcessUpdatesProc = nullptr;
     // allocated objects
     std::vector<AudioListener*> mAllListeners;
     std::vector<AudioSource*> mAllSources;
@@ -3,6 +3,11 @@
 #include "GameMapManager.h"
 #include "AudioDevice.h"
 #include "CarnageGame.h"
+#include "AudioMixer.h"
+#include "Pedestrian.h"
+#include "Vehicle.h"
+#include "TimeManager.h"
+#include "wave_utils.h"
 #include "cvars.h"
 
 AudioManager gAudioManager;
@@ -14,6 +19,20 @@ CvarEnum<eGameMusicMode> gCvarGameMusicMode("g_musicMode", eGameMusicMode_Radio,
 
 CvarInt gCvarMusicVolume("g_musicVolume", 3, "Game music volume in range 0-7", CvarFlags_Archive | CvarFlags_RequiresAppRestart);
 CvarInt gCvarSoundsVolume("g_soundsVolume", 3, "Audio effects volume in range 0-7", CvarFlags_Archive | CvarFlags_RequiresAppRestart);
+CvarFloat gCvarSoundsAudibleDistance("g_soundsAudibleDistance", 16.0f, "Sounds farther than this distance in map units from all listeners are culled", CvarFlags_Archive);
+CvarInt gCvarSoundsSampleRate("g_soundsSampleRate", 22050, "Resample sound effects to this rate on load, 0 keeps original rate", CvarFlags_Archive | CvarFlags_RequiresMapRestart);
+
+//////////////////////////////////////////////////////////////////////////
+
+// emitters spatial grid covers whole map, emitters outside are clamped to border cells
+static const int SfxGridCellMapUnits = 8;
+static const int SfxGridDims = MAP_DIMENSIONS / SfxGridCellMapUnits;
+static const float SfxGridCellSize = Convert::MapUnitsToMeters((float) SfxGridCellMapUnits);
+
+inline int GetSfxGridCoord(float position)
+{
+    return glm::clamp((int) floorf(position / SfxGridCellSize), 0, SfxGridDims - 1);
+}
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -71,6 +90,9 @@ bool AudioManager::PreloadLevelSounds()
 
 void AudioManager::ReleaseLevelSounds()
 {
+    // voices may refer level samples
+    ReleaseActiveEmitters();
+
     // stop all sources and detach buffers
     for (AudioSource* source: mSfxAudioSources)
     {
@@ -102,6 +124,7 @@ void AudioManager::ShutdownAudioResources()
         gAudioDevice.DestroyAudioSource(currSource);
     }
     mSfxAudioSources.clear();
+    mFreeSfxAudioSources.clear();
 
     if (mMusicAudioSource)
     {
@@ -117,15 +140,22 @@ void AudioManager::ShutdownAudioResources()
     mMusicSampleBuffers.clear();
 }
 
-AudioSource* AudioManager::GetFreeAudioSource() const
+AudioSource* AudioManager::AcquireAudioSource()
 {
-    for (AudioSource* currSource: mSfxAudioSources)
-    {
-        if (currSource && !currSource->IsPlaying() && !currSource->IsPaused())
-            return currSource;
-    }
+    if (mFreeSfxAudioSources.empty())
+        return nullptr;
+
+    AudioSource* audioSource = mFreeSfxAudioSources.back();
+    mFreeSfxAudioSources.pop_back();
+    return audioSource;
+}
+
+void AudioManager::ReleaseAudioSource(AudioSource* audioSource)
+{
+    debug_assert(audioSource);
+    debug_assert(!cxx::contains(mFreeSfxAudioSources, audioSource));
 
-    return nullptr;
+    mFreeSfxAudioSources.push_back(audioSource);
 }
 
 bool AudioManager::PrepareAudioResources()
@@ -138,6 +168,7 @@ bool AudioManager::PrepareAudioResources()
 
         mSfxAudioSources.push_back(audioSource);
     }
+    mFreeSfxAudioSources = mSfxAudioSources;
 
     // allocate additional music source
     mMusicAudioSource = gAudioDevice.CreateAudioSource();
@@ -163,34 +194,25 @@ bool AudioManager::PrepareAudioResources()
 
 void AudioManager::StopAllSounds()
 {
-    for (AudioSource* currSource: mSfxAudioSources)
+    for (SfxEmitter* currEmitter: mActiveEmitters)
     {
-        if (currSource->IsPlaying() || currSource->IsPaused())
-        {
-            currSource->Stop();
-        }
+        currEmitter->StopAllSounds();
     }
 }
 
 void AudioManager::PauseAllSounds()
 {
-    for (AudioSource* currSource: mSfxAudioSources)
+    for (SfxEmitter* currEmitter: mActiveEmitters)
     {
-        if (currSource->IsPlaying())
-        {
-            currSource->Pause();
-        }
+        currEmitter->PauseAllSounds();
     }
 }
 
 void AudioManager::ResumeAllSounds()
 {
-    for (AudioSource* currSource: mSfxAudioSources)
+    for (SfxEmitter* currEmitter: mActiveEmitters)
     {
-        if (currSource->IsPaused())
-        {
-            currSource->Resume();
-        }
+        currEmitter->ResumeAllSounds();
     }
 }
 
@@ -215,13 +237,36 @@ SfxSample* AudioManager::GetSound(eSfxSampleType sfxType, SfxSampleIndex sfxInde
             debug_assert(false);
             return nullptr;
         }
+        int sampleRate = archiveEntry.mSampleRate;
+        int bitsPerSample = archiveEntry.mBitsPerSample;
+        int dataLength = archiveEntry.mDataLength;
+        const void* sampleData = archiveEntry.mData;
+
+        // bring all sounds to single 16 bit format so device doesn't convert each one separately
+        int targetSampleRate = gCvarSoundsSampleRate.mValue;
+        if ((targetSampleRate > 0) && (dataLength > 0) && ((sampleRate != targetSampleRate) || (bitsPerSample != 16)))
+        {
+            int framesCount = dataLength / (archiveEntry.mChannelsCount * (bitsPerSample / 8));
+            int outputFramesCount = AudioResampler::GetOutputFramesCount(framesCount, sampleRate, targetSampleRate);
+            mResampledSoundData.resize(outputFramesCount * archiveEntry.mChannelsCount);
+            outputFramesCount = mSoundsResampler.ResampleFrames(sampleData, framesCount, sampleRate, bitsPerSample, 
+                archiveEntry.mChannelsCount, targetSampleRate, mResampledSoundData.data());
+            if (outputFramesCount > 0)
+            {
+                sampleRate = targetSampleRate;
+                bitsPerSample = 16;
+                dataLength = outputFramesCount * archiveEntry.mChannelsCount * (int) sizeof(short);
+                sampleData = mResampledSoundData.data();
+            }
+        }
+
         // upload audio data
         AudioSampleBuffer* audioBuffer = gAudioDevice.CreateSampleBuffer(
-            archiveEntry.mSampleRate,
-            archiveEntry.mBitsPerSample,
+            sampleRate,
+            bitsPerSample,
             archiveEntry.mChannelsCount,
-            archiveEntry.mDataLength,
-            archiveEntry.mData);
+            dataLength,
+            sampleData);
         debug_assert(audioBuffer && !audioBuffer->IsBufferError());
 
         // free source data
@@ -270,7 +315,9 @@ void AudioManager::ReleaseActiveEmitters()
         if (currEmitter->IsAutoreleaseEmitter())
         {
             deleteEmitters.push_back(currEmitter);
+            continue;
         }
+        currEmitter->ResetAudibility();
     }
     // destroy autorelease emitters
     for (SfxEmitter* currEmitter: deleteEmitters)
@@ -281,35 +328,283 @@ void AudioManager::ReleaseActiveEmitters()
 
 void AudioManager::UpdateActiveEmitters()
 {
+    mVoicesStats = AudioVoicesStats();
+
     if (mActiveEmitters.empty())
         return;
 
-    std::vector<SfxEmitter*> inactiveEmitters;
+    float deltaTime = gTimeManager.mSystemFrameDelta;
+
+    // remove finished emitters in place
+    int activeEmittersCount = 0;
     for (SfxEmitter* currEmitter: mActiveEmitters)
     {
         if (currEmitter->mGameObject) // sync audio params
         {
-            glm::vec3 gameObjectPosition = currEmitter->mGameObject->mTransform.mPosition;
-            currEmitter->UpdateEmitterParams(gameObjectPosition);
+            currEmitter->SetEmitterPosition(currEmitter->mGameObject->mTransform.mPosition);
         }
 
-        currEmitter->UpdateSounds();
+        currEmitter->UpdateSounds(deltaTime);
         if (!currEmitter->IsActiveEmitter())
         {
-            inactiveEmitters.push_back(currEmitter);
+            if (currEmitter->IsAutoreleaseEmitter())
+            {
+                mEmittersPool.destroy(currEmitter);
+                continue;
+            }
+            // stale culling result would decide hardware source binding when emitter starts playing again
+            currEmitter->ResetAudibility();
+            continue;
         }
+        mActiveEmitters[activeEmittersCount++] = currEmitter;
     }
+    mActiveEmitters.resize(activeEmittersCount);
 
-    for (SfxEmitter* currEmitter: inactiveEmitters)
+    UpdateEmittersAudibility();
+    UpdateVoicesVirtualization();
+
+    // sync positions of hardware sources in single pass, after voices got their sources
+    for (SfxEmitter* currEmitter: mActiveEmitters)
     {
-        cxx::erase_elements(mActiveEmitters, currEmitter);
-        if (currEmitter->IsAutoreleaseEmitter())
+        if (currEmitter->mAudible && currEmitter->mPositionChanged)
         {
-            mEmittersPool.destroy(currEmitter);
+            currEmitter->UploadEmitterParams();
+            ++mVoicesStats.mPositionUpdates;
         }
     }
 }
 
+void AudioManager::UpdateEmittersAudibility()
+{
+    const std::vector<AudioListener*>& audioListeners = gAudioDevice.GetAudioListeners();
+    if (audioListeners.empty())
+    {
+        // nothing to measure distance from, everything is audible
+        for (SfxEmitter* currEmitter: mActiveEmitters)
+        {
+            currEmitter->mAudible = true;
+            currEmitter->mListenerDistance = 0.0f;
+        }
+        mVoicesStats.mAudibleEmitters = (int) mActiveEmitters.size();
+        return;
+    }
+
+    for (SfxEmitter* currEmitter: mActiveEmitters)
+    {
+        currEmitter->mAudible = false;
+        currEmitter->mListenerDistance = std::numeric_limits<float>::max();
+    }
+
+    BuildEmittersGrid();
+
+    // visit only cells which overlap hearing range of each listener
+    const float audibleDistance = Convert::MapUnitsToMeters(gCvarSoundsAudibleDistance.mValue);
+    for (AudioListener* currListener: audioListeners)
+    {
+        const glm::vec3& listenerPosition = currListener->mPosition;
+        int minCellx = GetSfxGridCoord(listenerPosition.x - audibleDistance);
+        int maxCellx = GetSfxGridCoord(listenerPosition.x + audibleDistance);
+        int minCellz = GetSfxGridCoord(listenerPosition.z - audibleDistance);
+        int maxCellz = GetSfxGridCoord(listenerPosition.z + audibleDistance);
+        for (int cellz = minCellz; cellz <= maxCellz; ++cellz)
+        {
+            // cells within row are stored contiguously
+            int firstEntry = mEmittersGridCells[cellz * SfxGridDims + minCellx];
+            int lastEntry = mEmittersGridCells[cellz * SfxGridDims + maxCellx + 1];
+            for (int ientry = firstEntry; ientry < lastEntry; ++ientry)
+            {
+                SfxEmitter* currEmitter = mEmittersGridEntries[ientry];
+                glm::vec2 offset { currEmitter->mEmitterPosition.x - listenerPosition.x, currEmitter->mEmitterPosition.z - listenerPosition.z };
+                float listenerDistance = glm::length(offset);
+                if (listenerDistance > audibleDistance)
+                    continue;
+
+                currEmitter->mAudible = true;
+                currEmitter->mListenerDistance = std::min(currEmitter->mListenerDistance, listenerDistance);
+            }
+        }
+    }
+
+    for (SfxEmitter* currEmitter: mActiveEmitters)
+    {
+        if (currEmitter->mAudible)
+        {
+            ++mVoicesStats.mAudibleEmitters;
+        }
+        else
+        {
+            ++mVoicesStats.mCulledEmitters;
+        }
+    }
+}
+
+void AudioManager::BuildEmittersGrid()
+{
+    const int cellsCount = SfxGridDims * SfxGridDims;
+    const int emittersCount = (int) mActiveEmitters.size();
+
+    // counting sort by cell, buffers keep their capacity between frames
+    mEmittersGridCells.assign(cellsCount + 1, 0);
+    mEmittersGridEntries.resize(emittersCount);
+    mEmittersCellIndices.resize(emittersCount);
+
+    for (int iemitter = 0; iemitter < emittersCount; ++iemitter)
+    {
+        const glm::vec3& emitterPosition = mActiveEmitters[iemitter]->mEmitterPosition;
+        int cellIndex = GetSfxGridCoord(emitterPosition.z) * SfxGridDims + GetSfxGridCoord(emitterPosition.x);
+        mEmittersCellIndices[iemitter] = cellIndex;
+        ++mEmittersGridCells[cellIndex + 1];
+    }
+
+    for (int icell = 0; icell < cellsCount; ++icell)
+    {
+        mEmittersGridCells[icell + 1] += mEmittersGridCells[icell];
+    }
+
+    // scatter, each cell start is advanced to its end
+    for (int iemitter = 0; iemitter < emittersCount; ++iemitter)
+    {
+        int entryIndex = mEmittersGridCells[mEmittersCellIndices[iemitter]]++;
+        mEmittersGridEntries[entryIndex] = mActiveEmitters[iemitter];
+    }
+
+    // restore cell starts
+    for (int icell = cellsCount; icell > 0; --icell)
+    {
+        mEmittersGridCells[icell] = mEmittersGridCells[icell - 1];
+    }
+    mEmittersGridCells[0] = 0;
+}
+
+void AudioManager::UpdateVoicesVirtualization()
+{
+    mSfxVoices.clear();
+
+    for (SfxEmitter* currEmitter: mActiveEmitters)
+    {
+        for (int ichannel = 0, numChannels = (int) currEmitter->mAudioChannels.size(); ichannel < numChannels; ++ichannel)
+        {
+            SfxEmitter::SfxChannel& channel = currEmitter->mAudioChannels[ichannel];
+            if (!channel.mVoiceActive)
+                continue;
+
+            // out of hearing range, only playback time is tracked
+            if (!currEmitter->mAudible)
+            {
+                currEmitter->UnbindHardwareSource(channel);
+                ++mVoicesStats.mCulledVoices;
+                continue;
+            }
+
+            SfxVoice voice;
+            voice.mEmitter = currEmitter;
+            voice.mChannelIndex = ichannel;
+            voice.mPriority = ComputeVoicePriority(currEmitter, ichannel);
+            mSfxVoices.push_back(voice);
+        }
+    }
+
+    const int voicesCount = (int) mSfxVoices.size();
+    const int hardwareVoicesCount = std::min(voicesCount, (int) mSfxAudioSources.size());
+    if (hardwareVoicesCount < voicesCount)
+    {
+        std::nth_element(mSfxVoices.begin(), mSfxVoices.begin() + hardwareVoicesCount, mSfxVoices.end(), 
+            [](const SfxVoice& lhs, const SfxVoice& rhs)
+            {
+                return lhs.mPriority > rhs.mPriority;
+            });
+    }
+
+    // free sources of less important voices first
+    for (int ivoice = hardwareVoicesCount; ivoice < voicesCount; ++ivoice)
+    {
+        SfxVoice& currVoice = mSfxVoices[ivoice];
+        SfxEmitter::SfxChannel& channel = currVoice.mEmitter->mAudioChannels[currVoice.mChannelIndex];
+        if (channel.mHardwareSource)
+        {
+            currVoice.mEmitter->UnbindHardwareSource(channel);
+            ++mVoicesStats.mVoicesStolen;
+        }
+    }
+
+    // then bind sources to most important voices
+    for (int ivoice = 0; ivoice < hardwareVoicesCount; ++ivoice)
+    {
+        SfxVoice& currVoice = mSfxVoices[ivoice];
+        SfxEmitter::SfxChannel& channel = currVoice.mEmitter->mAudioChannels[currVoice.mChannelIndex];
+        if (channel.mHardwareSource)
+            continue;
+
+        AudioSource* audioSource = AcquireAudioSource();
+        if (audioSource == nullptr)
+        {
+            debug_assert(false);
+            break;
+        }
+        currVoice.mEmitter->BindHardwareSource(channel, audioSource);
+    }
+
+    mVoicesStats.mActiveVoices = voicesCount + mVoicesStats.mCulledVoices;
+    mVoicesStats.mHardwareVoices = (int) (mSfxAudioSources.size() - mFreeSfxAudioSources.size());
+    mVoicesStats.mVirtualVoices = mVoicesStats.mActiveVoices - mVoicesStats.mHardwareVoices;
+}
+
+float AudioManager::ComputeVoicePriority(SfxEmitter* emitter, int ichannel) const
+{
+    const SfxEmitter::SfxChannel& channel = emitter->mAudioChannels[ichannel];
+
+    float priority = 1.0f;
+    if ((channel.mSfxFlags & SfxFlags_HighPriority) > 0)
+    {
+        priority *= 4.0f;
+    }
+
+    // sounds made by human players or their cars should never be dropped
+    if (GameObject* gameObject = emitter->mGameObject)
+    {
+        Pedestrian* pedestrian = nullptr;
+        if (gameObject->IsPedestrianClass())
+        {
+            pedestrian = static_cast<Pedestrian*>(gameObject);
+        }
+        else if (gameObject->IsVehicleClass())
+        {
+            pedestrian = static_cast<Vehicle*>(gameObject)->GetCarDriver();
+        }
+
+        if (pedestrian && pedestrian->IsHumanPlayerCharacter())
+        {
+            priority *= 8.0f;
+        }
+    }
+
+    // distance attenuation, far voices will lose hardware sources first
+    float audibleDistance = Convert::MapUnitsToMeters(gCvarSoundsAudibleDistance.mValue);
+    if (audibleDistance > 0.0f)
+    {
+        float attenuation = 1.0f - glm::clamp(emitter->mListenerDistance / audibleDistance, 0.0f, 1.0f);
+        priority *= std::max(attenuation, 0.05f);
+    }
+
+    // fresh one shot sounds are more noticeable than ones which are about to end
+    if ((channel.mSfxFlags & SfxFlags_Loop) == 0)
+    {
+        priority /= (1.0f + channel.mPlaybackTime);
+    }
+
+    if (channel.mVoicePaused)
+    {
+        priority *= 0.5f;
+    }
+
+    // hysteresis, prevents voices from flapping between hardware and virtual state
+    if (channel.mHardwareSource)
+    {
+        priority *= 1.25f;
+    }
+    return priority;
+}
+
 bool AudioManager::StartSound(eSfxSampleType sfxType, SfxSampleIndex sfxIndex, SfxFlags sfxFlags, const glm::vec3& emitterPosition)
 {
     SfxSample* audioSample = GetSound(sfxType, sfxIndex);
@@ -332,7 +627,7 @@ float AudioManager::NextRandomPitch()
 {
     static const float _pitchValues[] = {0.95f, 1.0f, 1.1f};
 
-    int randomIndex = gCarnageGame.mGameRand.generate_int() % CountOf(_pitchValues);
+    int randomIndex = gCarnageGame.GetRandStream(eGameRandStream_Audio).generate_int() % CountOf(_pitchValues);
     return _pitchValues[randomIndex];
 }
 
@@ -352,6 +647,10 @@ void AudioManager::RegisterActiveEmitter(SfxEmitter* emitter)
 
 void AudioManager::UpdateMusic()
 {
+    mMusicStats.mBufferedChunks = mMusicStreamer.GetBufferedChunksCount();
+    mMusicStats.mAverageDecodeMs = mMusicStreamer.GetAverageDecodeMs();
+    mMusicStats.mMaxDecodeMs = mMusicStreamer.GetMaxDecodeMs();
+
     if ((gCvarGameMusicMode.mValue == eGameMusicMode_Disabled) || (mMusicStatus == eMusicStatus_Stopped))
         return;
 
@@ -363,34 +662,52 @@ void AudioManager::UpdateMusic()
 
     if (mMusicStatus == eMusicStatus_Playing)
     {
-        // process buffers
-        std::vector<AudioSampleBuffer*> sampleBuffers;
-        if (!mMusicAudioSource->ProcessBuffersQueue(sampleBuffers))
+        // keep next track queued so streaming thread can continue without gap
+        if (!mMusicTrackName.empty() && !mMusicStreamer.IsNextStreamQueued())
         {
-            StopMusic();
-            return;
+            AudioDataStream* nextStream = OpenAudioFileStream(mMusicTrackName.c_str());
+            if ((nextStream == nullptr) || !mMusicStreamer.QueueNextStream(nextStream))
+            {
+                SafeDelete(nextStream);
+                mMusicTrackName.clear();
+            }
         }
-        if (!sampleBuffers.empty())
+
+        // source stops by itself when all queued buffers are played
+        if (mMusicSourceStarted && !mMusicAudioSource->IsPlaying())
         {
-            mMusicSampleBuffers.insert(mMusicSampleBuffers.end(), sampleBuffers.begin(), sampleBuffers.end());
+            mMusicSourceStarted = false;
+            if (!mMusicStreamer.IsEndOfStream())
+            {
+                ++mMusicStats.mUnderrunsCount;
+            }
         }
 
-        if (!QueueMusicSampleBuffers())
+        ReclaimMusicSampleBuffers();
+        QueueMusicSampleBuffers();
+
+        if (mMusicSourceStarted)
+            return;
+
+        bool hasQueuedBuffers = (mMusicSampleBuffers.size() < MaxMusicSampleBuffers);
+        if (!hasQueuedBuffers)
         {
-            if (mMusicDataStream->EndOfStream())
+            if (mMusicStreamer.IsEndOfStream())
             {
                 StopMusic();
                 mMusicStatus = eMusicStatus_NextTrackRequest;
-                return;
             }
+            // otherwise wait for streaming thread
+            return;
         }
 
-        if (!mMusicAudioSource->IsPlaying() && !mMusicAudioSource->Start())
+        if (!mMusicAudioSource->Start())
         {
             StopMusic();
             return;
         }
 
+        mMusicSourceStarted = true;
         return;
     }
 }
@@ -402,22 +719,17 @@ bool AudioManager::StartMusic(const char* music)
     if (mMusicAudioSource == nullptr)
         return false;
 
-    mMusicDataStream = OpenAudioFileStream(music);
-    if (mMusicDataStream == nullptr)
+    AudioDataStream* dataStream = OpenAudioFileStream(music);
+    if (dataStream == nullptr)
         return false;
 
-    if (!QueueMusicSampleBuffers())
+    if (!mMusicStreamer.StartStreaming(dataStream))
     {
-        SafeDelete(mMusicDataStream);
-        return false;
-    }
-
-    if (!mMusicAudioSource->Start())
-    {
-        StopMusic();
+        SafeDelete(dataStream);
         return false;
     }
 
+    mMusicTrackName = music;
     mMusicStatus = eMusicStatus_Playing;
     return true;
 }
@@ -426,45 +738,55 @@ void AudioManager::StopMusic()
 {
     mMusicStatus = eMusicStatus_Stopped;
 
+    mMusicStreamer.StopStreaming();
+    mMusicTrackName.clear();
+
     if (mMusicAudioSource)
     {
-        std::vector<AudioSampleBuffer*> sampleBuffers;
         mMusicAudioSource->Stop();
-        mMusicAudioSource->ProcessBuffersQueue(sampleBuffers);
-        if (!sampleBuffers.empty())
-        {
-            mMusicSampleBuffers.insert(mMusicSampleBuffers.end(), sampleBuffers.begin(), sampleBuffers.end());
-        }
+        ReclaimMusicSampleBuffers();
     }
+    mMusicSourceStarted = false;
+    mMusicQueuedFormat = MusicPcmFormat();
+}
+
+void AudioManager::ReclaimMusicSampleBuffers()
+{
+    debug_assert(mMusicAudioSource);
 
-    SafeDelete(mMusicDataStream);
+    std::vector<AudioSampleBuffer*> sampleBuffers;
+    // source type is undetermined until first buffer gets queued
+    mMusicAudioSource->ProcessBuffersQueue(sampleBuffers);
+    if (!sampleBuffers.empty())
+    {
+        mMusicSampleBuffers.insert(mMusicSampleBuffers.end(), sampleBuffers.begin(), sampleBuffers.end());
+    }
 }
 
-bool AudioManager::QueueMusicSampleBuffers()
+int AudioManager::QueueMusicSampleBuffers()
 {
-    debug_assert(mMusicDataStream);
     debug_assert(mMusicAudioSource);
 
-    int bytesPerSample = mMusicDataStream->GetChannelsCount() * (mMusicDataStream->GetSampleBits() / 8);
-    int samplesPerBuffer = MusicSampleBufferSize / bytesPerSample;
-    // fill sample buffers
-    int totalSamplesProcessed = 0;
-    for (;;)
+    int queuedBuffersCount = 0;
+    while (!mMusicSampleBuffers.empty())
     {
-        if (mMusicSampleBuffers.empty())
+        const MusicStreamer::PcmChunk* pcmChunk = mMusicStreamer.PeekChunk();
+        if (pcmChunk == nullptr)
             break;
 
-        int numSamplesRead = mMusicDataStream->ReadPCMSamples(samplesPerBuffer, mMusicSampleData);
-        if (numSamplesRead == 0)
-            break;
+        // all buffers queued to source must share same format, so wait until queue is drained
+        if (pcmChunk->mFormat != mMusicQueuedFormat)
+        {
+            if (mMusicSampleBuffers.size() < MaxMusicSampleBuffers)
+                break;
 
-        int dataLength = numSamplesRead * bytesPerSample;
-        totalSamplesProcessed += numSamplesRead;
+            mMusicQueuedFormat = pcmChunk->mFormat;
+        }
 
         AudioSampleBuffer* sampleBuffer = mMusicSampleBuffers.front();
-        if (!sampleBuffer->SetupBufferData(mMusicDataStream->GetSampleRate(), 
-            mMusicDataStream->GetSampleBits(), 
-            mMusicDataStream->GetChannelsCount(), dataLength, mMusicSampleData))
+        if (!sampleBuffer->SetupBufferData(pcmChunk->mFormat.mSampleRate, 
+            pcmChunk->mFormat.mSampleBits, 
+            pcmChunk->mFormat.mChannelsCount, pcmChunk->mDataLength, pcmChunk->mData))
         {
             debug_assert(false);
             break;
@@ -476,9 +798,192 @@ bool AudioManager::QueueMusicSampleBuffers()
         }
 
         mMusicSampleBuffers.pop_front();
+        mMusicStreamer.PopChunk();
+        ++queuedBuffersCount;
+    }
+
+    return queuedBuffersCount;
+}
+
+bool AudioManager::RunMixerBenchmark(int voicesCount, float durationSeconds, const std::string& outputFilePath)
+{
+    const int samplesCount = mLevelSounds.GetEntriesCount();
+    if ((samplesCount == 0) || (voicesCount <= 0) || (durationSeconds <= 0.0f))
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot run mixer benchmark, level sounds are not loaded");
+        return false;
+    }
+
+    const int FramesPerMix = 1024;
+
+    AudioMixer audioMixer;
+    if (!audioMixer.Initialize(MixerSampleRate, FramesPerMix))
+        return false;
+
+    // load source data, it must be freed afterwards unless it's already in use
+    std::vector<AudioSampleArchive::SampleEntry> sampleEntries;
+    std::vector<int> loadedEntries;
+    for (int icurr = 0; icurr < samplesCount; ++icurr)
+    {
+        AudioSampleArchive::SampleEntry archiveEntry;
+        if (!mLevelSounds.GetEntryInfo(icurr, archiveEntry))
+            continue;
+
+        if ((archiveEntry.mBitsPerSample < 8) || (archiveEntry.mChannelsCount < 1))
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Mixer benchmark skips sound %d, unsupported format", icurr);
+            continue;
+        }
+
+        bool wasLoaded = (archiveEntry.mData != nullptr);
+        if (!mLevelSounds.GetEntryData(icurr, archiveEntry) || (archiveEntry.mDataLength == 0))
+            continue;
+
+        if (!wasLoaded)
+        {
+            loadedEntries.push_back(icurr);
+        }
+        sampleEntries.push_back(archiveEntry);
+    }
+
+    if (sampleEntries.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot run mixer benchmark, no level sounds can be mixed");
+        return false;
+    }
+
+    std::ofstream outputFile;
+    cxx::wave_writer waveWriter(outputFile);
+    if (!outputFilePath.empty())
+    {
+        outputFile.open(outputFilePath, std::ios::binary);
+        if (!waveWriter.write_header(2, MixerSampleRate, 16))
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Cannot create file '%s'", outputFilePath.c_str());
+        }
+    }
+
+    cxx::randomizer mixerRand;
+
+    auto StartRandomVoice = [&]()
+    {
+        const AudioSampleArchive::SampleEntry& archiveEntry = sampleEntries[mixerRand.generate_int((int) sampleEntries.size() - 1)];
+
+        AudioMixer::MixerVoice voice;
+        voice.mSampleData = archiveEntry.mData;
+        voice.mSampleRate = archiveEntry.mSampleRate;
+        voice.mBitsPerSample = archiveEntry.mBitsPerSample;
+        voice.mChannelsCount = archiveEntry.mChannelsCount;
+        voice.mSamplesCount = archiveEntry.mDataLength / (archiveEntry.mChannelsCount * (archiveEntry.mBitsPerSample / 8));
+        voice.mGain = 1.0f / voicesCount;
+        voice.mPan = mixerRand.generate_float(-1.0f, 1.0f);
+        voice.mPitch = mixerRand.generate_float(0.9f, 1.1f);
+        voice.mLoop = mixerRand.random_chance(25);
+        audioMixer.StartVoice(voice);
+    };
+
+    short outputFrames[FramesPerMix * 2];
+
+    const int totalFrames = (int) (durationSeconds * MixerSampleRate);
+    double mixTime = 0.0;
+    for (int framesMixed = 0; framesMixed < totalFrames; framesMixed += FramesPerMix)
+    {
+        // keep mixer saturated
+        for (int ivoice = audioMixer.GetActiveVoicesCount(); ivoice < voicesCount; ++ivoice)
+        {
+            StartRandomVoice();
+        }
+
+        int framesCount = std::min(FramesPerMix, totalFrames - framesMixed);
+
+        double startTime = gSystem.GetSystemSeconds();
+        audioMixer.MixFrames(framesCount, outputFrames);
+        mixTime += (gSystem.GetSystemSeconds() - startTime);
+
+        if (outputFile.is_open())
+        {
+            waveWriter.write_pcm_samples(framesCount, outputFrames);
+        }
+    }
+
+    if (outputFile.is_open())
+    {
+        waveWriter.finalize();
     }
 
-    return totalSamplesProcessed > 0;
+    for (int currEntry: loadedEntries)
+    {
+        mLevelSounds.FreeEntryData(currEntry);
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Mixer benchmark: %d voices, %.1f seconds of audio mixed in %.2f ms (x%.1f realtime)",
+        voicesCount, durationSeconds, mixTime * 1000.0, (mixTime > 0.0) ? (durationSeconds / mixTime) : 0.0);
+    return true;
+}
+
+bool AudioManager::RunDecoderBenchmark(const std::string& fileName)
+{
+    AudioDataStream* dataStream = OpenAudioFileStream(fileName.c_str());
+    if (dataStream == nullptr)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot open audio file '%s'", fileName.c_str());
+        return false;
+    }
+
+    const int channelsCount = dataStream->GetChannelsCount();
+    const int sampleRate = dataStream->GetSampleRate();
+    const int sampleBits = dataStream->GetSampleBits();
+    const int bytesPerFrame = channelsCount * (sampleBits / 8);
+    if ((bytesPerFrame <= 0) || (sampleRate <= 0))
+    {
+        SafeDelete(dataStream);
+        return false;
+    }
+
+    const int FramesPerRead = 4096;
+
+    // decode whole stream
+    std::vector<unsigned char> decodedData;
+    int framesDecoded = 0;
+
+    double decodeStartTime = gSystem.GetSystemSeconds();
+    for (;;)
+    {
+        decodedData.resize((framesDecoded + FramesPerRead) * bytesPerFrame);
+        int framesRead = dataStream->ReadPCMSamples(FramesPerRead, decodedData.data() + framesDecoded * bytesPerFrame);
+        framesDecoded += framesRead;
+        if ((framesRead < FramesPerRead) || dataStream->EndOfStream())
+            break;
+    }
+    double decodeTime = gSystem.GetSystemSeconds() - decodeStartTime;
+    SafeDelete(dataStream);
+
+    if (framesDecoded == 0)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Audio file '%s' contains no samples", fileName.c_str());
+        return false;
+    }
+
+    double durationSeconds = (1.0 * framesDecoded) / sampleRate;
+    gConsole.LogMessage(eLogMessage_Info, "Decoder benchmark: '%s' %d Hz %d bit %d ch, %.1f seconds decoded in %.2f ms (%.1f M samples/sec)",
+        fileName.c_str(), sampleRate, sampleBits, channelsCount, durationSeconds, decodeTime * 1000.0, 
+        (decodeTime > 0.0) ? ((1.0 * framesDecoded * channelsCount) / decodeTime) / 1000000.0 : 0.0);
+
+    // resample decoded data to typical device rate
+    const int OutputSampleRate = 44100;
+
+    AudioResampler resampler;
+    std::vector<short> resampledData(AudioResampler::GetOutputFramesCount(framesDecoded, sampleRate, OutputSampleRate) * channelsCount);
+
+    double resampleStartTime = gSystem.GetSystemSeconds();
+    int framesResampled = resampler.ResampleFrames(decodedData.data(), framesDecoded, sampleRate, sampleBits, channelsCount, 
+        OutputSampleRate, resampledData.data());
+    double resampleTime = gSystem.GetSystemSeconds() - resampleStartTime;
+
+    gConsole.LogMessage(eLogMessage_Info, "Resampler benchmark: %d Hz to %d Hz, %d frames in %.2f ms (%.1f M samples/sec)",
+        sampleRate, OutputSampleRate, framesResampled, resampleTime * 1000.0, 
+        (resampleTime > 0.0) ? ((1.0 * framesResampled * channelsCount) / resampleTime) / 1000000.0 : 0.0);
+    return true;
 }
 
 void AudioManager::InitSoundsAndMusicGainValue()
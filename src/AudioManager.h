@@ -4,12 +4,43 @@
 #include "SfxDefs.h"
 #include "SfxEmitter.h"
 #include "AudioDataStream.h"
+#include "MusicStreamer.h"
+#include "AudioResampler.h"
+
+// Logical voices statistics for last frame
+struct AudioVoicesStats
+{
+public:
+    int mActiveVoices = 0; // all playing sounds
+    int mHardwareVoices = 0; // sounds bound to hardware sources
+    int mVirtualVoices = 0; // sounds which are tracked but currently not heard
+    int mVoicesStolen = 0; // hardware sources taken from less important sounds
+    int mCulledVoices = 0; // sounds out of hearing range of all listeners
+    int mAudibleEmitters = 0; // emitters within hearing range of any listener
+    int mCulledEmitters = 0; // emitters out of hearing range, not synced with hardware
+    int mPositionUpdates = 0; // emitters whose position was sent to hardware sources
+};
+
+// Music streaming statistics
+struct AudioMusicStats
+{
+public:
+    int mUnderrunsCount = 0; // how many times music source ran out of queued data
+    int mBufferedChunks = 0; // decoded chunks waiting in streaming ring buffer
+    float mAverageDecodeMs = 0.0f; // time to decode single chunk on streaming thread
+    float mMaxDecodeMs = 0.0f;
+};
 
 // This class manages in game music and sounds
 class AudioManager final: public cxx::noncopyable
 {
     friend class SfxEmitter;
 
+public:
+    // readonly
+    AudioVoicesStats mVoicesStats;
+    AudioMusicStats mMusicStats;
+
 public:
     bool Initialize();
     void Deinit();
@@ -41,14 +72,41 @@ public:
     void PauseAllSounds();
     void ResumeAllSounds();
 
+    // Render level sounds with software mixer to wave file, does not require audio device
+    // @param voicesCount: Number of simultaneously playing voices
+    // @param durationSeconds: Length of rendered audio
+    // @param outputFilePath: Output wave file path, optional
+    bool RunMixerBenchmark(int voicesCount, float durationSeconds, const std::string& outputFilePath);
+
+    // Decode whole audio file and resample it, prints decoder and resampler throughput to console
+    // @param fileName: Audio file path, extension is optional
+    bool RunDecoderBenchmark(const std::string& fileName);
+
 private:
-    AudioSource* GetFreeAudioSource() const;
+    // logical voice reference
+    struct SfxVoice
+    {
+        SfxEmitter* mEmitter = nullptr;
+        int mChannelIndex = 0;
+        float mPriority = 0.0f;
+    };
+
+    // Get hardware source which is not used by any voice
+    AudioSource* AcquireAudioSource();
+    void ReleaseAudioSource(AudioSource* audioSource);
+
+    // Bind most important voices to hardware sources and virtualize others
+    void UpdateVoicesVirtualization();
+    float ComputeVoicePriority(SfxEmitter* emitter, int ichannel) const;
 
     void InitSoundsAndMusicGainValue();
     bool PrepareAudioResources();
     void ShutdownAudioResources();
 
     void UpdateActiveEmitters();
+    // Find emitters within hearing range of listeners using spatial grid
+    void UpdateEmittersAudibility();
+    void BuildEmittersGrid();
     void ReleaseActiveEmitters();
     void RegisterActiveEmitter(SfxEmitter* emitter);
 
@@ -59,13 +117,16 @@ private:
     bool StartMusic(const char* music);
     void StopMusic();
     void UpdateMusic();
-    bool QueueMusicSampleBuffers();
+    // Hand decoded chunks to music audio source
+    // @returns Number of queued buffers
+    int QueueMusicSampleBuffers();
+    void ReclaimMusicSampleBuffers();
 
 private:
     // constants
-    static const int MusicSampleBufferSize = 32768;
     static const int MaxSfxAudioSources = 32;
     static const int MaxMusicSampleBuffers = 4;
+    static const int MixerSampleRate = 22050;
 
     enum eMusicStatus
     {
@@ -76,20 +137,30 @@ private:
 
     // audio resources
     std::vector<AudioSource*> mSfxAudioSources; // available hardware audio sources
+    std::vector<AudioSource*> mFreeSfxAudioSources; // hardware sources not owned by any voice
+    std::vector<SfxVoice> mSfxVoices; // all logical voices, rebuilt every frame
     std::vector<SfxSample*> mLevelSfxSamples;
     std::vector<SfxSample*> mVoiceSfxSamples;
     std::vector<SfxEmitter*> mActiveEmitters;
+    // spatial grid of active emitters on xz plane, rebuilt every frame
+    std::vector<int> mEmittersGridCells; // first entry index for each cell, plus terminating entry
+    std::vector<SfxEmitter*> mEmittersGridEntries; // active emitters ordered by cell
+    std::vector<int> mEmittersCellIndices; // cell of each active emitter
     AudioSource* mMusicAudioSource = nullptr;
     std::deque<AudioSampleBuffer*> mMusicSampleBuffers;
 
     AudioSampleArchive mLevelSounds;
     AudioSampleArchive mVoiceSounds;
 
+    AudioResampler mSoundsResampler;
+    std::vector<short> mResampledSoundData; // temporary buffer for resampled sound effect
+
     // music data
     eMusicStatus mMusicStatus = eMusicStatus_NextTrackRequest;
-    AudioDataStream* mMusicDataStream = nullptr; // active music stream
-
-    unsigned char mMusicSampleData[MusicSampleBufferSize];
+    MusicStreamer mMusicStreamer;
+    MusicPcmFormat mMusicQueuedFormat; // format of buffers queued to music source
+    std::string mMusicTrackName; // track which is played in loop
+    bool mMusicSourceStarted = false;
 
     float mMusicGain = 1.0f;
     float mSoundsGain = 1.0f;
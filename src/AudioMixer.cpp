@@ -0,0 +1,259 @@
+#include "stdafx.h"
+#include "AudioMixer.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define AUDIO_MIXER_SSE2
+    #include <emmintrin.h>
+#endif
+
+AudioMixer::~AudioMixer()
+{
+    Deinit();
+}
+
+bool AudioMixer::Initialize(int outputSampleRate, int maxFramesPerMix)
+{
+    Deinit();
+
+    if ((outputSampleRate <= 0) || (maxFramesPerMix <= 0))
+    {
+        debug_assert(false);
+        return false;
+    }
+
+    mOutputSampleRate = outputSampleRate;
+    // keep buffers size multiple of 4 frames to simplify vectorized loops
+    mMaxFramesPerMix = (maxFramesPerMix + 3) & ~3;
+    mVoiceBuffer = new float[mMaxFramesPerMix];
+    mMixBuffer = new float[mMaxFramesPerMix * 2];
+    return true;
+}
+
+void AudioMixer::Deinit()
+{
+    mVoices.clear();
+    SafeDeleteArray(mVoiceBuffer);
+    SafeDeleteArray(mMixBuffer);
+    mMaxFramesPerMix = 0;
+    mOutputSampleRate = 0;
+}
+
+int AudioMixer::StartVoice(const MixerVoice& voiceParams)
+{
+    if ((voiceParams.mSampleData == nullptr) || (voiceParams.mSamplesCount <= 0) || (voiceParams.mSampleRate <= 0))
+    {
+        debug_assert(false);
+        return -1;
+    }
+
+    if (((voiceParams.mBitsPerSample != 8) && (voiceParams.mBitsPerSample != 16)) ||
+        ((voiceParams.mChannelsCount != 1) && (voiceParams.mChannelsCount != 2)))
+    {
+        debug_assert(false);
+        return -1;
+    }
+
+    // reuse finished voice slot
+    int voiceIndex = 0;
+    for (; voiceIndex < (int) mVoices.size(); ++voiceIndex)
+    {
+        if (!mVoices[voiceIndex].mActive)
+            break;
+    }
+    if (voiceIndex == (int) mVoices.size())
+    {
+        mVoices.emplace_back();
+    }
+
+    MixerVoiceState& voice = mVoices[voiceIndex];
+    voice.mParams = voiceParams;
+    voice.mPosition = 0.0;
+    voice.mActive = true;
+    return voiceIndex;
+}
+
+void AudioMixer::StopVoice(int voiceIndex)
+{
+    if ((voiceIndex < 0) || (voiceIndex >= (int) mVoices.size()))
+    {
+        debug_assert(false);
+        return;
+    }
+    mVoices[voiceIndex].mActive = false;
+}
+
+void AudioMixer::StopAllVoices()
+{
+    for (MixerVoiceState& currVoice: mVoices)
+    {
+        currVoice.mActive = false;
+    }
+}
+
+int AudioMixer::GetActiveVoicesCount() const
+{
+    int voicesCount = 0;
+    for (const MixerVoiceState& currVoice: mVoices)
+    {
+        if (currVoice.mActive)
+        {
+            ++voicesCount;
+        }
+    }
+    return voicesCount;
+}
+
+void AudioMixer::MixFrames(int framesCount, short* outputBuffer)
+{
+    debug_assert(outputBuffer);
+    debug_assert(mMixBuffer && mVoiceBuffer);
+
+    while (framesCount > 0)
+    {
+        int currFramesCount = std::min(framesCount, mMaxFramesPerMix);
+        ::memset(mMixBuffer, 0, currFramesCount * 2 * sizeof(float));
+
+        for (MixerVoiceState& currVoice: mVoices)
+        {
+            if (!currVoice.mActive)
+                continue;
+
+            int renderedFrames = RenderVoice(currVoice, currFramesCount, mVoiceBuffer);
+            if (renderedFrames > 0)
+            {
+                // constant power panning
+                float panAngle = (glm::clamp(currVoice.mParams.mPan, -1.0f, 1.0f) + 1.0f) * 0.25f * glm::pi<float>();
+                float gainL = cosf(panAngle) * currVoice.mParams.mGain;
+                float gainR = sinf(panAngle) * currVoice.mParams.mGain;
+                AccumulateVoice(mVoiceBuffer, renderedFrames, gainL, gainR);
+            }
+
+            if (renderedFrames < currFramesCount)
+            {
+                currVoice.mActive = false;
+            }
+        }
+
+        ConvertMixBuffer(currFramesCount, outputBuffer);
+
+        framesCount -= currFramesCount;
+        outputBuffer += currFramesCount * 2;
+    }
+}
+
+int AudioMixer::RenderVoice(MixerVoiceState& voice, int framesCount, float* outputBuffer) const
+{
+    const MixerVoice& params = voice.mParams;
+
+    const double positionStep = (1.0 * params.mSampleRate * params.mPitch) / mOutputSampleRate;
+    const int lastSample = params.mSamplesCount - 1;
+
+    int iframe = 0;
+    for (; iframe < framesCount; ++iframe)
+    {
+        if (voice.mPosition >= params.mSamplesCount)
+        {
+            if (!params.mLoop)
+                break;
+
+            voice.mPosition = fmod(voice.mPosition, (double) params.mSamplesCount);
+        }
+
+        int sampleIndex0 = (int) voice.mPosition;
+        int sampleIndex1 = std::min(sampleIndex0 + 1, lastSample);
+        float fraction = (float) (voice.mPosition - sampleIndex0);
+
+        float sample0 = 0.0f;
+        float sample1 = 0.0f;
+        if (params.mBitsPerSample == 8)
+        {
+            // unsigned 8 bit pcm, downmix to mono
+            const unsigned char* sampleData = params.mSampleData;
+            for (int ichannel = 0; ichannel < params.mChannelsCount; ++ichannel)
+            {
+                sample0 += (sampleData[sampleIndex0 * params.mChannelsCount + ichannel] - 128) * (1.0f / 128.0f);
+                sample1 += (sampleData[sampleIndex1 * params.mChannelsCount + ichannel] - 128) * (1.0f / 128.0f);
+            }
+        }
+        else
+        {
+            // signed 16 bit pcm, downmix to mono
+            const short* sampleData = reinterpret_cast<const short*>(params.mSampleData);
+            for (int ichannel = 0; ichannel < params.mChannelsCount; ++ichannel)
+            {
+                sample0 += sampleData[sampleIndex0 * params.mChannelsCount + ichannel] * (1.0f / 32768.0f);
+                sample1 += sampleData[sampleIndex1 * params.mChannelsCount + ichannel] * (1.0f / 32768.0f);
+            }
+        }
+
+        if (params.mChannelsCount == 2)
+        {
+            sample0 *= 0.5f;
+            sample1 *= 0.5f;
+        }
+
+        outputBuffer[iframe] = sample0 + (sample1 - sample0) * fraction;
+        voice.mPosition += positionStep;
+    }
+
+    // pad to vector width
+    for (int ipad = iframe; ipad < framesCount; ++ipad)
+    {
+        outputBuffer[ipad] = 0.0f;
+    }
+    return iframe;
+}
+
+void AudioMixer::AccumulateVoice(const float* voiceBuffer, int framesCount, float gainL, float gainR)
+{
+    float* mixBuffer = mMixBuffer;
+    int iframe = 0;
+
+#ifdef AUDIO_MIXER_SSE2
+    const __m128 gainLR = _mm_setr_ps(gainL, gainR, gainL, gainR);
+    for (; iframe + 4 <= framesCount; iframe += 4)
+    {
+        __m128 monoFrames = _mm_loadu_ps(voiceBuffer + iframe);
+        __m128 stereoLo = _mm_unpacklo_ps(monoFrames, monoFrames); // 0 0 1 1
+        __m128 stereoHi = _mm_unpackhi_ps(monoFrames, monoFrames); // 2 2 3 3
+
+        float* mixFrames = mixBuffer + iframe * 2;
+        _mm_storeu_ps(mixFrames + 0, _mm_add_ps(_mm_loadu_ps(mixFrames + 0), _mm_mul_ps(stereoLo, gainLR)));
+        _mm_storeu_ps(mixFrames + 4, _mm_add_ps(_mm_loadu_ps(mixFrames + 4), _mm_mul_ps(stereoHi, gainLR)));
+    }
+#endif
+
+    for (; iframe < framesCount; ++iframe)
+    {
+        mixBuffer[iframe * 2 + 0] += voiceBuffer[iframe] * gainL;
+        mixBuffer[iframe * 2 + 1] += voiceBuffer[iframe] * gainR;
+    }
+}
+
+void AudioMixer::ConvertMixBuffer(int framesCount, short* outputBuffer) const
+{
+    const int samplesCount = framesCount * 2;
+    int isample = 0;
+
+#ifdef AUDIO_MIXER_SSE2
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const __m128 minSample = _mm_set1_ps(-1.0f);
+    const __m128 maxSample = _mm_set1_ps(1.0f);
+    for (; isample + 8 <= samplesCount; isample += 8)
+    {
+        // clamp before conversion, out of range floats convert to 0x80000000 instead of saturating
+        __m128 mixLo = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(mMixBuffer + isample + 0), minSample), maxSample);
+        __m128 mixHi = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(mMixBuffer + isample + 4), minSample), maxSample);
+        __m128i samplesLo = _mm_cvtps_epi32(_mm_mul_ps(mixLo, scale));
+        __m128i samplesHi = _mm_cvtps_epi32(_mm_mul_ps(mixHi, scale));
+        // pack with signed saturation
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(outputBuffer + isample), _mm_packs_epi32(samplesLo, samplesHi));
+    }
+#endif
+
+    for (; isample < samplesCount; ++isample)
+    {
+        float sampleValue = glm::clamp(mMixBuffer[isample], -1.0f, 1.0f) * 32767.0f;
+        outputBuffer[isample] = (short) lrintf(sampleValue);
+    }
+}
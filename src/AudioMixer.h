@@ -0,0 +1,70 @@
+#pragma once
+
+// Pure software audio mixer, renders voices into interleaved 16 bit stereo pcm data
+// It does not require audio device so it can be used for offline rendering and benchmarking
+class AudioMixer final: public cxx::noncopyable
+{
+public:
+    // Mixer voice params, sample data is not owned by mixer
+    struct MixerVoice
+    {
+        const unsigned char* mSampleData = nullptr;
+        int mSamplesCount = 0; // per channel
+        int mSampleRate = 0;
+        int mBitsPerSample = 0; // 8 or 16
+        int mChannelsCount = 0; // 1 or 2
+        float mGain = 1.0f;
+        float mPan = 0.0f; // in range [-1, 1]
+        float mPitch = 1.0f;
+        bool mLoop = false;
+    };
+
+public:
+    ~AudioMixer();
+
+    // Setup mixer internal buffers
+    // @param outputSampleRate: Output sample rate
+    // @param maxFramesPerMix: Max stereo frames count per single MixFrames call
+    bool Initialize(int outputSampleRate, int maxFramesPerMix);
+    void Deinit();
+
+    // Add new voice to mixer
+    // @returns Voice index or -1 on error
+    int StartVoice(const MixerVoice& voiceParams);
+    void StopVoice(int voiceIndex);
+    void StopAllVoices();
+
+    // Render and mix all active voices into output buffer
+    // @param framesCount: Stereo frames count to render
+    // @param outputBuffer: Interleaved 16 bit stereo pcm data
+    void MixFrames(int framesCount, short* outputBuffer);
+
+    int GetActiveVoicesCount() const;
+    int GetOutputSampleRate() const { return mOutputSampleRate; }
+
+private:
+    // internal voice state
+    struct MixerVoiceState
+    {
+        MixerVoice mParams;
+        double mPosition = 0.0; // source sample position
+        bool mActive = false;
+    };
+
+    // Resample voice to output rate and convert to normalized float mono data
+    // @returns Number of rendered frames, rest of buffer is filled with silence
+    int RenderVoice(MixerVoiceState& voice, int framesCount, float* outputBuffer) const;
+
+    // Accumulate mono data into stereo mix buffer
+    void AccumulateVoice(const float* voiceBuffer, int framesCount, float gainL, float gainR);
+
+    // Convert mix buffer to 16 bit pcm with saturation
+    void ConvertMixBuffer(int framesCount, short* outputBuffer) const;
+
+private:
+    std::vector<MixerVoiceState> mVoices;
+    float* mVoiceBuffer = nullptr; // mono frames
+    float* mMixBuffer = nullptr; // stereo frames
+    int mMaxFramesPerMix = 0;
+    int mOutputSampleRate = 0;
+};
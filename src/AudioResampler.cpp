@@ -0,0 +1,187 @@
+#include "stdafx.h"
+#include "AudioResampler.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define AUDIO_RESAMPLER_SSE2
+    #include <emmintrin.h>
+#endif
+
+// number of fractional positions between two source frames, nearest one is used
+static const int FilterPhasesCount = 512;
+
+// number of sinc zero crossings on each side of filter center
+static const int FilterZeroCrossings = 16;
+
+// cutoff relative to lower of source and output nyquist frequencies, leaves room for transition band
+static const double FilterCutoff = 0.9;
+
+int AudioResampler::GetOutputFramesCount(int framesCount, int sourceSampleRate, int outputSampleRate)
+{
+    if ((framesCount <= 0) || (sourceSampleRate <= 0) || (outputSampleRate <= 0))
+        return 0;
+
+    long long outputFramesCount = ((long long) framesCount * outputSampleRate) / sourceSampleRate;
+    return std::max((int) outputFramesCount, 1);
+}
+
+int AudioResampler::ResampleFrames(const void* sourceData, int framesCount, int sourceSampleRate, int sampleBits, int channelsCount,
+    int outputSampleRate, short* outputData)
+{
+    if ((sourceData == nullptr) || (outputData == nullptr))
+    {
+        debug_assert(false);
+        return 0;
+    }
+
+    if (((sampleBits != 8) && (sampleBits != 16)) || ((channelsCount != 1) && (channelsCount != 2)))
+    {
+        debug_assert(false);
+        return 0;
+    }
+
+    int outputFramesCount = GetOutputFramesCount(framesCount, sourceSampleRate, outputSampleRate);
+    if (outputFramesCount == 0)
+        return 0;
+
+    // same rate, only sample format changes
+    if (sourceSampleRate == outputSampleRate)
+    {
+        int samplesCount = framesCount * channelsCount;
+        if (sampleBits == 8)
+        {
+            const unsigned char* sourceSamples = static_cast<const unsigned char*>(sourceData);
+            for (int isample = 0; isample < samplesCount; ++isample)
+            {
+                outputData[isample] = (short) ((sourceSamples[isample] - 128) << 8);
+            }
+        }
+        else
+        {
+            ::memcpy(outputData, sourceData, samplesCount * sizeof(short));
+        }
+        return framesCount;
+    }
+
+    SetupFilter(sourceSampleRate, outputSampleRate);
+
+    // convert to planar float, each channel is padded with copies of its first and last frames
+    // so filter never reads out of range
+    const int paddingFrames = mFilterTapsCount;
+    mSourceFramesCount = framesCount;
+    mSourceFramesStride = framesCount + paddingFrames * 2;
+    mSourceFrames.resize(mSourceFramesStride * channelsCount);
+    for (int ichannel = 0; ichannel < channelsCount; ++ichannel)
+    {
+        float* channelFrames = &mSourceFrames[ichannel * mSourceFramesStride + paddingFrames];
+        if (sampleBits == 8)
+        {
+            const unsigned char* sourceSamples = static_cast<const unsigned char*>(sourceData) + ichannel;
+            for (int iframe = 0; iframe < framesCount; ++iframe)
+            {
+                channelFrames[iframe] = (sourceSamples[iframe * channelsCount] - 128) * (1.0f / 128.0f);
+            }
+        }
+        else
+        {
+            const short* sourceSamples = static_cast<const short*>(sourceData) + ichannel;
+            for (int iframe = 0; iframe < framesCount; ++iframe)
+            {
+                channelFrames[iframe] = sourceSamples[iframe * channelsCount] * (1.0f / 32768.0f);
+            }
+        }
+        std::fill(channelFrames - paddingFrames, channelFrames, channelFrames[0]);
+        std::fill(channelFrames + framesCount, channelFrames + framesCount + paddingFrames, channelFrames[framesCount - 1]);
+    }
+
+    // source position in 32.32 fixed point
+    unsigned long long positionStep = ((unsigned long long) sourceSampleRate << 32) / (unsigned long long) outputSampleRate;
+    for (int ichannel = 0; ichannel < channelsCount; ++ichannel)
+    {
+        ResampleChannel(ichannel, channelsCount, outputFramesCount, positionStep, outputData);
+    }
+    return outputFramesCount;
+}
+
+void AudioResampler::SetupFilter(int sourceSampleRate, int outputSampleRate)
+{
+    if ((mFilterSourceRate == sourceSampleRate) && (mFilterOutputRate == outputSampleRate))
+        return;
+
+    mFilterSourceRate = sourceSampleRate;
+    mFilterOutputRate = outputSampleRate;
+
+    // cutoff in cycles per source frame multiplied by 2, when downsampling filter gets wider
+    // in source frames to keep same number of zero crossings
+    const double cutoff = FilterCutoff * std::min(1.0, (1.0 * outputSampleRate) / sourceSampleRate);
+    const double halfWidth = FilterZeroCrossings / cutoff;
+
+    // one extra tap on each side covers fractional offset, taps count is kept multiple of 4 for simd
+    mFilterTapsCount = ((int) ceil(halfWidth) * 2 + 2 + 3) & ~3;
+    mFilterTable.resize((FilterPhasesCount + 1) * mFilterTapsCount);
+
+    // tap k of phase p is applied to source frame (floor(position) - halfTaps + 1 + k),
+    // its distance from position is (k - halfTaps + 1 - p / phasesCount)
+    const int halfTaps = mFilterTapsCount / 2;
+    for (int iphase = 0; iphase <= FilterPhasesCount; ++iphase)
+    {
+        float* phaseTaps = &mFilterTable[iphase * mFilterTapsCount];
+        double tapsSum = 0.0;
+        for (int itap = 0; itap < mFilterTapsCount; ++itap)
+        {
+            double distance = (itap - halfTaps + 1) - (1.0 * iphase) / FilterPhasesCount;
+            double tapValue = 0.0;
+            if (fabs(distance) < halfWidth)
+            {
+                // blackman window over sinc
+                double x = glm::pi<double>() * distance * cutoff;
+                double sinc = (fabs(x) < 1e-9) ? 1.0 : (sin(x) / x);
+                double windowPos = glm::pi<double>() * distance / halfWidth;
+                double window = 0.42 + 0.5 * cos(windowPos) + 0.08 * cos(2.0 * windowPos);
+                tapValue = sinc * window;
+            }
+            phaseTaps[itap] = (float) tapValue;
+            tapsSum += tapValue;
+        }
+        // normalize to unity gain so constant signal stays unchanged
+        for (int itap = 0; itap < mFilterTapsCount; ++itap)
+        {
+            phaseTaps[itap] = (float) (phaseTaps[itap] / tapsSum);
+        }
+    }
+}
+
+void AudioResampler::ResampleChannel(int channelIndex, int channelsCount, int outputFramesCount, unsigned long long positionStep, short* outputData) const
+{
+    // first tap of output frame at position P reads padded frame (floor(P) - halfTaps + 1 + padding)
+    const int halfTaps = mFilterTapsCount / 2;
+    const float* sourceFrames = &mSourceFrames[channelIndex * mSourceFramesStride + mFilterTapsCount - halfTaps + 1];
+
+    unsigned long long position = 0;
+    for (int iframe = 0; iframe < outputFramesCount; ++iframe, position += positionStep)
+    {
+        const float* frames = sourceFrames + (int) (position >> 32);
+        // round fraction to nearest phase
+        const int phaseIndex = (int) (((position & 0xFFFFFFFFULL) * FilterPhasesCount + 0x80000000ULL) >> 32);
+        const float* phaseTaps = &mFilterTable[phaseIndex * mFilterTapsCount];
+
+        float result = 0.0f;
+        int itap = 0;
+#ifdef AUDIO_RESAMPLER_SSE2
+        // accumulate four taps at once
+        __m128 accum = _mm_setzero_ps();
+        for (; itap < mFilterTapsCount; itap += 4)
+        {
+            accum = _mm_add_ps(accum, _mm_mul_ps(_mm_loadu_ps(frames + itap), _mm_loadu_ps(phaseTaps + itap)));
+        }
+        accum = _mm_add_ps(accum, _mm_movehl_ps(accum, accum));
+        accum = _mm_add_ss(accum, _mm_shuffle_ps(accum, accum, 1));
+        result = _mm_cvtss_f32(accum);
+#endif
+        for (; itap < mFilterTapsCount; ++itap)
+        {
+            result += frames[itap] * phaseTaps[itap];
+        }
+        result = glm::clamp(result, -1.0f, 1.0f);
+        outputData[iframe * channelsCount + channelIndex] = (short) lrintf(result * 32767.0f);
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Sample rate converter for pcm data, output is always signed 16 bit
+// Used to bring sounds with different sample rates to single audio buffer format
+class AudioResampler final: public cxx::noncopyable
+{
+public:
+    // Get number of output frames after sample rate conversion
+    // @param framesCount: Source frames count
+    static int GetOutputFramesCount(int framesCount, int sourceSampleRate, int outputSampleRate);
+
+    // Convert pcm data using windowed sinc interpolation, when downsampling filter cutoff
+    // is lowered to output nyquist frequency so high frequencies do not alias
+    // @param sourceData: Interleaved 8 bit unsigned or 16 bit signed pcm data
+    // @param framesCount: Source frames count
+    // @param outputData: Interleaved 16 bit pcm data, must fit GetOutputFramesCount frames
+    // @returns Number of output frames
+    int ResampleFrames(const void* sourceData, int framesCount, int sourceSampleRate, int sampleBits, int channelsCount,
+        int outputSampleRate, short* outputData);
+
+private:
+    // Build polyphase filter table for specified conversion, does nothing if table is already built
+    void SetupFilter(int sourceSampleRate, int outputSampleRate);
+
+    // Resample single channel of normalized source data
+    void ResampleChannel(int channelIndex, int channelsCount, int outputFramesCount, unsigned long long positionStep, short* outputData) const;
+
+private:
+    std::vector<float> mSourceFrames; // planar source data converted to float, padded with filter taps on both sides
+    int mSourceFramesCount = 0;
+    int mSourceFramesStride = 0;
+
+    std::vector<float> mFilterTable; // filter taps for each of FilterPhasesCount fractional positions
+    int mFilterTapsCount = 0;
+    int mFilterSourceRate = 0;
+    int mFilterOutputRate = 0;
+};
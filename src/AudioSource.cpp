@@ -321,6 +321,18 @@ bool AudioSource::SetVelocity3D(float velocityx, float velocityy, float velocity
     return false;
 }
 
+bool AudioSource::SetPlaybackOffset(float seconds)
+{
+    if (::alIsSource(mSourceID))
+    {
+        ::alSourcef(mSourceID, AL_SEC_OFFSET, seconds);
+        alCheckError();
+
+        return true;
+    }
+    return false;
+}
+
 eAudioSourceStatus AudioSource::GetSourceStatus() const
 {
     if (::alIsSource(mSourceID))
@@ -78,6 +78,8 @@ public:
     bool SetPitch(float value);
     bool SetPosition3D(float positionx, float positiony, float positionz);
     bool SetVelocity3D(float velocityx, float velocityy, float velocityz);
+    // Set playback position within attached sample buffer
+    bool SetPlaybackOffset(float seconds);
     // Get source current status
     eAudioSourceStatus GetSourceStatus() const;
     // Status shortcuts
@@ -112,4 +114,6 @@ private:
     unsigned int mSourceID = 0; // openal source handle
 
     glm::vec3 mSourceLocation;
+    glm::vec3 mUploadedLocation; // relative position last sent to openal
+    bool mLocationUploaded = false;
 };
\ No newline at end of file
@@ -16,6 +16,8 @@
 #include "cvars.h"
 #include "ParticleEffectsManager.h"
 #include "WeatherManager.h"
+#include "ProjectilesManager.h"
+#include "ExplosionsManager.h"
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -32,12 +34,32 @@ CvarString gCvarCurrentBaseDir("g_basedir", "", "Current gta data location", Cva
 CvarEnum<eGtaGameVersion> gCvarGameVersion("g_gamever", eGtaGameVersion_Unknown, "Current gta game version", CvarFlags_Init);
 CvarString gCvarGameLanguage("g_gamelang", "en", "Current game language", CvarFlags_Init);
 CvarInt gCvarNumPlayers("g_numplayers", 1, "Number of players in split screen mode", CvarFlags_Init);
+CvarBoolean gCvarGameLockstep("g_lockstep", false, "Deterministic simulation with fixed frame delta and seeded random streams", CvarFlags_Archive | CvarFlags_RequiresMapRestart);
+CvarFloat gCvarGameLockstepFramerate("g_lockstepFramerate", 30.0f, "Game frames per second in lockstep mode", CvarFlags_Archive | CvarFlags_RequiresMapRestart);
+CvarInt gCvarGameLockstepSeed("g_lockstepSeed", 1, "Random seed in lockstep mode", CvarFlags_Archive | CvarFlags_RequiresMapRestart);
+CvarBoolean gCvarGameLockstepHashLog("g_lockstepHashLog", false, "Print state hash of each frame in lockstep mode", CvarFlags_None);
+CvarString gCvarGameLockstepHashRecord("g_lockstepHashRecord", "", "Write state hash of each frame to file in lockstep mode", CvarFlags_RequiresMapRestart);
+CvarString gCvarGameLockstepHashCompare("g_lockstepHashCompare", "", "Compare state hash of each frame in lockstep mode with file written by g_lockstepHashRecord", CvarFlags_RequiresMapRestart);
 
 // debug
 CvarVoid gCvarDbgDumpSpriteDeltas("dbg_dumpSpriteDeltas", "Dump sprite deltas", CvarFlags_None);
 CvarVoid gCvarDbgDumpBlockTextures("dbg_dumpBlocks", "Dump block textures", CvarFlags_None);
 CvarVoid gCvarDbgDumpSprites("dbg_dumpSprites", "Dump all sprites", CvarFlags_None);
 CvarVoid gCvarDbgDumpCarSprites("dbg_dumpCarSprites", "Dump car sprites", CvarFlags_None);
+CvarVoid gCvarDbgAudioMixerBenchmark("dbg_audioMixerBench", "Mix level sounds with software mixer to wave file, args: [voices] [seconds]", CvarFlags_None);
+CvarVoid gCvarDbgAudioDecodeBenchmark("dbg_audioDecodeBench", "Decode audio file and measure decoder and resampler throughput, args: [file]", CvarFlags_None);
+CvarVoid gCvarDbgVehicleDynamicsBenchmark("dbg_vehicleDynamicsBench", "Spawn cars around player and compare batched vehicle dynamics with per-vehicle model, args: [iterations]", CvarFlags_None);
+CvarVoid gCvarDbgProjectilesBenchmark("dbg_projectilesBench", "Keep projectiles flying from player in random directions and measure update time, args: [projectiles] [frames]", CvarFlags_None);
+CvarVoid gCvarDbgLineOfSightBenchmark("dbg_losBench", "Trace random map segments around player and measure line of sight queries throughput, args: [rays]", CvarFlags_None);
+CvarVoid gCvarDbgCollisionEventsBenchmark("dbg_collisionsBench", "Spawn cars pileup around player and measure collision events dispatch, args: [cars] [steps]", CvarFlags_None);
+CvarVoid gCvarDbgPedestriansBenchmark("dbg_pedsBench", "Spawn wandering pedestrians around player and measure objects update time without rendering, args: [peds] [frames]", CvarFlags_None);
+CvarVoid gCvarDbgSpritesBenchmark("dbg_spritesBench", "Measure sprites extraction time for split screen views, per view versus shared, without rendering, args: [views] [frames]", CvarFlags_None);
+CvarVoid gCvarDbgRenderCallsBenchmark("dbg_renderCallsBench", "Count graphics api calls per frame with state cache disabled and enabled, args: [frames]", CvarFlags_None);
+CvarVoid gCvarDbgHudBenchmark("dbg_hudBench", "Measure hud update and draw cpu time for all players with hud cache disabled and enabled, args: [frames]", CvarFlags_None);
+CvarVoid gCvarDbgSpritesBuildBenchmark("dbg_spritesBuildBench", "Measure sprites geometry generation time, vertices versus instances, without rendering, args: [sprites] [frames]", CvarFlags_None);
+CvarVoid gCvarDbgSpritesOcclusionTest("dbg_spritesOcclusionTest", "Check sprites occlusion test against predefined lids layouts, including staggered lids", CvarFlags_None);
+CvarVoid gCvarDbgExplosionChainBenchmark("dbg_explosionChainBench", "Spawn cars pileup around player, blow up one of them and measure frame time of chain explosion, args: [cars] [frames]", CvarFlags_None);
+CvarVoid gCvarDbgPhysicsBenchmark("dbg_physicsBench", "Spawn cars around player and measure physics step time with 1..N threads and frame time after hitches, args: [cars] [steps] [frameMs]", CvarFlags_None);
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -349,9 +371,13 @@ bool CarnageGame::StartScenario(const std::string& mapName)
         debug_assert(false);
     }
 
+    SetupSimulationMode();
+
     gPhysics.EnterWorld();
     gParticleManager.EnterWorld();
     gGameObjectsManager.EnterWorld();
+    gProjectilesManager.EnterWorld();
+    gExplosionsManager.EnterWorld();
     // temporary
     //glm::vec3 pos { 108.0f, 2.0f, 25.0f };
     //glm::vec3 pos { 14.0, 2.0f, 38.0f };
@@ -421,12 +447,132 @@ void CarnageGame::ShutdownCurrentScenario()
     gAiManager.ReleaseAiControllers();
     gTrafficManager.CleanupTraffic();
     gWeatherManager.ClearWorld();
+    gProjectilesManager.ClearWorld();
+    gExplosionsManager.ClearWorld();
     gGameObjectsManager.ClearWorld();
     gPhysics.ClearWorld();
     gGameMap.Cleanup();
     gBroadcastEvents.ClearEvents();
     gAudioManager.ReleaseLevelSounds();
     gParticleManager.ClearWorld();
+    gTimeManager.SetFixedGameFrameDelta(0.0f);
+
+    mStateHashRecordFile.close();
+    mReferenceStateHashes.clear();
+}
+
+void CarnageGame::SetupSimulationMode()
+{
+    mSimulationFrame = 0;
+    mStateHash = 0;
+    mStateHashDivergedFrame = 0;
+    mStateHashRecordFile.close();
+    mReferenceStateHashes.clear();
+
+    unsigned int randomSeed = 0;
+    if (gCvarGameLockstep.mValue)
+    {
+        float framerate = glm::clamp(gCvarGameLockstepFramerate.mValue, 1.0f, 1000.0f);
+        gTimeManager.SetFixedGameFrameDelta(1.0f / framerate);
+        randomSeed = (unsigned int) gCvarGameLockstepSeed.mValue;
+        gConsole.LogMessage(eLogMessage_Info, "Lockstep mode: %.1f frames per second, seed %u", framerate, randomSeed);
+        SetupStateHashFiles();
+    }
+    else
+    {
+        gTimeManager.SetFixedGameFrameDelta(0.0f);
+        randomSeed = (unsigned int) mGameRand.generate_int();
+    }
+
+    mGameRand.set_seed(randomSeed);
+    for (int istream = 0; istream < eGameRandStream_COUNT; ++istream)
+    {
+        mRandStreams[istream].set_seed(randomSeed + (istream + 1) * 0x9E3779B9U);
+    }
+}
+
+cxx::randomizer& CarnageGame::GetRandStream(eGameRandStream randStream)
+{
+    debug_assert(randStream < eGameRandStream_COUNT);
+    return mRandStreams[randStream];
+}
+
+bool CarnageGame::IsLockstepMode() const
+{
+    return gTimeManager.IsFixedGameFrameDelta();
+}
+
+void CarnageGame::FinishSimulationFrame()
+{
+    ++mSimulationFrame;
+
+    if (!IsLockstepMode())
+        return;
+
+    mStateHash = gGameObjectsManager.ComputeStateHash();
+    mStateHash = gProjectilesManager.ComputeStateHash(mStateHash);
+    if (gCvarGameLockstepHashLog.mValue)
+    {
+        gConsole.LogMessage(eLogMessage_Debug, "Frame %d state hash %016llx", mSimulationFrame, mStateHash);
+    }
+
+    if (mStateHashRecordFile.is_open())
+    {
+        mStateHashRecordFile << cxx::va("%d %016llx", mSimulationFrame, mStateHash) << std::endl;
+    }
+
+    // report first frame only, once diverged all following frames differ too
+    if ((mStateHashDivergedFrame == 0) && (mSimulationFrame <= (int) mReferenceStateHashes.size()))
+    {
+        unsigned long long referenceHash = mReferenceStateHashes[mSimulationFrame - 1];
+        if (referenceHash != mStateHash)
+        {
+            mStateHashDivergedFrame = mSimulationFrame;
+            gConsole.LogMessage(eLogMessage_Warning, "Lockstep state diverged from reference at frame %d (%016llx, expected %016llx)",
+                mSimulationFrame, mStateHash, referenceHash);
+        }
+    }
+}
+
+void CarnageGame::SetupStateHashFiles()
+{
+    const std::string& recordFileName = gCvarGameLockstepHashRecord.mValue;
+    if (!recordFileName.empty())
+    {
+        if (gFiles.CreateTextFile(recordFileName, mStateHashRecordFile))
+        {
+            gConsole.LogMessage(eLogMessage_Info, "Lockstep state hashes are written to '%s'", recordFileName.c_str());
+        }
+        else
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Cannot create lockstep state hashes file '%s'", recordFileName.c_str());
+        }
+    }
+
+    const std::string& compareFileName = gCvarGameLockstepHashCompare.mValue;
+    if (compareFileName.empty())
+        return;
+
+    std::ifstream referenceFile;
+    if (!gFiles.OpenTextFile(compareFileName, referenceFile))
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot open lockstep reference state hashes file '%s'", compareFileName.c_str());
+        return;
+    }
+
+    // each line is frame number and hash, frames go in order starting from 1
+    int frameNumber = 0;
+    std::string hashString;
+    while (referenceFile >> frameNumber >> hashString)
+    {
+        if (frameNumber != (int) mReferenceStateHashes.size() + 1)
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Lockstep reference state hashes file '%s' is broken at frame %d", compareFileName.c_str(), frameNumber);
+            break;
+        }
+        mReferenceStateHashes.push_back(strtoull(hashString.c_str(), nullptr, 16));
+    }
+    gConsole.LogMessage(eLogMessage_Info, "Lockstep state is compared with %d frames from '%s'", (int) mReferenceStateHashes.size(), compareFileName.c_str());
 }
 
 int CarnageGame::GetHumanPlayersCount() const
@@ -535,6 +681,64 @@ std::string CarnageGame::GetTextsLanguageFileName(const std::string& languageID)
     return "ENGLISH.FXT";
 }
 
+// run benchmark command if it was invoked from console, numeric args are parsed over default values
+// benchmarks run within current game session and may change its state, there is no separate world for them
+// @param defaultArgs: Default values of up to 3 args
+template<typename TRunProc>
+static void ProcessBenchmarkCommand(CvarVoid& benchmarkCvar, std::initializer_list<float> defaultArgs, TRunProc runProc)
+{
+    if (!benchmarkCvar.IsModified())
+        return;
+
+    benchmarkCvar.ClearModified();
+
+    if (gCarnageGame.IsLockstepMode())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Benchmark '%s' changes game session, lockstep state hashes will diverge from other runs",
+            benchmarkCvar.mName.c_str());
+    }
+
+    float args[3] {};
+    debug_assert(defaultArgs.size() <= 3);
+    std::copy(defaultArgs.begin(), defaultArgs.end(), args);
+    ::sscanf(benchmarkCvar.mCallingArgs.c_str(), "%f %f %f", &args[0], &args[1], &args[2]);
+    runProc(args);
+}
+
+// frame times accumulated by benchmark loop
+struct BenchmarkFrameTimes
+{
+    int mFramesCount = 0;
+    double mTotalTime = 0.0;
+    double mMaxTime = 0.0;
+};
+
+// run and measure benchmark frames, frame proc returns false to finish before frames limit
+template<typename TFrameProc>
+static BenchmarkFrameTimes MeasureBenchmarkFrames(int framesCount, TFrameProc frameProc)
+{
+    BenchmarkFrameTimes frameTimes;
+    while (frameTimes.mFramesCount < framesCount)
+    {
+        double startTime = gSystem.GetSystemSeconds();
+        bool continueRun = frameProc();
+
+        double frameTime = gSystem.GetSystemSeconds() - startTime;
+        frameTimes.mMaxTime = std::max(frameTimes.mMaxTime, frameTime);
+        frameTimes.mTotalTime += frameTime;
+        ++frameTimes.mFramesCount;
+        if (!continueRun)
+            break;
+    }
+    return frameTimes;
+}
+
+static void LogBenchmarkFrameTimes(const BenchmarkFrameTimes& frameTimes)
+{
+    gConsole.LogMessage(eLogMessage_Info, " - frame time avg %.3f ms, max %.3f ms",
+        (frameTimes.mTotalTime * 1000.0) / std::max(frameTimes.mFramesCount, 1), frameTimes.mMaxTime * 1000.0);
+}
+
 void CarnageGame::ProcessDebugCvars()
 {
     if (gCvarDbgDumpSpriteDeltas.IsModified())
@@ -568,6 +772,354 @@ void CarnageGame::ProcessDebugCvars()
         gSpriteManager.DumpCarsTextures(savePath);
         gConsole.LogMessage(eLogMessage_Info, "Car sprites path is '%s'", savePath.c_str());
     }
+
+    if (gCvarDbgSpritesOcclusionTest.IsModified())
+    {
+        gCvarDbgSpritesOcclusionTest.ClearModified();
+        if (gRenderManager.mMapRenderer.RunSpritesOcclusionTest())
+        {
+            gConsole.LogMessage(eLogMessage_Info, "Sprites occlusion test passed");
+        }
+    }
+
+    ProcessBenchmarkCommand(gCvarDbgAudioMixerBenchmark, { 64.0f, 10.0f }, [](const float* args)
+    {
+        std::string savePath = gFiles.mExecutableDirectory + "/mixer_benchmark.wav";
+        if (gAudioManager.RunMixerBenchmark((int) args[0], args[1], savePath))
+        {
+            gConsole.LogMessage(eLogMessage_Info, "Mixer output path is '%s'", savePath.c_str());
+        }
+    });
+
+    if (gCvarDbgAudioDecodeBenchmark.IsModified())
+    {
+        gCvarDbgAudioDecodeBenchmark.ClearModified();
+        std::string fileName = gCvarDbgAudioDecodeBenchmark.mCallingArgs;
+        cxx::trim(fileName);
+        if (fileName.empty())
+        {
+            fileName = "MUSIC/Track11";
+        }
+        gAudioManager.RunDecoderBenchmark(fileName);
+    }
+
+    ProcessBenchmarkCommand(gCvarDbgPhysicsBenchmark, { 1000.0f, 120.0f, 250.0f }, [this](const float* args)
+    {
+        RunPhysicsBenchmark((int) args[0], (int) args[1], args[2]);
+    });
+
+    ProcessBenchmarkCommand(gCvarDbgVehicleDynamicsBenchmark, { 20.0f }, [this](const float* args)
+    {
+        RunVehicleDynamicsBenchmark((int) args[0]);
+    });
+
+    ProcessBenchmarkCommand(gCvarDbgProjectilesBenchmark, { 1000.0f, 120.0f }, [this](const float* args)
+    {
+        RunProjectilesBenchmark((int) args[0], (int) args[1]);
+    });
+
+    ProcessBenchmarkCommand(gCvarDbgCollisionEventsBenchmark, { 500.0f, 120.0f }, [this](const float* args)
+    {
+        RunCollisionEventsBenchmark((int) args[0], (int) args[1]);
+    });
+
+    ProcessBenchmarkCommand(gCvarDbgExplosionChainBenchmark, { 100.0f, 300.0f }, [this](const float* args)
+    {
+        RunExplosionChainBenchmark((int) args[0], (int) args[1]);
+    });
+
+    ProcessBenchmarkCommand(gCvarDbgPedestriansBenchmark, { 5000.0f, 120.0f }, [this](const float* args)
+    {
+        RunPedestriansBenchmark((int) args[0], (int) args[1]);
+    });
+
+    ProcessBenchmarkCommand(gCvarDbgSpritesBenchmark, { 4.0f, 100.0f }, [](const float* args)
+    {
+        gRenderManager.mMapRenderer.RunSpritesBenchmark((int) args[0], (int) args[1]);
+    });
+
+    ProcessBenchmarkCommand(gCvarDbgSpritesBuildBenchmark, { 0.0f, 20.0f }, [](const float* args)
+    {
+        gRenderManager.mMapRenderer.RunSpritesBuildBenchmark((int) args[0], (int) args[1]);
+    });
+
+    ProcessBenchmarkCommand(gCvarDbgRenderCallsBenchmark, { 100.0f }, [](const float* args)
+    {
+        gRenderManager.RunRenderCallsBenchmark((int) args[0]);
+    });
+
+    ProcessBenchmarkCommand(gCvarDbgHudBenchmark, { 100.0f }, [](const float* args)
+    {
+        gGuiManager.RunScreensBenchmark((int) args[0]);
+    });
+
+    ProcessBenchmarkCommand(gCvarDbgLineOfSightBenchmark, { 100000.0f }, [this](const float* args)
+    {
+        HumanPlayer* humanPlayer = mHumanPlayers[0];
+        if (humanPlayer && humanPlayer->mCharacter)
+        {
+            gGameMap.RunLineOfSightBenchmark(humanPlayer->mCharacter->mTransform.mPosition, (int) args[0]);
+        }
+    });
+}
+
+void CarnageGame::RunProjectilesBenchmark(int projectilesCount, int framesCount)
+{
+    HumanPlayer* humanPlayer = mHumanPlayers[0];
+    if ((humanPlayer == nullptr) || (humanPlayer->mCharacter == nullptr))
+        return;
+
+    // bullets are most common projectiles, explosive ones would blow up everything around
+    WeaponInfo* weaponInfo = nullptr;
+    for (WeaponInfo& currWeapon: gGameMap.mStyleData.mWeaponTypes)
+    {
+        if (currWeapon.IsRange() && currWeapon.IsBulletDamage())
+        {
+            weaponInfo = &currWeapon;
+            break;
+        }
+    }
+
+    if (weaponInfo == nullptr)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Projectiles benchmark: no bullet weapon found");
+        return;
+    }
+    gProjectilesManager.RunUpdateBenchmark(humanPlayer->mCharacter, weaponInfo, projectilesCount, framesCount);
+}
+
+void CarnageGame::RunPhysicsBenchmark(int carsCount, int stepsCount, float hitchFrameMs)
+{
+    std::vector<Vehicle*> spawnedCars;
+    if (!SpawnBenchmarkCars(carsCount, 1, spawnedCars))
+        return;
+
+    gPhysics.RunStepBenchmark(stepsCount);
+    gPhysics.RunMapShapesBenchmark(stepsCount);
+    // every frame is long hitch, physics time per frame must stay within catch-up limits
+    gPhysics.RunFrameTimeBenchmark(stepsCount, hitchFrameMs / 1000.0f);
+
+    for (Vehicle* currVehicle: spawnedCars)
+    {
+        currVehicle->MarkForDeletion();
+    }
+}
+
+void CarnageGame::RunVehicleDynamicsBenchmark(int iterationsCount)
+{
+    std::vector<Vehicle*> spawnedCars;
+    if (!SpawnBenchmarkCars(2000, 1, spawnedCars))
+        return;
+
+    gPhysics.RunVehicleDynamicsBenchmark(iterationsCount);
+
+    for (Vehicle* currVehicle: spawnedCars)
+    {
+        currVehicle->MarkForDeletion();
+    }
+}
+
+void CarnageGame::RunCollisionEventsBenchmark(int carsCount, int stepsCount)
+{
+    // overlapping cars push each other apart, that produces lots of contacts
+    std::vector<Vehicle*> spawnedCars;
+    if (!SpawnBenchmarkCars(carsCount, 4, spawnedCars))
+        return;
+
+    gPhysics.RunCollisionEventsBenchmark(stepsCount);
+
+    for (Vehicle* currVehicle: spawnedCars)
+    {
+        currVehicle->MarkForDeletion();
+    }
+}
+
+void CarnageGame::RunExplosionChainBenchmark(int carsCount, int framesCount)
+{
+    framesCount = std::max(framesCount, 1);
+
+    // run same chain without detonations limit and then with current budget
+    const int savedBudget = gCvarExplosionsChainBudget.mValue;
+    const int budgets[] = { 0, savedBudget };
+    for (int currBudget: budgets)
+    {
+        // packed cars are within explosion radius of each other so whole pileup goes off
+        std::vector<Vehicle*> spawnedCars;
+        if (!SpawnBenchmarkCars(carsCount, 4, spawnedCars) || spawnedCars.empty())
+            break;
+
+        gCvarExplosionsChainBudget.mValue = currBudget;
+
+        DamageInfo damageInfo;
+        damageInfo.SetExplosionDamage(nullptr);
+        spawnedCars[0]->ReceiveDamage(damageInfo);
+
+        int maxDetonations = 0;
+        int wreckedCount = 0;
+        BenchmarkFrameTimes frameTimes = MeasureBenchmarkFrames(framesCount, [&]()
+        {
+            gPhysics.UpdateFrame();
+            gExplosionsManager.UpdateFrame();
+            gGameObjectsManager.UpdateFrame();
+
+            maxDetonations = std::max(maxDetonations, gExplosionsManager.mStats.mDetonatedCount);
+            wreckedCount = (int) std::count_if(spawnedCars.begin(), spawnedCars.end(), [](Vehicle* currVehicle)
+            {
+                return currVehicle->IsWrecked();
+            });
+            return (wreckedCount < (int) spawnedCars.size()) || (gExplosionsManager.mStats.mScheduledCount > 0);
+        });
+
+        gConsole.LogMessage(eLogMessage_Info, "Explosion chain benchmark: %d cars, budget %d per frame", (int) spawnedCars.size(), currBudget);
+        gConsole.LogMessage(eLogMessage_Info, " - %d cars exploded in %d frames, max %d detonations per frame", wreckedCount, frameTimes.mFramesCount, maxDetonations);
+        LogBenchmarkFrameTimes(frameTimes);
+
+        for (Vehicle* currVehicle: spawnedCars)
+        {
+            currVehicle->MarkForDeletion();
+        }
+        // remove wrecks before next run
+        gGameObjectsManager.UpdateFrame();
+    }
+    gCvarExplosionsChainBudget.mValue = savedBudget;
+}
+
+bool CarnageGame::SpawnBenchmarkCars(int carsCount, int carsPerBlock, std::vector<Vehicle*>& spawnedCars)
+{
+    std::vector<glm::ivec3> spawnBlocks;
+    if (!GetBenchmarkSpawnBlocks(carsCount, carsPerBlock, spawnBlocks) || gGameMap.mStyleData.mVehicles.empty())
+        return false;
+
+    // local random sequence, game one is reserved for simulation
+    cxx::randomizer spawnRand;
+    spawnedCars.reserve(carsCount);
+    for (const glm::ivec3& currBlock: spawnBlocks)
+    {
+        VehicleInfo* carStyle = &gGameMap.mStyleData.mVehicles[spawnedCars.size() % gGameMap.mStyleData.mVehicles.size()];
+        glm::vec3 position = Convert::MapUnitsToMeters(glm::vec3(currBlock.x + 0.5f, currBlock.y, currBlock.z + 0.5f));
+        if (carsPerBlock > 1)
+        {
+            position.x += Convert::MapUnitsToMeters(spawnRand.generate_float(-0.25f, 0.25f));
+            position.z += Convert::MapUnitsToMeters(spawnRand.generate_float(-0.25f, 0.25f));
+        }
+        cxx::angle_t heading { 360.0f * spawnRand.generate_float(), cxx::angle_t::units::degrees };
+        if (Vehicle* vehicle = gGameObjectsManager.CreateVehicle(position, heading, carStyle))
+        {
+            spawnedCars.push_back(vehicle);
+        }
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Spawned %d benchmark cars", (int) spawnedCars.size());
+    return true;
+}
+
+bool CarnageGame::GetBenchmarkSpawnBlocks(int objectsCount, int objectsPerBlock, std::vector<glm::ivec3>& spawnBlocks) const
+{
+    HumanPlayer* humanPlayer = mHumanPlayers[0];
+    if ((humanPlayer == nullptr) || (humanPlayer->mCharacter == nullptr))
+        return false;
+
+    // ground blocks nearest to player, one object per two blocks or packed into each block
+    objectsPerBlock = std::max(objectsPerBlock, 1);
+    const int BlocksSpacing = (objectsPerBlock > 1) ? 1 : 2;
+    glm::ivec3 centerBlock = Convert::MetersToMapUnits(humanPlayer->mCharacter->mTransform.mPosition);
+
+    std::vector<glm::ivec2> candidateBlocks;
+    for (int yBlock = centerBlock.z % BlocksSpacing; yBlock < MAP_DIMENSIONS; yBlock += BlocksSpacing)
+    {
+        for (int xBlock = centerBlock.x % BlocksSpacing; xBlock < MAP_DIMENSIONS; xBlock += BlocksSpacing)
+        {
+            candidateBlocks.emplace_back(xBlock, yBlock);
+        }
+    }
+    std::stable_sort(candidateBlocks.begin(), candidateBlocks.end(), [&centerBlock](const glm::ivec2& lhs, const glm::ivec2& rhs)
+    {
+        int lhsDistance = std::abs(lhs.x - centerBlock.x) + std::abs(lhs.y - centerBlock.z);
+        int rhsDistance = std::abs(rhs.x - centerBlock.x) + std::abs(rhs.y - centerBlock.z);
+        return lhsDistance < rhsDistance;
+    });
+
+    spawnBlocks.clear();
+    spawnBlocks.reserve(objectsCount);
+    for (const glm::ivec2& currBlock: candidateBlocks)
+    {
+        if ((int) spawnBlocks.size() == objectsCount)
+            break;
+
+        for (int zBlock = MAP_LAYERS_COUNT - 1; zBlock > -1; --zBlock)
+        {
+            const MapBlockInfo* blockInfo = gGameMap.GetBlockInfo(currBlock.x, currBlock.y, zBlock);
+            if (blockInfo->mGroundType == eGroundType_Field ||
+                blockInfo->mGroundType == eGroundType_Pawement ||
+                blockInfo->mGroundType == eGroundType_Road)
+            {
+                for (int icurr = 0; icurr < objectsPerBlock && (int) spawnBlocks.size() < objectsCount; ++icurr)
+                {
+                    spawnBlocks.emplace_back(currBlock.x, zBlock, currBlock.y);
+                }
+                break;
+            }
+            if (blockInfo->mGroundType != eGroundType_Air)
+                break;
+        }
+    }
+    return true;
+}
+
+void CarnageGame::RunPedestriansBenchmark(int pedestriansCount, int framesCount)
+{
+    framesCount = std::max(framesCount, 1);
+
+    // wandering traffic pedestrians, few per block
+    std::vector<glm::ivec3> spawnBlocks;
+    if (!GetBenchmarkSpawnBlocks(pedestriansCount, 4, spawnBlocks))
+        return;
+
+    std::vector<Pedestrian*> spawnedPedestrians;
+    spawnedPedestrians.reserve(pedestriansCount);
+    for (const glm::ivec3& currBlock: spawnBlocks)
+    {
+        if (Pedestrian* pedestrian = gTrafficManager.GenerateRandomTrafficPedestrian(currBlock.x, currBlock.y, currBlock.z))
+        {
+            spawnedPedestrians.push_back(pedestrian);
+        }
+    }
+
+    // objects update only, without rendering and physics
+    const bool savedUpdateByState = gCvarPedestrianStateBuckets.mValue;
+    const bool updateModes[] = { false, true };
+    for (bool currUpdateByState: updateModes)
+    {
+        gCvarPedestrianStateBuckets.mValue = currUpdateByState;
+
+        BenchmarkFrameTimes frameTimes = MeasureBenchmarkFrames(framesCount, []()
+        {
+            gGameObjectsManager.UpdateFrame();
+            return true;
+        });
+
+        gConsole.LogMessage(eLogMessage_Info, "Pedestrians benchmark: %d pedestrians, %d frames, %s",
+            (int) gGameObjectsManager.mPedestriansList.size(), framesCount, currUpdateByState ? "update by states" : "update in objects order");
+        LogBenchmarkFrameTimes(frameTimes);
+        gConsole.LogMessage(eLogMessage_Info, " - objects update %.3f us per pedestrian",
+            (frameTimes.mTotalTime * 1000000.0) / (framesCount * std::max((int) gGameObjectsManager.mPedestriansList.size(), 1)));
+    }
+    gCvarPedestrianStateBuckets.mValue = savedUpdateByState;
+
+    for (int istate = ePedestrianState_StandingStill; istate < ePedestrianState_COUNT; ++istate)
+    {
+        const PedestrianStateStats& stateStats = gGameObjectsManager.mPedestrianStateStats[istate];
+        if (stateStats.mPedestriansCount == 0)
+            continue;
+
+        gConsole.LogMessage(eLogMessage_Info, " - %s: %d pedestrians, %.3f ms", cxx::enum_to_string((ePedestrianState) istate), 
+            stateStats.mPedestriansCount, stateStats.mUpdateTimeMs);
+    }
+
+    for (Pedestrian* currPedestrian: spawnedPedestrians)
+    {
+        currPedestrian->MarkForDeletion();
+    }
 }
 
 void CarnageGame::SetCurrentGamestate(GenericGamestate* gamestate)
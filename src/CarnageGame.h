@@ -6,6 +6,17 @@
 #include "GameplayGamestate.h"
 #include "MainMenuGamestate.h"
 
+// separate random sequences for game subsystems, so that consumers don't shift each other sequences
+enum eGameRandStream
+{
+    eGameRandStream_Objects,
+    eGameRandStream_Traffic,
+    eGameRandStream_Ai,
+    eGameRandStream_Effects, // particles, visual only
+    eGameRandStream_Audio, // depends on listeners, must not affect simulation
+    eGameRandStream_COUNT
+};
+
 // top level game application controller
 class CarnageGame final: public InputEventsHandler
 {
@@ -14,11 +25,17 @@ class CarnageGame final: public InputEventsHandler
 
 public:
     cxx::randomizer mGameRand;
+    cxx::randomizer mRandStreams[eGameRandStream_COUNT];
 
     // readonly
     GenericGamestate* mCurrentGamestate = nullptr;
     HumanPlayer* mHumanPlayers[GAME_MAX_PLAYERS];
 
+    // lockstep simulation state
+    int mSimulationFrame = 0; // frames since scenario start
+    unsigned long long mStateHash = 0; // objects state after last frame, computed in lockstep mode only
+    int mStateHashDivergedFrame = 0; // first frame where state hash differs from reference file, 0 if none
+
 public:
     // Setup resources and switch to initial game state
     bool Initialize();
@@ -53,6 +70,17 @@ public:
     int GetHumanPlayerIndex(Pedestrian* pedestrian) const;
     int GetHumanPlayersCount() const;
 
+    // Get random sequence dedicated to specific subsystem
+    cxx::randomizer& GetRandStream(eGameRandStream randStream);
+
+    // Whether simulation runs with fixed game frame delta and seeded random streams
+    // Same seed and same inputs per frame give same state hash on every frame
+    bool IsLockstepMode() const;
+
+    // Advance simulation frames counter and update state hash, should be called after all simulation updates
+    // State hash is also written to record file and compared with reference file if those are specified
+    void FinishSimulationFrame();
+
 private:
     bool SetInputActionsFromConfig();
     bool DetectGameVersion();
@@ -64,11 +92,33 @@ private:
 
     void SetCurrentGamestate(GenericGamestate* gamestate);
 
+    // Setup game time and random streams for new scenario
+    void SetupSimulationMode();
+    // Open state hashes record file and load reference state hashes in lockstep mode
+    void SetupStateHashFiles();
+
     void ProcessDebugCvars();
 
+private:
+    // spawn cars around first player and run physics step benchmarks, cars are removed afterwards
+    void RunPhysicsBenchmark(int carsCount, int stepsCount, float hitchFrameMs);
+    // spawn cars around first player and compare batched vehicle dynamics with per-vehicle model
+    void RunVehicleDynamicsBenchmark(int iterationsCount);
+    void RunProjectilesBenchmark(int projectilesCount, int framesCount);
+    void RunCollisionEventsBenchmark(int carsCount, int stepsCount);
+    void RunExplosionChainBenchmark(int carsCount, int framesCount);
+    void RunPedestriansBenchmark(int pedestriansCount, int framesCount);
+    bool SpawnBenchmarkCars(int carsCount, int carsPerBlock, std::vector<Vehicle*>& spawnedCars);
+    // find ground blocks around first player to place benchmark objects, block position is x, layer, y
+    bool GetBenchmarkSpawnBlocks(int objectsCount, int objectsPerBlock, std::vector<glm::ivec3>& spawnBlocks) const;
+
 private:
     GameplayGamestate mGameplayGamestate;
     MainMenuGamestate mMainMenuGamestate;
+
+    // lockstep state hashes files
+    std::ofstream mStateHashRecordFile;
+    std::vector<unsigned long long> mReferenceStateHashes; // per frame, starting from first
 };
 
 extern CarnageGame gCarnageGame;
\ No newline at end of file
@@ -79,6 +79,23 @@ void Contact::SetupWithBox2Data(b2Contact* box2Contact, b2Fixture* thisFixture,
     }
 }
 
+void Contact::SetupWithContactPoint(Collider* thisCollider, Collider* thatCollider, const glm::vec2& position, const glm::vec2& normal, float separation)
+{
+    debug_assert(thisCollider);
+    debug_assert(thatCollider);
+
+    mThisCollider = thisCollider;
+    mThatCollider = thatCollider;
+    mThisObject = mThisCollider->mGameObject;
+    mThatObject = mThatCollider->mGameObject;
+    debug_assert(mThisObject);
+    debug_assert(mThatObject);
+    debug_assert(mThisObject != mThatObject);
+
+    mContactPointsCount = 1;
+    mContactPoints[0] = ContactPoint(position, mThisCollider->mPhysicsBody->mPositionY, normal, separation);
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 void Collision::SetupWithBox2Data(b2Contact* box2Contact, b2Fixture* thisFixture, b2Fixture* thatFixture, const b2ContactImpulse* contactImpulse)
@@ -94,6 +111,13 @@ void Collision::SetupWithBox2Data(b2Contact* box2Contact, b2Fixture* thisFixture
     }
 }
 
+void Collision::SetupWithContactPoint(Collider* thisCollider, Collider* thatCollider, const glm::vec2& position, const glm::vec2& normal, float separation, 
+    float contactImpulse)
+{
+    mContactInfo.SetupWithContactPoint(thisCollider, thatCollider, position, normal, separation);
+    mContactImpulse = contactImpulse;
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 bool MapCollision::HasContactPoints() const
@@ -140,3 +164,19 @@ void MapCollision::SetupWithBox2Data(b2Contact* box2Contact, b2Fixture* objectFi
         mContactImpulse += contactImpulse->normalImpulses[icurr];
     }
 }
+
+void MapCollision::SetupWithContactPoint(Collider* objectCollider, const MapBlockInfo* mapBlockInfo, const glm::vec2& position, const glm::vec2& normal, float separation, 
+    float contactImpulse)
+{
+    debug_assert(objectCollider);
+    debug_assert(mapBlockInfo);
+
+    mMapBlockInfo = mapBlockInfo;
+    mThisCollider = objectCollider;
+    mThisObject = mThisCollider->mGameObject;
+    debug_assert(mThisObject);
+
+    mContactPointsCount = 1;
+    mContactPoints[0] = ContactPoint(position, mThisCollider->mPhysicsBody->mPositionY, normal, separation);
+    mContactImpulse = contactImpulse;
+}
@@ -30,6 +30,8 @@ public:
 
 private:
     void SetupWithBox2Data(b2Contact* contact, b2Fixture* thisFixture, b2Fixture* thatFixture);
+    // setup single point contact from queued collision data
+    void SetupWithContactPoint(Collider* thisCollider, Collider* thatCollider, const glm::vec2& position, const glm::vec2& normal, float separation);
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -52,6 +54,8 @@ public:
     }
 private:
     void SetupWithBox2Data(b2Contact* contact, b2Fixture* thisFixture, b2Fixture* thatFixture, const b2ContactImpulse* contactImpulse);
+    void SetupWithContactPoint(Collider* thisCollider, Collider* thatCollider, const glm::vec2& position, const glm::vec2& normal, float separation, 
+        float contactImpulse);
 
 private:
     float mContactImpulse = 0.0f;
@@ -85,6 +89,8 @@ public:
     }
 private:
     void SetupWithBox2Data(b2Contact* contact, b2Fixture* objectFixture, const MapBlockInfo* mapBlockInfo, const b2ContactImpulse* contactImpulse);
+    void SetupWithContactPoint(Collider* objectCollider, const MapBlockInfo* mapBlockInfo, const glm::vec2& position, const glm::vec2& normal, float separation, 
+        float contactImpulse);
 
 private:
     float mContactImpulse = 0.0f;
@@ -87,10 +87,11 @@ void DamageInfo::SetExplosionDamage(GameObject* object)
     mSourceObject = object;
 }
 
-void DamageInfo::SetExplosionChainDamage(GameObject* object)
+void DamageInfo::SetExplosionChainDamage(GameObject* object, float falloff)
 {
     mDamageCause = eDamageCause_ExplosionChain;
     mSourceObject = object;
+    mExplosionFalloff = glm::clamp(falloff, 0.0f, 1.0f);
 }
 
 void DamageInfo::SetBulletDamage(GameObject* object)
@@ -117,6 +118,7 @@ void DamageInfo::Clear()
     mSourceObject = nullptr;
     mContactImpulse = 0.0f;
     mFallHeight = 0.0f;
+    mExplosionFalloff = 1.0f;
 }
 
 Pedestrian* DamageInfo::GetDamageCauser() const
@@ -35,7 +35,8 @@ public:
     void SetCollisionDamage(const Collision& collisionInfo);
     void SetCollisionDamage(const MapCollision& collisionInfo);
     void SetExplosionDamage(GameObject* object);
-    void SetExplosionChainDamage(GameObject* object);
+    // @param falloff: Explosion intensity at target, 1 at explosion center down to 0 at radius
+    void SetExplosionChainDamage(GameObject* object, float falloff);
     void SetBulletDamage(GameObject* object);
     void SetPunchDamage(GameObject* object);
     void SetCarHitDamage(GameObject* carObject);
@@ -55,4 +56,5 @@ public:
     ContactPoint mContactPoint;
     float mContactImpulse = 0.0f;
     float mFallHeight = 0.0f; // has meaning only if fall
+    float mExplosionFalloff = 1.0f; // has meaning only if explosion chain
 };
\ No newline at end of file
@@ -56,26 +56,15 @@ bool DebugRenderer::Initialize()
     mDebugLinesDepthTestCount = 0;
     mDebugVerticesCount = 0;
 
-    int BufferSizeBytes = MaxDebugVertices * Sizeof_Vertex3D_Debug;
-    mGpuVerticesBuffer = gGraphicsDevice.CreateBuffer(eBufferContent_Vertices, eBufferUsage_Stream, BufferSizeBytes, nullptr);
-    debug_assert(mGpuVerticesBuffer);
-
-    if (mGpuVerticesBuffer == nullptr)
-    {
-        Deinit();
-        return false;
-    }
-
+    // vertices are streamed through render manager buffers
     return true;
 }
 
 void DebugRenderer::Deinit()
 {
-    if (mGpuVerticesBuffer)
-    {
-        gGraphicsDevice.DestroyBuffer(mGpuVerticesBuffer);
-        mGpuVerticesBuffer = nullptr;
-    }
+    mDebugLinesCount = 0;
+    mDebugLinesDepthTestCount = 0;
+    mDebugVerticesCount = 0;
 }
 
 void DebugRenderer::RenderFrameBegin(GameCamera* camera)
@@ -384,24 +373,20 @@ void DebugRenderer::FlushDebugVertices(bool depth_test)
     gGraphicsDevice.SetRenderStates(renderStates);
 
     // upload data
-    debug_assert(mGpuVerticesBuffer);
-    gGraphicsDevice.BindIndexBuffer(nullptr);
-    gGraphicsDevice.BindVertexBuffer(mGpuVerticesBuffer, Vertex3D_Debug_Format::Get());
-
+    GpuBufferRange verticesRange;
     int vertexDataSizeBytes = mDebugVerticesCount * Sizeof_Vertex3D_Debug;
-    if (void* bufferData = mGpuVerticesBuffer->Lock(BufferAccess_Write | BufferAccess_InvalidateBuffer))
-    {
-        ::memcpy(bufferData, mDebugVertices, vertexDataSizeBytes);
-        if (!mGpuVerticesBuffer->Unlock())
-        {
-            debug_assert(false);
-        }
-    }
-    else
+    if (!gRenderManager.mStreamingVertices.Upload(vertexDataSizeBytes, mDebugVertices, verticesRange))
     {
         debug_assert(false);
+        mDebugVerticesCount = 0;
+        return;
     }
 
+    VertexFormat vertexFormat = Vertex3D_Debug_Format::Get();
+    vertexFormat.mBaseOffset = verticesRange.mOffset;
+    gGraphicsDevice.BindIndexBuffer(nullptr);
+    gGraphicsDevice.BindVertexBuffer(verticesRange.mBuffer, vertexFormat);
+
     // issue draw call
     gGraphicsDevice.RenderPrimitives(ePrimitiveType_Lines, 0, mDebugVerticesCount);
 
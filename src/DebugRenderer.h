@@ -75,6 +75,5 @@ private:
     DebugLineStruct mDebugLinesArray[MaxDebugLines];
     Vertex3D_Debug mDebugVertices[MaxDebugVertices];
 
-    GpuBuffer* mGpuVerticesBuffer = nullptr;
     GameCamera* mCurrentCamera = nullptr;
 };
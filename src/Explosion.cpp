@@ -79,34 +79,19 @@ void Explosion::HandleSpawn()
     // broadcast event
     gBroadcastEvents.RegisterEvent(eBroadcastEvent_Explosion, mTransform.GetPosition2(), gGameParams.mBroadcastExplosionEventDuration);
 
-    StartGameObjectSound(0, eSfxSampleType_Level, SfxLevel_HugeExplosion, SfxFlags_RandomPitch);
+    StartGameObjectSound(0, eSfxSampleType_Level, SfxLevel_HugeExplosion, SfxFlags_RandomPitch | SfxFlags_HighPriority);
 }
 
 void Explosion::DamagePedsNearby(bool enableInstantKill)
 {
-    float killHitDistance = gGameParams.mExplosionRadius * 0.5f;
-    float killlHitDistance2 = killHitDistance * killHitDistance;
-    float burnDistance2 = gGameParams.mExplosionRadius * gGameParams.mExplosionRadius;
-
     glm::vec2 centerPoint (mTransform.mPosition.x, mTransform.mPosition.z);
-    glm::vec2 extents ( 
-        gGameParams.mExplosionRadius, 
-        gGameParams.mExplosionRadius );
 
-    PhysicsQueryResult queryResult;
-    gPhysics.QueryObjectsWithinBox(centerPoint, extents, queryResult, CollisionGroup_Pedestrian);
+    std::vector<PhysicsBody*> queryResult;
+    gPhysics.QueryObjectsWithinRadius(centerPoint, gGameParams.mExplosionRadius, queryResult, CollisionGroup_Pedestrian);
 
-    for (int icurr = 0; icurr < queryResult.mElementsCount; ++icurr)
+    for (PhysicsBody* currBody: queryResult)
     {
-        PhysicsQueryElement& currElement = queryResult.mElements[icurr];
-
-        if (currElement.mPhysicsObject == nullptr)
-        {
-            debug_assert(false);
-            continue;
-        }
-
-        GameObject* gameObject = currElement.mPhysicsObject->mGameObject;
+        GameObject* gameObject = currBody->mGameObject;
         if ((gameObject == nullptr) || !gameObject->IsPedestrianClass())
         {
             debug_assert(false);
@@ -114,35 +99,20 @@ void Explosion::DamagePedsNearby(bool enableInstantKill)
         }
 
         Pedestrian* currPedestrian = (Pedestrian*) gameObject;
-        if (currPedestrian == nullptr)
-            continue;
-
-        glm::vec2 pedestrianPosition = currPedestrian->mTransform.GetPosition2();
-        float distanceToExplosionCenter2 = glm::distance2(centerPoint, pedestrianPosition);
 
-        if (enableInstantKill)
+        // kill instantly within half of radius, burn otherwise
+        float falloff = GetDamageFalloff(currPedestrian->mTransform.GetPosition2());
+        DamageInfo damageInfo;
+        if (enableInstantKill && (falloff > 0.5f))
         {
-            if (distanceToExplosionCenter2 < killlHitDistance2)
-            {
-                // kill instantly
-                DamageInfo damageInfo;
-                damageInfo.SetExplosionDamage(this);
-                currPedestrian->ReceiveDamage(damageInfo);
-                continue;
-            }
+            damageInfo.SetExplosionDamage(this);
         }
-
-        if (distanceToExplosionCenter2 < burnDistance2)
+        else
         {
-            // burn
-            DamageInfo damageInfo;
             damageInfo.SetFireDamage(this);
-            currPedestrian->ReceiveDamage(damageInfo);
-            continue;
         }
-
+        currPedestrian->ReceiveDamage(damageInfo);
     }
-    queryResult.Clear();
 }
 
 void Explosion::DamageObjectInContact()
@@ -157,27 +127,14 @@ void Explosion::DamageObjectInContact()
 
 void Explosion::DamageCarsNearby()
 {
-    float explodeDistance2 = gGameParams.mExplosionRadius * gGameParams.mExplosionRadius;
-
     glm::vec2 centerPoint (mTransform.mPosition.x, mTransform.mPosition.z);
-    glm::vec2 extents ( 
-        gGameParams.mExplosionRadius, 
-        gGameParams.mExplosionRadius );
 
-    PhysicsQueryResult queryResult;
-    gPhysics.QueryObjectsWithinBox(centerPoint, extents, queryResult, CollisionGroup_Car);
+    std::vector<PhysicsBody*> queryResult;
+    gPhysics.QueryObjectsWithinRadius(centerPoint, gGameParams.mExplosionRadius, queryResult, CollisionGroup_Car);
 
-    for (int icurr = 0; icurr < queryResult.mElementsCount; ++icurr)
+    for (PhysicsBody* currBody: queryResult)
     {
-        PhysicsQueryElement& currElement = queryResult.mElements[icurr];
-
-        if (currElement.mPhysicsObject == nullptr)
-        {
-            debug_assert(false);
-            continue;
-        }
-
-        GameObject* gameObject = currElement.mPhysicsObject->mGameObject;
+        GameObject* gameObject = currBody->mGameObject;
         if ((gameObject == nullptr) || !gameObject->IsVehicleClass())
         {
             debug_assert(false);
@@ -188,14 +145,15 @@ void Explosion::DamageCarsNearby()
         if (currentCar == mExplodingObject)
             continue;
 
-        glm::vec2 carPosition = currentCar->mTransform.GetPosition2();
-        float distanceToExplosionCenter2 = glm::distance2(centerPoint, carPosition);
-        if (distanceToExplosionCenter2 < explodeDistance2)
-        {
-            DamageInfo damageInfo;
-            damageInfo.SetExplosionChainDamage(this);
-            currentCar->ReceiveDamage(damageInfo);
-        }
+        DamageInfo damageInfo;
+        damageInfo.SetExplosionChainDamage(this, GetDamageFalloff(currentCar->mTransform.GetPosition2()));
+        currentCar->ReceiveDamage(damageInfo);
     }
-    queryResult.Clear();
+}
+
+float Explosion::GetDamageFalloff(const glm::vec2& position) const
+{
+    glm::vec2 centerPoint (mTransform.mPosition.x, mTransform.mPosition.z);
+    float distanceToExplosionCenter = glm::distance(centerPoint, position);
+    return glm::clamp(1.0f - (distanceToExplosionCenter / gGameParams.mExplosionRadius), 0.0f, 1.0f);
 }
\ No newline at end of file
@@ -29,6 +29,9 @@ private:
     void DamagePedsNearby(bool enableInstantKill);
     void DamageCarsNearby();
 
+    // Get damage intensity at specified point, 1 at explosion center down to 0 at radius
+    float GetDamageFalloff(const glm::vec2& position) const;
+
 private:
     SpriteAnimation mAnimationState;
     int mUpdatesCounter = 0;
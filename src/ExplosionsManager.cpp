@@ -0,0 +1,123 @@
+#include "stdafx.h"
+#include "ExplosionsManager.h"
+#include "Vehicle.h"
+#include "TimeManager.h"
+#include "cvars.h"
+
+ExplosionsManager gExplosionsManager;
+
+//////////////////////////////////////////////////////////////////////////
+// cvars
+//////////////////////////////////////////////////////////////////////////
+
+CvarInt gCvarExplosionsChainBudget("g_explosionsChainBudget", 4, "Max chain explosions of vehicles per frame, 0 means no limit", CvarFlags_Archive);
+
+//////////////////////////////////////////////////////////////////////////
+
+void ExplosionsManager::EnterWorld()
+{
+    mScheduled.clear();
+    mCurrentTime = 0.0f;
+    mStats = ExplosionsStats();
+}
+
+void ExplosionsManager::ClearWorld()
+{
+    mScheduled.clear();
+    mCurrentTime = 0.0f;
+    mStats = ExplosionsStats();
+}
+
+int ExplosionsManager::GetDetonationsBudget() const
+{
+    return std::max(gCvarExplosionsChainBudget.mValue, 0);
+}
+
+void ExplosionsManager::ScheduleCarDetonation(Vehicle* vehicle, float delayTime)
+{
+    debug_assert(vehicle);
+
+    ScheduledDetonation detonation;
+    detonation.mVehicle = vehicle;
+    detonation.mDetonationTime = mCurrentTime + std::max(delayTime, 0.0f);
+
+    // vehicle detonates once, earliest schedule wins
+    auto existingPosition = std::find_if(mScheduled.begin(), mScheduled.end(), [vehicle](const ScheduledDetonation& currDetonation)
+        {
+            return currDetonation.mVehicle == vehicle;
+        });
+    if (existingPosition != mScheduled.end())
+    {
+        if (existingPosition->mDetonationTime <= detonation.mDetonationTime)
+            return;
+
+        mScheduled.erase(existingPosition);
+    }
+
+    // keep scheduling order for same detonation time
+    auto insertPosition = std::upper_bound(mScheduled.begin(), mScheduled.end(), detonation, 
+        [](const ScheduledDetonation& lhs, const ScheduledDetonation& rhs)
+        {
+            return lhs.mDetonationTime < rhs.mDetonationTime;
+        });
+    mScheduled.insert(insertPosition, detonation);
+    mStats.mScheduledCount = (int) mScheduled.size();
+}
+
+void ExplosionsManager::UpdateFrame()
+{
+    double startTime = gSystem.GetSystemSeconds();
+
+    int budget = GetDetonationsBudget();
+    if (budget == 0)
+    {
+        budget = std::numeric_limits<int>::max();
+    }
+
+    mCurrentTime += gTimeManager.mGameFrameDelta;
+
+    // new detonations may be scheduled by explosions created here, but those are not resolved until their own update
+    int detonatedCount = 0;
+    int processedCount = 0;
+    for (; processedCount < (int) mScheduled.size(); ++processedCount)
+    {
+        ScheduledDetonation& detonation = mScheduled[processedCount];
+        if ((detonation.mDetonationTime > mCurrentTime) || (detonatedCount == budget))
+            break;
+
+        if (Detonate(detonation.mVehicle))
+        {
+            ++detonatedCount;
+        }
+    }
+    mScheduled.erase(mScheduled.begin(), mScheduled.begin() + processedCount);
+
+    int deferredCount = 0;
+    for (const ScheduledDetonation& detonation: mScheduled)
+    {
+        if (detonation.mDetonationTime > mCurrentTime)
+            break;
+
+        ++deferredCount;
+    }
+
+    mStats.mScheduledCount = (int) mScheduled.size();
+    mStats.mDetonatedCount = detonatedCount;
+    mStats.mDeferredCount = deferredCount;
+    mStats.mPeakDetonatedCount = std::max(mStats.mPeakDetonatedCount, detonatedCount);
+    mStats.mUpdateTimeMs = (float) ((gSystem.GetSystemSeconds() - startTime) * 1000.0);
+}
+
+bool ExplosionsManager::Detonate(Vehicle* vehicle)
+{
+    // vehicle could be deleted or repaired while waiting
+    if ((vehicle == nullptr) || vehicle->IsMarkedForDeletion() || vehicle->IsWrecked())
+        return false;
+
+    if (!vehicle->mChainExplosionScheduled || !vehicle->IsCriticalDamageState())
+        return false;
+
+    vehicle->SetWrecked();
+    vehicle->Explode();
+    return true;
+}
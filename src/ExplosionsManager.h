@@ -0,0 +1,53 @@
+#pragma once
+
+#include "GameDefs.h"
+
+// chain explosions statistics
+struct ExplosionsStats
+{
+public:
+    ExplosionsStats() = default;
+public:
+    int mScheduledCount = 0; // detonations waiting
+    int mDetonatedCount = 0; // last frame
+    int mDeferredCount = 0; // last frame, detonations due but postponed by budget
+    int mPeakDetonatedCount = 0; // max per frame since world enter
+    float mUpdateTimeMs = 0.0f; // last frame
+};
+
+// Schedules chain explosions of vehicles damaged by nearby explosions
+// Detonations are processed in order of due time and limited per frame so big pileups are spread across several frames
+class ExplosionsManager final: public cxx::noncopyable
+{
+public:
+    // readonly
+    ExplosionsStats mStats;
+
+public:
+    void EnterWorld();
+    void ClearWorld();
+    void UpdateFrame();
+
+    // Schedule delayed vehicle detonation, vehicle which is already scheduled keeps earliest detonation time
+    // @param vehicle: Vehicle in critical damage state
+    // @param delayTime: Min time before detonation, seconds
+    void ScheduleCarDetonation(Vehicle* vehicle, float delayTime);
+
+    // Get max vehicle detonations per frame, 0 means no limit
+    int GetDetonationsBudget() const;
+
+private:
+    struct ScheduledDetonation
+    {
+        VehicleHandle mVehicle;
+        float mDetonationTime = 0.0f; // scheduler time
+    };
+
+    bool Detonate(Vehicle* vehicle);
+
+private:
+    std::vector<ScheduledDetonation> mScheduled; // sorted by detonation time
+    float mCurrentTime = 0.0f; // game time accumulated by scheduler updates
+};
+
+extern ExplosionsManager gExplosionsManager;
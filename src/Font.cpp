@@ -4,6 +4,7 @@
 #include "GpuTexture2D.h"
 #include "stb_rect_pack.h"
 #include "GuiContext.h"
+#include "cvars.h"
 
 static const int MaxFontAtlasTextureSize = 2048;
 
@@ -101,6 +102,7 @@ void Font::Unload()
     }
     mFontData.mRawCharacters.clear();
     mCharacters.clear();
+    ClearGlyphRuns();
     mFontData.mPalette.FillWithColor(0);
 }
 
@@ -180,25 +182,8 @@ void Font::MeasureString(const std::string& text, const Point& maxSize, Point& o
             continue;
         }
 
-        unsigned char charIndex = 0;
-        if (currChar >= 0xC0)
-        {
-            if (currChar > 0xFC)
-                continue;
-
-            unsigned char baseoffset = ('z' - mBaseCharCode) + 6;
-            currChar = (currChar - 0xC0);
-            charIndex = baseoffset + AnsiCharsOffsetTable[currChar];
-        }
-        else
-        {
-            if (currChar < mBaseCharCode)
-                continue;
-
-            charIndex = currChar - mBaseCharCode;
-        }
-
-        if (charIndex >= maxCharCodes)
+        int charIndex = GetCharIndex(currChar);
+        if (charIndex < 0)
             continue;
 
         const RawCharacter& charData = mFontData.mRawCharacters[charIndex];
@@ -223,7 +208,11 @@ void Font::MeasureString(const std::string& text, const Point& maxSize, Point& o
 void Font::SetFontBaseCharCode(int charCode)
 {
     debug_assert(charCode >= 0);
-    mBaseCharCode = charCode;
+    if (mBaseCharCode != charCode)
+    {
+        mBaseCharCode = charCode;
+        ClearGlyphRuns();
+    }
 }
 
 void Font::DrawString(GuiContext& guiContext, const std::string& text, const Point& position, int paletteIndex)
@@ -234,10 +223,58 @@ void Font::DrawString(GuiContext& guiContext, const std::string& text, const Poi
 
 void Font::DrawString(GuiContext& guiContext, const std::string& text, const Point& position, const Point& maxSize, int paletteIndex)
 {
-    int maxCharCodes = (int) mCharacters.size();
-    if (maxCharCodes < 1)
+    if (mCharacters.empty())
         return;
 
+    const std::vector<Sprite2D>* glyphs = &mGlyphsScratch;
+    if (gCvarUiCache.mValue)
+    {
+        glyphs = &GetGlyphRun(text, paletteIndex).mGlyphs;
+    }
+    else
+    {
+        BuildGlyphRun(text, paletteIndex, mGlyphsScratch);
+    }
+
+    const glm::vec2 offset { position.x * 1.0f, position.y * 1.0f };
+    for (const Sprite2D& currGlyph: *glyphs)
+    {
+        Sprite2D spriteData = currGlyph;
+        spriteData.mPosition += offset;
+        guiContext.mSpriteBatch.DrawSprite(spriteData);
+    }
+}
+
+int Font::GetCharIndex(unsigned char charCode) const
+{
+    unsigned char charIndex = 0;
+    if (charCode >= 0xC0)
+    {
+        if (charCode > 0xFC)
+            return -1;
+
+        unsigned char baseoffset = ('z' - mBaseCharCode) + 6;
+        charCode = (charCode - 0xC0);
+        charIndex = baseoffset + AnsiCharsOffsetTable[charCode];
+    }
+    else
+    {
+        if (charCode < mBaseCharCode)
+            return -1;
+
+        charIndex = charCode - mBaseCharCode;
+    }
+
+    if (charIndex >= (int) mCharacters.size())
+        return -1;
+
+    return charIndex;
+}
+
+void Font::BuildGlyphRun(const std::string& text, int paletteIndex, std::vector<Sprite2D>& outputGlyphs) const
+{
+    outputGlyphs.clear();
+
     Sprite2D spriteData;
     spriteData.mTexture = mFontTexture;
     spriteData.mScale = HUD_SPRITE_SCALE;
@@ -245,13 +282,13 @@ void Font::DrawString(GuiContext& guiContext, const std::string& text, const Poi
     spriteData.mOriginMode = eSpriteOrigin_TopLeft;
     spriteData.mDrawOrder = eSpriteDrawOrder_HUD_TextMessages;
 
-    int currentOffsetX = position.x;
-    int currentOffsetY = position.y;
+    int currentOffsetX = 0;
+    int currentOffsetY = 0;
     for (unsigned char currChar: text)
     {
         if (currChar == '\n')
         {
-            currentOffsetX = position.x;
+            currentOffsetX = 0;
             currentOffsetY += mLineHeight;
             continue;
         }
@@ -262,25 +299,8 @@ void Font::DrawString(GuiContext& guiContext, const std::string& text, const Poi
             continue;
         }
 
-        unsigned char charIndex = 0;
-        if (currChar >= 0xC0)
-        {
-            if (currChar > 0xFC)
-                continue;
-
-            unsigned char baseoffset = ('z' - mBaseCharCode) + 6;
-            currChar = (currChar - 0xC0);
-            charIndex = baseoffset + AnsiCharsOffsetTable[currChar];
-        }
-        else
-        {
-            if (currChar < mBaseCharCode)
-                continue;
-
-            charIndex = currChar - mBaseCharCode;
-        }
-
-        if (charIndex >= maxCharCodes)
+        int charIndex = GetCharIndex(currChar);
+        if (charIndex < 0)
             continue;
 
         spriteData.mTextureRegion = mCharacters[charIndex];
@@ -288,10 +308,41 @@ void Font::DrawString(GuiContext& guiContext, const std::string& text, const Poi
         spriteData.mPosition.y = currentOffsetY * 1.0f;
         currentOffsetX += spriteData.mTextureRegion.mRectangle.w;
 
-        guiContext.mSpriteBatch.DrawSprite(spriteData);
+        outputGlyphs.push_back(spriteData);
     }
 }
 
+const Font::GlyphRun& Font::GetGlyphRun(const std::string& text, int paletteIndex)
+{
+    // counters and messages produce limited set of strings, just drop everything when cache grows too much
+    const int MaxGlyphRuns = 256;
+
+    std::map<std::string, GlyphRun>& paletteRuns = mGlyphRuns[paletteIndex];
+    auto runIterator = paletteRuns.find(text);
+    if (runIterator != paletteRuns.end())
+        return runIterator->second;
+
+    if (mGlyphRunsCount == MaxGlyphRuns)
+    {
+        for (auto& currPaletteRuns: mGlyphRuns)
+        {
+            currPaletteRuns.second.clear();
+        }
+        mGlyphRunsCount = 0;
+    }
+
+    GlyphRun& glyphRun = paletteRuns[text];
+    BuildGlyphRun(text, paletteIndex, glyphRun.mGlyphs);
+    ++mGlyphRunsCount;
+    return glyphRun;
+}
+
+void Font::ClearGlyphRuns()
+{
+    mGlyphRuns.clear();
+    mGlyphRunsCount = 0;
+}
+
 bool Font::CreateFontAtlas()
 {
     const int numCharacters = (int) mFontData.mRawCharacters.size();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GuiDefs.h"
+#include "Sprite2D.h"
 
 // Drawable font instance
 class Font final: public cxx::noncopyable
@@ -23,6 +24,7 @@ public:
     void SetFontBaseCharCode(int charCode);
 
     // Simple draw text characters on screen
+    // Glyph sprites of string are built once and cached by text and palette until font gets unloaded
     // @param guiContext: Context
     // @param text: Source string
     // @param position: Screen position in pixels
@@ -46,6 +48,20 @@ public:
 private:
     bool CreateFontAtlas();
 
+    // glyph sprites of single string, positions are relative to string origin
+    struct GlyphRun
+    {
+    public:
+        std::vector<Sprite2D> mGlyphs;
+    };
+
+    // Get character index within font atlas
+    // @returns -1 if character cannot be drawn
+    int GetCharIndex(unsigned char charCode) const;
+    void BuildGlyphRun(const std::string& text, int paletteIndex, std::vector<Sprite2D>& outputGlyphs) const;
+    const GlyphRun& GetGlyphRun(const std::string& text, int paletteIndex);
+    void ClearGlyphRuns();
+
 private:
 
     struct RawCharacter
@@ -66,4 +82,9 @@ private:
 
     int mBaseCharCode = 0;
     int mLineHeight = 0;
+
+    // cached strings, palette index to text
+    std::map<int, std::map<std::string, GlyphRun>> mGlyphRuns;
+    int mGlyphRunsCount = 0;
+    std::vector<Sprite2D> mGlyphsScratch; // used when cache is disabled
 };
\ No newline at end of file
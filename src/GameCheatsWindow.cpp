@@ -9,6 +9,9 @@
 #include "AiManager.h"
 #include "TrafficManager.h"
 #include "AiCharacterController.h"
+#include "AudioManager.h"
+#include "ProjectilesManager.h"
+#include "ExplosionsManager.h"
 #include "cvars.h"
 #include "ImGuiHelpers.h"
 
@@ -203,12 +206,75 @@ void GameCheatsWindow::DoUI(ImGuiIO& imguiContext)
     {
         //ImGui::Checkbox("Enable map collisions", &mEnableMapCollisions);
         ImGui::Checkbox("Enable gravity", &mEnableGravity);
+        ImGui::HorzSpacing();
+        if (gCarnageGame.IsLockstepMode())
+        {
+            ImGui::Text("Lockstep frame: %d, state hash: %016llx", gCarnageGame.mSimulationFrame, gCarnageGame.mStateHash);
+            ImGui::Checkbox("Log state hash", &gCvarGameLockstepHashLog.mValue);
+            if (gCarnageGame.mStateHashDivergedFrame > 0)
+            {
+                ImGui::Text("Diverged from reference at frame %d", gCarnageGame.mStateHashDivergedFrame);
+            }
+        }
+        else
+        {
+            ImGui::Text("Lockstep mode: off");
+        }
+        ImGui::HorzSpacing();
+        const PhysicsWorldStats& worldStats = gPhysics.mWorldStats;
+        ImGui::Text("Map shapes: %d (%d wall blocks)", worldStats.mMapShapes, worldStats.mMapWallBlocks);
+        ImGui::Text("Map shapes per block column: %d", worldStats.mMapColumnShapes);
+        ImGui::Text("Bodies: %d", worldStats.mBodiesCount);
+        ImGui::Text("Broadphase proxies: %d", worldStats.mProxiesCount);
+        ImGui::Text("Broadphase pairs: %d", worldStats.mContactsCount);
+        ImGui::Text("Step time: %.3f ms", worldStats.mStepTimeMs);
+        ImGui::Text("Per-body phases: %.3f ms (%d threads)", worldStats.mBodiesPhaseTimeMs, worldStats.mWorkerThreadsCount);
+        ImGui::HorzSpacing();
+        ImGui::Text("Step size: %.2f ms", worldStats.mSimulationStepTimeMs);
+        ImGui::Text("Frame substeps: %d (%.3f ms)", worldStats.mFrameSubsteps, worldStats.mFrameStepsTimeMs);
+        ImGui::Text("Time dilation: %.2f", worldStats.mTimeDilation);
+        ImGui::Text("Dropped time: %.2f s (%d frames)", worldStats.mDroppedTime, worldStats.mCatchUpLimitHits);
+        ImGui::Text("Collision contacts: %d, events: %d (%.3f ms)", worldStats.mCollisionContacts, worldStats.mCollisionEvents, 
+            worldStats.mCollisionDispatchTimeMs);
+        ImGui::HorzSpacing();
+        ImGui::Checkbox("Lightweight projectiles", &gCvarLightweightProjectiles.mValue);
+        ImGui::Text("Projectiles: %d (%d hits)", gProjectilesManager.mStats.mActiveCount, gProjectilesManager.mStats.mHitsCount);
+        ImGui::Text("Projectiles update: %.3f ms", gProjectilesManager.mStats.mUpdateTimeMs);
+        ImGui::HorzSpacing();
+        ImGui::SliderInt("Chain explosions per frame", &gCvarExplosionsChainBudget.mValue, 0, 32);
+        ImGui::Text("Chain explosions: %d scheduled, %d detonated, %d deferred", gExplosionsManager.mStats.mScheduledCount, 
+            gExplosionsManager.mStats.mDetonatedCount, gExplosionsManager.mStats.mDeferredCount);
+        ImGui::Text("Chain explosions peak: %d per frame", gExplosionsManager.mStats.mPeakDetonatedCount);
     }
 
     if (ImGui::CollapsingHeader("Draw"))
     {
         ImGui::Text("Map chunks drawn: %d", gRenderManager.mMapRenderer.mRenderStats.mBlockChunksDrawnCount);
+        ImGui::Text("Map draw calls: %d (%d ranges)", gRenderManager.mMapRenderer.mRenderStats.mCityMeshDrawCallsCount, 
+            gRenderManager.mMapRenderer.mRenderStats.mCityMeshDrawCommandsCount);
+        if (gGraphicsDevice.mCaps.mFeatures[eGraphicsFeature_MultiDrawIndirect])
+        {
+            ImGui::Checkbox("Multi draw indirect", &gCvarGraphicsMultiDrawIndirect.mValue);
+        }
         ImGui::Text("Sprites drawn: %d", gRenderManager.mMapRenderer.mRenderStats.mSpritesDrawnCount);
+        ImGui::Text("Sprites culled: %d, occluded: %d", gRenderManager.mMapRenderer.mRenderStats.mSpritesCulledCount, 
+            gRenderManager.mMapRenderer.mRenderStats.mSpritesOccludedCount);
+        ImGui::Checkbox("Instanced sprites", &gCvarGraphicsInstancedSprites.mValue);
+        ImGui::SameLine(); ImGui::Checkbox("Sprites occlusion", &gCvarGraphicsSpritesOcclusion.mValue);
+        ImGui::Text("City mesh: %d triangles, %d vertices, %d KB (unpacked %d KB)", 
+            gRenderManager.mMapRenderer.mRenderStats.mCityMeshTrianglesCount,
+            gRenderManager.mMapRenderer.mRenderStats.mCityMeshVerticesCount, 
+            gRenderManager.mMapRenderer.mRenderStats.mCityMeshVertexBytes / 1024, 
+            gRenderManager.mMapRenderer.mRenderStats.mCityMeshUnpackedVertexBytes / 1024);
+        ImGui::Text("Streaming upload: %d KB per frame (%s)", gRenderManager.mMapRenderer.mRenderStats.mStreamingUploadBytes / 1024,
+            gRenderManager.mStreamingVertices.IsPersistentMapped() ? "persistent mapped" : "unsynchronized mapping");
+        const GraphicsCallsStats& callsStats = gGraphicsDevice.mLastFrameStats;
+        ImGui::Text("Api calls: %d per frame, %d skipped", callsStats.GetIssuedCallsCount(), callsStats.GetSkippedCallsCount());
+        ImGui::Text("Draws %d, programs %d, textures %d, buffers %d", callsStats.mDrawCalls, callsStats.mProgramBinds, 
+            callsStats.mTextureBinds, callsStats.mBufferBinds);
+        ImGui::Text("Attributes %d, states %d, uniforms %d (%d skipped)", callsStats.mAttributeCalls, callsStats.mStateChanges, 
+            callsStats.mUniformUploads, callsStats.mSkippedUniformUploads);
+        ImGui::Checkbox("State cache", &gCvarGraphicsStateCache.mValue);
         ImGui::HorzSpacing();
         ImGui::Checkbox("Debug draw", &mEnableDebugDraw);
         ImGui::Checkbox("Decorations", &mEnableDrawDecorations);
@@ -218,6 +284,22 @@ void GameCheatsWindow::DoUI(ImGuiIO& imguiContext)
         ImGui::Checkbox("City mesh", &mEnableDrawCityMesh);
     }
 
+    if (ImGui::CollapsingHeader("Audio"))
+    {
+        ImGui::Text("Active voices: %d", gAudioManager.mVoicesStats.mActiveVoices);
+        ImGui::Text("Hardware voices: %d", gAudioManager.mVoicesStats.mHardwareVoices);
+        ImGui::Text("Virtual voices: %d", gAudioManager.mVoicesStats.mVirtualVoices);
+        ImGui::Text("Voices stolen: %d", gAudioManager.mVoicesStats.mVoicesStolen);
+        ImGui::Text("Culled voices: %d", gAudioManager.mVoicesStats.mCulledVoices);
+        ImGui::Text("Audible emitters: %d", gAudioManager.mVoicesStats.mAudibleEmitters);
+        ImGui::Text("Culled emitters: %d", gAudioManager.mVoicesStats.mCulledEmitters);
+        ImGui::Text("Position updates: %d", gAudioManager.mVoicesStats.mPositionUpdates);
+        ImGui::HorzSpacing();
+        ImGui::Text("Music underruns: %d", gAudioManager.mMusicStats.mUnderrunsCount);
+        ImGui::Text("Music buffered chunks: %d", gAudioManager.mMusicStats.mBufferedChunks);
+        ImGui::Text("Music decode time: %.3f ms (max %.3f ms)", gAudioManager.mMusicStats.mAverageDecodeMs, gAudioManager.mMusicStats.mMaxDecodeMs);
+    }
+
     if (ImGui::CollapsingHeader("Traffic"))
     {
         ImGui::HorzSpacing();
@@ -238,6 +320,18 @@ void GameCheatsWindow::DoUI(ImGuiIO& imguiContext)
         ImGui::SliderInt("Generation chance##car", &gGameParams.mTrafficGenCarsChance, 0, 100);
         ImGui::SliderFloat("Generation cooldown##car", &gGameParams.mTrafficGenCarsCooldownTime, 0.5f, 5.0f, "%.1f");
         ImGui::Checkbox("Generation enabled##car", &mEnableTrafficCarsGeneration);
+        ImGui::HorzSpacing();
+        ImGui::TextColored(ImVec4(1.0f,1.0f,0.0f,1.0f), "Pedestrian states");
+        ImGui::HorzSpacing();
+        ImGui::Checkbox("Update by states", &gCvarPedestrianStateBuckets.mValue);
+        for (int istate = ePedestrianState_StandingStill; istate < ePedestrianState_COUNT; ++istate)
+        {
+            const PedestrianStateStats& stateStats = gGameObjectsManager.mPedestrianStateStats[istate];
+            if (stateStats.mPedestriansCount == 0)
+                continue;
+
+            ImGui::Text("%s: %d (%.3f ms)", cxx::enum_to_string((ePedestrianState) istate), stateStats.mPedestriansCount, stateStats.mUpdateTimeMs);
+        }
     }
 
     if (ImGui::CollapsingHeader("Graphics"))
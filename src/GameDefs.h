@@ -345,6 +345,9 @@ decl_enum_strings(eBlockFace);
 using SpriteDeltaBits = unsigned int;
 static_assert(sizeof(SpriteDeltaBits) * 8 >= MAX_SPRITE_DELTAS, "Delta bits underlying type is too small, see MAX_SPRITE_DELTAS");
 
+// set in sprite delta texel when it overrides color index of sprite pixel
+const unsigned short SpriteDeltaTexelCovered = 0x100;
+
 // defines picture rectanle within sprite atlas
 struct TextureRegion
 {
@@ -405,12 +408,14 @@ public:
     // clear spritesheet
     inline void Clear()
     {
-        mSpritesheetTexture = nullptr;
+        mPageTextures.clear();
         mEntries.clear();
+        mEntriesPages.clear();
     }
 public:
-    GpuTexture2D* mSpritesheetTexture = nullptr;
+    std::vector<GpuTexture2D*> mPageTextures; // entries which don't fit single texture spill into next page
     std::vector<TextureRegion> mEntries;
+    std::vector<int> mEntriesPages; // page index for each entry
 };
 
 // define sprite HLS remap information
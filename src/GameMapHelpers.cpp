@@ -2,6 +2,7 @@
 #include "GameMapHelpers.h"
 #include "SpriteManager.h"
 #include "GameMapManager.h"
+#include <unordered_map>
 
 bool GameMapHelpers::BuildMapMesh(GameMapManager& cityScape, const Rect& area, int layerIndex, CityMeshData& meshData)
 {
@@ -58,6 +59,263 @@ bool GameMapHelpers::BuildMapMesh(GameMapManager& cityScape, const Rect& area, C
     return true;
 }
 
+bool GameMapHelpers::BuildMapMeshOptimized(GameMapManager& cityScape, const Rect& area, CityMeshData& meshData, MapMeshBuildStats& stats)
+{
+    // preallocate
+    meshData.mBlocksIndices.reserve(4 * 1024 * 1024);
+    meshData.mBlocksVertices.reserve(4 * 1024 * 1024);
+
+    // flat lids candidates for merging within current layer
+    std::vector<const MapBlockInfo*> layerLids(area.w * area.h);
+
+    for (int tilez = 0; tilez < MAP_LAYERS_COUNT; ++tilez)
+    {
+        std::fill(layerLids.begin(), layerLids.end(), nullptr);
+
+        for (int tiley = 0; tiley < area.h; ++tiley)
+        for (int tilex = 0; tilex < area.w; ++tilex)
+        {
+            const MapBlockInfo* mapBlock = cityScape.GetBlockInfo(tilex + area.x, tiley + area.y, tilez);
+            if (mapBlock == nullptr)
+                continue;
+
+            for (int iface = 0; iface < eBlockFace_COUNT; ++iface)
+            {
+                if (mapBlock->mFaces[iface] == 0)
+                    continue;
+
+                ++stats.mFacesCount;
+
+                eBlockFace faceid = (eBlockFace) iface;
+                if (IsBlockFaceHidden(cityScape, tilex + area.x, tiley + area.y, tilez, faceid))
+                {
+                    ++stats.mHiddenFacesCount;
+                    continue;
+                }
+
+                if (faceid == eBlockFace_Lid && mapBlock->mSlopeType == 0)
+                {
+                    layerLids[tiley * area.w + tilex] = mapBlock;
+                    continue;
+                }
+
+                PutBlockFace(cityScape, meshData, tilex + area.x, tiley + area.y, tilez, faceid, mapBlock);
+                ++stats.mQuadsCount;
+            }
+        }
+
+        // greedy merge lids, extend along x first then along y while whole row matches
+        for (int tiley = 0; tiley < area.h; ++tiley)
+        for (int tilex = 0; tilex < area.w; ++tilex)
+        {
+            const MapBlockInfo* lidBlock = layerLids[tiley * area.w + tilex];
+            if (lidBlock == nullptr)
+                continue;
+
+            int sizex = 1;
+            while ((tilex + sizex) < area.w && CanMergeLids(lidBlock, layerLids[tiley * area.w + tilex + sizex]))
+            {
+                ++sizex;
+            }
+
+            int sizey = 1;
+            for (; (tiley + sizey) < area.h; ++sizey)
+            {
+                bool rowMatches = true;
+                for (int ix = 0; ix < sizex && rowMatches; ++ix)
+                {
+                    rowMatches = CanMergeLids(lidBlock, layerLids[(tiley + sizey) * area.w + tilex + ix]);
+                }
+                if (!rowMatches)
+                    break;
+            }
+
+            for (int iy = 0; iy < sizey; ++iy)
+            for (int ix = 0; ix < sizex; ++ix)
+            {
+                layerLids[(tiley + iy) * area.w + tilex + ix] = nullptr;
+            }
+
+            PutBlockLid(cityScape, meshData, tilex + area.x, tiley + area.y, tilez, sizex, sizey, lidBlock);
+            ++stats.mQuadsCount;
+            stats.mMergedLidsCount += (sizex * sizey) - 1;
+        }
+    }
+    return true;
+}
+
+bool GameMapHelpers::IsSolidBlock(GameMapManager& cityScape, int x, int y, int z)
+{
+    // blocks outside of map are never treated as occluders
+    if (x < 0 || y < 0 || z < 0 || x >= MAP_DIMENSIONS || y >= MAP_DIMENSIONS || z >= MAP_LAYERS_COUNT)
+        return false;
+
+    const MapBlockInfo* blockInfo = cityScape.GetBlockInfo(x, y, z);
+    return blockInfo && (blockInfo->mGroundType == eGroundType_Building) && (blockInfo->mSlopeType == 0) && 
+        !blockInfo->mIsFlat && (blockInfo->mFaces[eBlockFace_Lid] != 0);
+}
+
+bool GameMapHelpers::IsBlockFaceHidden(GameMapManager& cityScape, int x, int y, int z, eBlockFace face)
+{
+    switch (face)
+    {
+        case eBlockFace_W: return IsSolidBlock(cityScape, x - 1, y, z);
+        case eBlockFace_E: return IsSolidBlock(cityScape, x + 1, y, z);
+        case eBlockFace_N: return IsSolidBlock(cityScape, x, y - 1, z);
+        case eBlockFace_S: return IsSolidBlock(cityScape, x, y + 1, z);
+        case eBlockFace_Lid: return IsSolidBlock(cityScape, x, y, z + 1);
+        default:
+            debug_assert(false);
+        break;
+    }
+    return false;
+}
+
+bool GameMapHelpers::CanMergeLids(const MapBlockInfo* blockInfo, const MapBlockInfo* otherBlockInfo)
+{
+    return otherBlockInfo && 
+        (blockInfo->mFaces[eBlockFace_Lid] == otherBlockInfo->mFaces[eBlockFace_Lid]) &&
+        (blockInfo->mRemap == otherBlockInfo->mRemap) &&
+        (blockInfo->mLidRotation == otherBlockInfo->mLidRotation) &&
+        (blockInfo->mIsFlat == otherBlockInfo->mIsFlat);
+}
+
+void GameMapHelpers::PutBlockLid(GameMapManager& cityScape, CityMeshData& meshData, int x, int y, int z, int sizex, int sizey, const MapBlockInfo* blockInfo)
+{
+    debug_assert(blockInfo->mSlopeType == 0);
+
+    const int baseVertexIndex = meshData.mBlocksVertices.size();
+    const int baseIndex = meshData.mBlocksIndices.size();
+    PutBlockFace(cityScape, meshData, x, y, z, eBlockFace_Lid, blockInfo);
+
+    if (sizex == 1 && sizey == 1)
+        return;
+
+    // stretch single block lid, texture repeats once per block
+    const bool rotatedTexture = (blockInfo->mLidRotation == eLidRotation_90) || (blockInfo->mLidRotation == eLidRotation_270);
+    const glm::vec3 cubeOffset { x * METERS_PER_MAP_UNIT, z * METERS_PER_MAP_UNIT, y * METERS_PER_MAP_UNIT };
+    CityVertex3D corners[4]; // x, y: 0 0, 1 0, 1 1, 0 1
+    for (int icorner = 0; icorner < 4; ++icorner)
+    {
+        CityVertex3D& vertex = corners[icorner];
+        vertex = meshData.mBlocksVertices[baseVertexIndex + icorner];
+        glm::vec3 localPosition = vertex.mPosition - cubeOffset;
+        localPosition.x *= sizex;
+        localPosition.z *= sizey;
+        vertex.mPosition = cubeOffset + localPosition;
+        vertex.mTexcoord.x *= rotatedTexture ? sizey : sizex;
+        vertex.mTexcoord.y *= rotatedTexture ? sizex : sizey;
+    }
+    meshData.mBlocksVertices.resize(baseVertexIndex);
+    meshData.mBlocksIndices.resize(baseIndex);
+
+    // neighbour faces have vertices at each block corner, so merged lid needs them too along its edges,
+    // otherwise long edges would produce t-junctions and cracks between faces
+    // edge points go counterclockwise starting from corner 0, texture coordinates are whole numbers there
+    auto putEdgePoint = [&](int pointx, int pointy)
+    {
+        const float factorx = (pointx * 1.0f) / sizex;
+        const float factory = (pointy * 1.0f) / sizey;
+
+        CityVertex3D vertex = corners[0];
+        vertex.mPosition.x = (x + pointx) * METERS_PER_MAP_UNIT;
+        vertex.mPosition.z = (y + pointy) * METERS_PER_MAP_UNIT;
+        glm::vec3 texcoord = corners[0].mTexcoord +
+            (corners[1].mTexcoord - corners[0].mTexcoord) * factorx +
+            (corners[3].mTexcoord - corners[0].mTexcoord) * factory;
+        vertex.mTexcoord.x = roundf(texcoord.x);
+        vertex.mTexcoord.y = roundf(texcoord.y);
+        meshData.mBlocksVertices.push_back(vertex);
+    };
+    for (int ix = 0; ix < sizex; ++ix) putEdgePoint(ix, 0);
+    for (int iy = 0; iy < sizey; ++iy) putEdgePoint(sizex, iy);
+    for (int ix = sizex; ix > 0; --ix) putEdgePoint(ix, sizey);
+    for (int iy = sizey; iy > 0; --iy) putEdgePoint(0, iy);
+
+    // clip ears at vertices that are not collinear with their neighbours, polygon is convex so each of them is ear
+    std::vector<int> polygon;
+    polygon.reserve((sizex + sizey) * 2);
+    for (int ivertex = baseVertexIndex; ivertex < (int) meshData.mBlocksVertices.size(); ++ivertex)
+    {
+        polygon.push_back(ivertex);
+    }
+
+    auto isCollinear = [&meshData](int prev, int curr, int next)
+    {
+        const glm::vec3& pointA = meshData.mBlocksVertices[prev].mPosition;
+        const glm::vec3& pointB = meshData.mBlocksVertices[curr].mPosition;
+        const glm::vec3& pointC = meshData.mBlocksVertices[next].mPosition;
+        float cross = (pointB.x - pointA.x) * (pointC.z - pointA.z) - (pointB.z - pointA.z) * (pointC.x - pointA.x);
+        return fabs(cross) < 0.0001f;
+    };
+
+    // also new diagonal must not pass through remaining points, that would be t-junction again
+    for (int icurr = 0, skipsCount = 0; (polygon.size() > 3) && (skipsCount < (int) polygon.size()); )
+    {
+        const int pointsCount = (int) polygon.size();
+        const int iprev = (icurr + pointsCount - 1) % pointsCount;
+        const int inext = (icurr + 1) % pointsCount;
+        if (isCollinear(polygon[iprev], polygon[icurr], polygon[inext]) ||
+            isCollinear(polygon[iprev], polygon[inext], polygon[(inext + 1) % pointsCount]) ||
+            isCollinear(polygon[(iprev + pointsCount - 1) % pointsCount], polygon[iprev], polygon[inext]))
+        {
+            icurr = inext;
+            ++skipsCount;
+            continue;
+        }
+        // same winding as single block lid
+        meshData.mBlocksIndices.push_back(polygon[inext]);
+        meshData.mBlocksIndices.push_back(polygon[icurr]);
+        meshData.mBlocksIndices.push_back(polygon[iprev]);
+        polygon.erase(polygon.begin() + icurr);
+        icurr = icurr % (pointsCount - 1);
+        skipsCount = 0;
+    }
+    debug_assert(polygon.size() == 3);
+    for (int icurr = 2; icurr < (int) polygon.size(); ++icurr)
+    {
+        meshData.mBlocksIndices.push_back(polygon[icurr]);
+        meshData.mBlocksIndices.push_back(polygon[icurr - 1]);
+        meshData.mBlocksIndices.push_back(polygon[0]);
+    }
+}
+
+void GameMapHelpers::PackMeshData(const CityMeshData& sourceMesh, unsigned int indicesStart, unsigned int indicesCount, 
+    const glm::vec3& origin, const glm::ivec2& chunkCell, CityPackedMeshData& meshData)
+{
+    struct PackedVertexHash
+    {
+        size_t operator () (const CityPackedVertex3D& vertex) const
+        {
+            unsigned long long hashValue = 0;
+            static_assert(sizeof(CityPackedVertex3D) >= sizeof(hashValue), "Unexpected vertex size");
+            memcpy(&hashValue, &vertex, sizeof(hashValue));
+            return std::hash<unsigned long long>()(hashValue) ^ (vertex.mTexcoord[0] | (vertex.mTexcoord[1] << 8));
+        }
+    };
+    // vertices are shared within single call only so that index ranges remains independent
+    std::unordered_map<CityPackedVertex3D, DrawIndex, PackedVertexHash> sharedVertices;
+    sharedVertices.reserve(indicesCount);
+
+    meshData.mBlocksIndices.reserve(meshData.mBlocksIndices.size() + indicesCount);
+    for (unsigned int iindex = indicesStart; iindex < (indicesStart + indicesCount); ++iindex)
+    {
+        const CityVertex3D& sourceVertex = sourceMesh.mBlocksVertices[sourceMesh.mBlocksIndices[iindex]];
+
+        CityPackedVertex3D packedVertex;
+        packedVertex.Set(sourceVertex.mPosition - origin, glm::vec2(sourceVertex.mTexcoord), 
+            static_cast<int>(sourceVertex.mTexcoord.z + 0.5f), sourceVertex.mRemap, sourceVertex.mTransparency);
+        packedVertex.SetChunkCell(chunkCell.x, chunkCell.y);
+
+        auto insertResult = sharedVertices.emplace(packedVertex, static_cast<DrawIndex>(meshData.mBlocksVertices.size()));
+        if (insertResult.second)
+        {
+            meshData.mBlocksVertices.push_back(packedVertex);
+        }
+        meshData.mBlocksIndices.push_back(insertResult.first->second);
+    }
+}
+
 void GameMapHelpers::PutBlockFace(GameMapManager& cityScape, CityMeshData& meshData, int x, int y, int z, eBlockFace face, const MapBlockInfo* blockInfo)
 {
     assert(blockInfo && blockInfo->mFaces[face]);
@@ -20,6 +20,19 @@ public:
 };
 
 using CityMeshData = MeshData<CityVertex3D>;
+using CityPackedMeshData = MeshData<CityPackedVertex3D>;
+
+// map mesh builder statistics
+struct MapMeshBuildStats
+{
+public:
+    MapMeshBuildStats() = default;
+public:
+    int mFacesCount = 0; // faces defined in map data
+    int mHiddenFacesCount = 0; // faces fully occluded by solid neighbours
+    int mMergedLidsCount = 0; // lids eliminated by merging
+    int mQuadsCount = 0; // quads emitted
+};
 
 class GameMapManager;
 class GameMapHelpers final
@@ -33,6 +46,25 @@ public:
     static bool BuildMapMesh(GameMapManager& city, const Rect& area, int layerIndex, CityMeshData& meshData);
     static bool BuildMapMesh(GameMapManager& city, const Rect& area, CityMeshData& meshData);
 
+    // construct mesh for specified city area, faces occluded by solid neighbour blocks are skipped
+    // and adjacent flat lids with same tile, remap and rotation are merged into single quads
+    // merged lids have texture coordinates beyond [0, 1] and require repeat wrap mode,
+    // they keep vertex at each block corner along their edges so that they do not make t-junctions with neighbour faces
+    // @param cityScape: City scape data
+    // @param area: Target map rect
+    // @param meshData: Output mesh data
+    // @param stats: Output statistics, gets accumulated
+    static bool BuildMapMeshOptimized(GameMapManager& city, const Rect& area, CityMeshData& meshData, MapMeshBuildStats& stats);
+
+    // convert part of mesh to quantized vertex format, identical vertices are shared
+    // @param sourceMesh: Source mesh data
+    // @param indicesStart, indicesCount: Source triangles range
+    // @param origin: Positions are stored relative to this point
+    // @param chunkCell: Mesh chunk position within chunks grid, origin must match to this position
+    // @param meshData: Output mesh data, new geometry gets appended
+    static void PackMeshData(const CityMeshData& sourceMesh, unsigned int indicesStart, unsigned int indicesCount, 
+        const glm::vec3& origin, const glm::ivec2& chunkCell, CityPackedMeshData& meshData);
+
     // compute height for specific block slope type
     // @param slopeType: Slope type
     // @param x, y: Position within block [0, 1]
@@ -42,4 +74,8 @@ public:
 private:
     // internals
     static void PutBlockFace(GameMapManager& city, CityMeshData& meshData, int x, int y, int z, eBlockFace face, const MapBlockInfo* blockInfo);
+    static void PutBlockLid(GameMapManager& city, CityMeshData& meshData, int x, int y, int z, int sizex, int sizey, const MapBlockInfo* blockInfo);
+    static bool IsSolidBlock(GameMapManager& city, int x, int y, int z);
+    static bool IsBlockFaceHidden(GameMapManager& city, int x, int y, int z, eBlockFace face);
+    static bool CanMergeLids(const MapBlockInfo* blockInfo, const MapBlockInfo* otherBlockInfo);
 };
\ No newline at end of file
@@ -54,6 +54,7 @@ bool GameMapManager::LoadFromFile(const std::string& filename)
         gConsole.LogMessage(eLogMessage_Warning, "Cannot read compressed map data");
         return false;
     }
+    BuildTopSolidLayers();
 
     if (!ReadStartupObjects(file, header.object_pos_size))
     {
@@ -104,6 +105,7 @@ void GameMapManager::Cleanup()
             memset(&mMapTiles[tilez][tiley][tilex], 0, Sizeof_BlockInfo);
         }
     }
+    memset(mTopSolidLayers, 0, sizeof(mTopSolidLayers));
     mStartupObjects.clear();
     for (int ibase = 0; ibase < eAccidentServise_COUNT; ++ibase)
     {
@@ -118,6 +120,25 @@ bool GameMapManager::IsLoaded() const
     return mStyleData.IsLoaded();
 }
 
+void GameMapManager::BuildTopSolidLayers()
+{
+    for (int tiley = 0; tiley < MAP_DIMENSIONS; ++tiley)
+    for (int tilex = 0; tilex < MAP_DIMENSIONS; ++tilex)
+    {
+        mTopSolidLayers[tiley][tilex] = 0;
+        for (int tilez = MAP_LAYERS_COUNT - 1; tilez > 0; --tilez)
+        {
+            // flat lids have transparent pixels
+            const MapBlockInfo& blockInfo = mMapTiles[tilez][tiley][tilex];
+            if (blockInfo.mFaces[eBlockFace_Lid] && !blockInfo.mIsFlat)
+            {
+                mTopSolidLayers[tiley][tilex] = tilez;
+                break;
+            }
+        }
+    }
+}
+
 bool GameMapManager::ReadCompressedMapData(std::istream& file, int columnLength, int blocksLength)
 {
     // reading base data
@@ -335,13 +356,23 @@ float GameMapManager::GetHeightAtPosition(const glm::vec3& position, bool exclud
     return Convert::MapUnitsToMeters(currentHeight);
 }
 
-bool GameMapManager::TraceSegment2D(const glm::vec2& origin, const glm::vec2& destination, float height, glm::vec2& outPoint)
+bool GameMapManager::TraceSegment2D(const glm::vec2& origin, const glm::vec2& destination, float height, glm::vec2& outPoint) const
 {
-    glm::ivec2 mapcoord_start = origin;
-    glm::ivec2 mapcoord_end = destination;
+    glm::ivec2 mapcoord_start = glm::floor(origin);
+    glm::ivec2 mapcoord_end = glm::floor(destination);
 
     int mapcoord_z = (int) height;
 
+    // segment may start inside solid block
+    if (GetBlockInfo(mapcoord_start.x, mapcoord_start.y, mapcoord_z)->mGroundType == eGroundType_Building)
+    {
+        outPoint = origin;
+        return true;
+    }
+
+    if (mapcoord_start == mapcoord_end)
+        return false;
+
     glm::vec2 direction = glm::normalize(destination - origin);
 
     // find all cells intersecting with line
@@ -387,8 +418,8 @@ bool GameMapManager::TraceSegment2D(const glm::vec2& origin, const glm::vec2& de
         sideDistY = (mapcoord_curr.y + 1.0f - posY) * deltaDistY;
     }
 
-    //perform DDA
-    const int MaxSteps = 16;
+    //perform DDA, segment crosses at most that number of cells
+    const int MaxSteps = std::abs(mapcoord_end.x - mapcoord_start.x) + std::abs(mapcoord_end.y - mapcoord_start.y);
     for (int istep = 0; ; ++istep)
     {
         if (istep == MaxSteps)
@@ -408,6 +439,10 @@ bool GameMapManager::TraceSegment2D(const glm::vec2& origin, const glm::vec2& de
             side = 1;
         }
 
+        // outside of map there are no blocks
+        if ((mapcoord_curr.x < 0) || (mapcoord_curr.y < 0) || (mapcoord_curr.x >= MAP_DIMENSIONS) || (mapcoord_curr.y >= MAP_DIMENSIONS))
+            return false;
+
         // detect hit
         const MapBlockInfo* blockData = GetBlockInfo(mapcoord_curr.x, mapcoord_curr.y, mapcoord_z);
         if (blockData->mGroundType == eGroundType_Building)
@@ -427,6 +462,251 @@ bool GameMapManager::TraceSegment2D(const glm::vec2& origin, const glm::vec2& de
     return false;
 }
 
+bool GameMapManager::TraceSegment(const glm::vec3& origin, const glm::vec3& destination, MapTraceResult* outResult) const
+{
+    // all computations are in map units, y is map layer
+    // note that vector conversion is not used here because it adds height offset
+    glm::vec3 start (Convert::MetersToMapUnits(origin.x), Convert::MetersToMapUnits(origin.y), Convert::MetersToMapUnits(origin.z));
+    glm::vec3 delta = glm::vec3(Convert::MetersToMapUnits(destination.x), Convert::MetersToMapUnits(destination.y), Convert::MetersToMapUnits(destination.z)) - start;
+
+    // clip segment to map volume
+    const glm::vec3 mapExtents (MAP_DIMENSIONS * 1.0f, MAP_LAYERS_COUNT * 1.0f, MAP_DIMENSIONS * 1.0f);
+
+    float fractionMin = 0.0f;
+    float fractionMax = 1.0f;
+    for (int iaxis = 0; iaxis < 3; ++iaxis)
+    {
+        if (delta[iaxis] == 0.0f)
+        {
+            if (start[iaxis] < 0.0f || start[iaxis] >= mapExtents[iaxis])
+                return false;
+
+            continue;
+        }
+        float fractionA = (0.0f - start[iaxis]) / delta[iaxis];
+        float fractionB = (mapExtents[iaxis] - start[iaxis]) / delta[iaxis];
+        if (fractionA > fractionB)
+        {
+            std::swap(fractionA, fractionB);
+        }
+        fractionMin = std::max(fractionMin, fractionA);
+        fractionMax = std::min(fractionMax, fractionB);
+    }
+
+    if (fractionMin > fractionMax)
+        return false;
+
+    // setup dda
+    glm::ivec3 blockPosition = glm::floor(start + delta * fractionMin);
+    glm::ivec3 blockStep;
+    glm::vec3 fractionNext;
+    glm::vec3 fractionDelta;
+    for (int iaxis = 0; iaxis < 3; ++iaxis)
+    {
+        blockPosition[iaxis] = glm::clamp(blockPosition[iaxis], 0, (int) mapExtents[iaxis] - 1);
+        if (delta[iaxis] > 0.0f)
+        {
+            blockStep[iaxis] = 1;
+            fractionDelta[iaxis] = 1.0f / delta[iaxis];
+            fractionNext[iaxis] = (blockPosition[iaxis] + 1.0f - start[iaxis]) / delta[iaxis];
+        }
+        else if (delta[iaxis] < 0.0f)
+        {
+            blockStep[iaxis] = -1;
+            fractionDelta[iaxis] = -1.0f / delta[iaxis];
+            fractionNext[iaxis] = (blockPosition[iaxis] - start[iaxis]) / delta[iaxis];
+        }
+        else
+        {
+            blockStep[iaxis] = 0;
+            fractionDelta[iaxis] = 0.0f;
+            fractionNext[iaxis] = std::numeric_limits<float>::max();
+        }
+    }
+
+    float fractionEnter = fractionMin;
+    int enterAxis = -1;
+    for (;;)
+    {
+        // find next block boundary
+        int exitAxis = 0;
+        if (fractionNext[1] < fractionNext[exitAxis]) exitAxis = 1;
+        if (fractionNext[2] < fractionNext[exitAxis]) exitAxis = 2;
+
+        float fractionExit = fractionNext[exitAxis];
+        if (fractionExit >= fractionMax)
+        {
+            fractionExit = fractionMax;
+            exitAxis = -1;
+        }
+
+        float hitFraction;
+        if (TraceBlock(blockPosition, start, delta, fractionEnter, fractionExit, enterAxis, exitAxis, hitFraction))
+        {
+            if (outResult)
+            {
+                outResult->mFraction = hitFraction;
+                outResult->mHitPoint = Convert::MapUnitsToMeters(start + delta * hitFraction);
+                outResult->mBlockPosition = blockPosition;
+            }
+            return true;
+        }
+
+        if (exitAxis == -1)
+            break;
+
+        blockPosition[exitAxis] += blockStep[exitAxis];
+        if (blockPosition[exitAxis] < 0 || blockPosition[exitAxis] >= (int) mapExtents[exitAxis])
+            break;
+
+        fractionNext[exitAxis] += fractionDelta[exitAxis];
+        fractionEnter = fractionExit;
+        enterAxis = exitAxis;
+    }
+
+    return false;
+}
+
+bool GameMapManager::TraceBlock(const glm::ivec3& blockPosition, const glm::vec3& start, const glm::vec3& delta, float fractionEnter, float fractionExit,
+    int enterAxis, int exitAxis, float& outFraction) const
+{
+    const MapBlockInfo& blockData = mMapTiles[blockPosition.y][blockPosition.z][blockPosition.x];
+
+    // slope surface is plane within block, so distance from segment to surface changes linearly
+    if (blockData.mSlopeType > 0 && blockData.mSlopeType <= 44)
+    {
+        auto getHeightAboveSlope = [&](float fraction)
+        {
+            glm::vec3 point = start + delta * fraction;
+            float cx = glm::clamp(point.x - blockPosition.x, 0.0f, 1.0f);
+            float cy = glm::clamp(point.z - blockPosition.z, 0.0f, 1.0f);
+            return point.y - (blockPosition.y + GameMapHelpers::GetSlopeHeight(blockData.mSlopeType, cx, cy));
+        };
+
+        float heightEnter = getHeightAboveSlope(fractionEnter);
+        if (heightEnter <= 0.0f)
+        {
+            outFraction = fractionEnter;
+            return true;
+        }
+
+        float heightExit = getHeightAboveSlope(fractionExit);
+        if (heightExit <= 0.0f)
+        {
+            outFraction = fractionEnter + (fractionExit - fractionEnter) * (heightEnter / (heightEnter - heightExit));
+            return true;
+        }
+        return false;
+    }
+
+    if (blockData.mGroundType == eGroundType_Building)
+    {
+        outFraction = fractionEnter;
+        return true;
+    }
+
+    // ground is solid floor at bottom of block, check if segment crosses it
+    if (blockData.mGroundType == eGroundType_Field ||
+        blockData.mGroundType == eGroundType_Pawement ||
+        blockData.mGroundType == eGroundType_Road)
+    {
+        if (enterAxis == 1 && delta.y > 0.0f)
+        {
+            outFraction = fractionEnter;
+            return true;
+        }
+
+        if (exitAxis == 1 && delta.y < 0.0f)
+        {
+            outFraction = fractionExit;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GameMapManager::HasLineOfSight(const glm::vec3& pointA, const glm::vec3& pointB) const
+{
+    return !TraceSegment(pointA, pointB);
+}
+
+void GameMapManager::QueryLineOfSight(MapLineOfSightQuery* queries, int queriesCount) const
+{
+    debug_assert(queries || (queriesCount == 0));
+
+    // map data is readonly here so queries are processed independently
+    const int MinQueriesPerThread = 256;
+    gWorkerPool.parallel_for(queriesCount, MinQueriesPerThread, 0, [this, queries](int ibegin, int iend)
+    {
+        for (int icurr = ibegin; icurr < iend; ++icurr)
+        {
+            MapLineOfSightQuery& currQuery = queries[icurr];
+            currQuery.mVisible = !TraceSegment(currQuery.mPointA, currQuery.mPointB);
+        }
+    });
+}
+
+void GameMapManager::RunLineOfSightBenchmark(const glm::vec3& center, int raysCount) const
+{
+    raysCount = std::max(raysCount, 1);
+
+    // random segments within few blocks around center, like ai pedestrians looking at player
+    const float AreaExtents = Convert::MapUnitsToMeters(12.0f);
+    const float HeightExtents = Convert::MapUnitsToMeters(1.0f);
+
+    cxx::randomizer random;
+    std::vector<MapLineOfSightQuery> queries(raysCount);
+    for (MapLineOfSightQuery& currQuery: queries)
+    {
+        currQuery.mPointA.x = center.x + random.generate_float(-AreaExtents, AreaExtents);
+        currQuery.mPointA.y = center.y + random.generate_float(0.0f, HeightExtents);
+        currQuery.mPointA.z = center.z + random.generate_float(-AreaExtents, AreaExtents);
+        currQuery.mPointB = center;
+        currQuery.mPointB.y += 0.5f * HeightExtents;
+    }
+
+    const int PassesCount = 10;
+
+    // single ray queries
+    int visibleCount = 0;
+    double startTime = gSystem.GetSystemSeconds();
+    for (int ipass = 0; ipass < PassesCount; ++ipass)
+    {
+        visibleCount = 0;
+        for (const MapLineOfSightQuery& currQuery: queries)
+        {
+            if (HasLineOfSight(currQuery.mPointA, currQuery.mPointB))
+            {
+                ++visibleCount;
+            }
+        }
+    }
+    double singleTime = std::max(gSystem.GetSystemSeconds() - startTime, 0.000001);
+
+    // batch queries
+    startTime = gSystem.GetSystemSeconds();
+    for (int ipass = 0; ipass < PassesCount; ++ipass)
+    {
+        QueryLineOfSight(queries.data(), raysCount);
+    }
+    double batchTime = std::max(gSystem.GetSystemSeconds() - startTime, 0.000001);
+
+    int batchVisibleCount = 0;
+    for (const MapLineOfSightQuery& currQuery: queries)
+    {
+        if (currQuery.mVisible)
+        {
+            ++batchVisibleCount;
+        }
+    }
+    debug_assert(batchVisibleCount == visibleCount);
+
+    double raysTotal = (double) raysCount * PassesCount;
+    gConsole.LogMessage(eLogMessage_Info, "Line of sight benchmark: %d rays, %d visible", raysCount, visibleCount);
+    gConsole.LogMessage(eLogMessage_Info, "    single: %.0f rays/sec", raysTotal / singleTime);
+    gConsole.LogMessage(eLogMessage_Info, "    batch: %.0f rays/sec (%d threads)", raysTotal / batchTime, gWorkerPool.get_threads_count());
+}
+
 bool GameMapManager::ReadStartupObjects(std::istream& file, int dataSize)
 {
     const unsigned int RecordSize = 14;
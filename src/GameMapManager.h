@@ -3,6 +3,33 @@
 #include "GameDefs.h"
 #include "StyleData.h"
 
+// map segment trace result
+struct MapTraceResult
+{
+public:
+    MapTraceResult() = default;
+public:
+    glm::vec3 mHitPoint; // meters
+    glm::ivec3 mBlockPosition; // map units, y is map layer
+    float mFraction = 0.0f; // distance to hit point in range [0, 1] along segment
+};
+
+// line of sight query, used for batch processing
+struct MapLineOfSightQuery
+{
+public:
+    MapLineOfSightQuery() = default;
+    MapLineOfSightQuery(const glm::vec3& pointA, const glm::vec3& pointB)
+        : mPointA(pointA)
+        , mPointB(pointB)
+    {
+    }
+public:
+    glm::vec3 mPointA; // meters
+    glm::vec3 mPointB; // meters
+    bool mVisible = false; // result
+};
+
 // this class manages GTA map and style data which get loaded from CMP/G24-files
 class GameMapManager final: public cxx::noncopyable
 {
@@ -32,6 +59,16 @@ public:
     // @param coordx, coordy, layer: Block location
     const MapBlockInfo* GetBlockInfo(int coordx, int coordy, int layer) const;
 
+    // get layer of topmost block with opaque lid at specific map column, everything below that block is hidden when viewed from above
+    // @param coordx, coordy: Map column location, clamped to map dimensions
+    // @returns Layer index or 0 if column has no lids
+    inline int GetTopSolidLayer(int coordx, int coordy) const
+    {
+        coordx = glm::clamp(coordx, 0, MAP_DIMENSIONS - 1);
+        coordy = glm::clamp(coordy, 0, MAP_DIMENSIONS - 1);
+        return mTopSolidLayers[coordy][coordx];
+    }
+
     // Get navigation data sector at specific map point
     // @param position: Current position on map, meters
     // @returns null on error
@@ -48,12 +85,34 @@ public:
     float GetWaterLevelAtPosition2(const glm::vec2& position) const;
 
     // get intersection with solid blocks on specific map layer, ignores slopes
-    // @param origin: Start position
-    // @param destination: End position
+    // @param origin: Start position, map units
+    // @param destination: End position, map units
     // @param height: Z coord which is map layer
-    // @param outPoint: Intersection point
+    // @param outPoint: Intersection point, map units
+    // @returns true if intersection detected or false otherwise
+    bool TraceSegment2D(const glm::vec2& origin, const glm::vec2& destination, float height, glm::vec2& outPoint) const;
+
+    // get first intersection with map blocks along segment, walks through blocks in 3d
+    // buildings are solid, slopes are solid below surface and ground blocks are solid floor at bottom of block
+    // @param origin: Start position, meters
+    // @param destination: End position, meters
+    // @param outResult: Intersection info, optional
     // @returns true if intersection detected or false otherwise
-    bool TraceSegment2D(const glm::vec2& origin, const glm::vec2& destination, float height, glm::vec2& outPoint);
+    bool TraceSegment(const glm::vec3& origin, const glm::vec3& destination, MapTraceResult* outResult = nullptr) const;
+
+    // test whether there is no map blocks between two points
+    // @param pointA, pointB: Positions, meters
+    bool HasLineOfSight(const glm::vec3& pointA, const glm::vec3& pointB) const;
+
+    // process many line of sight queries at once, large batches are split between worker threads
+    // @param queries: Queries to process, results are written back
+    // @param queriesCount: Number of queries
+    void QueryLineOfSight(MapLineOfSightQuery* queries, int queriesCount) const;
+
+    // Trace random segments around specific point and measure throughput, results are printed to log
+    // @param center: Segments area center, meters
+    // @param raysCount: Number of segments per pass
+    void RunLineOfSightBenchmark(const glm::vec3& center, int raysCount) const;
 
 private:
     // Reading map data internals
@@ -64,12 +123,20 @@ private:
     bool ReadServiceBaseLocations(std::ifstream& file);
     bool ReadNavData(std::ifstream& file, int dataSize);
     void FixShiftedBits();
+    void BuildTopSolidLayers();
+
+    // test segment part within single block, all values are in map units
+    // @param enterAxis, exitAxis: Axis which segment crosses to enter and to exit block, -1 if segment starts or ends within block
+    // @param outFraction: Intersection distance along segment
+    bool TraceBlock(const glm::ivec3& blockPosition, const glm::vec3& start, const glm::vec3& delta, float fractionEnter, float fractionExit,
+        int enterAxis, int exitAxis, float& outFraction) const;
 
     std::string GetStyleFileName(int styleNumber) const;
 
 private:
     MapBlockInfo mMapTiles[MAP_LAYERS_COUNT][MAP_DIMENSIONS][MAP_DIMENSIONS]; // z, y, x
     int mBaseTilesData[MAP_DIMENSIONS][MAP_DIMENSIONS]; // y x
+    unsigned char mTopSolidLayers[MAP_DIMENSIONS][MAP_DIMENSIONS] {}; // y x
 
     // accident service base locations
     std::vector<glm::ivec3> mAccidentServicesBases[eAccidentServise_COUNT];
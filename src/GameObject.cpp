@@ -45,11 +45,11 @@ void GameObject::SetSprite(int spriteIndex, SpriteDeltaBits deltaBits)
 {
     if (deltaBits > 0)
     {
-        gSpriteManager.GetSpriteTexture(mObjectID, spriteIndex, mRemapClut, deltaBits, mDrawSprite);
+        gSpriteManager.GetSpriteTexture(spriteIndex, mRemapClut, deltaBits, mDrawSprite);
     }
     else
     {
-        gSpriteManager.GetSpriteTexture(mObjectID, spriteIndex, mRemapClut, mDrawSprite);
+        gSpriteManager.GetSpriteTexture(spriteIndex, mRemapClut, mDrawSprite);
     }
     RefreshDrawSprite();
 }
@@ -6,9 +6,18 @@
 #include "GameMapManager.h"
 #include "Projectile.h"
 #include "RenderingManager.h"
+#include "cvars.h"
 
 GameObjectsManager gGameObjectsManager;
 
+//////////////////////////////////////////////////////////////////////////
+// cvars
+//////////////////////////////////////////////////////////////////////////
+
+CvarBoolean gCvarPedestrianStateBuckets("g_pedStateBuckets", true, "Update pedestrians grouped by their current state after all other objects", CvarFlags_Archive);
+
+//////////////////////////////////////////////////////////////////////////
+
 GameObjectsManager::~GameObjectsManager()
 {
     mPedestriansPool.cleanup();
@@ -42,6 +51,8 @@ void GameObjectsManager::UpdateFrame()
 {
     bool hasDeadObjects = false;
 
+    bool updatePedestriansByState = IsPedestriansUpdateByState();
+
     // if is safe to add new objects during loop by adding them to the end of the list
 
     for (size_t i = 0, NumElements = mAllObjects.size(); i < NumElements; ++i)
@@ -52,9 +63,30 @@ void GameObjectsManager::UpdateFrame()
             hasDeadObjects = true;
             continue;
         }
+        // pedestrians go after all other objects, so within a frame they always see cars and obstacles already updated,
+        // while other objects see pedestrians state from previous frame, order is still same for every run
+        if (updatePedestriansByState && currentObject->IsPedestrianClass())
+            continue;
+
         currentObject->UpdateFrame();
     }
 
+    if (updatePedestriansByState)
+    {
+        UpdatePedestriansByState();
+    }
+    else
+    {
+        for (PedestrianStateStats& currStats: mPedestrianStateStats)
+        {
+            currStats = PedestrianStateStats();
+        }
+        for (Pedestrian* currPedestrian: mPedestriansList)
+        {
+            ++mPedestrianStateStats[currPedestrian->GetCurrentStateID()].mPedestriansCount;
+        }
+    }
+
     if (hasDeadObjects)
     {
         DestroyMarkedForDeletionObjects();
@@ -407,6 +439,86 @@ void GameObjectsManager::DestroyMarkedForDeletionObjects()
     }
 }
 
+bool GameObjectsManager::IsPedestriansUpdateByState() const
+{
+    return gCvarPedestrianStateBuckets.mValue;
+}
+
+void GameObjectsManager::UpdatePedestriansByState()
+{
+    // counting sort by current state, pedestrians keep creation order within state
+    int stateOffsets[ePedestrianState_COUNT + 1] = {};
+    for (Pedestrian* currPedestrian: mPedestriansList)
+    {
+        ++stateOffsets[currPedestrian->GetCurrentStateID() + 1];
+    }
+    for (int istate = 0; istate < ePedestrianState_COUNT; ++istate)
+    {
+        stateOffsets[istate + 1] += stateOffsets[istate];
+    }
+
+    mPedestriansByState.resize(mPedestriansList.size());
+    int stateCursors[ePedestrianState_COUNT];
+    std::copy(stateOffsets, stateOffsets + ePedestrianState_COUNT, stateCursors);
+    for (Pedestrian* currPedestrian: mPedestriansList)
+    {
+        mPedestriansByState[stateCursors[currPedestrian->GetCurrentStateID()]++] = currPedestrian;
+    }
+
+    // pedestrians created during update are not in the list, they will be updated next frame
+    for (int istate = 0; istate < ePedestrianState_COUNT; ++istate)
+    {
+        double startTime = gSystem.GetSystemSeconds();
+
+        int updatedCount = 0;
+        for (int icurr = stateOffsets[istate]; icurr < stateOffsets[istate + 1]; ++icurr)
+        {
+            Pedestrian* currPedestrian = mPedestriansByState[icurr];
+            if (currPedestrian->IsMarkedForDeletion())
+                continue;
+
+            currPedestrian->UpdateFrame();
+            ++updatedCount;
+        }
+
+        PedestrianStateStats& stateStats = mPedestrianStateStats[istate];
+        stateStats.mPedestriansCount = updatedCount;
+        stateStats.mUpdateTimeMs = (float) ((gSystem.GetSystemSeconds() - startTime) * 1000.0);
+    }
+}
+
+unsigned long long GameObjectsManager::ComputeStateHash() const
+{
+    // fnv-1a
+    unsigned long long hashValue = 14695981039346656037ULL;
+    auto hash_bytes = [&hashValue](const void* data, size_t dataLength)
+    {
+        const unsigned char* bytes = (const unsigned char*) data;
+        for (size_t ibyte = 0; ibyte < dataLength; ++ibyte)
+        {
+            hashValue ^= bytes[ibyte];
+            hashValue *= 1099511628211ULL;
+        }
+    };
+
+    for (const GameObject* currentObject: mAllObjects)
+    {
+        if (currentObject->IsMarkedForDeletion())
+            continue;
+
+        hash_bytes(&currentObject->mObjectID, sizeof(currentObject->mObjectID));
+        hash_bytes(&currentObject->mClassID, sizeof(currentObject->mClassID));
+        hash_bytes(&currentObject->mTransform.mPosition, sizeof(currentObject->mTransform.mPosition));
+        hash_bytes(&currentObject->mTransform.mOrientation.mDegrees, sizeof(currentObject->mTransform.mOrientation.mDegrees));
+        if (currentObject->mPhysicsBody)
+        {
+            glm::vec2 linearVelocity = currentObject->mPhysicsBody->GetLinearVelocity();
+            hash_bytes(&linearVelocity, sizeof(linearVelocity));
+        }
+    }
+    return hashValue;
+}
+
 GameObjectID GameObjectsManager::GenerateUniqueID()
 {
     GameObjectID newID = ++mIDsCounter;
@@ -7,6 +7,16 @@
 #include "Obstacle.h"
 #include "Explosion.h"
 
+// pedestrians update statistics for single state
+struct PedestrianStateStats
+{
+public:
+    PedestrianStateStats() = default;
+public:
+    int mPedestriansCount = 0; // last frame
+    float mUpdateTimeMs = 0.0f; // last frame, measured only if pedestrians are updated by states
+};
+
 // define game objects manager class
 class GameObjectsManager final: public cxx::noncopyable
 {
@@ -16,6 +26,8 @@ public:
     std::vector<Pedestrian*> mPedestriansList;
     std::vector<Vehicle*> mVehiclesList;
 
+    PedestrianStateStats mPedestrianStateStats[ePedestrianState_COUNT];
+
 public:
     ~GameObjectsManager();
 
@@ -63,6 +75,10 @@ public:
     Pedestrian* GetPedestrianByID(GameObjectID objectID) const;
     GameObject* GetGameObjectByID(GameObjectID objectID) const;
 
+    // Compute hash of all objects transforms and velocities, used to compare simulation runs in lockstep mode
+    // Objects are visited in creation order so result only depends on simulation state
+    unsigned long long ComputeStateHash() const;
+
     // Will immediately destroy gameobject, don't call this mehod during UpdateFrame
     // @param object: Object to destroy
     void DestroyGameObject(GameObject* object);
@@ -73,9 +89,15 @@ private:
     void DestroyMarkedForDeletionObjects();
     GameObjectID GenerateUniqueID();
 
+    // Update pedestrians grouped by their current state, each state is processed as continuous run
+    void UpdatePedestriansByState();
+    bool IsPedestriansUpdateByState() const;
+
 private:
     GameObjectID mIDsCounter = 0;
 
+    std::vector<Pedestrian*> mPedestriansByState; // sorted by current state each frame
+
     // objects pools
     cxx::object_pool<Pedestrian> mPedestriansPool;
     cxx::object_pool<Vehicle> mCarsPool;
@@ -10,6 +10,8 @@
 #include "ParticleEffectsManager.h"
 #include "TrafficManager.h"
 #include "AiManager.h"
+#include "ProjectilesManager.h"
+#include "ExplosionsManager.h"
 
 void GameplayGamestate::OnGamestateEnter()
 {
@@ -28,12 +30,16 @@ void GameplayGamestate::OnGamestateFrame()
     // advance game state
     gSpriteManager.UpdateBlocksAnimations(deltaTime);
     gPhysics.UpdateFrame();
+    gProjectilesManager.UpdateFrame();
+    gExplosionsManager.UpdateFrame();
     gGameObjectsManager.UpdateFrame();
     gWeatherManager.UpdateFrame();
     gParticleManager.UpdateFrame();
     gTrafficManager.UpdateFrame();
     gAiManager.UpdateFrame();
     gBroadcastEvents.UpdateFrame();
+
+    gCarnageGame.FinishSimulationFrame();
 }
 
 void GameplayGamestate::OnGamestateInputEvent(KeyInputEvent& inputEvent)
@@ -70,6 +70,12 @@ void GpuBuffer::SetUnbound()
 
 bool GpuBuffer::Setup(eBufferUsage bufferUsage, unsigned int bufferLength, const void* dataBuffer)
 {
+    if (IsPersistentMapped())
+    {
+        debug_assert(false); // storage is immutable
+        return false;
+    }
+
     unsigned int paddedContentLength = (bufferLength + 15U) & (~15U);
 
     mBufferLength = bufferLength;
@@ -109,9 +115,40 @@ bool GpuBuffer::Setup(eBufferUsage bufferUsage, unsigned int bufferLength, const
     return true;
 }
 
+bool GpuBuffer::SetupPersistent(unsigned int bufferLength)
+{
+#ifdef __EMSCRIPTEN__
+    debug_assert(false); // not supported
+    return false;
+#else
+    if (IsBufferInited() || !gGraphicsDevice.mCaps.mFeatures[eGraphicsFeature_BufferStorage])
+    {
+        debug_assert(false);
+        return false;
+    }
+
+    unsigned int paddedContentLength = (bufferLength + 15U) & (~15U);
+
+    mBufferLength = bufferLength;
+    mBufferCapacity = paddedContentLength;
+    mUsageHint = eBufferUsage_Stream;
+
+    ScopedBufferBinder scopedBind (mGraphicsContext, this);
+    GLenum bufferTargetGL = EnumToGL(mContent);
+    const GLbitfield storageBitsGL = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    ::glBufferStorage(bufferTargetGL, mBufferCapacity, nullptr, storageBitsGL);
+    glCheckError();
+
+    mPersistentData = ::glMapBufferRange(bufferTargetGL, 0, mBufferCapacity, storageBitsGL);
+    glCheckError();
+    debug_assert(mPersistentData);
+    return mPersistentData != nullptr;
+#endif
+}
+
 bool GpuBuffer::Resize(unsigned int newLength)
 {
-    if (!IsBufferInited())
+    if (!IsBufferInited() || IsPersistentMapped())
     {
         debug_assert(false);
         return false;
@@ -190,7 +227,7 @@ bool GpuBuffer::SubData(unsigned int dataOffset, unsigned int dataLength, const
 
 void* GpuBuffer::Lock(BufferAccessBits accessBits)
 {
-    if (!IsBufferInited())
+    if (!IsBufferInited() || IsPersistentMapped())
     {
         debug_assert(false);
         return nullptr;
@@ -223,9 +260,46 @@ void* GpuBuffer::Lock(BufferAccessBits accessBits)
     return pMappedData;
 }
 
+void* GpuBuffer::LockRange(unsigned int dataOffset, unsigned int dataLength, BufferAccessBits accessBits)
+{
+    if (!IsBufferInited() || IsPersistentMapped())
+    {
+        debug_assert(false);
+        return nullptr;
+    }
+
+    debug_assert(dataLength > 0 && (dataOffset + dataLength) <= mBufferCapacity);
+
+    ScopedBufferBinder scopedBind (mGraphicsContext, this);
+    GLenum bufferTargetGL = EnumToGL(mContent);
+
+    void* pMappedData = nullptr;
+#ifdef __EMSCRIPTEN__
+    if ((accessBits & BufferAccess_Read) > 0)
+    {
+        debug_assert(false); // reading is not supported
+        return nullptr;
+    }
+    pMappedData = ::glMapBufferRange(bufferTargetGL, dataOffset, dataLength, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+
+#else
+    GLbitfield accessBitsGL = ((accessBits & BufferAccess_Read) > 0 ? GL_MAP_READ_BIT : 0) |
+        ((accessBits & BufferAccess_Write) > 0 ? GL_MAP_WRITE_BIT : 0) |
+        ((accessBits & BufferAccess_Unsynchronized) > 0 ? GL_MAP_UNSYNCHRONIZED_BIT : 0) |
+        ((accessBits & BufferAccess_InvalidateRange) > 0 ? GL_MAP_INVALIDATE_RANGE_BIT : 0) |
+        ((accessBits & BufferAccess_InvalidateBuffer) > 0 ? GL_MAP_INVALIDATE_BUFFER_BIT : 0);
+
+    debug_assert(accessBitsGL > 0);
+    pMappedData = ::glMapBufferRange(bufferTargetGL, dataOffset, dataLength, accessBitsGL);
+
+#endif
+    glCheckError();
+    return pMappedData;
+}
+
 bool GpuBuffer::Unlock()
 {
-    if (!IsBufferInited())
+    if (!IsBufferInited() || IsPersistentMapped())
     {
         debug_assert(false);
         return false;
@@ -240,7 +314,7 @@ bool GpuBuffer::Unlock()
 
 void GpuBuffer::Invalidate()
 {
-    if (!IsBufferInited())
+    if (!IsBufferInited() || IsPersistentMapped())
     {
         debug_assert(false);
         return;
@@ -266,3 +340,8 @@ bool GpuBuffer::IsBufferInited() const
 {
     return mBufferCapacity > 0;
 }
+
+bool GpuBuffer::IsPersistentMapped() const
+{
+    return mPersistentData != nullptr;
+}
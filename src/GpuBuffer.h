@@ -12,6 +12,7 @@ public:
     eBufferUsage mUsageHint;
     unsigned int mBufferLength; // user requested length, bytes
     unsigned int mBufferCapacity; // actually allocated length, bytes
+    void* mPersistentData = nullptr; // mapped buffer content, exists only for persistent buffers
 
 public:
     // @param bufferContent: Content type stored in buffer, cannot be changed 
@@ -25,6 +26,12 @@ public:
     // @returns false if out of memory
     bool Setup(eBufferUsage bufferUsage, unsigned int bufferLength, const void* dataBuffer);
 
+    // Allocate immutable storage which stays mapped for writing during whole buffer lifetime, requires eGraphicsFeature_BufferStorage
+    // Client must to guarantee that written regions are doesn't used by the GPU
+    // @param bufferLength: Data length
+    // @returns false on fail
+    bool SetupPersistent(unsigned int bufferLength);
+
     // Upload source data to buffer replacing old content
     // @param dataOffset: Offset within buffer to write in bytes
     // @param dataLength: Size of data to write in bytes
@@ -40,6 +47,13 @@ public:
     // @return Pointer to buffer data or null on fail
     void* Lock(BufferAccessBits accessBits);
 
+    // Map part of hardware buffer content to process memory
+    // @param dataOffset: Offset within buffer in bytes
+    // @param dataLength: Size of mapped range in bytes
+    // @param accessBits: Desired data access policy
+    // @return Pointer to range data or null on fail
+    void* LockRange(unsigned int dataOffset, unsigned int dataLength, BufferAccessBits accessBits);
+
     template<typename TElement>
     inline TElement* LockData(BufferAccessBits accessBits)
     {
@@ -60,6 +74,9 @@ public:
     // Test whether buffer is created
     bool IsBufferInited() const;
 
+    // Test whether buffer has immutable persistently mapped storage
+    bool IsPersistentMapped() const;
+
 private:
     void SetUnbound();
 
@@ -2,6 +2,7 @@
 #include "GpuProgram.h"
 #include "GraphicsContext.h"
 #include "OpenGLDefs.h"
+#include "cvars.h"
 
 #ifdef __EMSCRIPTEN__
 static const char* gGLSL_version_string = 
@@ -83,6 +84,7 @@ public:
         {
             ::glUseProgram(mProgram->mResourceHandle);
             glCheckError();
+            ++mRenderContext.mCallsStats.mProgramBinds;
         }
     }
     ~ScopedProgramBinder()
@@ -91,6 +93,7 @@ public:
         {
             ::glUseProgram(mPreviousProgram ? mPreviousProgram->mResourceHandle : 0);
             glCheckError();
+            ++mRenderContext.mCallsStats.mProgramBinds;
         }
     }
 private:
@@ -101,6 +104,24 @@ private:
 
 //////////////////////////////////////////////////////////////////////////
 
+inline unsigned int GetUniformDataSize(int uniformType)
+{
+    const unsigned int UniformDataSizes[] = 
+    {
+        sizeof(float) * 1, // float1
+        sizeof(float) * 2, // float2
+        sizeof(float) * 3, // float3
+        sizeof(float) * 4, // float4
+        sizeof(int), // int1
+        sizeof(float) * 9, // matrix3
+        sizeof(float) * 16, // matrix4
+    };
+    debug_assert(uniformType >= 0 && uniformType < CountOf(UniformDataSizes));
+    return UniformDataSizes[uniformType];
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 GpuProgram::GpuProgram(GraphicsContext& graphicsContext)
     : mResourceHandle()
     , mInputLayout()
@@ -189,101 +210,142 @@ void GpuProgram::SetUniform(eRenderUniform constant, const glm::mat4& floatMatri
 
 void GpuProgram::SetCustomUniform(GpuVariableLocation constantLocation, float param0)
 {
-    debug_assert(constantLocation != GpuVariableNULL);
-    if (constantLocation != GpuVariableNULL)
-    {
-        ScopedProgramBinder scopedBind(mGraphicsContext, this);
-        ::glUniform1f(constantLocation, param0);
-        glCheckError();
-    }
+    const float values[] = { param0 };
+    SetUniformValue(constantLocation, eUniformType_Float1, values);
 }
 
 void GpuProgram::SetCustomUniform(GpuVariableLocation constantLocation, float param0, float param1)
 {
-    debug_assert(constantLocation != GpuVariableNULL);
-    if (constantLocation != GpuVariableNULL)
-    {
-        ScopedProgramBinder scopedBind(mGraphicsContext, this);
-        ::glUniform2f(constantLocation, param0, param1);
-        glCheckError();
-    }
+    const float values[] = { param0, param1 };
+    SetUniformValue(constantLocation, eUniformType_Float2, values);
 }
 
 void GpuProgram::SetCustomUniform(GpuVariableLocation constantLocation, float param0, float param1, float param2)
 {
-    debug_assert(constantLocation != GpuVariableNULL);
-    if (constantLocation != GpuVariableNULL)
-    {
-        ScopedProgramBinder scopedBind(mGraphicsContext, this);
-        ::glUniform3f(constantLocation, param0, param1, param2);
-        glCheckError();
-    }
+    const float values[] = { param0, param1, param2 };
+    SetUniformValue(constantLocation, eUniformType_Float3, values);
 }
 
 void GpuProgram::SetCustomUniform(GpuVariableLocation constantLocation, int param0)
 {
-    debug_assert(constantLocation != GpuVariableNULL);
-    if (constantLocation != GpuVariableNULL)
-    {
-        ScopedProgramBinder scopedBind(mGraphicsContext, this);
-        ::glUniform1i(constantLocation, param0);
-        glCheckError();
-    }
+    SetUniformValue(constantLocation, eUniformType_Int1, &param0);
 }
 
 void GpuProgram::SetCustomUniform(GpuVariableLocation constantLocation, const glm::vec2& floatVector2)
 {
-    debug_assert(constantLocation != GpuVariableNULL);
-    if (constantLocation != GpuVariableNULL)
-    {
-        ScopedProgramBinder scopedBind(mGraphicsContext, this);
-        ::glUniform2fv(constantLocation, 1, &floatVector2.x);
-        glCheckError();
-    }
+    SetUniformValue(constantLocation, eUniformType_Float2, &floatVector2.x);
 }
 
 void GpuProgram::SetCustomUniform(GpuVariableLocation constantLocation, const glm::vec3& floatVector3)
 {
-    debug_assert(constantLocation != GpuVariableNULL);
-    if (constantLocation != GpuVariableNULL)
-    {
-        ScopedProgramBinder scopedBind(mGraphicsContext, this);
-        ::glUniform3fv(constantLocation, 1, &floatVector3.x);
-        glCheckError();
-    }
+    SetUniformValue(constantLocation, eUniformType_Float3, &floatVector3.x);
 }
 
 void GpuProgram::SetCustomUniform(GpuVariableLocation constantLocation, const glm::vec4& floatVector4)
 {
-    debug_assert(constantLocation != GpuVariableNULL);
-    if (constantLocation != GpuVariableNULL)
-    {
-        ScopedProgramBinder scopedBind(mGraphicsContext, this);
-        ::glUniform4fv(constantLocation, 1, &floatVector4.x);
-        glCheckError();
-    }
+    SetUniformValue(constantLocation, eUniformType_Float4, &floatVector4.x);
 }
 
 void GpuProgram::SetCustomUniform(GpuVariableLocation constantLocation, const glm::mat3& floatMatrix3)
 {
-    debug_assert(constantLocation != GpuVariableNULL);
-    if (constantLocation != GpuVariableNULL)
-    {
-        ScopedProgramBinder scopedBind(mGraphicsContext, this);
-        ::glUniformMatrix3fv(constantLocation, 1, GL_FALSE, &floatMatrix3[0][0]);
-        glCheckError();
-    }
+    SetUniformValue(constantLocation, eUniformType_Matrix3, &floatMatrix3[0][0]);
 }
 
 void GpuProgram::SetCustomUniform(GpuVariableLocation constantLocation, const glm::mat4& floatMatrix4)
+{
+    SetUniformValue(constantLocation, eUniformType_Matrix4, &floatMatrix4[0][0]);
+}
+
+void GpuProgram::UploadDeferredUniforms()
+{
+    debug_assert(IsProgramBound());
+    if (mDeferredUniformsCount == 0)
+        return;
+
+    for (UniformValue& currValue: mUniformValues)
+    {
+        if (!currValue.mDeferred)
+            continue;
+
+        currValue.mDeferred = false;
+        UploadUniformValue(currValue);
+    }
+    mDeferredUniformsCount = 0;
+}
+
+void GpuProgram::SetUniformValue(GpuVariableLocation constantLocation, eUniformType uniformType, const void* sourceData)
 {
     debug_assert(constantLocation != GpuVariableNULL);
-    if (constantLocation != GpuVariableNULL)
+    if (constantLocation == GpuVariableNULL)
+        return;
+
+    const unsigned int dataSize = GetUniformDataSize(uniformType);
+
+    UniformValue* uniformValue = nullptr;
+    for (UniformValue& currValue: mUniformValues)
     {
-        ScopedProgramBinder scopedBind(mGraphicsContext, this);
-        ::glUniformMatrix4fv(constantLocation, 1, GL_FALSE, &floatMatrix4[0][0]);
-        glCheckError();
+        if (currValue.mLocation == constantLocation)
+        {
+            uniformValue = &currValue;
+            break;
+        }
+    }
+
+    const bool stateCacheEnabled = gCvarGraphicsStateCache.mValue;
+    if (uniformValue == nullptr)
+    {
+        mUniformValues.emplace_back();
+        uniformValue = &mUniformValues.back();
+        uniformValue->mLocation = constantLocation;
     }
+    else if (stateCacheEnabled && uniformValue->mType == uniformType && ::memcmp(uniformValue->mFloats, sourceData, dataSize) == 0)
+    {
+        ++mGraphicsContext.mCallsStats.mSkippedUniformUploads;
+        return;
+    }
+
+    uniformValue->mType = uniformType;
+    ::memcpy(uniformValue->mFloats, sourceData, dataSize);
+
+    if (stateCacheEnabled && !IsProgramBound())
+    {
+        // binding program just to set uniform costs two extra api calls
+        if (!uniformValue->mDeferred)
+        {
+            uniformValue->mDeferred = true;
+            ++mDeferredUniformsCount;
+        }
+        return;
+    }
+
+    if (uniformValue->mDeferred)
+    {
+        uniformValue->mDeferred = false;
+        --mDeferredUniformsCount;
+    }
+
+    ScopedProgramBinder scopedBind(mGraphicsContext, this);
+    UploadUniformValue(*uniformValue);
+}
+
+void GpuProgram::UploadUniformValue(const UniformValue& uniformValue)
+{
+    debug_assert(uniformValue.mLocation != GpuVariableNULL);
+    switch (uniformValue.mType)
+    {
+        case eUniformType_Float1: ::glUniform1fv(uniformValue.mLocation, 1, uniformValue.mFloats); break;
+        case eUniformType_Float2: ::glUniform2fv(uniformValue.mLocation, 1, uniformValue.mFloats); break;
+        case eUniformType_Float3: ::glUniform3fv(uniformValue.mLocation, 1, uniformValue.mFloats); break;
+        case eUniformType_Float4: ::glUniform4fv(uniformValue.mLocation, 1, uniformValue.mFloats); break;
+        case eUniformType_Int1: ::glUniform1i(uniformValue.mLocation, uniformValue.mInt); break;
+        case eUniformType_Matrix3: ::glUniformMatrix3fv(uniformValue.mLocation, 1, GL_FALSE, uniformValue.mFloats); break;
+        case eUniformType_Matrix4: ::glUniformMatrix4fv(uniformValue.mLocation, 1, GL_FALSE, uniformValue.mFloats); break;
+        default:
+            debug_assert(false);
+        break;
+    }
+    glCheckError();
+    ++mGraphicsContext.mCallsStats.mUniformUploads;
 }
 
 bool GpuProgram::CompileSourceCode(const char* shaderSource)
@@ -331,6 +393,10 @@ bool GpuProgram::CompileSourceCode(const char* shaderSource)
     for (GpuVariableLocation& location: mAttributes) { location = GpuVariableNULL; }
     for (GpuVariableLocation& location: mConstants) { location = GpuVariableNULL; }
     for (GpuVariableLocation& location: mSamplers) { location = GpuVariableNULL; }
+
+    // uniform locations of new program might differ
+    mUniformValues.clear();
+    mDeferredUniformsCount = 0;
 
     // query attributes
     for (int iattribute = 0; iattribute < eVertexAttribute_COUNT; ++iattribute)
@@ -60,11 +60,47 @@ public:
     // @param outLocation: Out location index
     bool QueryUniformLocation(const char* constantName, GpuVariableLocation& outLocation) const;
 
+    // Upload uniform values that were set while render program was not bound, called by graphics device on bind
+    void UploadDeferredUniforms();
+
 private:
+    enum eUniformType
+    {
+        eUniformType_Float1,
+        eUniformType_Float2,
+        eUniformType_Float3,
+        eUniformType_Float4,
+        eUniformType_Int1,
+        eUniformType_Matrix3,
+        eUniformType_Matrix4,
+    };
+
+    // last value that was set to uniform location
+    struct UniformValue
+    {
+        GpuVariableLocation mLocation = GpuVariableNULL;
+        eUniformType mType = eUniformType_Float1;
+        bool mDeferred = false; // value is not uploaded yet
+        union
+        {
+            float mFloats[16];
+            int mInt;
+        };
+    };
+
     // implementation details
     bool CompileSourceCode(GpuProgramHandle targetHandle, const char* programSrc);
     void SetUnbound();
 
+    // Skip value if it is already set, upload it immediately if program is bound or defer until bind
+    // @param constantLocation: Constant location
+    // @param uniformType: Value type
+    // @param sourceData: Value data, size is defined by type
+    void SetUniformValue(GpuVariableLocation constantLocation, eUniformType uniformType, const void* sourceData);
+    void UploadUniformValue(const UniformValue& uniformValue);
+
 private:
     GraphicsContext& mGraphicsContext;
+    std::vector<UniformValue> mUniformValues;
+    int mDeferredUniformsCount = 0;
 };
\ No newline at end of file
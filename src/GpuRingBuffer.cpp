@@ -0,0 +1,220 @@
+#include "stdafx.h"
+#include "GpuRingBuffer.h"
+#include "GpuBuffer.h"
+#include "OpenGLDefs.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+const unsigned int RangeAlignment = 16; // bytes
+
+inline unsigned int AlignRangeLength(unsigned int dataLength)
+{
+    return (dataLength + RangeAlignment - 1) & ~(RangeAlignment - 1);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+GpuRingBuffer::GpuRingBuffer(eBufferContent bufferContent)
+    : mContent(bufferContent)
+{
+}
+
+GpuRingBuffer::~GpuRingBuffer()
+{
+    debug_assert(mBuffer == nullptr);
+}
+
+bool GpuRingBuffer::Initialize(unsigned int regionLength)
+{
+    Deinit();
+
+    if (!CreateBuffer(regionLength))
+    {
+        Deinit();
+        return false;
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Streaming %s buffer: %d KB per frame, %s", cxx::enum_to_string(mContent),
+        mRegionLength / 1024, IsPersistentMapped() ? "persistent mapped" : "unsynchronized mapping");
+    return true;
+}
+
+void GpuRingBuffer::Deinit()
+{
+    for (int iregion = 0; iregion < RegionsCount; ++iregion)
+    {
+        WaitRegion(iregion);
+    }
+    for (GpuBuffer* currBuffer: mRetiredBuffers)
+    {
+        gGraphicsDevice.DestroyBuffer(currBuffer);
+    }
+    mRetiredBuffers.clear();
+
+    if (mBuffer)
+    {
+        gGraphicsDevice.DestroyBuffer(mBuffer);
+        mBuffer = nullptr;
+    }
+    mRegionLength = 0;
+    mRegionOffset = 0;
+    mRegionIndex = 0;
+    mUploadBytes = 0;
+}
+
+void GpuRingBuffer::FrameBegin()
+{
+    // buffers replaced during previous frame are not referenced anymore, driver will release them when gpu is done
+    for (GpuBuffer* currBuffer: mRetiredBuffers)
+    {
+        gGraphicsDevice.DestroyBuffer(currBuffer);
+    }
+    mRetiredBuffers.clear();
+
+    mRegionIndex = (mRegionIndex + 1) % RegionsCount;
+    mRegionOffset = 0;
+    mUploadBytes = 0;
+    ++mFramesCounter;
+
+    WaitRegion(mRegionIndex);
+}
+
+void GpuRingBuffer::FrameEnd()
+{
+#ifndef __EMSCRIPTEN__
+    debug_assert(mRegionFences[mRegionIndex] == nullptr);
+    if (mRegionOffset > 0)
+    {
+        mRegionFences[mRegionIndex] = ::glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glCheckError();
+    }
+#endif
+}
+
+void* GpuRingBuffer::Allocate(unsigned int dataLength, GpuBufferRange& outRange)
+{
+    outRange = GpuBufferRange();
+    if (mBuffer == nullptr || dataLength == 0)
+    {
+        debug_assert(false);
+        return nullptr;
+    }
+
+    const unsigned int alignedLength = AlignRangeLength(dataLength);
+    if ((mRegionOffset + alignedLength) > mRegionLength)
+    {
+        // ranges allocated earlier in this frame keep referencing old buffer
+        unsigned int newRegionLength = std::max(mRegionLength * 2, AlignRangeLength(mRegionOffset + alignedLength));
+        gConsole.LogMessage(eLogMessage_Info, "Streaming %s buffer grows to %d KB per frame", cxx::enum_to_string(mContent),
+            newRegionLength / 1024);
+
+        for (int iregion = 0; iregion < RegionsCount; ++iregion)
+        {
+            WaitRegion(iregion);
+        }
+        mRetiredBuffers.push_back(mBuffer);
+        mBuffer = nullptr;
+        if (!CreateBuffer(newRegionLength))
+        {
+            debug_assert(false);
+            return nullptr;
+        }
+        mRegionIndex = 0;
+        mRegionOffset = 0;
+    }
+
+    outRange.mBuffer = mBuffer;
+    outRange.mOffset = (mRegionIndex * mRegionLength) + mRegionOffset;
+    outRange.mLength = dataLength;
+
+    mRegionOffset += alignedLength;
+    mUploadBytes += dataLength;
+
+    if (mBuffer->IsPersistentMapped())
+    {
+        return static_cast<unsigned char*>(mBuffer->mPersistentData) + outRange.mOffset;
+    }
+    // region is not used by gpu, so there is no need to sync
+    void* mappedData = mBuffer->LockRange(outRange.mOffset, outRange.mLength, BufferAccess_UnsynchronizedWrite | BufferAccess_InvalidateRange);
+    debug_assert(mappedData);
+    return mappedData;
+}
+
+void GpuRingBuffer::Commit(const GpuBufferRange& bufferRange)
+{
+    debug_assert(bufferRange.mBuffer);
+    if (bufferRange.mBuffer == nullptr || bufferRange.mBuffer->IsPersistentMapped())
+        return; // coherent mapping, writes are visible to gpu
+
+    if (!bufferRange.mBuffer->Unlock())
+    {
+        debug_assert(false);
+    }
+}
+
+bool GpuRingBuffer::Upload(unsigned int dataLength, const void* dataSource, GpuBufferRange& outRange)
+{
+    debug_assert(dataSource);
+
+    void* mappedData = Allocate(dataLength, outRange);
+    if (mappedData == nullptr)
+        return false;
+
+    ::memcpy(mappedData, dataSource, dataLength);
+    Commit(outRange);
+    return true;
+}
+
+bool GpuRingBuffer::IsPersistentMapped() const
+{
+    return mBuffer && mBuffer->IsPersistentMapped();
+}
+
+bool GpuRingBuffer::CreateBuffer(unsigned int regionLength)
+{
+    debug_assert(mBuffer == nullptr);
+
+    mRegionLength = AlignRangeLength(regionLength);
+
+    mBuffer = gGraphicsDevice.CreateBuffer(mContent);
+    if (mBuffer == nullptr)
+        return false;
+
+    const unsigned int bufferLength = mRegionLength * RegionsCount;
+    if (gGraphicsDevice.mCaps.mFeatures[eGraphicsFeature_BufferStorage])
+    {
+        if (mBuffer->SetupPersistent(bufferLength))
+            return true;
+
+        // try ordinary storage
+        gGraphicsDevice.DestroyBuffer(mBuffer);
+        mBuffer = gGraphicsDevice.CreateBuffer(mContent);
+        if (mBuffer == nullptr)
+            return false;
+    }
+    return mBuffer->Setup(eBufferUsage_Stream, bufferLength, nullptr);
+}
+
+void GpuRingBuffer::WaitRegion(int regionIndex)
+{
+#ifndef __EMSCRIPTEN__
+    GLsync& regionFence = mRegionFences[regionIndex];
+    if (regionFence == nullptr)
+        return;
+
+    const GLuint64 WaitTimeoutNs = 1000000; // 1 ms
+    for (GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;; waitFlags = 0)
+    {
+        GLenum waitResult = ::glClientWaitSync(regionFence, waitFlags, WaitTimeoutNs);
+        glCheckError();
+        if (waitResult != GL_TIMEOUT_EXPIRED)
+        {
+            debug_assert(waitResult != GL_WAIT_FAILED);
+            break;
+        }
+    }
+    ::glDeleteSync(regionFence);
+    glCheckError();
+    regionFence = nullptr;
+#endif
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "GraphicsDefs.h"
+
+// sub-allocated range of streaming buffer, valid until end of current frame
+struct GpuBufferRange
+{
+public:
+    GpuBufferRange() = default;
+
+public:
+    GpuBuffer* mBuffer = nullptr;
+    unsigned int mOffset = 0; // offset within buffer, bytes
+    unsigned int mLength = 0; // bytes
+};
+
+// Streams dynamic geometry through single hardware buffer split into per-frame regions
+// Buffer is persistently mapped when buffer storage is supported, otherwise ranges are mapped unsynchronized,
+// in both cases region gets reused only when gpu is done with commands of the frame that was writing it
+class GpuRingBuffer final: public cxx::noncopyable
+{
+public:
+    // readonly
+    unsigned int mUploadBytes = 0; // current frame
+    unsigned int mFramesCounter = 0; // gets incremented on every frame, allocated ranges of previous frames are invalid
+    unsigned int mRegionLength = 0; // frame region size, bytes
+
+public:
+    // @param bufferContent: Content type stored in buffer
+    GpuRingBuffer(eBufferContent bufferContent);
+    ~GpuRingBuffer();
+
+    // Allocate hardware buffer
+    // @param regionLength: Initial size of data that can be allocated within single frame, grows on demand
+    bool Initialize(unsigned int regionLength);
+    void Deinit();
+
+    // Switch to next region, waits until gpu has done with it
+    void FrameBegin();
+    // Mark end of commands that are using current region
+    void FrameEnd();
+
+    // Allocate range within current region and map it for writing
+    // Commit must be called before range is used for drawing
+    // @param dataLength: Size of data in bytes
+    // @param outRange: Allocated range
+    // @returns Pointer to range data or null on fail
+    void* Allocate(unsigned int dataLength, GpuBufferRange& outRange);
+    void Commit(const GpuBufferRange& bufferRange);
+
+    // Copy source data to streaming buffer
+    // @param dataLength: Size of data in bytes
+    // @param dataSource: Source data
+    // @param outRange: Allocated range
+    bool Upload(unsigned int dataLength, const void* dataSource, GpuBufferRange& outRange);
+
+    // Whether hardware buffer stays mapped between frames
+    bool IsPersistentMapped() const;
+
+private:
+    bool CreateBuffer(unsigned int regionLength);
+    void WaitRegion(int regionIndex);
+
+private:
+    static const int RegionsCount = 3; // frames in flight
+
+    eBufferContent mContent;
+    GpuBuffer* mBuffer = nullptr;
+    std::vector<GpuBuffer*> mRetiredBuffers; // replaced by bigger buffer within current frame
+    GLsync mRegionFences[RegionsCount] {};
+    int mRegionIndex = 0;
+    unsigned int mRegionOffset = 0; // allocated bytes within current region
+};
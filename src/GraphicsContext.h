@@ -14,10 +14,23 @@ public:
         , mCurrentTextures()
         , mCurrentProgram()
         , mVaoHandle()
+        , mVertexAttributeDivisors()
+        , mVertexAttributes()
     {
     }
 public:
 
+    // vertex attribute pointer and enable state, used to skip redundant setup
+    struct VertexAttributeState
+    {
+        GpuBuffer* mSourceBuffer = nullptr;
+        eVertexAttributeFormat mFormat = eVertexAttributeFormat_Unknown;
+        unsigned int mDataStride = 0;
+        unsigned int mDataOffset = 0; // including base offset
+        bool mNormalized = false;
+        bool mEnabled = false;
+    };
+
     struct TextureUnitState
     {
         // note: mutual exclusion is used for different texture types
@@ -26,8 +39,11 @@ public:
     };
 
     GpuVertexArrayHandle mVaoHandle;
+    unsigned int mVertexAttributeDivisors[eVertexAttribute_MAX]; // per attribute location
+    VertexAttributeState mVertexAttributes[eVertexAttribute_MAX]; // per attribute location
     GpuBuffer* mCurrentBuffers[eBufferContent_COUNT];
     GpuProgram* mCurrentProgram;
     eTextureUnit mCurrentTextureUnit;
     TextureUnitState mCurrentTextures[eTextureUnit_COUNT];
+    GraphicsCallsStats mCallsStats; // current frame
 };
\ No newline at end of file
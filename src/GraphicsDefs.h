@@ -21,6 +21,21 @@ const GpuVariableLocation GpuVariableNULL = -1;
 using DrawIndex = unsigned int;
 const unsigned int Sizeof_DrawIndex = sizeof(DrawIndex);
 
+// indexed draw parameters stored in draw indirect buffer, layout is defined by opengl
+struct DrawIndexedIndirectCommand
+{
+public:
+    DrawIndexedIndirectCommand() = default;
+public:
+    unsigned int mIndicesCount = 0;
+    unsigned int mInstancesCount = 1;
+    unsigned int mFirstIndex = 0;
+    int mBaseVertex = 0;
+    unsigned int mBaseInstance = 0;
+};
+
+const unsigned int Sizeof_DrawIndexedIndirectCommand = sizeof(DrawIndexedIndirectCommand);
+
 // vertex 3d
 struct Vertex3D
 {
@@ -246,6 +261,7 @@ enum eTextureFormat
     eTextureFormat_RGBA8UI,
     eTextureFormat_R8UI,
     eTextureFormat_R16UI,
+    eTextureFormat_RGBA16UI,
     eTextureFormat_COUNT
 };
 
@@ -263,6 +279,7 @@ inline int NumBytesPerPixel(eTextureFormat format)
         case eTextureFormat_R8_G8 : return 2;
         case eTextureFormat_R8 : return 1;
         case eTextureFormat_R16UI: return 2;
+        case eTextureFormat_RGBA16UI: return 8;
         case eTextureFormat_R8UI: return 1;
         case eTextureFormat_RGBA8UI: return 4;
         default: break;
@@ -433,6 +450,7 @@ public:
     SingleAttribute mAttributes[eVertexAttribute_COUNT];
     unsigned int mDataStride = 0; // common to all attributes
     unsigned int mBaseOffset = 0; // additional offset in bytes within source vertex buffer, affects on all attribues
+    unsigned int mInstanceDivisor = 0; // attributes advance once per specified number of instances, zero for per vertex data
 };
 
 // standard engine vertex definition
@@ -518,6 +536,7 @@ enum eBufferContent
 {
     eBufferContent_Vertices,
     eBufferContent_Indices,
+    eBufferContent_DrawIndirect, // draw commands, requires eGraphicsFeature_MultiDrawIndirect
     eBufferContent_COUNT
 };
 
@@ -553,6 +572,8 @@ enum eRenderUniform
     eRenderUniform_NormalMatrix,         
     eRenderUniform_CameraPosition, // world space camera position
     eRenderUniform_EnableBiLinearFiltering,
+    eRenderUniform_ChunkOrigin, // world space origin of quantized mesh chunks grid
+    eRenderUniform_ChunkSize, // world space size of quantized mesh chunk
     eRenderUniform_COUNT
 };
 
@@ -711,6 +732,8 @@ enum eGraphicsFeature
 {
     eGraphicsFeature_NPOT_Textures,
     eGraphicsFeature_ABGR,
+    eGraphicsFeature_MultiDrawIndirect,
+    eGraphicsFeature_BufferStorage, // immutable persistently mapped buffers
     eGraphicsFeature_COUNT
 };
 
@@ -723,4 +746,39 @@ public:
     int mMaxArrayTextureLayers;
     int mMaxTextureBufferSize;
     bool mFeatures[eGraphicsFeature_COUNT];
+};
+
+// graphics api calls issued within single frame, redundant calls are filtered out by state tracking
+struct GraphicsCallsStats
+{
+public:
+    GraphicsCallsStats() = default;
+
+    // Number of api calls issued to driver
+    inline int GetIssuedCallsCount() const
+    {
+        return mDrawCalls + mProgramBinds + mTextureBinds + mBufferBinds + mAttributeCalls + mStateChanges + mUniformUploads;
+    }
+    // Number of redundant api calls that were skipped
+    inline int GetSkippedCallsCount() const
+    {
+        return mSkippedProgramBinds + mSkippedTextureBinds + mSkippedBufferBinds + mSkippedAttributeCalls + 
+            mSkippedStateChanges + mSkippedUniformUploads;
+    }
+
+public:
+    int mDrawCalls = 0;
+    int mProgramBinds = 0;
+    int mTextureBinds = 0; // including texture unit switches
+    int mBufferBinds = 0;
+    int mAttributeCalls = 0; // vertex attribute arrays enable, pointer and divisor setup
+    int mStateChanges = 0; // render states, viewport and scissor
+    int mUniformUploads = 0;
+    // redundant calls
+    int mSkippedProgramBinds = 0;
+    int mSkippedTextureBinds = 0;
+    int mSkippedBufferBinds = 0;
+    int mSkippedAttributeCalls = 0;
+    int mSkippedStateChanges = 0;
+    int mSkippedUniformUploads = 0;
 };
\ No newline at end of file
@@ -6,6 +6,8 @@
 #include "GpuTexture2D.h"
 #include "GpuTextureArray2D.h"
 #include "cvars.h"
+
+CvarBoolean gCvarGraphicsStateCache("r_stateCache", true, "Skip redundant vertex attributes setup and uniform uploads, uniforms of unbound programs are uploaded on bind", CvarFlags_None);
 
 GraphicsDevice gGraphicsDevice;
 
@@ -535,6 +537,11 @@ void GraphicsDevice::BindVertexBuffer(GpuBuffer* sourceBuffer, const VertexForma
         mGraphicsContext.mCurrentBuffers[eBufferContent_Vertices] = sourceBuffer;
         ::glBindBuffer(bufferTargetGL, sourceBuffer ? sourceBuffer->mResourceHandle : 0);
         glCheckError();
+        ++mGraphicsContext.mCallsStats.mBufferBinds;
+    }
+    else
+    {
+        ++mGraphicsContext.mCallsStats.mSkippedBufferBinds;
     }
 
     if (sourceBuffer)
@@ -557,12 +564,16 @@ void GraphicsDevice::BindIndexBuffer(GpuBuffer* sourceBuffer)
     }
     
     if (mGraphicsContext.mCurrentBuffers[eBufferContent_Indices] == sourceBuffer)
+    {
+        ++mGraphicsContext.mCallsStats.mSkippedBufferBinds;
         return;
+    }
 
     mGraphicsContext.mCurrentBuffers[eBufferContent_Indices] = sourceBuffer;
     GLenum bufferTargetGL = EnumToGL(eBufferContent_Indices);
     ::glBindBuffer(bufferTargetGL, sourceBuffer ? sourceBuffer->mResourceHandle : 0);
     glCheckError();
+    ++mGraphicsContext.mCallsStats.mBufferBinds;
 }
 
 void GraphicsDevice::BindTexture(eTextureUnit textureUnit, GpuTexture2D* texture)
@@ -575,13 +586,17 @@ void GraphicsDevice::BindTexture(eTextureUnit textureUnit, GpuTexture2D* texture
 
     debug_assert(textureUnit < eTextureUnit_COUNT);
     if (mGraphicsContext.mCurrentTextures[textureUnit].mTexture2D == texture)
+    {
+        ++mGraphicsContext.mCallsStats.mSkippedTextureBinds;
         return;
+    }
 
     ActivateTextureUnit(textureUnit);
 
     mGraphicsContext.mCurrentTextures[textureUnit].mTexture2D = texture;
     ::glBindTexture(GL_TEXTURE_2D, texture ? texture->mResourceHandle : 0);
     glCheckError();
+    ++mGraphicsContext.mCallsStats.mTextureBinds;
 }
 
 void GraphicsDevice::BindTexture(eTextureUnit textureUnit, GpuTextureArray2D* texture)
@@ -594,13 +609,17 @@ void GraphicsDevice::BindTexture(eTextureUnit textureUnit, GpuTextureArray2D* te
 
     debug_assert(textureUnit < eTextureUnit_COUNT);
     if (mGraphicsContext.mCurrentTextures[textureUnit].mTextureArray2D == texture)
+    {
+        ++mGraphicsContext.mCallsStats.mSkippedTextureBinds;
         return;
+    }
 
     ActivateTextureUnit(textureUnit);
 
     mGraphicsContext.mCurrentTextures[textureUnit].mTextureArray2D = texture;
     ::glBindTexture(GL_TEXTURE_2D_ARRAY, texture ? texture->mResourceHandle : 0);
     glCheckError();
+    ++mGraphicsContext.mCallsStats.mTextureBinds;
 }
 
 void GraphicsDevice::BindRenderProgram(GpuProgram* program)
@@ -612,10 +631,16 @@ void GraphicsDevice::BindRenderProgram(GpuProgram* program)
     }
 
     if (mGraphicsContext.mCurrentProgram == program)
+    {
+        ++mGraphicsContext.mCallsStats.mSkippedProgramBinds;
         return;
+    }
 
     ::glUseProgram(program ? program->mResourceHandle : 0);
     glCheckError();
+    ++mGraphicsContext.mCallsStats.mProgramBinds;
+
+    const bool stateCacheEnabled = gCvarGraphicsStateCache.mValue;
     if (program)
     {
         bool programAttributes[eVertexAttribute_MAX] = {};
@@ -627,10 +652,18 @@ void GraphicsDevice::BindRenderProgram(GpuProgram* program)
             programAttributes[program->mAttributes[streamIndex]] = true;
         }
 
-        // setup attribute streams
-        for (int ivattribute = 0; ivattribute < eVertexAttribute_COUNT; ++ivattribute)
+        // setup attribute streams, only locations that differ from previous program are touched
+        for (int ivattribute = 0; ivattribute < eVertexAttribute_MAX; ++ivattribute)
         {
-            if (programAttributes[ivattribute])
+            GraphicsContext::VertexAttributeState& attributeState = mGraphicsContext.mVertexAttributes[ivattribute];
+            if (stateCacheEnabled && (attributeState.mEnabled == programAttributes[ivattribute]))
+            {
+                ++mGraphicsContext.mCallsStats.mSkippedAttributeCalls;
+                continue;
+            }
+
+            attributeState.mEnabled = programAttributes[ivattribute];
+            if (attributeState.mEnabled)
             {
                 ::glEnableVertexAttribArray(ivattribute);
                 glCheckError();
@@ -640,17 +673,27 @@ void GraphicsDevice::BindRenderProgram(GpuProgram* program)
                 ::glDisableVertexAttribArray(ivattribute);
                 glCheckError();
             }
+            ++mGraphicsContext.mCallsStats.mAttributeCalls;
         }
     }
-    else
+    else if (!stateCacheEnabled)
     {
+        // with state cache attribute streams are kept enabled until next program gets bound
         for (int ivattribute = 0; ivattribute < eVertexAttribute_MAX; ++ivattribute)
         {
             ::glDisableVertexAttribArray(ivattribute);
             glCheckError();
+            ++mGraphicsContext.mCallsStats.mAttributeCalls;
+
+            mGraphicsContext.mVertexAttributes[ivattribute].mEnabled = false;
         }
     }
     mGraphicsContext.mCurrentProgram = program;
+
+    if (program)
+    {
+        program->UploadDeferredUniforms();
+    }
 }
 
 void GraphicsDevice::DestroyTexture(GpuTexture2D* textureResource)
@@ -694,6 +737,15 @@ void GraphicsDevice::DestroyBuffer(GpuBuffer* bufferResource)
         return;
     }
 
+    // deleted buffer gets detached from vertex array object
+    for (GraphicsContext::VertexAttributeState& attributeState: mGraphicsContext.mVertexAttributes)
+    {
+        if (attributeState.mSourceBuffer == bufferResource)
+        {
+            attributeState.mSourceBuffer = nullptr;
+            attributeState.mFormat = eVertexAttributeFormat_Unknown;
+        }
+    }
     SafeDelete(bufferResource);
 }
 
@@ -713,6 +765,7 @@ void GraphicsDevice::RenderIndexedPrimitives(ePrimitiveType primitive, eIndicesT
     GLenum indicesTypeGL = EnumToGL(indices);
     ::glDrawElements(primitives, numIndices, indicesTypeGL, BUFFER_OFFSET(offset));
     glCheckError();
+    ++mGraphicsContext.mCallsStats.mDrawCalls;
 }
 
 void GraphicsDevice::RenderIndexedPrimitives(ePrimitiveType primitive, eIndicesType indices, unsigned int offset, unsigned int numIndices, unsigned int baseVertex)
@@ -731,8 +784,40 @@ void GraphicsDevice::RenderIndexedPrimitives(ePrimitiveType primitive, eIndicesT
     GLenum indicesTypeGL = EnumToGL(indices);
     ::glDrawElementsBaseVertex(primitives, numIndices, indicesTypeGL, BUFFER_OFFSET(offset), baseVertex);
     glCheckError();
+    ++mGraphicsContext.mCallsStats.mDrawCalls;
 }
 
+void GraphicsDevice::RenderIndexedPrimitivesIndirect(ePrimitiveType primitive, eIndicesType indices, GpuBuffer* commandsBuffer, unsigned int offset, unsigned int numCommands)
+{
+    if (!IsDeviceInited() || !mCaps.mFeatures[eGraphicsFeature_MultiDrawIndirect])
+    {
+        debug_assert(false);
+        return;
+    }
+
+    GpuBuffer* indexBuffer = mGraphicsContext.mCurrentBuffers[eBufferContent_Indices];
+    GpuBuffer* vertexBuffer = mGraphicsContext.mCurrentBuffers[eBufferContent_Vertices];
+    debug_assert(indexBuffer && vertexBuffer && mGraphicsContext.mCurrentProgram);
+    debug_assert(commandsBuffer && commandsBuffer->mContent == eBufferContent_DrawIndirect);
+
+#ifndef __EMSCRIPTEN__
+    if (mGraphicsContext.mCurrentBuffers[eBufferContent_DrawIndirect] != commandsBuffer)
+    {
+        GLenum bufferTargetGL = EnumToGL(eBufferContent_DrawIndirect);
+        mGraphicsContext.mCurrentBuffers[eBufferContent_DrawIndirect] = commandsBuffer;
+        ::glBindBuffer(bufferTargetGL, commandsBuffer->mResourceHandle);
+        glCheckError();
+        ++mGraphicsContext.mCallsStats.mBufferBinds;
+    }
+
+    GLenum primitives = EnumToGL(primitive);
+    GLenum indicesTypeGL = EnumToGL(indices);
+    ::glMultiDrawElementsIndirect(primitives, indicesTypeGL, BUFFER_OFFSET(offset), numCommands, Sizeof_DrawIndexedIndirectCommand);
+    glCheckError();
+    ++mGraphicsContext.mCallsStats.mDrawCalls;
+#endif // __EMSCRIPTEN__
+}
+
 void GraphicsDevice::RenderPrimitives(ePrimitiveType primitiveType, unsigned int firstIndex, unsigned int numElements)
 {
     if (!IsDeviceInited())
@@ -747,8 +832,26 @@ void GraphicsDevice::RenderPrimitives(ePrimitiveType primitiveType, unsigned int
     GLenum primitives = EnumToGL(primitiveType);
     ::glDrawArrays(primitives, firstIndex, numElements);
     glCheckError();
+    ++mGraphicsContext.mCallsStats.mDrawCalls;
 }
 
+void GraphicsDevice::RenderPrimitivesInstanced(ePrimitiveType primitiveType, unsigned int firstIndex, unsigned int numElements, unsigned int numInstances)
+{
+    if (!IsDeviceInited())
+    {
+        debug_assert(false);
+        return;
+    }
+
+    GpuBuffer* vertexBuffer = mGraphicsContext.mCurrentBuffers[eBufferContent_Vertices];
+    debug_assert(vertexBuffer && mGraphicsContext.mCurrentProgram);
+
+    GLenum primitives = EnumToGL(primitiveType);
+    ::glDrawArraysInstanced(primitives, firstIndex, numElements, numInstances);
+    glCheckError();
+    ++mGraphicsContext.mCallsStats.mDrawCalls;
+}
+
 void GraphicsDevice::Present()
 {
     if (!IsDeviceInited())
@@ -766,6 +869,13 @@ void GraphicsDevice::Present()
         return;
     }
     ProcessGamepadsInputs();
+    ResetFrameStats();
+}
+
+void GraphicsDevice::ResetFrameStats()
+{
+    mLastFrameStats = mGraphicsContext.mCallsStats;
+    mGraphicsContext.mCallsStats = GraphicsCallsStats();
 }
 
 void GraphicsDevice::ProcessGamepadsInputs()
@@ -823,11 +933,15 @@ void GraphicsDevice::SetViewportRect(const Rect& sourceRectangle)
     }
 
     if (mViewportRect == sourceRectangle)
+    {
+        ++mGraphicsContext.mCallsStats.mSkippedStateChanges;
         return;
+    }
 
     mViewportRect = sourceRectangle;
     ::glViewport(mViewportRect.x, mScreenResolution.y - (mViewportRect.y + mViewportRect.h), mViewportRect.w, mViewportRect.h);
     glCheckError();
+    ++mGraphicsContext.mCallsStats.mStateChanges;
 }
 
 void GraphicsDevice::SetScissorRect(const Rect& sourceRectangle)
@@ -839,11 +953,15 @@ void GraphicsDevice::SetScissorRect(const Rect& sourceRectangle)
     }
 
     if (mScissorBox == sourceRectangle)
+    {
+        ++mGraphicsContext.mCallsStats.mSkippedStateChanges;
         return;
+    }
 
     mScissorBox = sourceRectangle;
     ::glScissor(mScissorBox.x, mScissorBox.y, mScissorBox.w, mScissorBox.h);
     glCheckError();
+    ++mGraphicsContext.mCallsStats.mStateChanges;
 }
 
 void GraphicsDevice::SetClearColor(Color32 clearColor)
@@ -921,6 +1039,8 @@ bool GraphicsDevice::InitializeOGLExtensions()
 void GraphicsDevice::SetupVertexAttributes(const VertexFormat& streamDefinition)
 {
     GpuProgram* currentProgram = mGraphicsContext.mCurrentProgram;
+    GpuBuffer* sourceBuffer = mGraphicsContext.mCurrentBuffers[eBufferContent_Vertices];
+    const bool stateCacheEnabled = gCvarGraphicsStateCache.mValue;
     for (int iattribute = 0; iattribute < eVertexAttribute_COUNT; ++iattribute)
     {
         if (currentProgram->mAttributes[iattribute] == GpuVariableNULL)
@@ -943,28 +1063,62 @@ void GraphicsDevice::SetupVertexAttributes(const VertexFormat& streamDefinition)
             continue;
         }
 
-        GLenum dataType = GetAttributeDataTypeGL(attribute.mFormat);
-
-        if (dataType == GL_FLOAT || attribute.mNormalized)
+        // attribute pointer is vertex array object state, skip setup if source data is the same
+        GraphicsContext::VertexAttributeState& attributeState = mGraphicsContext.mVertexAttributes[currentProgram->mAttributes[iattribute]];
+        const unsigned int dataOffset = attribute.mDataOffset + streamDefinition.mBaseOffset;
+        if (stateCacheEnabled && 
+            attributeState.mSourceBuffer == sourceBuffer && 
+            attributeState.mFormat == attribute.mFormat &&
+            attributeState.mNormalized == attribute.mNormalized &&
+            attributeState.mDataStride == streamDefinition.mDataStride &&
+            attributeState.mDataOffset == dataOffset)
         {
-            // set attribute location
-            ::glVertexAttribPointer(currentProgram->mAttributes[iattribute], numComponents, dataType, 
-                attribute.mNormalized ? GL_TRUE : GL_FALSE, 
-                streamDefinition.mDataStride, BUFFER_OFFSET(attribute.mDataOffset + streamDefinition.mBaseOffset));
+            ++mGraphicsContext.mCallsStats.mSkippedAttributeCalls;
         }
         else
         {
-            ::glVertexAttribIPointer(currentProgram->mAttributes[iattribute], numComponents, dataType, 
-                streamDefinition.mDataStride, BUFFER_OFFSET(attribute.mDataOffset + streamDefinition.mBaseOffset));
+            attributeState.mSourceBuffer = sourceBuffer;
+            attributeState.mFormat = attribute.mFormat;
+            attributeState.mNormalized = attribute.mNormalized;
+            attributeState.mDataStride = streamDefinition.mDataStride;
+            attributeState.mDataOffset = dataOffset;
+
+            GLenum dataType = GetAttributeDataTypeGL(attribute.mFormat);
+            if (dataType == GL_FLOAT || attribute.mNormalized)
+            {
+                // set attribute location
+                ::glVertexAttribPointer(currentProgram->mAttributes[iattribute], numComponents, dataType, 
+                    attribute.mNormalized ? GL_TRUE : GL_FALSE, 
+                    streamDefinition.mDataStride, BUFFER_OFFSET(dataOffset));
+            }
+            else
+            {
+                ::glVertexAttribIPointer(currentProgram->mAttributes[iattribute], numComponents, dataType, 
+                    streamDefinition.mDataStride, BUFFER_OFFSET(dataOffset));
+            }
+            glCheckError();
+            ++mGraphicsContext.mCallsStats.mAttributeCalls;
         }
-        glCheckError();
+
+        // divisor is attribute location state, change it only when needed
+        unsigned int& currentDivisor = mGraphicsContext.mVertexAttributeDivisors[currentProgram->mAttributes[iattribute]];
+        if (currentDivisor != streamDefinition.mInstanceDivisor)
+        {
+            currentDivisor = streamDefinition.mInstanceDivisor;
+            ::glVertexAttribDivisor(currentProgram->mAttributes[iattribute], currentDivisor);
+            glCheckError();
+            ++mGraphicsContext.mCallsStats.mAttributeCalls;
+        }
     }
 }
 
 void GraphicsDevice::InternalSetRenderStates(const RenderStates& renderStates, bool forceState)
 {
     if (mCurrentStates == renderStates && !forceState)
+    {
+        ++mGraphicsContext.mCallsStats.mSkippedStateChanges;
         return;
+    }
 
 #ifndef __EMSCRIPTEN__
     // polygon mode
@@ -981,6 +1135,7 @@ void GraphicsDevice::InternalSetRenderStates(const RenderStates& renderStates, b
         }
         ::glPolygonMode(GL_FRONT_AND_BACK, mode);
         glCheckError();
+        ++mGraphicsContext.mCallsStats.mStateChanges;
     }
 #endif // __EMSCRIPTEN__
 
@@ -996,6 +1151,7 @@ void GraphicsDevice::InternalSetRenderStates(const RenderStates& renderStates, b
             ::glDisable(GL_DEPTH_TEST);
         }
         glCheckError();
+        ++mGraphicsContext.mCallsStats.mStateChanges;
     }
 
     // depth function
@@ -1017,12 +1173,14 @@ void GraphicsDevice::InternalSetRenderStates(const RenderStates& renderStates, b
         }
         ::glDepthFunc(mode);
         glCheckError();
+        ++mGraphicsContext.mCallsStats.mStateChanges;
     }
 
     if (forceState || !mCurrentStates.MatchFlags(renderStates, RenderStateFlags_DepthWrite))
     {
         ::glDepthMask(renderStates.IsEnabled(RenderStateFlags_DepthWrite) ? GL_TRUE : GL_FALSE);
         glCheckError();
+        ++mGraphicsContext.mCallsStats.mStateChanges;
     }
 
     if (forceState || !mCurrentStates.MatchFlags(renderStates, RenderStateFlags_ColorWrite))
@@ -1030,6 +1188,7 @@ void GraphicsDevice::InternalSetRenderStates(const RenderStates& renderStates, b
         const GLboolean isEnabled = renderStates.IsEnabled(RenderStateFlags_ColorWrite) ? GL_TRUE : GL_FALSE;
         ::glColorMask(isEnabled, isEnabled, isEnabled, isEnabled);
         glCheckError();
+        ++mGraphicsContext.mCallsStats.mStateChanges;
     }
 
     // blending
@@ -1044,6 +1203,7 @@ void GraphicsDevice::InternalSetRenderStates(const RenderStates& renderStates, b
             ::glDisable(GL_BLEND);
         }
         glCheckError();
+        ++mGraphicsContext.mCallsStats.mStateChanges;
     }
 
     if (forceState || (mCurrentStates.mBlendMode != renderStates.mBlendMode))
@@ -1080,6 +1240,7 @@ void GraphicsDevice::InternalSetRenderStates(const RenderStates& renderStates, b
 
         ::glBlendFunc(srcFactor, dstFactor);
         glCheckError();
+        ++mGraphicsContext.mCallsStats.mStateChanges;
     }
 
     // culling
@@ -1094,6 +1255,7 @@ void GraphicsDevice::InternalSetRenderStates(const RenderStates& renderStates, b
             ::glDisable(GL_CULL_FACE);
         }
         glCheckError();
+        ++mGraphicsContext.mCallsStats.mStateChanges;
     }
 
     if (forceState || (mCurrentStates.mCullMode != renderStates.mCullMode))
@@ -1110,6 +1272,7 @@ void GraphicsDevice::InternalSetRenderStates(const RenderStates& renderStates, b
         }
         ::glCullFace(mode);
         glCheckError();
+        ++mGraphicsContext.mCallsStats.mStateChanges;
     }
 
     mCurrentStates = renderStates;
@@ -1119,6 +1282,13 @@ void GraphicsDevice::QueryGraphicsDeviceCaps()
 {
     mCaps.mFeatures[eGraphicsFeature_NPOT_Textures] = (GLEW_ARB_texture_non_power_of_two == GL_TRUE);
     mCaps.mFeatures[eGraphicsFeature_ABGR] = (GLEW_EXT_abgr == GL_TRUE);
+#ifdef __EMSCRIPTEN__
+    mCaps.mFeatures[eGraphicsFeature_MultiDrawIndirect] = false;
+    mCaps.mFeatures[eGraphicsFeature_BufferStorage] = false;
+#else
+    mCaps.mFeatures[eGraphicsFeature_MultiDrawIndirect] = (GLEW_VERSION_4_3 == GL_TRUE) || (GLEW_ARB_multi_draw_indirect == GL_TRUE);
+    mCaps.mFeatures[eGraphicsFeature_BufferStorage] = (GLEW_VERSION_4_4 == GL_TRUE) || (GLEW_ARB_buffer_storage == GL_TRUE);
+#endif
 
     ::glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &mCaps.mMaxTextureBufferSize);
     glCheckError();
@@ -1129,6 +1299,8 @@ void GraphicsDevice::QueryGraphicsDeviceCaps()
     gConsole.LogMessage(eLogMessage_Info, "Graphics Device caps:");
     gConsole.LogMessage(eLogMessage_Info, " - max array texture layers: %d", mCaps.mMaxArrayTextureLayers);
     gConsole.LogMessage(eLogMessage_Info, " - max texture buffer size: %d bytes", mCaps.mMaxTextureBufferSize);
+    gConsole.LogMessage(eLogMessage_Info, " - multi draw indirect: %s", mCaps.mFeatures[eGraphicsFeature_MultiDrawIndirect] ? "yes" : "no");
+    gConsole.LogMessage(eLogMessage_Info, " - buffer storage: %s", mCaps.mFeatures[eGraphicsFeature_BufferStorage] ? "yes" : "no");
 }
 
 void GraphicsDevice::ActivateTextureUnit(eTextureUnit textureUnit)
@@ -1140,4 +1312,5 @@ void GraphicsDevice::ActivateTextureUnit(eTextureUnit textureUnit)
 
     ::glActiveTexture(GL_TEXTURE0 + textureUnit);
     glCheckError();
+    ++mGraphicsContext.mCallsStats.mTextureBinds;
 }
@@ -13,6 +13,7 @@ public:
     Rect mViewportRect;
     Rect mScissorBox;
     GraphicsDeviceCaps mCaps;
+    GraphicsCallsStats mLastFrameStats; // api calls issued during last finished frame
 
     // these params will automatically set during texture creation
     eTextureFilterMode mDefaultTextureFilter = eTextureFilterMode_Nearest;
@@ -116,15 +117,33 @@ public:
     void RenderIndexedPrimitives(ePrimitiveType primitive, eIndicesType indicesType, unsigned int offset, unsigned int numIndices);
     void RenderIndexedPrimitives(ePrimitiveType primitive, eIndicesType indicesType, unsigned int offset, unsigned int numIndices, unsigned int baseVertex);
 
+    // Render multiple indexed geometries with single call, requires eGraphicsFeature_MultiDrawIndirect
+    // @param primitive: Type of primitives to render
+    // @param indicesType: Type of indices data
+    // @param commandsBuffer: Buffer with DrawIndexedIndirectCommand records
+    // @param offset: Offset within commands buffer in bytes
+    // @param numCommands: Number of draw commands
+    void RenderIndexedPrimitivesIndirect(ePrimitiveType primitive, eIndicesType indicesType, GpuBuffer* commandsBuffer, unsigned int offset, unsigned int numCommands);
+
     // Render geometry
     // @param primitiveType: Type of primitives to render
     // @param firstIndex: Start position in attribute buffers, index
     // @param numElements: Number of elements to render
     void RenderPrimitives(ePrimitiveType primitiveType, unsigned int firstIndex, unsigned int numElements);
 
+    // Render multiple instances of non indexed geometry, per instance attributes are specified by vertex format divisor
+    // @param primitiveType: Primitive type
+    // @param firstIndex: Start position in attribute buffers, index
+    // @param numElements: Number of elements to render
+    // @param numInstances: Number of instances to render
+    void RenderPrimitivesInstanced(ePrimitiveType primitiveType, unsigned int firstIndex, unsigned int numElements, unsigned int numInstances);
+
     // Finish render frame, prenent on screen
     void Present();
 
+    // Store api calls statistics of current frame to last frame stats and start counting from zero, called on present
+    void ResetFrameStats();
+
     // Setup dimensions of graphic device viewport
     // @param sourceRectangle: Viewport rectangle
     void SetViewportRect(const Rect& sourceRectangle);
@@ -14,6 +14,7 @@
 //////////////////////////////////////////////////////////////////////////
 
 CvarFloat gCvarUiScale("g_uiScale", 1.0f, "Ui elements scale factor", CvarFlags_Archive);
+CvarBoolean gCvarUiCache("g_uiCache", true, "Recompute hud layout only when it changes and reuse prebuilt text glyphs", CvarFlags_Archive);
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -45,15 +46,45 @@ void GuiManager::Deinit()
 
 void GuiManager::RenderFrame()
 {
-    mSpriteBatch.BeginBatch(SpriteBatch::DepthAxis_Z, eSpritesSortMode_None);
-
     Rect prevScreenRect = gGraphicsDevice.mViewportRect;
     Rect prevScissorsBox = gGraphicsDevice.mScissorBox;
 
     // draw renderviews
+    RenderScreens(nullptr);
+
+    { // draw imgui
+
+        mCamera2D.SetIdentity();
+        mCamera2D.mViewportRect = prevScreenRect;
+        mCamera2D.SetProjection(0.0f, mCamera2D.mViewportRect.w * 1.0f, mCamera2D.mViewportRect.h * 1.0f, 0.0f);
+
+        gRenderManager.mGuiTexColorProgram.Activate();
+        gRenderManager.mGuiTexColorProgram.UploadCameraTransformMatrices(mCamera2D);
+    
+        RenderStates guiRenderStates = RenderStates()
+            .Disable(RenderStateFlags_FaceCulling)
+            .Disable(RenderStateFlags_DepthTest)
+            .SetAlphaBlend(eBlendMode_Alpha);
+        gGraphicsDevice.SetRenderStates(guiRenderStates);
+
+        gGraphicsDevice.SetScissorRect(prevScissorsBox);
+        gGraphicsDevice.SetViewportRect(prevScreenRect);
+
+        gImGuiManager.RenderFrame();
+
+        gRenderManager.mGuiTexColorProgram.Deactivate();
+    }
+}
+
+void GuiManager::RenderScreens(double* drawSeconds)
+{
+    mSpriteBatch.BeginBatch(SpriteBatch::DepthAxis_Z, eSpritesSortMode_None);
+
     {
         gGraphicsDevice.BindTexture(eTextureUnit_3, gSpriteManager.mPalettesTable);
         gGraphicsDevice.BindTexture(eTextureUnit_2, gSpriteManager.mPaletteIndicesTable);
+        gGraphicsDevice.BindTexture(eTextureUnit_4, gSpriteManager.mSpriteDeltasTable);
+        gGraphicsDevice.BindTexture(eTextureUnit_5, gSpriteManager.mSpriteDeltasTextureArray);
 
         gRenderManager.mSpritesProgram.Activate();
 
@@ -75,7 +106,12 @@ void GuiManager::RenderFrame()
             Rect clipRect { 0, 0, mCamera2D.mViewportRect.w, mCamera2D.mViewportRect.h };
             if (uiContext.EnterChildClipArea(clipRect))
             {
+                double startTime = drawSeconds ? gSystem.GetSystemSeconds() : 0.0;
                 currScreen->DrawScreen(uiContext);
+                if (drawSeconds)
+                {
+                    *drawSeconds += gSystem.GetSystemSeconds() - startTime;
+                }
                 uiContext.LeaveChildClipArea();
             }
             mSpriteBatch.Flush();   
@@ -83,29 +119,6 @@ void GuiManager::RenderFrame()
 
         gRenderManager.mSpritesProgram.Deactivate();
     }
-
-    { // draw imgui
-
-        mCamera2D.SetIdentity();
-        mCamera2D.mViewportRect = prevScreenRect;
-        mCamera2D.SetProjection(0.0f, mCamera2D.mViewportRect.w * 1.0f, mCamera2D.mViewportRect.h * 1.0f, 0.0f);
-
-        gRenderManager.mGuiTexColorProgram.Activate();
-        gRenderManager.mGuiTexColorProgram.UploadCameraTransformMatrices(mCamera2D);
-    
-        RenderStates guiRenderStates = RenderStates()
-            .Disable(RenderStateFlags_FaceCulling)
-            .Disable(RenderStateFlags_DepthTest)
-            .SetAlphaBlend(eBlendMode_Alpha);
-        gGraphicsDevice.SetRenderStates(guiRenderStates);
-
-        gGraphicsDevice.SetScissorRect(prevScissorsBox);
-        gGraphicsDevice.SetViewportRect(prevScreenRect);
-
-        gImGuiManager.RenderFrame();
-
-        gRenderManager.mGuiTexColorProgram.Deactivate();
-    }
 }
 
 void GuiManager::UpdateFrame()
@@ -114,6 +127,64 @@ void GuiManager::UpdateFrame()
     {
         currScreen->UpdateScreen();
     }
+}
+
+void GuiManager::RunScreensBenchmark(int framesCount)
+{
+    if (mScreensList.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Gui screens benchmark: no active screens");
+        return;
+    }
+
+    framesCount = std::max(framesCount, 1);
+    gConsole.LogMessage(eLogMessage_Info, "Gui screens benchmark: %d screens, %d frames",
+        static_cast<int>(mScreensList.size()), framesCount);
+
+    Rect prevScreenRect = gGraphicsDevice.mViewportRect;
+    Rect prevScissorsBox = gGraphicsDevice.mScissorBox;
+
+    const bool uiCacheEnabled = gCvarUiCache.mValue;
+    for (bool currUiCache: {false, true})
+    {
+        gCvarUiCache.mValue = currUiCache;
+
+        // warm up, first frame rebuilds layout and text glyphs
+        const int WarmupFrames = 1;
+
+        double updateTime = 0.0;
+        double drawTime = 0.0;
+        for (int iframe = 0; iframe < (framesCount + WarmupFrames); ++iframe)
+        {
+            double startTime = gSystem.GetSystemSeconds();
+            UpdateFrame();
+            double frameUpdateTime = gSystem.GetSystemSeconds() - startTime;
+
+            double frameDrawTime = 0.0;
+            gRenderManager.mStreamingVertices.FrameBegin();
+            gRenderManager.mStreamingIndices.FrameBegin();
+            RenderScreens(&frameDrawTime);
+            gRenderManager.mStreamingVertices.FrameEnd();
+            gRenderManager.mStreamingIndices.FrameEnd();
+
+            if (iframe < WarmupFrames)
+                continue;
+
+            updateTime += frameUpdateTime;
+            drawTime += frameDrawTime;
+        }
+
+        const double framesInv = 1.0 / framesCount;
+        gConsole.LogMessage(eLogMessage_Info, " - hud cache %s: update avg %.3f ms, draw avg %.3f ms, total avg %.3f ms",
+            currUiCache ? "on" : "off",
+            updateTime * framesInv * 1000.0,
+            drawTime * framesInv * 1000.0,
+            (updateTime + drawTime) * framesInv * 1000.0);
+    }
+    gCvarUiCache.mValue = uiCacheEnabled;
+
+    gGraphicsDevice.SetScissorRect(prevScissorsBox);
+    gGraphicsDevice.SetViewportRect(prevScreenRect);
 }
 
 void GuiManager::InputEvent(MouseMovedInputEvent& inputEvent)
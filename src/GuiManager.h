@@ -19,6 +19,9 @@ public:
     void AttachScreen(GuiScreen* screen);
     void DetachScreen(GuiScreen* screen);
 
+    // Update and draw gui screens with hud cache disabled and enabled and measure cpu time, results are printed to log
+    void RunScreensBenchmark(int framesCount);
+
     // override InputEventsHandler
     void InputEvent(MouseMovedInputEvent& inputEvent) override;
     void InputEvent(MouseScrollInputEvent& inputEvent) override;
@@ -27,6 +30,10 @@ public:
     void InputEvent(KeyCharEvent& inputEvent) override;
     void InputEvent(GamepadInputEvent& inputEvent) override;
 
+private:
+    // @param drawSeconds: Optional, accumulates time spent in screens drawing
+    void RenderScreens(double* drawSeconds);
+
 private:
     SpriteBatch mSpriteBatch;
     GameCamera2D mCamera2D;
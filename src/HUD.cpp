@@ -10,12 +10,15 @@
 #include "GameTextsManager.h"
 #include "TimeManager.h"
 #include "HumanPlayer.h"
+#include "cvars.h"
 
 //////////////////////////////////////////////////////////////////////////
 
 HUDPanel::HUDPanel()
     : mLocalPosition()
     , mSize()
+    , mMinSize()
+    , mMaxSize()
 {
 }
 
@@ -25,11 +28,20 @@ HUDPanel::~HUDPanel()
 
 void HUDPanel::SetPosition(const Point& localPosition)
 {
+    if (mLocalPosition == localPosition)
+        return;
+
     mLocalPosition = localPosition;
+    InvalidateLayout();
 }
 
 void HUDPanel::SetSizeLimits(const Point& minSize, const Point& maxSize)
 {
+    if ((mMinSize == minSize) && (mMaxSize == maxSize))
+        return;
+
+    InvalidateLayout();
+
     mMaxSize = maxSize;
     debug_assert(mMaxSize.x >= 0);
     debug_assert(mMaxSize.y >= 0);
@@ -47,6 +59,11 @@ void HUDPanel::Self_ComputeSize(Point& outputSize) const
     // do nothing
 }
 
+bool HUDPanel::Self_CheckSizeChanged()
+{
+    return false;
+}
+
 void HUDPanel::Self_DrawFrame(GuiContext& guiContext)
 {
     // do nothing
@@ -69,6 +86,11 @@ void HUDPanel::SetParentContainer(HUDPanel* parentContainer)
 
 void HUDPanel::ComputeSize()
 {
+    if (gCvarUiCache.mValue && !mLayoutDirty)
+        return;
+
+    mLayoutDirty = false;
+
     Point childSize_max {0, 0};
     Point childSize_acc {0, 0};
 
@@ -214,10 +236,54 @@ void HUDPanel::ComputeOwnScreenPosition()
     }
 }
 
+void HUDPanel::CheckSizeChanged()
+{
+    for (HUDPanel* currChild: mChildPanels)
+    {
+        if (currChild->IsVisible())
+        {
+            currChild->CheckSizeChanged();
+        }
+    }
+
+    if (Self_CheckSizeChanged())
+    {
+        InvalidateLayout();
+    }
+}
+
+void HUDPanel::UpdateLayout()
+{
+    if (gCvarUiCache.mValue)
+    {
+        CheckSizeChanged();
+        if (!mLayoutDirty)
+            return;
+    }
+
+    ComputeSize();
+    ComputePosition();
+}
+
+void HUDPanel::InvalidateLayout()
+{
+    // hidden panels keep dirty flag while their containers are recomputed, so walk whole chain
+    for (HUDPanel* currPanel = this; currPanel; currPanel = currPanel->mParentContainer)
+    {
+        currPanel->mLayoutDirty = true;
+    }
+}
+
+bool HUDPanel::IsLayoutDirty() const
+{
+    return mLayoutDirty;
+}
+
 void HUDPanel::SetAlignMode(eHorzAlignMode horzAlignMode, eVertAlignMode vertAlignMode)
 {
     mHorzAlignMode = horzAlignMode;
     mVertAlignMode = vertAlignMode;
+    InvalidateLayout();
 }
 
 void HUDPanel::SetBorders(int borderL, int borderR, int borderT, int borderB)
@@ -226,11 +292,16 @@ void HUDPanel::SetBorders(int borderL, int borderR, int borderT, int borderB)
     mBorderR = borderR;
     mBorderT = borderT;
     mBorderB = borderB;
+    InvalidateLayout();
 }
 
 void HUDPanel::SetVisible(bool isVisible)
 {
+    if (mIsVisible == isVisible)
+        return;
+
     mIsVisible = isVisible;
+    InvalidateLayout();
 }
 
 bool HUDPanel::IsVisible() const
@@ -251,11 +322,13 @@ bool HUDPanel::IsClippingChildren() const
 void HUDPanel::SetLayoutMode(eLayoutMode layoutMode)
 {
     mLayoutMode = layoutMode;
+    InvalidateLayout();
 }
 
 void HUDPanel::SetInnerSpacing(int panelsSpacing)
 {
     mInnerSpacing = panelsSpacing;
+    InvalidateLayout();
 }
 
 void HUDPanel::AttachPanel(HUDPanel* panel)
@@ -273,6 +346,7 @@ void HUDPanel::AttachPanel(HUDPanel* panel)
     }
     panel->mParentContainer = this;
     mChildPanels.push_back(panel);
+    panel->InvalidateLayout();
 }
 
 void HUDPanel::DetachPanel(HUDPanel* panel)
@@ -283,6 +357,7 @@ void HUDPanel::DetachPanel(HUDPanel* panel)
     {
         panel->mParentContainer = nullptr;
         cxx::erase_elements(mChildPanels, panel);
+        InvalidateLayout();
     }
 }
 
@@ -294,6 +369,7 @@ void HUDPanel::DetachPanels()
         currPanel->mParentContainer = nullptr;
     }
     mChildPanels.clear();
+    InvalidateLayout();
 }
 
 void HUDPanel::SetupHUD()
@@ -349,11 +425,16 @@ void HUDText::SetTextFont(Font* textFont, int fontRemap)
 {
     mTextFont = textFont;
     mTextPaletteIndex = gGameMap.mStyleData.GetFontPaletteIndex(fontRemap);
+    InvalidateLayout();
 }
 
 void HUDText::SetText(const std::string& textString)
 {
+    if (mText == textString)
+        return;
+
     mText = textString;
+    InvalidateLayout();
 }
 
 void HUDText::SetTextRemap(int fontRemap)
@@ -392,12 +473,23 @@ void HUDSprite::Self_DrawFrame(GuiContext& guiContext)
     guiContext.mSpriteBatch.DrawSprite(mSprite);
 }
 
+bool HUDSprite::Self_CheckSizeChanged()
+{
+    // sprite is modified directly, so compare with size of last check
+    Point spriteSize {mSprite.mTextureRegion.mRectangle.w, mSprite.mTextureRegion.mRectangle.h};
+    if (mSpriteSize == spriteSize)
+        return false;
+
+    mSpriteSize = spriteSize;
+    return true;
+}
+
 void HUDSprite::Self_UpdateFrame()
 {
     if (mAnimationState.UpdateFrame(gTimeManager.mUiFrameDelta))
     {
         int spriteIndex = gGameMap.mStyleData.GetSpriteIndex(eSpriteType_Arrow, mAnimationState.GetSpriteIndex());
-        gSpriteManager.GetSpriteTexture(GAMEOBJECT_ID_NULL, spriteIndex, 0, mSprite);
+        gSpriteManager.GetSpriteTexture(spriteIndex, 0, mSprite);
     }
 }
 
@@ -414,7 +506,7 @@ void HUDWeaponPanel::SetWeapon(Weapon& weaponState)
     WeaponInfo* weaponInfo = weaponState.GetWeaponInfo();
     int spriteIndex = gGameMap.mStyleData.GetSpriteIndex(eSpriteType_Arrow, weaponInfo->mSpriteIndex);
 
-    gSpriteManager.GetSpriteTexture(GAMEOBJECT_ID_NULL, spriteIndex, 0, mIcon.mSprite);
+    gSpriteManager.GetSpriteTexture(spriteIndex, 0, mIcon.mSprite);
 }
 
 void HUDWeaponPanel::Self_SetupHUD()
@@ -460,7 +552,7 @@ void HUDCarNamePanel::Self_SetupHUD()
     mMessageText.SetTextFont(messageFont, FontRemap_Default);
 
     int spriteIndex = gGameMap.mStyleData.GetSpriteIndex(eSpriteType_Arrow, eSpriteID_Arrow_VehicleDisplay);
-    gSpriteManager.GetSpriteTexture(GAMEOBJECT_ID_NULL, spriteIndex, 0, mSprite);
+    gSpriteManager.GetSpriteTexture(spriteIndex, 0, mSprite);
 
     mSprite.mHeight = 0.0f;
     mSprite.mScale = HUD_SPRITE_SCALE;
@@ -494,13 +586,13 @@ void HUDDistrictNamePanel::Self_SetupHUD()
 
     // setup left part sprite
     int spriteIndex = gGameMap.mStyleData.GetSpriteIndex(eSpriteType_Arrow, eSpriteID_Arrow_AreaDisplayLeft);
-    gSpriteManager.GetSpriteTexture(GAMEOBJECT_ID_NULL, spriteIndex, 0, mBgLeftPart.mSprite);
+    gSpriteManager.GetSpriteTexture(spriteIndex, 0, mBgLeftPart.mSprite);
     mBgLeftPart.mSprite.mHeight = 0.0f;
     mBgLeftPart.mSprite.mScale = HUD_SPRITE_SCALE;
     mBgLeftPart.mSprite.mOriginMode = eSpriteOrigin_TopLeft;
     // setup right part sprite
     spriteIndex = gGameMap.mStyleData.GetSpriteIndex(eSpriteType_Arrow, eSpriteID_Arrow_AreaDisplayRight);
-    gSpriteManager.GetSpriteTexture(GAMEOBJECT_ID_NULL, spriteIndex, 0, mBgRightPart.mSprite);
+    gSpriteManager.GetSpriteTexture(spriteIndex, 0, mBgRightPart.mSprite);
     mBgRightPart.mSprite.mHeight = 0.0f;
     mBgRightPart.mSprite.mScale = HUD_SPRITE_SCALE;
     mBgRightPart.mSprite.mOriginMode = eSpriteOrigin_TopLeft;
@@ -541,7 +633,7 @@ void HUDWantedLevelPanel::Self_SetupHUD()
         currLevel.mAnimationState.PlayAnimation(eSpriteAnimLoop_FromStart);
         currLevel.SetVisible(false);
         // initial sprite
-        gSpriteManager.GetSpriteTexture(GAMEOBJECT_ID_NULL, eSpriteID_Arrow_WantedFrame1, 0, currLevel.mSprite);
+        gSpriteManager.GetSpriteTexture(eSpriteID_Arrow_WantedFrame1, 0, currLevel.mSprite);
         AttachPanel(&currLevel);
     }
 }
@@ -642,7 +734,7 @@ void HUDBonusPanel::Self_SetupHUD()
 
     // setup sprite
     int keySpriteIndex = gGameMap.mStyleData.GetSpriteIndex(eSpriteType_Arrow, mKeyIcon.mAnimationState.GetSpriteIndex());
-    gSpriteManager.GetSpriteTexture(GAMEOBJECT_ID_NULL, keySpriteIndex, 0, mKeyIcon.mSprite);
+    gSpriteManager.GetSpriteTexture(keySpriteIndex, 0, mKeyIcon.mSprite);
 
     mArmorIcon.mSprite.mHeight = 0.0f;
     mArmorIcon.mSprite.mScale = HUD_SPRITE_SCALE;
@@ -659,7 +751,7 @@ void HUDBonusPanel::Self_SetupHUD()
 
     // setup sprite
     int armorSpriteIndex = gGameMap.mStyleData.GetSpriteIndex(eSpriteType_Arrow, mArmorIcon.mAnimationState.GetSpriteIndex());
-    gSpriteManager.GetSpriteTexture(GAMEOBJECT_ID_NULL, armorSpriteIndex, 0, mArmorIcon.mSprite);
+    gSpriteManager.GetSpriteTexture(armorSpriteIndex, 0, mArmorIcon.mSprite);
 
     Font* font = gFontManager.GetFont("SUB1.FON");
     debug_assert(font);
@@ -688,7 +780,7 @@ bool HUDPagerMessage::IsTextScrolling() const
 void HUDPagerMessage::Self_SetupHUD()
 {
     int spriteIndex = gGameMap.mStyleData.GetSpriteIndex(eSpriteType_Arrow, eSpriteID_Arrow_Pager);
-    gSpriteManager.GetSpriteTexture(GAMEOBJECT_ID_NULL, spriteIndex, 0, mBackground.mSprite);
+    gSpriteManager.GetSpriteTexture(spriteIndex, 0, mBackground.mSprite);
 
     mBackground.mSprite.mHeight = 0.0f;
     mBackground.mSprite.mScale = HUD_SPRITE_SCALE;
@@ -697,7 +789,7 @@ void HUDPagerMessage::Self_SetupHUD()
     AttachPanel(&mBackground);
 
     spriteIndex = gGameMap.mStyleData.GetSpriteIndex(eSpriteType_Arrow, eSpriteID_Arrow_PagerFlash);
-    gSpriteManager.GetSpriteTexture(GAMEOBJECT_ID_NULL, spriteIndex, 0, mFlash.mSprite);
+    gSpriteManager.GetSpriteTexture(spriteIndex, 0, mFlash.mSprite);
 
     mFlash.mSprite.mHeight = 0.0f;
     mFlash.mSprite.mScale = HUD_SPRITE_SCALE;
@@ -933,8 +1025,7 @@ void HUD::DrawScreen(GuiContext& context)
     mPanelsContainer.SetSizeLimits(
         Point(viewportRect.w, viewportRect.h), 
         Point(viewportRect.w, viewportRect.h));
-    mPanelsContainer.ComputeSize();
-    mPanelsContainer.ComputePosition();
+    mPanelsContainer.UpdateLayout();
     mPanelsContainer.DrawFrame(context);
 
     if (CheckCharacterObscure())
@@ -1028,7 +1119,7 @@ void HUD::DrawArrowAboveCharacter(GuiContext& guiContext)
 
     // setup arrow sprite
     Sprite2D arrowSprite;
-    gSpriteManager.GetSpriteTexture(GAMEOBJECT_ID_NULL, eSpriteID_Arrow_Pointer, 0, arrowSprite);
+    gSpriteManager.GetSpriteTexture(eSpriteID_Arrow_Pointer, 0, arrowSprite);
 
     arrowSprite.mScale = HUD_SPRITE_SCALE;
     arrowSprite.mDrawOrder = eSpriteDrawOrder_HUD_Arrow;
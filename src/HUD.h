@@ -64,9 +64,18 @@ public:
     void SetClipChildren(bool isClipChildren);
     bool IsClippingChildren() const;
 
+    // Recompute size and position of panel and its attached panels if something was changed since last time
+    void UpdateLayout();
+
+    // Force layout recompute of panel and all its parent containers
+    void InvalidateLayout();
+    bool IsLayoutDirty() const;
+
 protected:
     // overridable methods
     virtual void Self_ComputeSize(Point& outputSize) const;
+    // @returns true if panel size was changed outside of setters
+    virtual bool Self_CheckSizeChanged();
     virtual void Self_DrawFrame(GuiContext& guiContext);
     virtual void Self_UpdateFrame();
     virtual void Self_SetupHUD();
@@ -76,9 +85,11 @@ protected:
     void ComputeSize();
     void ComputePosition();
     void ComputeOwnScreenPosition();
+    void CheckSizeChanged();
 
 protected:
     bool mIsVisible = true; // whether the panel should draw and update
+    bool mLayoutDirty = true; // whether size of panel should be recomputed
     bool mClipChildren = false;
 
     std::vector<HUDPanel*> mChildPanels; // all attached panels
@@ -119,6 +130,9 @@ protected:
     void Self_ComputeSize(Point& outputSize) const override;
     void Self_DrawFrame(GuiContext& guiContext) override;
     void Self_UpdateFrame() override;
+    bool Self_CheckSizeChanged() override;
+private:
+    Point mSpriteSize {0, 0}; // sprite size at last layout check
 };
 
 //////////////////////////////////////////////////////////////////////////
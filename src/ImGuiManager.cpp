@@ -138,7 +138,7 @@ void ImGuiManager::RenderFrame()
             gGraphicsDevice.BindTexture(eTextureUnit_0, bindTexture);
 
             gGraphicsDevice.SetScissorRect(rcClip);
-            unsigned int idxBufferOffset = Sizeof_ImGuiIndex * pcmd->IdxOffset;
+            unsigned int idxBufferOffset = mTrimeshBuffer.GetIndicesOffset() + Sizeof_ImGuiIndex * pcmd->IdxOffset;
 
             eIndicesType indicesType = Sizeof_ImGuiIndex == 2 ? eIndicesType_i16 : eIndicesType_i32;
             gGraphicsDevice.RenderIndexedPrimitives(ePrimitiveType_Triangles, indicesType, idxBufferOffset, pcmd->ElemCount);
@@ -5,12 +5,28 @@
 #include "CarnageGame.h"
 #include "SpriteManager.h"
 #include "GpuTexture2D.h"
+#include "GpuTextureArray2D.h"
 #include "GameCheatsWindow.h"
 #include "PhysicsBody.h"
 #include "PhysicsManager.h"
 #include "Pedestrian.h"
 #include "Vehicle.h"
 #include "TrafficManager.h"
+#include "ProjectilesManager.h"
+#include "GpuProgram.h"
+#include "cvars.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define MAP_RENDERER_SSE2
+    #include <emmintrin.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+
+CvarBoolean gCvarGraphicsOptimizeCityMesh("r_optimizeCityMesh", true, "Skip hidden faces and merge identical lids of city mesh", CvarFlags_Archive | CvarFlags_RequiresMapRestart);
+CvarBoolean gCvarGraphicsMultiDrawIndirect("r_multiDrawIndirect", true, "Submit visible city mesh chunks with single draw call where supported", CvarFlags_Archive);
+CvarBoolean gCvarGraphicsSpritesOcclusion("r_spritesOcclusion", true, "Skip map sprites hidden under solid lids of city blocks", CvarFlags_Archive);
+CvarBoolean gCvarGraphicsPackedCityMesh("r_packedCityMesh", true, "Use quantized vertex format for city mesh", CvarFlags_Archive | CvarFlags_RequiresMapRestart);
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -18,6 +34,10 @@ void MapRenderStats::FrameBegin()
 {
     mBlockChunksDrawnCount = 0;
     mSpritesDrawnCount = 0;
+    mSpritesCulledCount = 0;
+    mSpritesOccludedCount = 0;
+    mCityMeshDrawCallsCount = 0;
+    mCityMeshDrawCommandsCount = 0;
 
     ++mRenderFramesCounter;
 }
@@ -39,11 +59,18 @@ bool MapRenderer::Initialize()
     if (mCityMeshBufferV == nullptr || mCityMeshBufferI == nullptr)
         return false;
 
+    if (gGraphicsDevice.mCaps.mFeatures[eGraphicsFeature_MultiDrawIndirect])
+    {
+        mCityMeshBufferCommands = gGraphicsDevice.CreateBuffer(eBufferContent_DrawIndirect);
+        debug_assert(mCityMeshBufferCommands);
+    }
+
     if (!mSpriteBatch.Initialize())
     {
         gConsole.LogMessage(eLogMessage_Warning, "Cannot initialize sprites batch");
         return false;
     }
+    mSpriteBatch.SetInstancingAllowed(true);
 
     return true;
 }
@@ -62,6 +89,14 @@ void MapRenderer::Deinit()
         gGraphicsDevice.DestroyBuffer(mCityMeshBufferI);
         mCityMeshBufferI = nullptr;
     }
+
+    if (mCityMeshBufferCommands)
+    {
+        gGraphicsDevice.DestroyBuffer(mCityMeshBufferCommands);
+        mCityMeshBufferCommands = nullptr;
+    }
+    mCityMeshViewDraws.clear();
+    mCityMeshDrawCommands.clear();
 }
 
 void MapRenderer::RenderFrameBegin()
@@ -80,6 +115,9 @@ void MapRenderer::RenderFrameBegin()
 
 void MapRenderer::RenderFrameEnd()
 {
+    mSpriteBatch.Clear();
+    mRenderViews.clear();
+
     mRenderStats.FrameEnd();
 }
 
@@ -101,41 +139,84 @@ void MapRenderer::RenderFrame(GameCamera* renderview)
 
     gGraphicsDevice.BindTexture(eTextureUnit_3, gSpriteManager.mPalettesTable);
     gGraphicsDevice.BindTexture(eTextureUnit_2, gSpriteManager.mPaletteIndicesTable);
+    gGraphicsDevice.BindTexture(eTextureUnit_4, gSpriteManager.mSpriteDeltasTable);
+    gGraphicsDevice.BindTexture(eTextureUnit_5, gSpriteManager.mSpriteDeltasTextureArray);
 
     if (gGameCheatsWindow.mEnableDrawCityMesh)
     {
         DrawCityMesh(renderview);
     }
 
-    mSpriteBatch.BeginBatch(SpriteBatch::DepthAxis_Y, eSpritesSortMode_HeightAndDrawOrder);
-
-    // collect and render game objects sprites
-    for (GameObject* gameObject: gGameObjectsManager.mAllObjects)
+    // sprites were extracted for all views in PrepareRenderViews
+    auto renderviewIterator = std::find(mRenderViews.begin(), mRenderViews.end(), renderview);
+    if (renderviewIterator == mRenderViews.end())
     {
-        // attached objects must be drawn after the object to which they are attached
-        if (gameObject->IsAttachedToObject())
-            continue;
-
-        DrawGameObject(renderview, gameObject);
+        debug_assert(false);
+        return;
     }
+    const int viewIndex = std::distance(mRenderViews.begin(), renderviewIterator);
 
-    gRenderManager.mSpritesProgram.Activate();
-    gRenderManager.mSpritesProgram.UploadCameraTransformMatrices(*renderview);
+    RenderProgram& spritesProgram = mSpriteBatch.IsInstancedViews() ? gRenderManager.mSpritesInstancedProgram : gRenderManager.mSpritesProgram;
+    spritesProgram.Activate();
+    spritesProgram.UploadCameraTransformMatrices(*renderview);
 
     RenderStates renderStates = RenderStates()
         .Disable(RenderStateFlags_FaceCulling)
         .Disable(RenderStateFlags_DepthWrite);
     gGraphicsDevice.SetRenderStates(renderStates);
 
-    mSpriteBatch.Flush();
+    mRenderStats.mSpritesDrawnCount += mSpriteBatch.RenderView(viewIndex);
 
-    gRenderManager.mSpritesProgram.Deactivate();
+    spritesProgram.Deactivate();
+}
+
+void MapRenderer::PrepareRenderViews(const std::vector<GameCamera*>& renderviews)
+{
+    const int viewsCount = std::min(static_cast<int>(renderviews.size()), static_cast<int>(MaxCulledRenderViews));
+    mRenderViews.assign(renderviews.begin(), renderviews.begin() + viewsCount);
+
+    CullCityMesh(mRenderViews);
+
+    cxx::aabbox2d_t screenAreas[MaxCulledRenderViews];
+    glm::vec3 viewPositions[MaxCulledRenderViews];
+    for (int iview = 0; iview < viewsCount; ++iview)
+    {
+        screenAreas[iview] = mRenderViews[iview]->mOnScreenMapArea;
+        viewPositions[iview] = mRenderViews[iview]->mPosition;
+    }
+
+    // sprites are sorted and vertices are generated once, views share same geometry with own index ranges
+    mSpriteBatch.BeginBatch(SpriteBatch::DepthAxis_Y, eSpritesSortMode_HeightAndDrawOrder);
+    ExtractSprites(screenAreas, gCvarGraphicsSpritesOcclusion.mValue ? viewPositions : nullptr, viewsCount);
+    if (viewsCount > 0)
+    {
+        mSpriteBatch.BuildViews(viewsCount);
+        mSpriteBatch.UploadViews();
+    }
 }
 
-void MapRenderer::DrawGameObject(GameCamera* renderview, GameObject* gameObject)
+int MapRenderer::ExtractSprites(const cxx::aabbox2d_t* screenAreas, const glm::vec3* viewPositions, int screenAreasCount)
+{
+    int spritesCount = 0;
+    for (GameObject* gameObject: gGameObjectsManager.mAllObjects)
+    {
+        // attached objects must be drawn after the object to which they are attached
+        if (gameObject->IsAttachedToObject())
+            continue;
+
+        spritesCount += ExtractGameObjectSprites(gameObject, screenAreas, viewPositions, screenAreasCount);
+    }
+    spritesCount += gProjectilesManager.DrawProjectiles(mSpriteBatch, screenAreas, screenAreasCount);
+    return spritesCount;
+}
+
+int MapRenderer::ExtractGameObjectSprites(GameObject* gameObject, const cxx::aabbox2d_t* screenAreas, const glm::vec3* viewPositions, 
+    int screenAreasCount)
 {
     if (gameObject->IsMarkedForDeletion() || gameObject->IsInvisibleFlag())
-        return;
+        return 0;
+
+    int spritesCount = 0;
 
     bool debugSkipDraw = 
         (!gGameCheatsWindow.mEnableDrawPedestrians && gameObject->IsPedestrianClass()) ||
@@ -143,20 +224,157 @@ void MapRenderer::DrawGameObject(GameCamera* renderview, GameObject* gameObject)
         (!gGameCheatsWindow.mEnableDrawObstacles && gameObject->IsObstacleClass()) ||
         (!gGameCheatsWindow.mEnableDrawDecorations && gameObject->IsDecorationClass());
 
-    // detect if gameobject is visible on screen
-    if (!debugSkipDraw && gameObject->IsOnScreen(renderview->mOnScreenMapArea))
+    // detect on which screens gameobject is visible
+    unsigned int viewsMask = 0;
+    if (!debugSkipDraw)
     {
-        mSpriteBatch.DrawSprite(gameObject->mDrawSprite);
+        bool isOnScreen = false;
+        for (int iview = 0; iview < screenAreasCount; ++iview)
+        {
+            if (!gameObject->IsOnScreen(screenAreas[iview]))
+                continue;
 
-        ++mRenderStats.mSpritesDrawnCount;
+            isOnScreen = true;
+            if (viewPositions && IsSpriteOccluded(gameObject->mDrawBounds, gameObject->mDrawSprite.mHeight, viewPositions[iview]))
+                continue;
+
+            viewsMask |= (1U << iview);
+        }
+
+        if (viewsMask == 0 && isOnScreen)
+        {
+            ++mRenderStats.mSpritesOccludedCount;
+        }
+        else if (viewsMask == 0)
+        {
+            ++mRenderStats.mSpritesCulledCount;
+        }
+    }
+
+    if (viewsMask)
+    {
+        mSpriteBatch.DrawSprite(gameObject->mDrawSprite, viewsMask);
+
+        ++spritesCount;
         gameObject->mLastRenderFrame = mRenderStats.mRenderFramesCounter;
     }
 
     // draw attached objects
     for (GameObject* currAttachment: gameObject->mAttachedObjects)
     {
-        DrawGameObject(renderview, currAttachment);
+        spritesCount += ExtractGameObjectSprites(currAttachment, screenAreas, viewPositions, screenAreasCount);
     }
+    return spritesCount;
+}
+
+// test whether every ray from flat sprite to camera crosses opaque lid
+// rays pass through slab of map layer within area between sprite bounds projections towards camera onto slab bottom and top,
+// if each column within that area has opaque lid on this layer then each ray enters slab below lid and leaves it above lid
+// @param hasOpaqueLid: Proc(tilex, tiley, layer) returns whether map block has opaque lid
+template<typename TLidProc>
+static bool IsSpriteUnderLids(const cxx::aabbox2d_t& spriteBounds, float spriteHeight, const glm::vec3& viewPosition, TLidProc hasOpaqueLid)
+{
+    // heights in map units, lids of sprite layer are not above sprite
+    const float spriteLayer = Convert::MetersToMapUnits(spriteHeight);
+    const float viewLayer = Convert::MetersToMapUnits(viewPosition.y);
+    if (viewLayer <= spriteLayer)
+        return false;
+
+    const glm::vec2 viewPoint { viewPosition.x, viewPosition.z };
+    for (int layer = (int) floorf(spriteLayer) + 1; (layer < MAP_LAYERS_COUNT) && (layer + 1.0f <= viewLayer); ++layer)
+    {
+        const float bottomT = (layer - spriteLayer) / (viewLayer - spriteLayer);
+        const float topT = (layer + 1.0f - spriteLayer) / (viewLayer - spriteLayer);
+        cxx::aabbox2d_t slabArea { glm::mix(spriteBounds.mMin, viewPoint, bottomT), glm::mix(spriteBounds.mMax, viewPoint, bottomT) };
+        slabArea.extend(glm::mix(spriteBounds.mMin, viewPoint, topT));
+        slabArea.extend(glm::mix(spriteBounds.mMax, viewPoint, topT));
+
+        const int minx = (int) floorf(Convert::MetersToMapUnits(slabArea.mMin.x));
+        const int miny = (int) floorf(Convert::MetersToMapUnits(slabArea.mMin.y));
+        const int maxx = (int) floorf(Convert::MetersToMapUnits(slabArea.mMax.x));
+        const int maxy = (int) floorf(Convert::MetersToMapUnits(slabArea.mMax.y));
+        if (minx < 0 || miny < 0 || maxx >= MAP_DIMENSIONS || maxy >= MAP_DIMENSIONS)
+            return false;
+
+        bool allColumnsBlock = true;
+        for (int tiley = miny; tiley <= maxy && allColumnsBlock; ++tiley)
+        for (int tilex = minx; tilex <= maxx && allColumnsBlock; ++tilex)
+        {
+            allColumnsBlock = hasOpaqueLid(tilex, tiley, layer);
+        }
+
+        if (allColumnsBlock)
+            return true;
+    }
+    return false;
+}
+
+bool MapRenderer::IsSpriteOccluded(const cxx::aabbox2d_t& spriteBounds, float spriteHeight, const glm::vec3& viewPosition) const
+{
+    // quick reject for sprites in open, lids of neighbour columns alone are not enough to cull them
+    const int minx = (int) floorf(Convert::MetersToMapUnits(spriteBounds.mMin.x));
+    const int miny = (int) floorf(Convert::MetersToMapUnits(spriteBounds.mMin.y));
+    const int maxx = (int) floorf(Convert::MetersToMapUnits(spriteBounds.mMax.x));
+    const int maxy = (int) floorf(Convert::MetersToMapUnits(spriteBounds.mMax.y));
+    for (int tiley = miny; tiley <= maxy; ++tiley)
+    for (int tilex = minx; tilex <= maxx; ++tilex)
+    {
+        if (Convert::MapUnitsToMeters((float) gGameMap.GetTopSolidLayer(tilex, tiley)) <= spriteHeight)
+            return false;
+    }
+
+    return IsSpriteUnderLids(spriteBounds, spriteHeight, viewPosition, [](int tilex, int tiley, int layer)
+    {
+        // same as top solid layers, flat lids have transparent pixels
+        const MapBlockInfo* blockInfo = gGameMap.GetBlockInfo(tilex, tiley, layer);
+        return blockInfo->mFaces[eBlockFace_Lid] && !blockInfo->mIsFlat;
+    });
+}
+
+bool MapRenderer::RunSpritesOcclusionTest() const
+{
+    struct OcclusionTestCase
+    {
+        const char* mName;
+        glm::vec3 mViewPosition; // map units, y is height
+        std::vector<glm::ivec3> mLids; // x, y, layer
+        bool mOccluded;
+    };
+
+    // sprite on ground under bridge deck at layer 4, camera is high and slightly shifted along x
+    const OcclusionTestCase testCases[] =
+    {
+        { "open ground", { 7.9f, 17.0f, 5.5f }, {}, false },
+        { "camera above deck", { 5.5f, 17.0f, 5.5f }, { {5, 5, 4} }, true },
+        { "wide deck", { 7.9f, 17.0f, 5.5f }, { {5, 5, 4}, {6, 5, 4} }, true },
+        // rays leave deck column below its lid but above lower lid of next column
+        { "staggered lids", { 7.9f, 17.0f, 5.5f }, { {5, 5, 4}, {6, 5, 2}, {7, 5, 2} }, false },
+    };
+
+    const cxx::aabbox2d_t spriteBounds
+    {
+        Convert::MapUnitsToMeters(glm::vec2 { 5.4f, 5.4f }),
+        Convert::MapUnitsToMeters(glm::vec2 { 5.6f, 5.6f })
+    };
+    const float spriteHeight = Convert::MapUnitsToMeters(1.0f);
+
+    bool testsPassed = true;
+    for (const OcclusionTestCase& currCase: testCases)
+    {
+        bool isOccluded = IsSpriteUnderLids(spriteBounds, spriteHeight, Convert::MapUnitsToMeters(currCase.mViewPosition), 
+            [&currCase](int tilex, int tiley, int layer)
+            {
+                return std::find(currCase.mLids.begin(), currCase.mLids.end(), glm::ivec3(tilex, tiley, layer)) != currCase.mLids.end();
+            });
+
+        if (isOccluded != currCase.mOccluded)
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Sprites occlusion test '%s' failed, expected %s", currCase.mName, currCase.mOccluded ? "occluded" : "visible");
+            testsPassed = false;
+        }
+    }
+    debug_assert(testsPassed);
+    return testsPassed;
 }
 
 void MapRenderer::DebugDraw(DebugRenderer& debugRender)
@@ -177,32 +395,200 @@ void MapRenderer::DrawCityMesh(GameCamera* renderview)
 
     gGraphicsDevice.SetRenderStates(cityMeshRenderStates);
 
-    gRenderManager.mCityMeshProgram.Activate();
-    gRenderManager.mCityMeshProgram.UploadCameraTransformMatrices(*renderview);
+    RenderProgram& cityMeshProgram = mCityMeshPacked ? gRenderManager.mCityMeshPackedProgram : gRenderManager.mCityMeshProgram;
+    cityMeshProgram.Activate();
+    cityMeshProgram.UploadCameraTransformMatrices(*renderview);
 
     if (mCityMeshBufferV && mCityMeshBufferI)
     {
-        gGraphicsDevice.BindVertexBuffer(mCityMeshBufferV, CityVertex3D_Format::Get());
+        if (mCityMeshPacked)
+        {
+            gGraphicsDevice.BindVertexBuffer(mCityMeshBufferV, CityPackedVertex3D_Format::Get());
+        }
+        else
+        {
+            gGraphicsDevice.BindVertexBuffer(mCityMeshBufferV, CityVertex3D_Format::Get());
+        }
         gGraphicsDevice.BindIndexBuffer(mCityMeshBufferI);
+        if (gSpriteManager.mBlocksTextureArray)
+        {
+            // merged lids span several blocks and repeat block texture, otherwise keep default wrapping
+            eTextureWrapMode wrapMode = mCityMeshLidsMerged ? eTextureWrapMode_Repeat : gGraphicsDevice.mDefaultTextureWrap;
+            gSpriteManager.mBlocksTextureArray->SetSamplerState(gGraphicsDevice.mDefaultTextureFilter, wrapMode);
+        }
         gGraphicsDevice.BindTexture(eTextureUnit_0, gSpriteManager.mBlocksTextureArray);
         gGraphicsDevice.BindTexture(eTextureUnit_1, gSpriteManager.mBlocksIndicesTable);
 
-        for (const MapBlocksChunk& currChunk: mMapBlocksChunks)
+        if (mCityMeshPacked)
         {
-            if (!renderview->mFrustum.contains(currChunk.mBounds))
-                continue;
-
-            gGraphicsDevice.RenderIndexedPrimitives(ePrimitiveType_Triangles, eIndicesType_i32, 
-                currChunk.mIndicesStart * Sizeof_DrawIndex, currChunk.mIndicesCount);
+            const glm::vec3 chunksOrigin { -ExtraBlocksPerSide * METERS_PER_MAP_UNIT, 0.0f, -ExtraBlocksPerSide * METERS_PER_MAP_UNIT };
+            cityMeshProgram.mGpuProgram->SetUniform(eRenderUniform_ChunkOrigin, chunksOrigin);
+            cityMeshProgram.mGpuProgram->SetUniform(eRenderUniform_ChunkSize, BlocksBatchDims * METERS_PER_MAP_UNIT);
+        }
 
-            ++mRenderStats.mBlockChunksDrawnCount;
+        auto viewDrawsIterator = std::find_if(mCityMeshViewDraws.begin(), mCityMeshViewDraws.end(), 
+            [renderview](const CityMeshViewDraws& viewDraws)
+            {
+                return viewDraws.mRenderView == renderview;
+            });
+        debug_assert(viewDrawsIterator != mCityMeshViewDraws.end());
+
+        if (viewDrawsIterator != mCityMeshViewDraws.end() && viewDrawsIterator->mCommandsCount > 0)
+        {
+            const CityMeshViewDraws& viewDraws = *viewDrawsIterator;
+            if (IsMultiDrawIndirectEnabled())
+            {
+                gGraphicsDevice.RenderIndexedPrimitivesIndirect(ePrimitiveType_Triangles, eIndicesType_i32, mCityMeshBufferCommands,
+                    viewDraws.mCommandsStart * Sizeof_DrawIndexedIndirectCommand, viewDraws.mCommandsCount);
+                ++mRenderStats.mCityMeshDrawCallsCount;
+            }
+            else
+            {
+                for (int icommand = 0; icommand < viewDraws.mCommandsCount; ++icommand)
+                {
+                    const DrawIndexedIndirectCommand& drawCommand = mCityMeshDrawCommands[viewDraws.mCommandsStart + icommand];
+                    gGraphicsDevice.RenderIndexedPrimitives(ePrimitiveType_Triangles, eIndicesType_i32, 
+                        drawCommand.mFirstIndex * Sizeof_DrawIndex, drawCommand.mIndicesCount);
+                }
+                mRenderStats.mCityMeshDrawCallsCount += viewDraws.mCommandsCount;
+            }
+            mRenderStats.mCityMeshDrawCommandsCount += viewDraws.mCommandsCount;
+            mRenderStats.mBlockChunksDrawnCount += viewDraws.mChunksCount;
         }
     }
-    gRenderManager.mCityMeshProgram.Deactivate();
+    cityMeshProgram.Deactivate();
+}
+
+void MapRenderer::CullCityMesh(const std::vector<GameCamera*>& renderviews)
+{
+    mCityMeshViewDraws.clear();
+    mCityMeshDrawCommands.clear();
+
+    const int viewsCount = std::min(static_cast<int>(renderviews.size()), static_cast<int>(MaxCulledRenderViews));
+    debug_assert(viewsCount == static_cast<int>(renderviews.size()));
+
+    // single pass over chunks, each group of four chunks gets tested against all views
+    ::memset(mChunksVisibility, 0, sizeof(mChunksVisibility));
+    for (int ichunk = 0; ichunk < BlocksBatchCountPadded; ichunk += 4)
+    {
+        for (int iview = 0; iview < viewsCount; ++iview)
+        {
+            unsigned int visibleLanes = CullChunksLanes(renderviews[iview]->mFrustum, ichunk);
+            for (int ilane = 0; ilane < 4 && (ichunk + ilane) < BlocksBatchCount; ++ilane)
+            {
+                if (visibleLanes & (1U << ilane))
+                {
+                    mChunksVisibility[ichunk + ilane] |= (1U << iview);
+                }
+            }
+        }
+    }
+
+    // generate draw commands, chunks are stored sequentially so adjacent index ranges are joined
+    for (int iview = 0; iview < viewsCount; ++iview)
+    {
+        CityMeshViewDraws viewDraws;
+        viewDraws.mRenderView = renderviews[iview];
+        viewDraws.mCommandsStart = mCityMeshDrawCommands.size();
+        for (int ichunk = 0; ichunk < BlocksBatchCount; ++ichunk)
+        {
+            const MapBlocksChunk& currChunk = mMapBlocksChunks[ichunk];
+            if ((mChunksVisibility[ichunk] & (1U << iview)) == 0 || currChunk.mIndicesCount == 0)
+                continue;
+
+            ++viewDraws.mChunksCount;
+            if (static_cast<int>(mCityMeshDrawCommands.size()) > viewDraws.mCommandsStart)
+            {
+                DrawIndexedIndirectCommand& prevCommand = mCityMeshDrawCommands.back();
+                if ((prevCommand.mFirstIndex + prevCommand.mIndicesCount) == currChunk.mIndicesStart)
+                {
+                    prevCommand.mIndicesCount += currChunk.mIndicesCount;
+                    continue;
+                }
+            }
+            DrawIndexedIndirectCommand drawCommand;
+            drawCommand.mFirstIndex = currChunk.mIndicesStart;
+            drawCommand.mIndicesCount = currChunk.mIndicesCount;
+            mCityMeshDrawCommands.push_back(drawCommand);
+        }
+        viewDraws.mCommandsCount = mCityMeshDrawCommands.size() - viewDraws.mCommandsStart;
+        mCityMeshViewDraws.push_back(viewDraws);
+    }
+
+    // commands for all views are uploaded at once
+    if (IsMultiDrawIndirectEnabled() && !mCityMeshDrawCommands.empty())
+    {
+        mCityMeshBufferCommands->Setup(eBufferUsage_Stream, 
+            mCityMeshDrawCommands.size() * Sizeof_DrawIndexedIndirectCommand, mCityMeshDrawCommands.data());
+    }
+}
+
+unsigned int MapRenderer::CullChunksLanes(const cxx::frustum_t& frustum, int chunkIndex) const
+{
+    // box is outside if its most positive vertex relative to plane normal is behind the plane,
+    // that is same test as cxx::frustum_t::contains does with eight corners
+#ifdef MAP_RENDERER_SSE2
+    const __m128 centerX = _mm_loadu_ps(&mChunksBounds[eChunkBounds_CenterX][chunkIndex]);
+    const __m128 centerY = _mm_loadu_ps(&mChunksBounds[eChunkBounds_CenterY][chunkIndex]);
+    const __m128 centerZ = _mm_loadu_ps(&mChunksBounds[eChunkBounds_CenterZ][chunkIndex]);
+    const __m128 extentX = _mm_loadu_ps(&mChunksBounds[eChunkBounds_ExtentX][chunkIndex]);
+    const __m128 extentY = _mm_loadu_ps(&mChunksBounds[eChunkBounds_ExtentY][chunkIndex]);
+    const __m128 extentZ = _mm_loadu_ps(&mChunksBounds[eChunkBounds_ExtentZ][chunkIndex]);
+    const __m128 zero = _mm_setzero_ps();
+
+    __m128 visible = _mm_cmpeq_ps(zero, zero);
+    for (const cxx::plane3d_t& currPlane: frustum.mPlanes)
+    {
+        __m128 distance = _mm_set1_ps(currPlane.mDistance);
+        distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(currPlane.mNormal.x), centerX));
+        distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(currPlane.mNormal.y), centerY));
+        distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(currPlane.mNormal.z), centerZ));
+        distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(fabsf(currPlane.mNormal.x)), extentX));
+        distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(fabsf(currPlane.mNormal.y)), extentY));
+        distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(fabsf(currPlane.mNormal.z)), extentZ));
+        visible = _mm_and_ps(visible, _mm_cmpgt_ps(distance, zero));
+    }
+    return static_cast<unsigned int>(_mm_movemask_ps(visible));
+#else
+    unsigned int visibleLanes = 0;
+    for (int ilane = 0; ilane < 4; ++ilane)
+    {
+        const int ichunk = chunkIndex + ilane;
+        bool visible = true;
+        for (const cxx::plane3d_t& currPlane: frustum.mPlanes)
+        {
+            float distance = currPlane.mDistance + 
+                currPlane.mNormal.x * mChunksBounds[eChunkBounds_CenterX][ichunk] +
+                currPlane.mNormal.y * mChunksBounds[eChunkBounds_CenterY][ichunk] +
+                currPlane.mNormal.z * mChunksBounds[eChunkBounds_CenterZ][ichunk] +
+                fabsf(currPlane.mNormal.x) * mChunksBounds[eChunkBounds_ExtentX][ichunk] +
+                fabsf(currPlane.mNormal.y) * mChunksBounds[eChunkBounds_ExtentY][ichunk] +
+                fabsf(currPlane.mNormal.z) * mChunksBounds[eChunkBounds_ExtentZ][ichunk];
+            if (distance <= 0.0f)
+            {
+                visible = false;
+                break;
+            }
+        }
+        if (visible)
+        {
+            visibleLanes |= (1U << ilane);
+        }
+    }
+    return visibleLanes;
+#endif // MAP_RENDERER_SSE2
+}
+
+bool MapRenderer::IsMultiDrawIndirectEnabled() const
+{
+    return gCvarGraphicsMultiDrawIndirect.mValue && (mCityMeshBufferCommands != nullptr);
 }
 
 void MapRenderer::BuildMapMesh()
 {
+    double buildStartTime = gSystem.GetSystemSeconds();
+
+    MapMeshBuildStats meshBuildStats;
     CityMeshData blocksMesh;
     for (int batchy = 0; batchy < BlocksBatchesPerSide; ++batchy)
     {
@@ -225,24 +611,107 @@ void MapRenderer::BuildMapMesh()
 
             currChunk.mVerticesStart = prevVerticesCount;
             currChunk.mIndicesStart = prevIndicesCount;
+
+            // culling data
+            const int chunkIndex = batchy * BlocksBatchesPerSide + batchx;
+            const glm::vec3 chunkCenter = (currChunk.mBounds.mMin + currChunk.mBounds.mMax) * 0.5f;
+            const glm::vec3 chunkExtent = (currChunk.mBounds.mMax - currChunk.mBounds.mMin) * 0.5f;
+            mChunksBounds[eChunkBounds_CenterX][chunkIndex] = chunkCenter.x;
+            mChunksBounds[eChunkBounds_CenterY][chunkIndex] = chunkCenter.y;
+            mChunksBounds[eChunkBounds_CenterZ][chunkIndex] = chunkCenter.z;
+            mChunksBounds[eChunkBounds_ExtentX][chunkIndex] = chunkExtent.x;
+            mChunksBounds[eChunkBounds_ExtentY][chunkIndex] = chunkExtent.y;
+            mChunksBounds[eChunkBounds_ExtentZ][chunkIndex] = chunkExtent.z;
             
             // append new geometry
-            GameMapHelpers::BuildMapMesh(gGameMap, mapArea, blocksMesh);
+            if (gCvarGraphicsOptimizeCityMesh.mValue)
+            {
+                GameMapHelpers::BuildMapMeshOptimized(gGameMap, mapArea, blocksMesh, meshBuildStats);
+            }
+            else
+            {
+                GameMapHelpers::BuildMapMesh(gGameMap, mapArea, blocksMesh);
+            }
             
             currChunk.mVerticesCount = blocksMesh.mBlocksVertices.size() - prevVerticesCount;
             currChunk.mIndicesCount = blocksMesh.mBlocksIndices.size() - prevIndicesCount;
         }
     }
 
-    // upload map geometry to video memory
-    int totalVertexDataBytes = blocksMesh.mBlocksVertices.size() * Sizeof_CityVertex3D;
-    int totalIndexDataBytes = blocksMesh.mBlocksIndices.size() * Sizeof_DrawIndex;
+    if (!gCvarGraphicsOptimizeCityMesh.mValue)
+    {
+        // every defined face goes to mesh as is
+        meshBuildStats.mFacesCount = blocksMesh.mBlocksIndices.size() / 6;
+        meshBuildStats.mQuadsCount = meshBuildStats.mFacesCount;
+    }
+    mRenderStats.mCityMeshTrianglesCount = blocksMesh.mBlocksIndices.size() / 3;
+    mRenderStats.mCityMeshUnpackedVertexBytes = blocksMesh.mBlocksVertices.size() * Sizeof_CityVertex3D;
+
+    mCityMeshLidsMerged = meshBuildStats.mMergedLidsCount > 0;
+    mCityMeshPacked = gCvarGraphicsPackedCityMesh.mValue && gRenderManager.mCityMeshPackedProgram.IsProgramInited();
+    if (mCityMeshPacked)
+    {
+        // convert chunks to quantized format, each chunk is stored relative to its bounds origin
+        CityPackedMeshData packedMesh;
+        packedMesh.mBlocksVertices.reserve(blocksMesh.mBlocksVertices.size());
+        packedMesh.mBlocksIndices.reserve(blocksMesh.mBlocksIndices.size());
+        for (int ichunk = 0; ichunk < BlocksBatchCount; ++ichunk)
+        {
+            MapBlocksChunk& currChunk = mMapBlocksChunks[ichunk];
+
+            unsigned int prevVerticesCount = packedMesh.mBlocksVertices.size();
+            unsigned int prevIndicesCount = packedMesh.mBlocksIndices.size();
+
+            const glm::ivec2 chunkCell { ichunk % BlocksBatchesPerSide, ichunk / BlocksBatchesPerSide };
+            GameMapHelpers::PackMeshData(blocksMesh, currChunk.mIndicesStart, currChunk.mIndicesCount, currChunk.mBounds.mMin, chunkCell, packedMesh);
+
+            currChunk.mVerticesStart = prevVerticesCount;
+            currChunk.mVerticesCount = packedMesh.mBlocksVertices.size() - prevVerticesCount;
+            currChunk.mIndicesStart = prevIndicesCount;
+            currChunk.mIndicesCount = packedMesh.mBlocksIndices.size() - prevIndicesCount;
+        }
+        mRenderStats.mCityMeshVerticesCount = packedMesh.mBlocksVertices.size();
+        mRenderStats.mCityMeshVertexBytes = packedMesh.mBlocksVertices.size() * Sizeof_CityPackedVertex3D;
+        UploadCityMesh(packedMesh.mBlocksVertices.data(), mRenderStats.mCityMeshVertexBytes, packedMesh.mBlocksIndices);
+        mRenderStats.mCityMeshIndicesCount = packedMesh.mBlocksIndices.size();
+    }
+    else
+    {
+        mRenderStats.mCityMeshVerticesCount = blocksMesh.mBlocksVertices.size();
+        mRenderStats.mCityMeshVertexBytes = mRenderStats.mCityMeshUnpackedVertexBytes;
+        UploadCityMesh(blocksMesh.mBlocksVertices.data(), mRenderStats.mCityMeshVertexBytes, blocksMesh.mBlocksIndices);
+        mRenderStats.mCityMeshIndicesCount = blocksMesh.mBlocksIndices.size();
+    }
+
+    mRenderStats.mCityMeshBuildTimeMs = static_cast<float>((gSystem.GetSystemSeconds() - buildStartTime) * 1000.0);
+    gConsole.LogMessage(eLogMessage_Info, "City mesh (%s): %d vertices, %d indices, vertex data %d KB (unpacked %d KB), build time %.2f ms", 
+        mCityMeshPacked ? "packed" : "unpacked",
+        mRenderStats.mCityMeshVerticesCount, 
+        mRenderStats.mCityMeshIndicesCount, 
+        mRenderStats.mCityMeshVertexBytes / 1024, 
+        mRenderStats.mCityMeshUnpackedVertexBytes / 1024, 
+        mRenderStats.mCityMeshBuildTimeMs);
+
+    // triangles comparison table
+    const int naiveTrianglesCount = meshBuildStats.mFacesCount * 2;
+    gConsole.LogMessage(eLogMessage_Info, "City mesh faces: %d defined, %d hidden, %d lids merged", 
+        meshBuildStats.mFacesCount, meshBuildStats.mHiddenFacesCount, meshBuildStats.mMergedLidsCount);
+    gConsole.LogMessage(eLogMessage_Info, "    %-12s %10s %8s", "mesher", "triangles", "ratio");
+    gConsole.LogMessage(eLogMessage_Info, "    %-12s %10d %7.1f%%", "naive", naiveTrianglesCount, 100.0f);
+    gConsole.LogMessage(eLogMessage_Info, "    %-12s %10d %7.1f%%", gCvarGraphicsOptimizeCityMesh.mValue ? "optimized" : "(disabled)", 
+        mRenderStats.mCityMeshTrianglesCount, 
+        naiveTrianglesCount > 0 ? (100.0f * mRenderStats.mCityMeshTrianglesCount / naiveTrianglesCount) : 0.0f);
+}
+
+void MapRenderer::UploadCityMesh(const void* verticesData, int verticesDataBytes, const std::vector<DrawIndex>& indices)
+{
+    int totalIndexDataBytes = indices.size() * Sizeof_DrawIndex;
 
     // upload vertex data
-    mCityMeshBufferV->Setup(eBufferUsage_Static, totalVertexDataBytes, nullptr);
+    mCityMeshBufferV->Setup(eBufferUsage_Static, verticesDataBytes, nullptr);
     if (void* pdata = mCityMeshBufferV->Lock(BufferAccess_Write))
     {
-        memcpy(pdata, blocksMesh.mBlocksVertices.data(), totalVertexDataBytes);
+        memcpy(pdata, verticesData, verticesDataBytes);
         mCityMeshBufferV->Unlock();
     }
 
@@ -250,7 +719,156 @@ void MapRenderer::BuildMapMesh()
     mCityMeshBufferI->Setup(eBufferUsage_Static, totalIndexDataBytes, nullptr);
     if (void* pdata = mCityMeshBufferI->Lock(BufferAccess_Write))
     {
-        memcpy(pdata, blocksMesh.mBlocksIndices.data(), totalIndexDataBytes);
+        memcpy(pdata, indices.data(), totalIndexDataBytes);
         mCityMeshBufferI->Unlock();
     }
-}
\ No newline at end of file
+}
+
+void MapRenderer::RunSpritesBenchmark(int viewsCount, int framesCount)
+{
+    viewsCount = glm::clamp(viewsCount, 1, static_cast<int>(MaxCulledRenderViews));
+    framesCount = std::max(framesCount, 1);
+
+    // take screen areas of active views, missing views are simulated by shifting them along x axis
+    std::vector<cxx::aabbox2d_t> baseAreas;
+    for (GameCamera* currRenderview: gRenderManager.mActiveRenderViews)
+    {
+        baseAreas.push_back(currRenderview->mOnScreenMapArea);
+    }
+    if (baseAreas.empty() && gCarnageGame.mHumanPlayers[0])
+    {
+        baseAreas.push_back(gCarnageGame.mHumanPlayers[0]->mViewCamera.mOnScreenMapArea);
+    }
+    if (baseAreas.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Sprites benchmark: no render views");
+        return;
+    }
+
+    cxx::aabbox2d_t screenAreas[MaxCulledRenderViews];
+    for (int iview = 0; iview < viewsCount; ++iview)
+    {
+        const int baseCount = baseAreas.size();
+        const cxx::aabbox2d_t& baseArea = baseAreas[iview % baseCount];
+        // neighbour views overlap by half
+        const float shift = (iview / baseCount) * (baseArea.mMax.x - baseArea.mMin.x) * 0.5f;
+        screenAreas[iview] = baseArea;
+        screenAreas[iview].mMin.x += shift;
+        screenAreas[iview].mMax.x += shift;
+    }
+
+    double separateTotalTime = 0.0;
+    double separateMaxTime = 0.0;
+    double sharedTotalTime = 0.0;
+    double sharedMaxTime = 0.0;
+    int separateSpritesCount = 0;
+    int sharedSpritesCount = 0;
+    for (int iframe = 0; iframe < framesCount; ++iframe)
+    {
+        // each view extracts, sorts and builds own sprites
+        double startTime = gSystem.GetSystemSeconds();
+        separateSpritesCount = 0;
+        for (int iview = 0; iview < viewsCount; ++iview)
+        {
+            mSpriteBatch.BeginBatch(SpriteBatch::DepthAxis_Y, eSpritesSortMode_HeightAndDrawOrder);
+            separateSpritesCount += ExtractSprites(&screenAreas[iview], nullptr, 1);
+            mSpriteBatch.BuildViews(1);
+        }
+        double frameTime = gSystem.GetSystemSeconds() - startTime;
+        separateMaxTime = std::max(separateMaxTime, frameTime);
+        separateTotalTime += frameTime;
+
+        // sprites are processed once for all views
+        startTime = gSystem.GetSystemSeconds();
+        mSpriteBatch.BeginBatch(SpriteBatch::DepthAxis_Y, eSpritesSortMode_HeightAndDrawOrder);
+        sharedSpritesCount = ExtractSprites(screenAreas, nullptr, viewsCount);
+        mSpriteBatch.BuildViews(viewsCount);
+        frameTime = gSystem.GetSystemSeconds() - startTime;
+        sharedMaxTime = std::max(sharedMaxTime, frameTime);
+        sharedTotalTime += frameTime;
+    }
+    mSpriteBatch.Clear();
+
+    gConsole.LogMessage(eLogMessage_Info, "Sprites benchmark: %d views, %d frames, no rendering", viewsCount, framesCount);
+    gConsole.LogMessage(eLogMessage_Info, " - per view: %d sprites, avg %.3f ms, max %.3f ms", 
+        separateSpritesCount, (separateTotalTime * 1000.0) / framesCount, separateMaxTime * 1000.0);
+    gConsole.LogMessage(eLogMessage_Info, " - shared: %d sprites, avg %.3f ms, max %.3f ms", 
+        sharedSpritesCount, (sharedTotalTime * 1000.0) / framesCount, sharedMaxTime * 1000.0);
+}
+
+void MapRenderer::RunSpritesBuildBenchmark(int spritesCount, int framesCount)
+{
+    framesCount = std::max(framesCount, 1);
+
+    std::vector<Sprite2D> sourceSprites;
+    for (GameObject* gameObject: gGameObjectsManager.mAllObjects)
+    {
+        if (gameObject->IsMarkedForDeletion() || !gameObject->mDrawSprite)
+            continue;
+
+        sourceSprites.push_back(gameObject->mDrawSprite);
+    }
+    if (sourceSprites.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Sprites build benchmark: no game objects to take sprites from");
+        return;
+    }
+
+    std::vector<int> spritesCounts;
+    if (spritesCount > 0)
+    {
+        spritesCounts.push_back(spritesCount);
+    }
+    else
+    {
+        spritesCounts = { 10000, 50000, 100000, 200000 };
+    }
+
+    const bool savedInstancedSprites = gCvarGraphicsInstancedSprites.mValue;
+    for (int currSpritesCount: spritesCounts)
+    {
+        // spread sprites on grid with different rotations
+        std::vector<Sprite2D> sprites(currSpritesCount);
+        for (int isprite = 0; isprite < currSpritesCount; ++isprite)
+        {
+            Sprite2D& sprite = sprites[isprite];
+            sprite = sourceSprites[isprite % sourceSprites.size()];
+            sprite.mPosition.x += (isprite % 200) * 0.5f;
+            sprite.mPosition.y += (isprite / 200) * 0.5f;
+            sprite.mRotateAngle = cxx::angle_t::from_degrees((isprite * 7) % 360 * 1.0f);
+        }
+
+        gConsole.LogMessage(eLogMessage_Info, "Sprites build benchmark: %d sprites, %d frames, no rendering", currSpritesCount, framesCount);
+
+        const bool buildModes[] = { false, true };
+        for (bool currInstanced: buildModes)
+        {
+            gCvarGraphicsInstancedSprites.mValue = currInstanced;
+
+            double totalFrameTime = 0.0;
+            double maxFrameTime = 0.0;
+            unsigned int dataBytes = 0;
+            for (int iframe = 0; iframe < framesCount; ++iframe)
+            {
+                mSpriteBatch.BeginBatch(SpriteBatch::DepthAxis_Y, eSpritesSortMode_HeightAndDrawOrder);
+                for (const Sprite2D& sprite: sprites)
+                {
+                    mSpriteBatch.DrawSprite(sprite);
+                }
+
+                double startTime = gSystem.GetSystemSeconds();
+                mSpriteBatch.BuildViews(1);
+
+                double frameTime = gSystem.GetSystemSeconds() - startTime;
+                maxFrameTime = std::max(maxFrameTime, frameTime);
+                totalFrameTime += frameTime;
+                dataBytes = mSpriteBatch.GetViewsDataBytes();
+            }
+
+            gConsole.LogMessage(eLogMessage_Info, " - %s: avg %.3f ms, max %.3f ms, %d KB", currInstanced ? "instances" : "vertices", 
+                (totalFrameTime * 1000.0) / framesCount, maxFrameTime * 1000.0, dataBytes / 1024);
+        }
+    }
+    gCvarGraphicsInstancedSprites.mValue = savedInstancedSprites;
+    mSpriteBatch.Clear();
+}
@@ -16,8 +16,21 @@ public:
 public:
     int mBlockChunksDrawnCount = 0;  // per frame
     int mSpritesDrawnCount = 0; // per frame
+    int mSpritesCulledCount = 0; // per frame, outside of all render views
+    int mSpritesOccludedCount = 0; // per frame, within render views but hidden under solid lids
+    int mCityMeshDrawCallsCount = 0; // per frame, api calls issued for city mesh
+    int mCityMeshDrawCommandsCount = 0; // per frame, draw ranges submitted for city mesh
+    unsigned int mStreamingUploadBytes = 0; // previous frame, dynamic geometry written to streaming buffers
 
     unsigned int mRenderFramesCounter = 0; // gets incremented on every frame
+
+    // city mesh info, updated on map mesh build
+    int mCityMeshVerticesCount = 0;
+    int mCityMeshTrianglesCount = 0;
+    int mCityMeshIndicesCount = 0;
+    int mCityMeshVertexBytes = 0;
+    int mCityMeshUnpackedVertexBytes = 0; // same mesh in CityVertex3D format
+    float mCityMeshBuildTimeMs = 0.0f;
 };
 
 // renders map mesh, peds, cars and map objects
@@ -31,14 +44,50 @@ public:
     void Deinit();
     void RenderFrameBegin();
     void RenderFrame(GameCamera* renderview);
+
+    // Cull city mesh and extract sprites for all render views at once, each view then draws its own subset
+    // Must be called after render views matrices and frustums are computed
+    // @param renderviews: Render views that will be drawn in current frame
+    void PrepareRenderViews(const std::vector<GameCamera*>& renderviews);
+
     void DebugDraw(DebugRenderer& debugRender);
     void RenderFrameEnd();
     void BuildMapMesh();
 
+    // Measure cpu cost of sprites extraction for split screen views, per view versus shared, results are printed to log
+    // Geometry is not uploaded to video memory
+    // @param viewsCount: Number of simulated render views
+    void RunSpritesBenchmark(int viewsCount, int framesCount);
+
+    // Measure cpu cost of sprites geometry generation, vertices versus instances, results are printed to log
+    // Sprites are cloned from game objects currently present in world
+    // @param spritesCount: Number of sprites, zero or less runs series of 10k to 200k sprites
+    void RunSpritesBuildBenchmark(int spritesCount, int framesCount);
+
+    // Check sprites occlusion test against synthetic lids layouts, including staggered lids which must not hide sprite
+    // @returns false if some case fails
+    bool RunSpritesOcclusionTest() const;
+
 private:
     void DrawCityMesh(GameCamera* renderview);
-    void DrawGameObject(GameCamera* renderview, GameObject* gameObject);
+    // find visible city mesh chunks for all render views and prepare draw commands
+    void CullCityMesh(const std::vector<GameCamera*>& renderviews);
+    // collect sprites of game objects and projectiles visible within screen areas
+    // @param viewPositions: Camera positions of render views used for occlusion test, optional
+    // @returns Number of sprites extracted
+    int ExtractSprites(const cxx::aabbox2d_t* screenAreas, const glm::vec3* viewPositions, int screenAreasCount);
+    int ExtractGameObjectSprites(GameObject* gameObject, const cxx::aabbox2d_t* screenAreas, const glm::vec3* viewPositions, int screenAreasCount);
+    // conservative test whether sprite is completely hidden under solid lids of city blocks
+    // @param spriteBounds: Sprite bounds on map, meters
+    // @param spriteHeight: Sprite height, meters
+    // @param viewPosition: Camera position, meters
+    bool IsSpriteOccluded(const cxx::aabbox2d_t& spriteBounds, float spriteHeight, const glm::vec3& viewPosition) const;
     void PreDrawGameObject(GameObject* gameObject);
+    void UploadCityMesh(const void* verticesData, int verticesDataBytes, const std::vector<DrawIndex>& indices);
+    // test four chunks starting from specified index against frustum
+    // @returns Mask of visible chunks
+    unsigned int CullChunksLanes(const cxx::frustum_t& frustum, int chunkIndex) const;
+    bool IsMultiDrawIndirectEnabled() const;
 
 private:
     enum
@@ -47,7 +96,10 @@ private:
         ExtraBlocksPerSide = 4,
         BlocksBatchesPerSide = ((MAP_DIMENSIONS + (ExtraBlocksPerSide * 2)) + BlocksBatchDims - 1) / BlocksBatchDims,
         BlocksBatchCount = BlocksBatchesPerSide * BlocksBatchesPerSide,
+        BlocksBatchCountPadded = (BlocksBatchCount + 3) & (~3), // culled in groups of four
+        MaxCulledRenderViews = 32, // visibility is stored as bits
     };
+    static_assert(GAME_MAX_PLAYERS <= MaxCulledRenderViews, "Too many render views");
     struct MapBlocksChunk
     {
         cxx::aabbox_t mBounds; // for culling
@@ -57,8 +109,37 @@ private:
     };
     MapBlocksChunk mMapBlocksChunks[BlocksBatchCount];
 
+    // chunks bounds as structure of arrays for culling
+    enum eChunkBounds
+    {
+        eChunkBounds_CenterX,
+        eChunkBounds_CenterY,
+        eChunkBounds_CenterZ,
+        eChunkBounds_ExtentX,
+        eChunkBounds_ExtentY,
+        eChunkBounds_ExtentZ,
+        eChunkBounds_COUNT
+    };
+    float mChunksBounds[eChunkBounds_COUNT][BlocksBatchCountPadded] {};
+    unsigned int mChunksVisibility[BlocksBatchCount] {}; // bit per culled render view
+
+    // city mesh draw commands range for render view
+    struct CityMeshViewDraws
+    {
+        GameCamera* mRenderView = nullptr;
+        int mCommandsStart = 0;
+        int mCommandsCount = 0;
+        int mChunksCount = 0;
+    };
+    std::vector<CityMeshViewDraws> mCityMeshViewDraws;
+    std::vector<DrawIndexedIndirectCommand> mCityMeshDrawCommands;
+
     GpuBuffer* mCityMeshBufferV;
     GpuBuffer* mCityMeshBufferI;
+    GpuBuffer* mCityMeshBufferCommands = nullptr; // optional, exists if multi draw indirect is supported
+    bool mCityMeshPacked = false; // whether vertex buffer holds CityPackedVertex3D data
+    bool mCityMeshLidsMerged = false; // whether mesh has lids spanning several blocks
 
     SpriteBatch mSpriteBatch;
+    std::vector<GameCamera*> mRenderViews; // current frame render views, index matches sprites view index
 };
\ No newline at end of file
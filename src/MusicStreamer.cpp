@@ -0,0 +1,236 @@
+#include "stdafx.h"
+#include "MusicStreamer.h"
+
+// how long decoding thread waits when ring buffer is full or there is nothing to decode
+static const int DecoderIdleSleepMs = 10;
+
+MusicStreamer::~MusicStreamer()
+{
+    StopStreaming();
+}
+
+bool MusicStreamer::StartStreaming(AudioDataStream* dataStream)
+{
+    StopStreaming();
+
+    if (dataStream == nullptr)
+    {
+        debug_assert(false);
+        return false;
+    }
+
+    mCurrentStream = dataStream;
+    mPendingStreamsCount = 1;
+
+    mReadIndex = 0;
+    mWriteIndex = 0;
+
+    mDecodedChunksCount = 0;
+    mDecodeTotalMicroseconds = 0;
+    mDecodeMaxMicroseconds = 0;
+
+    mStopRequest = false;
+    mDecodingThread = std::thread(&MusicStreamer::DecodingThreadProc, this);
+    return true;
+}
+
+void MusicStreamer::StopStreaming()
+{
+    if (mDecodingThread.joinable())
+    {
+        mStopRequest = true;
+        mDecodingThread.join();
+    }
+
+    DestroyStreams();
+
+    mPendingStreamsCount = 0;
+    mReadIndex = 0;
+    mWriteIndex = 0;
+}
+
+bool MusicStreamer::QueueNextStream(AudioDataStream* dataStream)
+{
+    if ((dataStream == nullptr) || !IsStreaming())
+    {
+        debug_assert(false);
+        return false;
+    }
+
+    // must be counted before stream becomes visible to decoder
+    mPendingStreamsCount.fetch_add(1);
+
+    AudioDataStream* expectedStream = nullptr;
+    if (!mNextStream.compare_exchange_strong(expectedStream, dataStream))
+    {
+        mPendingStreamsCount.fetch_sub(1);
+        return false;
+    }
+    return true;
+}
+
+bool MusicStreamer::IsNextStreamQueued() const
+{
+    return mNextStream.load() != nullptr;
+}
+
+const MusicStreamer::PcmChunk* MusicStreamer::PeekChunk() const
+{
+    unsigned int readIndex = mReadIndex.load(std::memory_order_relaxed);
+    unsigned int writeIndex = mWriteIndex.load(std::memory_order_acquire);
+    if (readIndex == writeIndex)
+        return nullptr;
+
+    return &mChunks[readIndex % RingChunksCount];
+}
+
+void MusicStreamer::PopChunk()
+{
+    unsigned int readIndex = mReadIndex.load(std::memory_order_relaxed);
+    debug_assert(readIndex != mWriteIndex.load(std::memory_order_acquire));
+
+    mReadIndex.store(readIndex + 1, std::memory_order_release);
+}
+
+bool MusicStreamer::IsStreaming() const
+{
+    return mDecodingThread.joinable();
+}
+
+bool MusicStreamer::IsEndOfStream() const
+{
+    // decoder publishes last chunk before stream is marked as finished
+    if (mPendingStreamsCount.load() > 0)
+        return false;
+
+    return GetBufferedChunksCount() == 0;
+}
+
+int MusicStreamer::GetBufferedChunksCount() const
+{
+    unsigned int writeIndex = mWriteIndex.load(std::memory_order_acquire);
+    unsigned int readIndex = mReadIndex.load(std::memory_order_acquire);
+    return (int) (writeIndex - readIndex);
+}
+
+float MusicStreamer::GetAverageDecodeMs() const
+{
+    int chunksCount = mDecodedChunksCount.load();
+    if (chunksCount == 0)
+        return 0.0f;
+
+    return (mDecodeTotalMicroseconds.load() / 1000.0f) / chunksCount;
+}
+
+float MusicStreamer::GetMaxDecodeMs() const
+{
+    return mDecodeMaxMicroseconds.load() / 1000.0f;
+}
+
+void MusicStreamer::DecodingThreadProc()
+{
+    while (!mStopRequest.load())
+    {
+        unsigned int writeIndex = mWriteIndex.load(std::memory_order_relaxed);
+        unsigned int readIndex = mReadIndex.load(std::memory_order_acquire);
+        if ((writeIndex - readIndex) >= RingChunksCount)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(DecoderIdleSleepMs));
+            continue;
+        }
+
+        PcmChunk& chunk = mChunks[writeIndex % RingChunksCount];
+
+        auto decodeStartTime = std::chrono::steady_clock::now();
+
+        int finishedStreamsCount = 0;
+        bool hasDecodedData = DecodeChunk(chunk, finishedStreamsCount);
+        if (hasDecodedData)
+        {
+            long long decodeMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - decodeStartTime).count();
+
+            mDecodeTotalMicroseconds.fetch_add(decodeMicroseconds);
+            if (decodeMicroseconds > mDecodeMaxMicroseconds.load())
+            {
+                mDecodeMaxMicroseconds = decodeMicroseconds;
+            }
+            mDecodedChunksCount.fetch_add(1);
+
+            mWriteIndex.store(writeIndex + 1, std::memory_order_release);
+        }
+
+        if (finishedStreamsCount > 0)
+        {
+            mPendingStreamsCount.fetch_sub(finishedStreamsCount);
+        }
+
+        if (!hasDecodedData)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(DecoderIdleSleepMs));
+        }
+    }
+}
+
+bool MusicStreamer::DecodeChunk(PcmChunk& chunk, int& finishedStreamsCount)
+{
+    chunk.mDataLength = 0;
+
+    for (;;)
+    {
+        if (mCurrentStream == nullptr)
+        {
+            mCurrentStream = mNextStream.exchange(nullptr);
+            if (mCurrentStream == nullptr)
+                break;
+        }
+
+        MusicPcmFormat streamFormat;
+        streamFormat.mSampleRate = mCurrentStream->GetSampleRate();
+        streamFormat.mSampleBits = mCurrentStream->GetSampleBits();
+        streamFormat.mChannelsCount = mCurrentStream->GetChannelsCount();
+
+        int bytesPerSample = streamFormat.mChannelsCount * (streamFormat.mSampleBits / 8);
+        if (bytesPerSample <= 0)
+        {
+            // broken stream
+            SafeDelete(mCurrentStream);
+            ++finishedStreamsCount;
+            continue;
+        }
+
+        if (chunk.mDataLength == 0)
+        {
+            chunk.mFormat = streamFormat;
+        }
+        else if (chunk.mFormat != streamFormat)
+        {
+            // next track will start with new chunk
+            break;
+        }
+
+        int samplesToRead = (ChunkDataSize - chunk.mDataLength) / bytesPerSample;
+        if (samplesToRead == 0)
+            break;
+
+        int samplesRead = mCurrentStream->ReadPCMSamples(samplesToRead, chunk.mData + chunk.mDataLength);
+        chunk.mDataLength += samplesRead * bytesPerSample;
+
+        if ((samplesRead < samplesToRead) || mCurrentStream->EndOfStream())
+        {
+            // continue with next stream to fill the rest of chunk without gap
+            SafeDelete(mCurrentStream);
+            ++finishedStreamsCount;
+        }
+    }
+
+    return chunk.mDataLength > 0;
+}
+
+void MusicStreamer::DestroyStreams()
+{
+    SafeDelete(mCurrentStream);
+
+    AudioDataStream* nextStream = mNextStream.exchange(nullptr);
+    SafeDelete(nextStream);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "AudioDataStream.h"
+
+// Pcm data format of decoded music chunk
+struct MusicPcmFormat
+{
+public:
+    inline bool operator == (const MusicPcmFormat& rhs) const
+    {
+        return (mSampleRate == rhs.mSampleRate) && (mSampleBits == rhs.mSampleBits) && (mChannelsCount == rhs.mChannelsCount);
+    }
+    inline bool operator != (const MusicPcmFormat& rhs) const
+    {
+        return !(*this == rhs);
+    }
+public:
+    int mSampleRate = 0;
+    int mSampleBits = 0;
+    int mChannelsCount = 0;
+};
+
+// Decodes music streams on dedicated thread into single-producer/single-consumer lock-free ring buffer
+// Game thread only takes decoded chunks and hands them to audio source
+// Next stream can be queued in advance, it will be decoded right after current one without gap
+class MusicStreamer final: public cxx::noncopyable
+{
+public:
+    static const int ChunkDataSize = 32768;
+    static const int RingChunksCount = 8;
+
+    // Decoded pcm data
+    struct PcmChunk
+    {
+        MusicPcmFormat mFormat;
+        int mDataLength = 0;
+        unsigned char mData[ChunkDataSize];
+    };
+
+public:
+    ~MusicStreamer();
+
+    // Start decoding thread, ownership of data stream is transferred to streamer
+    // @param dataStream: Music stream
+    bool StartStreaming(AudioDataStream* dataStream);
+
+    // Stop decoding thread and destroy all active streams, decoded data is discarded
+    void StopStreaming();
+
+    // Set stream which will be decoded after current one
+    // Ownership of data stream is transferred to streamer only on success
+    // @param dataStream: Music stream
+    bool QueueNextStream(AudioDataStream* dataStream);
+    bool IsNextStreamQueued() const;
+
+    // Get oldest decoded chunk, consumer side
+    // @returns nullptr if ring buffer is empty
+    const PcmChunk* PeekChunk() const;
+    // Release oldest decoded chunk so it can be reused by decoder
+    void PopChunk();
+
+    bool IsStreaming() const;
+    // All streams are decoded and there is no decoded data left
+    bool IsEndOfStream() const;
+
+    int GetBufferedChunksCount() const;
+    // Get chunk decoding time stats, in milliseconds
+    float GetAverageDecodeMs() const;
+    float GetMaxDecodeMs() const;
+
+private:
+    void DecodingThreadProc();
+
+    // Read next portion of pcm data from active streams
+    // @param chunk: Output chunk
+    // @param finishedStreamsCount: Output number of streams that reached end
+    // @returns false if there is no data decoded
+    bool DecodeChunk(PcmChunk& chunk, int& finishedStreamsCount);
+
+    void DestroyStreams();
+
+private:
+    std::thread mDecodingThread;
+    std::atomic<bool> mStopRequest { false };
+
+    // owned by decoding thread
+    AudioDataStream* mCurrentStream = nullptr;
+
+    std::atomic<AudioDataStream*> mNextStream { nullptr };
+    std::atomic<int> mPendingStreamsCount { 0 }; // started or queued streams that are not fully decoded yet
+
+    // ring buffer, chunk indices are growing monotonically
+    PcmChunk mChunks[RingChunksCount];
+    std::atomic<unsigned int> mReadIndex { 0 };
+    std::atomic<unsigned int> mWriteIndex { 0 };
+
+    // stats
+    std::atomic<int> mDecodedChunksCount { 0 };
+    std::atomic<long long> mDecodeTotalMicroseconds { 0 };
+    std::atomic<long long> mDecodeMaxMicroseconds { 0 };
+};
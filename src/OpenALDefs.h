@@ -24,6 +24,10 @@
     #define alCheckError()
 #endif
 
+// AL_SOFT_deferred_updates extension entry points
+typedef void (AL_APIENTRY* ALDeferUpdatesProc)(void);
+typedef void (AL_APIENTRY* ALProcessUpdatesProc)(void);
+
 // resets current openal error code
 inline void alClearError()
 {
@@ -41,4 +45,5 @@ public:
 public:
     int mMaxSourcesMono = 0;
     int mMaxSourcesStereo = 0;
+    bool mDeferredUpdates = false; // AL_SOFT_deferred_updates
 };
@@ -40,6 +40,9 @@ inline GLenum EnumToGL(eBufferContent bufferContent)
     {
         case eBufferContent_Vertices: return GL_ARRAY_BUFFER;
         case eBufferContent_Indices: return GL_ELEMENT_ARRAY_BUFFER;
+#ifndef __EMSCRIPTEN__
+        case eBufferContent_DrawIndirect: return GL_DRAW_INDIRECT_BUFFER;
+#endif
         default: break;
     }
     debug_assert(false);
@@ -95,10 +98,12 @@ inline GLuint GetTextureInputFormatGL(eTextureFormat textureFormat)
         case eTextureFormat_R8_G8: return GL_RG;
         case eTextureFormat_RGB8: return GL_RGB;
         case eTextureFormat_RGBA8: return GL_RGBA;
-        case eTextureFormat_RGBA8UI:
         case eTextureFormat_R16UI: 
         case eTextureFormat_R8UI:
             return GL_RED_INTEGER;
+        case eTextureFormat_RGBA8UI:
+        case eTextureFormat_RGBA16UI:
+            return GL_RGBA_INTEGER;
         default: break;
     }
     debug_assert(false);
@@ -116,6 +121,7 @@ inline GLint GetTextureInternalFormatGL(eTextureFormat textureFormat)
         case eTextureFormat_R16UI: return GL_R16UI;
         case eTextureFormat_R8UI: return GL_R8UI;
         case eTextureFormat_RGBA8UI: return GL_RGBA8UI;
+        case eTextureFormat_RGBA16UI: return GL_RGBA16UI;
         default: break;
     }
     debug_assert(false);
@@ -135,6 +141,7 @@ inline GLenum GetTextureDataTypeGL(eTextureFormat textureFormat)
             return GL_UNSIGNED_BYTE;
 
         case eTextureFormat_R16UI: 
+        case eTextureFormat_RGBA16UI:
             return GL_UNSIGNED_SHORT;
 
         default: break;
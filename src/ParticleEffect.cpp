@@ -234,7 +234,7 @@ bool ParticleEffect::UpdateParticle(Particle& particle, float deltaTime)
 
 void ParticleEffect::SpawnParticle(Particle& particle)
 {
-    cxx::randomizer& random = gCarnageGame.mGameRand;
+    cxx::randomizer& random = gCarnageGame.GetRandStream(eGameRandStream_Effects);
 
     particle.mAge = 0.0f;
     particle.mState = eParticleState_Alive;
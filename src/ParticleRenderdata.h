@@ -1,6 +1,6 @@
 #pragma once
 
-#include "GpuBuffer.h"
+#include "GpuRingBuffer.h"
 
 // Renderdata is associated with particle effect instance
 class ParticleRenderdata final: public cxx::noncopyable
@@ -11,9 +11,7 @@ public:
     void Invalidate();
     void ResetInvalidated();
 private:
-    bool PrepareVertexbuffer(int vertexbufferSize);
-    void DestroyVertexbuffer();
-private:
-    GpuBuffer* mVertexBuffer = nullptr;
+    GpuBufferRange mVertices; // allocated in streaming buffer
+    unsigned int mVerticesFrame = 0; // streaming buffer frame when vertices were uploaded
     bool mIsInvalidated = false;
 };
\ No newline at end of file
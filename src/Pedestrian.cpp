@@ -47,7 +47,7 @@ void Pedestrian::HandleSpawn()
     if (pedestrianInfo.mRemapType == ePedestrianRemapType_RandomCivilian)
     {
         // todo: find out correct civilian peds indices
-        SetRemap(gCarnageGame.mGameRand.generate_int(0, MAX_PED_REMAPS - 1));
+        SetRemap(gCarnageGame.GetRandStream(eGameRandStream_Objects).generate_int(0, MAX_PED_REMAPS - 1));
     }
 
     mCurrentStateTime = 0.0f;
@@ -154,6 +154,30 @@ void Pedestrian::UpdateFrame()
         SetSprite(mCurrentAnimState.GetSpriteIndex());
     }
 
+    UpdateWeapons();
+
+    mCurrentStateTime += deltaTime;
+
+    UpdateDamageFromRailways();
+
+    // update current state logic
+    mStatesManager.ProcessFrame();
+    
+    UpdateBurnEffect();
+    UpdateDrawOrder();
+}
+
+void Pedestrian::UpdateWeapons()
+{
+    // standing or walking peds don't use weapons unless shooting or changing weapon,
+    // reloading state is only depends on last fire time so it gets caught up on next update
+    ePedestrianState currState = GetCurrentStateID();
+    if ((currState == ePedestrianState_StandingStill || currState == ePedestrianState_Walks) && 
+        (mCurrentWeapon == mChangeWeapon) && !GetCtlState().mShoot)
+    {
+        return;
+    }
+
     // update weapons state
     for (Weapon& currWeapon: mWeapons)
     {
@@ -171,16 +195,6 @@ void Pedestrian::UpdateFrame()
             mStatesManager.ProcessEvent(evData);
         }
     }
-
-    mCurrentStateTime += deltaTime;
-
-    UpdateDamageFromRailways();
-
-    // update current state logic
-    mStatesManager.ProcessFrame();
-    
-    UpdateBurnEffect();
-    UpdateDrawOrder();
 }
 
 void Pedestrian::SimulationStep()
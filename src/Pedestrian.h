@@ -152,6 +152,7 @@ private:
     void UpdateBurnEffect();
     void UpdateDamageFromRailways();
     void UpdateDrawOrder();
+    void UpdateWeapons();
 
     void UpdateLocomotion();
     void UpdateRotation();
@@ -655,7 +655,7 @@ void PedestrianStatesManager::StateIdle_ProcessFrame()
     // do special sounds :)
     if (ctlState.mSpecial)
     {
-        SfxSampleIndex specialSound = gCarnageGame.mGameRand.random_chance(50) ? SfxLevel_SpecialSound1 : SfxLevel_SpecialSound2;
+        SfxSampleIndex specialSound = gCarnageGame.GetRandStream(eGameRandStream_Audio).random_chance(50) ? SfxLevel_SpecialSound1 : SfxLevel_SpecialSound2;
         mPedestrian->StartGameObjectSound(ePedSfxChannelIndex_Voice, eSfxSampleType_Level, specialSound, SfxFlags_RandomPitch);
     }
 
@@ -9,6 +9,7 @@ class PhysicsBody final: public cxx::noncopyable
 {
     friend class PhysicsManager;
     friend class Collider;
+    friend class VehicleDynamics;
 
 public:    
     // readonly
@@ -108,4 +109,8 @@ public:
 private:
     PhysicsBodyFlags mBodyFlags = PhysicsBodyFlags_None;
     b2Body* mBox2Body = nullptr;
+
+    // map layer which walls body collides with, evaluated once per simulation step
+    int mMapLayer = 0;
+    unsigned int mMapLayerStepIndex = 0;
 };
@@ -16,8 +16,19 @@
 
 //////////////////////////////////////////////////////////////////////////
 
+CvarInt gCvarPhysicsThreads("g_physicsThreads", 0, "Max threads for per-body physics step phases, 0 uses all hardware threads", CvarFlags_Archive);
+CvarInt gCvarPhysicsMaxSubsteps("g_physicsMaxSubsteps", 4, "Max physics steps per frame, rest of frame time is dropped", CvarFlags_Archive);
+CvarFloat gCvarPhysicsFrameBudget("g_physicsFrameBudgetMs", 12.0f, "Stop physics catch-up when steps took longer than that per frame, 0 disables", CvarFlags_Archive);
+CvarBoolean gCvarPhysicsBatchedVehicles("g_physicsBatchedVehicles", true, "Process vehicles tire model for all cars at once", CvarFlags_Archive);
+CvarInt gCvarPhysicsAdaptiveStepBodies("g_physicsAdaptiveStepBodies", 0, "Double physics step time when bodies count exceeds this value, 0 disables", CvarFlags_Archive);
+
+//////////////////////////////////////////////////////////////////////////
+
 static cxx::object_pool<PhysicsBody> gPhysicsBodiesPool;
 
+// bodies ranges smaller than that are not split between threads
+static const int ParallelStepMinBodies = 64;
+
 //////////////////////////////////////////////////////////////////////////
 
 union b2FixtureData_map
@@ -27,9 +38,11 @@ union b2FixtureData_map
     {
     }
 
+    // wall rectangle in map blocks, inclusive
     struct
     {
-        unsigned char mX, mZ;
+        unsigned char mMinX, mMinZ;
+        unsigned char mMaxX, mMaxZ;
     };
 
     void* mAsPointer;
@@ -45,12 +58,28 @@ inline bool CheckCollisionGroup(const b2Fixture* fixture, CollisionGroup collisi
     return (filterData.categoryBits & collisionGroup) > 0;
 }
 
+// building block is a wall if pedestrians or cars can get next to it, inner blocks are ignored
+inline bool IsMapWallBlock(int x, int z, int layer)
+{
+    auto is_walkable = [](eGroundType gtype)
+    {
+        return gtype == eGroundType_Field || gtype == eGroundType_Pawement || gtype == eGroundType_Road;
+    };
+
+    if (gGameMap.GetBlockInfo(x, z, layer)->mGroundType != eGroundType_Building)
+        return false;
+
+    return is_walkable(gGameMap.GetBlockInfo(x + 1, z, layer)->mGroundType) || is_walkable(gGameMap.GetBlockInfo(x - 1, z, layer)->mGroundType) ||
+        is_walkable(gGameMap.GetBlockInfo(x, z - 1, layer)->mGroundType) || is_walkable(gGameMap.GetBlockInfo(x, z + 1, layer)->mGroundType);
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 PhysicsManager gPhysics;
 
 PhysicsManager::PhysicsManager()
-    : mBox2MapBody()
+    : mBox2MapLayers()
+    , mBox2MapColumns()
     , mBox2World()
     , mGravity()
 {
@@ -61,34 +90,83 @@ void PhysicsManager::EnterWorld()
     b2Vec2 gravity {0.0f, 0.0f};
     mBox2World = new b2World(gravity);
     mBox2World->SetContactListener(this);
+    mBox2World->SetContactFilter(this);
 
-    mSimulationStepTime = 1.0f / std::max(gCvarPhysicsFramerate.mValue, 1.0f);
+    mBaseSimulationStepTime = 1.0f / std::max(gCvarPhysicsFramerate.mValue, 1.0f);
+    mSimulationStepTime = mBaseSimulationStepTime;
+    mSimulationTimeAccumulator = 0.0f;
     mGravity = Convert::MapUnitsToMeters(0.5f);
 
+    mWorldStats = PhysicsWorldStats();
+
     CreateMapCollisionShape();
 }
 
 void PhysicsManager::ClearWorld()
 {
-    if (mBox2MapBody)
-    {
-        mBox2World->DestroyBody(mBox2MapBody);
-        mBox2MapBody = nullptr;
-    }
+    DestroyMapCollisionShape();
     SafeDelete(mBox2World);
 }
 
 void PhysicsManager::UpdateFrame()
 {
-    mSimulationTimeAccumulator += gTimeManager.mGameFrameDelta;
+    ProcessFrameSteps(gTimeManager.mGameFrameDelta);
+    ProcessInterpolation();
+}
+
+void PhysicsManager::ProcessFrameSteps(float frameDelta)
+{
+    // with lots of bodies simulation runs at half rate
+    float prevStepTime = mSimulationStepTime;
+    mSimulationStepTime = mBaseSimulationStepTime;
+    if ((gCvarPhysicsAdaptiveStepBodies.mValue > 0) && ((int) mBodiesList.size() > gCvarPhysicsAdaptiveStepBodies.mValue))
+    {
+        mSimulationStepTime = mBaseSimulationStepTime * 2.0f;
+    }
+    if (prevStepTime != mSimulationStepTime)
+    {
+        // keep interpolation factor
+        mSimulationTimeAccumulator = (mSimulationTimeAccumulator / prevStepTime) * mSimulationStepTime;
+    }
+
+    mSimulationTimeAccumulator += frameDelta;
+
+    int maxSubsteps = std::max(gCvarPhysicsMaxSubsteps.mValue, 1);
+    double frameBudgetSeconds = gCvarPhysicsFrameBudget.mValue / 1000.0;
+    if (gTimeManager.IsFixedGameFrameDelta())
+    {
+        // steps dropped by real time budget would differ between runs
+        frameBudgetSeconds = 0.0;
+    }
+    double stepsStartTime = gSystem.GetSystemSeconds();
+    double stepsTime = 0.0;
 
+    int substepsCount = 0;
+    float droppedTime = 0.0f;
     while (mSimulationTimeAccumulator >= mSimulationStepTime)
     {
+        // catch-up limit reached, drop the rest of time so simulation runs slower than real time instead
+        // of spending even more time on next frame
+        if ((substepsCount == maxSubsteps) || ((frameBudgetSeconds > 0.0) && (stepsTime > frameBudgetSeconds)))
+        {
+            droppedTime = mSimulationTimeAccumulator - fmodf(mSimulationTimeAccumulator, mSimulationStepTime);
+            mSimulationTimeAccumulator -= droppedTime;
+            mWorldStats.mDroppedTime += droppedTime;
+            ++mWorldStats.mCatchUpLimitHits;
+            break;
+        }
+
         ProcessSimulationStep();
         mSimulationTimeAccumulator -= mSimulationStepTime;
+
+        ++substepsCount;
+        stepsTime = gSystem.GetSystemSeconds() - stepsStartTime;
     }
 
-    ProcessInterpolation();
+    mWorldStats.mFrameSubsteps = substepsCount;
+    mWorldStats.mFrameStepsTimeMs = (float) (stepsTime * 1000.0);
+    mWorldStats.mSimulationStepTimeMs = mSimulationStepTime * 1000.0f;
+    mWorldStats.mTimeDilation = (frameDelta > 0.0f) ? std::max((frameDelta - droppedTime) / frameDelta, 0.0f) : 1.0f;
 }
 
 void PhysicsManager::ProcessSimulationStep()
@@ -96,16 +174,20 @@ void PhysicsManager::ProcessSimulationStep()
     const int velocityIterations = 6;
     const int positionIterations = 4;
 
-    // fixed update
-    for (size_t i = 0, NumElements = mBodiesList.size(); i < NumElements; ++i)
+    int threadsCount = (mWorkerThreadsLimit > 0) ? mWorkerThreadsLimit : gCvarPhysicsThreads.mValue;
+    if ((threadsCount <= 0) || (threadsCount > gWorkerPool.get_threads_count()))
     {
-        PhysicsBody* currObjectBody = mBodiesList[i];
-        if (!currObjectBody->CheckFlags(PhysicsBodyFlags_Disabled))
-        {
-            GameObject* currGameObject = currObjectBody->mGameObject;
-            currGameObject->SimulationStep();
-        }
+        threadsCount = gWorkerPool.get_threads_count();
     }
+    mWorldStats.mWorkerThreadsCount = threadsCount;
+
+    double bodiesPhaseTime = 0.0;
+    double phaseStartTime = gSystem.GetSystemSeconds();
+
+    // fixed update
+    ProcessBodiesSimulationStep(threadsCount);
+
+    bodiesPhaseTime += (gSystem.GetSystemSeconds() - phaseStartTime);
 
     // drop old contacts before new simulation frame
     for (PhysicsBody* currObjectBody: mBodiesList)
@@ -115,18 +197,39 @@ void PhysicsManager::ProcessSimulationStep()
         currGameObject->ClearContacts();
     }
 
-    mBox2World->Step(mSimulationStepTime, velocityIterations, positionIterations);
+    ++mSimulationStepIndex;
 
-    // process y position
+    // pairs with map walls are filtered by layer, so bodies which moved to another layer get them filtered again
     for (PhysicsBody* currObjectBody: mBodiesList)
     {
-        GameObject* currGameObject = currObjectBody->mGameObject;
-        if (currGameObject->IsAttachedToObject() || currObjectBody->CheckFlags(PhysicsBodyFlags_Disabled))
+        if (currObjectBody->CheckFlags(PhysicsBodyFlags_Disabled))
+            continue;
+
+        int prevMapLayer = currObjectBody->mMapLayer;
+        if (GetMapLayer(currObjectBody) == prevMapLayer)
             continue;
 
-        UpdateHeightPosition(currObjectBody);
+        for (b2Fixture* currFixture = currObjectBody->mBox2Body->GetFixtureList(); currFixture; currFixture = currFixture->GetNext())
+        {
+            currFixture->Refilter();
+        }
     }
 
+    double stepStartTime = gSystem.GetSystemSeconds();
+    mBox2World->Step(mSimulationStepTime, velocityIterations, positionIterations);
+
+    mWorldStats.mStepTimeMs = (float) ((gSystem.GetSystemSeconds() - stepStartTime) * 1000.0);
+    mWorldStats.mBodiesCount = mBox2World->GetBodyCount();
+    mWorldStats.mProxiesCount = mBox2World->GetProxyCount();
+    mWorldStats.mContactsCount = mBox2World->GetContactCount();
+
+    // process y position
+    phaseStartTime = gSystem.GetSystemSeconds();
+    UpdateHeightPositions(threadsCount);
+
+    bodiesPhaseTime += (gSystem.GetSystemSeconds() - phaseStartTime);
+    mWorldStats.mBodiesPhaseTimeMs = (float) (bodiesPhaseTime * 1000.0);
+
     DispatchCollisionEvents();
 
     // sync transform
@@ -140,6 +243,309 @@ void PhysicsManager::ProcessSimulationStep()
     }
 }
 
+void PhysicsManager::ProcessBodiesSimulationStep(int threadsCount)
+{
+    mParallelStepBodies.clear();
+
+    // objects that may affect other objects are processed in bodies order
+    for (size_t i = 0, NumElements = mBodiesList.size(); i < NumElements; ++i)
+    {
+        PhysicsBody* currObjectBody = mBodiesList[i];
+        if (currObjectBody->CheckFlags(PhysicsBodyFlags_Disabled))
+            continue;
+
+        GameObject* currGameObject = currObjectBody->mGameObject;
+        if (currGameObject->IsVehicleClass())
+        {
+            mParallelStepBodies.push_back(currObjectBody);
+            continue;
+        }
+        currGameObject->SimulationStep();
+    }
+
+    if (gCvarPhysicsBatchedVehicles.mValue)
+    {
+        mVehicleDynamics.ProcessVehicles(mParallelStepBodies, gWorkerPool, threadsCount);
+        return;
+    }
+
+    // vehicle only applies forces to its own body and reads driver controls,
+    // so each one is independent island and can be processed on any thread
+    gWorkerPool.parallel_for((int) mParallelStepBodies.size(), ParallelStepMinBodies, threadsCount, [this](int ibegin, int iend)
+    {
+        for (int ibody = ibegin; ibody < iend; ++ibody)
+        {
+            mParallelStepBodies[ibody]->mGameObject->SimulationStep();
+        }
+    });
+}
+
+void PhysicsManager::UpdateHeightPositions(int threadsCount)
+{
+    // ground queries only read map data so they are done in parallel,
+    // results are applied in bodies order since falling events may touch other objects
+    int bodiesCount = (int) mBodiesList.size();
+    mBodiesGroundHeight.resize(bodiesCount);
+
+    gWorkerPool.parallel_for(bodiesCount, ParallelStepMinBodies, threadsCount, [this](int ibegin, int iend)
+    {
+        for (int ibody = ibegin; ibody < iend; ++ibody)
+        {
+            PhysicsBody* currObjectBody = mBodiesList[ibody];
+            if (currObjectBody->mGameObject->IsAttachedToObject() || currObjectBody->CheckFlags(PhysicsBodyFlags_Disabled) ||
+                currObjectBody->mWaterContact)
+            {
+                continue;
+            }
+            mBodiesGroundHeight[ibody] = gGameMap.GetHeightAtPosition(currObjectBody->GetPosition(), false);
+        }
+    });
+
+    for (int ibody = 0; ibody < bodiesCount; ++ibody)
+    {
+        PhysicsBody* currObjectBody = mBodiesList[ibody];
+        GameObject* currGameObject = currObjectBody->mGameObject;
+        if (currGameObject->IsAttachedToObject() || currObjectBody->CheckFlags(PhysicsBodyFlags_Disabled))
+            continue;
+
+        UpdateHeightPosition(currObjectBody, mBodiesGroundHeight[ibody]);
+    }
+}
+
+void PhysicsManager::RunStepBenchmark(int stepsCount)
+{
+    stepsCount = std::max(stepsCount, 1);
+
+    int maxThreadsCount = gWorkerPool.get_threads_count();
+    gConsole.LogMessage(eLogMessage_Info, "Physics step benchmark: %d bodies, %d steps, up to %d threads",
+        (int) mBodiesList.size(), stepsCount, maxThreadsCount);
+
+    double singleThreadStepTime = 0.0;
+    for (int ithreads = 1; ithreads <= maxThreadsCount; ++ithreads)
+    {
+        mWorkerThreadsLimit = ithreads;
+
+        double bodiesPhaseTime = 0.0;
+        double startTime = gSystem.GetSystemSeconds();
+        for (int istep = 0; istep < stepsCount; ++istep)
+        {
+            ProcessSimulationStep();
+            bodiesPhaseTime += mWorldStats.mBodiesPhaseTimeMs;
+        }
+        double stepTime = ((gSystem.GetSystemSeconds() - startTime) * 1000.0) / stepsCount;
+        if (ithreads == 1)
+        {
+            singleThreadStepTime = stepTime;
+        }
+
+        gConsole.LogMessage(eLogMessage_Info, " - threads %d: step %.3f ms, per-body phases %.3f ms, speedup %.2fx", ithreads,
+            stepTime, bodiesPhaseTime / stepsCount, (stepTime > 0.0) ? (singleThreadStepTime / stepTime) : 1.0);
+    }
+    mWorkerThreadsLimit = 0;
+}
+
+void PhysicsManager::RunMapShapesBenchmark(int stepsCount)
+{
+    stepsCount = std::max(stepsCount, 1);
+
+    gConsole.LogMessage(eLogMessage_Info, "Map shapes benchmark: %d bodies, %d steps", (int) mBodiesList.size(), stepsCount);
+
+    auto measureSteps = [this, stepsCount](const char* layoutName, int shapesCount)
+    {
+        double worldStepTime = 0.0;
+        long long pairsCount = 0;
+        for (int istep = 0; istep < stepsCount; ++istep)
+        {
+            ProcessSimulationStep();
+            worldStepTime += mWorldStats.mStepTimeMs;
+            pairsCount += mWorldStats.mContactsCount;
+        }
+        gConsole.LogMessage(eLogMessage_Info, " - %s: %d shapes, %d proxies, %.1f broadphase pairs, world step %.3f ms", layoutName,
+            shapesCount, mWorldStats.mProxiesCount, (double) pairsCount / stepsCount, worldStepTime / stepsCount);
+    };
+
+    // layout used before walls were merged, filtered in PreSolve only
+    DestroyMapCollisionShape();
+    CreateMapColumnsCollisionShape();
+    measureSteps("box per block column", mWorldStats.mMapColumnShapes);
+
+    DestroyMapCollisionShape();
+    CreateMapCollisionShape();
+    measureSteps("merged per-layer walls", mWorldStats.mMapShapes);
+}
+
+void PhysicsManager::RunCollisionEventsBenchmark(int stepsCount)
+{
+    stepsCount = std::max(stepsCount, 1);
+
+    long long contactsCount = 0;
+    long long eventsCount = 0;
+    double dispatchTime = 0.0;
+    double startTime = gSystem.GetSystemSeconds();
+    for (int istep = 0; istep < stepsCount; ++istep)
+    {
+        ProcessSimulationStep();
+        contactsCount += mWorldStats.mCollisionContacts;
+        eventsCount += mWorldStats.mCollisionEvents;
+        dispatchTime += mWorldStats.mCollisionDispatchTimeMs / 1000.0;
+    }
+    double stepTime = ((gSystem.GetSystemSeconds() - startTime) * 1000.0) / stepsCount;
+    dispatchTime = std::max(dispatchTime, 0.000001);
+
+    gConsole.LogMessage(eLogMessage_Info, "Collision events benchmark: %d bodies, %d steps, step %.3f ms",
+        (int) mBodiesList.size(), stepsCount, stepTime);
+    gConsole.LogMessage(eLogMessage_Info, "    contacts: %.1f per step, events: %.1f per step (%.2f contacts per event)",
+        (double) contactsCount / stepsCount, (double) eventsCount / stepsCount, (double) contactsCount / std::max(eventsCount, 1LL));
+    gConsole.LogMessage(eLogMessage_Info, "    dispatch: %.3f ms per step, %.0f contacts/sec, %.0f events/sec",
+        (dispatchTime * 1000.0) / stepsCount, contactsCount / dispatchTime, eventsCount / dispatchTime);
+}
+
+void PhysicsManager::RunVehicleDynamicsBenchmark(int iterationsCount)
+{
+    iterationsCount = std::max(iterationsCount, 1);
+
+    std::vector<PhysicsBody*> vehicleBodies;
+    for (PhysicsBody* currBody: mBodiesList)
+    {
+        if (currBody->mGameObject->IsVehicleClass() && !currBody->CheckFlags(PhysicsBodyFlags_Disabled))
+        {
+            vehicleBodies.push_back(currBody);
+        }
+    }
+
+    struct VehicleState
+    {
+        b2Vec2 mLinearVelocity;
+        float mAngularVelocity;
+        float mSteeringAngle;
+    };
+
+    auto saveStates = [&vehicleBodies](std::vector<VehicleState>& states)
+    {
+        states.resize(vehicleBodies.size());
+        for (size_t ibody = 0; ibody < vehicleBodies.size(); ++ibody)
+        {
+            b2Body* box2Body = vehicleBodies[ibody]->mBox2Body;
+            states[ibody].mLinearVelocity = box2Body->GetLinearVelocity();
+            states[ibody].mAngularVelocity = box2Body->GetAngularVelocity();
+            states[ibody].mSteeringAngle = ToVehicle(vehicleBodies[ibody]->mGameObject)->mSteeringAngleRadians;
+        }
+    };
+
+    auto loadStates = [this, &vehicleBodies](const std::vector<VehicleState>& states)
+    {
+        for (size_t ibody = 0; ibody < vehicleBodies.size(); ++ibody)
+        {
+            b2Body* box2Body = vehicleBodies[ibody]->mBox2Body;
+            box2Body->SetLinearVelocity(states[ibody].mLinearVelocity);
+            box2Body->SetAngularVelocity(states[ibody].mAngularVelocity);
+            ToVehicle(vehicleBodies[ibody]->mGameObject)->mSteeringAngleRadians = states[ibody].mSteeringAngle;
+        }
+        mBox2World->ClearForces();
+    };
+
+    std::vector<VehicleState> originalStates;
+    saveStates(originalStates);
+
+    // moving and steering vehicles so that all tire forces are present
+    std::vector<VehicleState> testStates = originalStates;
+    for (size_t ibody = 0; ibody < testStates.size(); ++ibody)
+    {
+        testStates[ibody].mLinearVelocity.Set(8.0f * sinf(ibody * 0.37f), 8.0f * cosf(ibody * 0.71f));
+        testStates[ibody].mAngularVelocity = 2.0f * sinf(ibody * 1.3f);
+        testStates[ibody].mSteeringAngle = 0.3f * sinf(ibody * 0.53f);
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Vehicle dynamics benchmark: %d vehicles available, %d iterations",
+        (int) vehicleBodies.size(), iterationsCount);
+
+    const int VehiclesCounts[] = {50, 200, 500, 1000, 2000};
+
+    std::vector<PhysicsBody*> testBodies;
+    std::vector<VehicleState> referenceStates;
+    std::vector<VehicleState> batchedStates;
+    for (int vehiclesCount: VehiclesCounts)
+    {
+        if (vehiclesCount > (int) vehicleBodies.size())
+            break;
+
+        testBodies.assign(vehicleBodies.begin(), vehicleBodies.begin() + vehiclesCount);
+
+        // per-vehicle model
+        double perVehicleTime = 0.0;
+        for (int iteration = 0; iteration < iterationsCount; ++iteration)
+        {
+            loadStates(testStates);
+            double startTime = gSystem.GetSystemSeconds();
+            for (PhysicsBody* currBody: testBodies)
+            {
+                currBody->mGameObject->SimulationStep();
+            }
+            perVehicleTime += gSystem.GetSystemSeconds() - startTime;
+        }
+        saveStates(referenceStates);
+
+        // batched model, single thread
+        double batchedTime = 0.0;
+        for (int iteration = 0; iteration < iterationsCount; ++iteration)
+        {
+            loadStates(testStates);
+            double startTime = gSystem.GetSystemSeconds();
+            mVehicleDynamics.ProcessVehicles(testBodies, gWorkerPool, 1);
+            batchedTime += gSystem.GetSystemSeconds() - startTime;
+        }
+        saveStates(batchedStates);
+
+        float maxVelocityError = 0.0f;
+        float maxAngularError = 0.0f;
+        float maxSteeringError = 0.0f;
+        for (int ibody = 0; ibody < vehiclesCount; ++ibody)
+        {
+            b2Vec2 velocityDelta = referenceStates[ibody].mLinearVelocity - batchedStates[ibody].mLinearVelocity;
+            maxVelocityError = std::max(maxVelocityError, velocityDelta.Length());
+            maxAngularError = std::max(maxAngularError, fabsf(referenceStates[ibody].mAngularVelocity - batchedStates[ibody].mAngularVelocity));
+            maxSteeringError = std::max(maxSteeringError, fabsf(referenceStates[ibody].mSteeringAngle - batchedStates[ibody].mSteeringAngle));
+        }
+
+        perVehicleTime = (perVehicleTime * 1000.0) / iterationsCount;
+        batchedTime = (batchedTime * 1000.0) / iterationsCount;
+        gConsole.LogMessage(eLogMessage_Info, " - %d vehicles: per-vehicle %.3f ms, batched %.3f ms (x%.2f), max error: velocity %g, angular %g, steering %g",
+            vehiclesCount, perVehicleTime, batchedTime, (batchedTime > 0.0) ? (perVehicleTime / batchedTime) : 1.0,
+            maxVelocityError, maxAngularError, maxSteeringError);
+    }
+
+    loadStates(originalStates);
+}
+
+void PhysicsManager::RunFrameTimeBenchmark(int framesCount, float frameDelta)
+{
+    framesCount = std::max(framesCount, 1);
+
+    PhysicsWorldStats prevStats = mWorldStats;
+
+    double maxFrameTime = 0.0;
+    double totalFrameTime = 0.0;
+    int totalSubsteps = 0;
+    for (int iframe = 0; iframe < framesCount; ++iframe)
+    {
+        double startTime = gSystem.GetSystemSeconds();
+        ProcessFrameSteps(frameDelta);
+
+        double frameTime = gSystem.GetSystemSeconds() - startTime;
+        maxFrameTime = std::max(maxFrameTime, frameTime);
+        totalFrameTime += frameTime;
+        totalSubsteps += mWorldStats.mFrameSubsteps;
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Physics frame benchmark: %d bodies, %d frames of %.1f ms",
+        (int) mBodiesList.size(), framesCount, frameDelta * 1000.0f);
+    gConsole.LogMessage(eLogMessage_Info, " - frame time avg %.3f ms, max %.3f ms",
+        (totalFrameTime * 1000.0) / framesCount, maxFrameTime * 1000.0);
+    float droppedTime = mWorldStats.mDroppedTime - prevStats.mDroppedTime;
+    gConsole.LogMessage(eLogMessage_Info, " - substeps per frame %.2f, dropped time %.3f s, time dilation %.2f",
+        (float) totalSubsteps / framesCount, droppedTime, 1.0f - droppedTime / (framesCount * frameDelta));
+}
+
 PhysicsBody* PhysicsManager::CreateBody(GameObject* gameObject, PhysicsBodyFlags flags)
 {
     debug_assert(!IsSimulationStepInProgress());
@@ -168,76 +574,184 @@ PhysicsBody* PhysicsManager::CreateBody(GameObject* gameObject, const CollisionS
 
 void PhysicsManager::CreateMapCollisionShape()
 {
-    b2BodyDef bodyDef;
-    bodyDef.type = b2_staticBody;
-    bodyDef.userData.pointer = reinterpret_cast<uintptr_t>(nullptr); // make sure userdata is nullptr
+    mWorldStats.mMapShapes = 0;
+    mWorldStats.mMapWallBlocks = 0;
+    mWorldStats.mMapColumnShapes = 0;
+
+    // count boxes which would be created with single box per block column, for comparison
+    for (int y = 0; y < MAP_DIMENSIONS; ++y)
+    {
+        for (int x = 0; x < MAP_DIMENSIONS; ++x)
+        {
+            for (int layer = 0; layer < MAP_LAYERS_COUNT; ++layer)
+            {
+                if (IsMapWallBlock(x, y, layer))
+                {
+                    ++mWorldStats.mMapColumnShapes;
+                    break;
+                }
+            }
+        }
+    }
 
-    mBox2MapBody = mBox2World->CreateBody(&bodyDef);
-    debug_assert(mBox2MapBody);
+    // wall blocks of current layer, cleared as they get covered by shapes
+    std::vector<unsigned char> wallBlocks(MAP_DIMENSIONS * MAP_DIMENSIONS);
 
-    int numFixtures = 0;
-    // for each block create fixture
-    for (int x = 0; x < MAP_DIMENSIONS; ++x)
+    for (int layer = 0; layer < MAP_LAYERS_COUNT; ++layer)
     {
+        b2BodyDef bodyDef;
+        bodyDef.type = b2_staticBody;
+        bodyDef.userData.pointer = reinterpret_cast<uintptr_t>(nullptr); // make sure userdata is nullptr
+
+        mBox2MapLayers[layer] = mBox2World->CreateBody(&bodyDef);
+        debug_assert(mBox2MapLayers[layer]);
+
         for (int y = 0; y < MAP_DIMENSIONS; ++y)
         {
-            for (int layer = 0; layer < MAP_LAYERS_COUNT; ++layer)
+            for (int x = 0; x < MAP_DIMENSIONS; ++x)
             {
-                const MapBlockInfo* blockData = gGameMap.GetBlockInfo(x, y, layer);
-                debug_assert(blockData);
+                bool isWall = IsMapWallBlock(x, y, layer);
 
-                if (blockData->mGroundType != eGroundType_Building)
+                wallBlocks[y * MAP_DIMENSIONS + x] = isWall ? 1 : 0;
+                if (isWall)
+                {
+                    ++mWorldStats.mMapWallBlocks;
+                }
+            }
+        }
+
+        // greedy merge wall blocks into rectangles, first along x then along y
+        for (int y = 0; y < MAP_DIMENSIONS; ++y)
+        {
+            for (int x = 0; x < MAP_DIMENSIONS; ++x)
+            {
+                if (wallBlocks[y * MAP_DIMENSIONS + x] == 0)
                     continue;
 
-                // checek blox is inner
+                int endx = x + 1;
+                while (endx < MAP_DIMENSIONS && wallBlocks[y * MAP_DIMENSIONS + endx])
                 {
-                    const MapBlockInfo* neighbourE = gGameMap.GetBlockInfo(x + 1, y, layer);
-                    const MapBlockInfo* neighbourW = gGameMap.GetBlockInfo(x - 1, y, layer);
-                    const MapBlockInfo* neighbourN = gGameMap.GetBlockInfo(x, y - 1, layer);
-                    const MapBlockInfo* neighbourS = gGameMap.GetBlockInfo(x, y + 1, layer);
-
-                    auto is_walkable = [](eGroundType gtype)
-                    {
-                        return gtype == eGroundType_Field || gtype == eGroundType_Pawement || gtype == eGroundType_Road;
-                    };
-
-                    if (!is_walkable(neighbourE->mGroundType) && !is_walkable(neighbourW->mGroundType) &&
-                        !is_walkable(neighbourN->mGroundType) && !is_walkable(neighbourS->mGroundType))
-                    {
-                        continue; // just ignore this block
-                    }
+                    ++endx;
                 }
 
-                b2PolygonShape b2shapeDef;
-
-                glm::vec2 shapeCenter (x + 0.5f, y + 0.5f);
-                shapeCenter = Convert::MapUnitsToMeters(shapeCenter);
+                int endy = y + 1;
+                for (; endy < MAP_DIMENSIONS; ++endy)
+                {
+                    const unsigned char* rowBlocks = &wallBlocks[endy * MAP_DIMENSIONS];
+                    if (std::find(rowBlocks + x, rowBlocks + endx, 0) != rowBlocks + endx)
+                        break;
+                }
 
-                glm::vec2 shapeLength (0.5f, 0.5f);
-                shapeLength = Convert::MapUnitsToMeters(shapeLength);
+                for (int iy = y; iy < endy; ++iy)
+                {
+                    std::fill_n(&wallBlocks[iy * MAP_DIMENSIONS + x], endx - x, 0);
+                }
 
-                b2shapeDef.SetAsBox(shapeLength.x, shapeLength.y, convert_vec2(shapeCenter), 0.0f);
+                CreateMapWallFixture(mBox2MapLayers[layer], x, y, endx, endy);
+                ++mWorldStats.mMapShapes;
+            }
+        }
+    }
 
-                b2FixtureData_map fixtureData;
-                fixtureData.mX = x;
-                fixtureData.mZ = y;
+    gConsole.LogMessage(eLogMessage_Info, "Map collision: %d wall blocks merged into %d shapes (%d with box per block column)",
+        mWorldStats.mMapWallBlocks, mWorldStats.mMapShapes, mWorldStats.mMapColumnShapes);
+}
 
-                b2FixtureDef b2fixtureDef;
-                b2fixtureDef.density = 0.0f;
-                b2fixtureDef.shape = &b2shapeDef;
-                b2fixtureDef.userData.pointer = reinterpret_cast<uintptr_t>(fixtureData.mAsPointer);
-                b2fixtureDef.filter.categoryBits = CollisionGroup_MapBlock;
+void PhysicsManager::CreateMapColumnsCollisionShape()
+{
+    b2BodyDef bodyDef;
+    bodyDef.type = b2_staticBody;
+    bodyDef.userData.pointer = reinterpret_cast<uintptr_t>(nullptr); // make sure userdata is nullptr
 
-                b2Fixture* b2fixture = mBox2MapBody->CreateFixture(&b2fixtureDef);
-                debug_assert(b2fixture);
+    mBox2MapColumns = mBox2World->CreateBody(&bodyDef);
+    debug_assert(mBox2MapColumns);
 
-                ++numFixtures;
-                break; // single fixture per block column
+    // single box per block column which has wall on any layer, layer is checked on contact
+    for (int y = 0; y < MAP_DIMENSIONS; ++y)
+    {
+        for (int x = 0; x < MAP_DIMENSIONS; ++x)
+        {
+            for (int layer = 0; layer < MAP_LAYERS_COUNT; ++layer)
+            {
+                if (IsMapWallBlock(x, y, layer))
+                {
+                    CreateMapWallFixture(mBox2MapColumns, x, y, x + 1, y + 1);
+                    break;
+                }
             }
         }
     }
 }
 
+void PhysicsManager::CreateMapWallFixture(b2Body* mapBody, int minx, int minz, int endx, int endz)
+{
+    b2PolygonShape b2shapeDef;
+
+    glm::vec2 shapeCenter ((minx + endx) * 0.5f, (minz + endz) * 0.5f);
+    shapeCenter = Convert::MapUnitsToMeters(shapeCenter);
+
+    glm::vec2 shapeLength ((endx - minx) * 0.5f, (endz - minz) * 0.5f);
+    shapeLength = Convert::MapUnitsToMeters(shapeLength);
+
+    b2shapeDef.SetAsBox(shapeLength.x, shapeLength.y, convert_vec2(shapeCenter), 0.0f);
+
+    b2FixtureData_map fixtureData;
+    fixtureData.mMinX = minx;
+    fixtureData.mMinZ = minz;
+    fixtureData.mMaxX = endx - 1;
+    fixtureData.mMaxZ = endz - 1;
+
+    b2FixtureDef b2fixtureDef;
+    b2fixtureDef.density = 0.0f;
+    b2fixtureDef.shape = &b2shapeDef;
+    b2fixtureDef.userData.pointer = reinterpret_cast<uintptr_t>(fixtureData.mAsPointer);
+    b2fixtureDef.filter.categoryBits = CollisionGroup_MapBlock;
+
+    b2Fixture* b2fixture = mapBody->CreateFixture(&b2fixtureDef);
+    debug_assert(b2fixture);
+}
+
+void PhysicsManager::DestroyMapCollisionShape()
+{
+    for (b2Body*& mapBody: mBox2MapLayers)
+    {
+        if (mapBody)
+        {
+            mBox2World->DestroyBody(mapBody);
+            mapBody = nullptr;
+        }
+    }
+
+    if (mBox2MapColumns)
+    {
+        mBox2World->DestroyBody(mBox2MapColumns);
+        mBox2MapColumns = nullptr;
+    }
+}
+
+int PhysicsManager::GetMapFixtureLayer(const b2Fixture* mapFixture) const
+{
+    const b2Body* mapBody = mapFixture->GetBody();
+    for (int layer = 0; layer < MAP_LAYERS_COUNT; ++layer)
+    {
+        if (mBox2MapLayers[layer] == mapBody)
+            return layer;
+    }
+    return -1;
+}
+
+int PhysicsManager::GetMapLayer(PhysicsBody* physicsBody) const
+{
+    if (physicsBody->mMapLayerStepIndex != mSimulationStepIndex)
+    {
+        physicsBody->mMapLayerStepIndex = mSimulationStepIndex;
+
+        float height = gGameMap.GetHeightAtPosition(physicsBody->GetPosition());
+        physicsBody->mMapLayer = glm::clamp((int) (Convert::MetersToMapUnits(height) + 0.5f), 0, MAP_LAYERS_COUNT - 1);
+    }
+    return physicsBody->mMapLayer;
+}
+
 void PhysicsManager::DestroyBody(PhysicsBody* physicsBody)
 {
     debug_assert(!IsSimulationStepInProgress());
@@ -272,6 +786,31 @@ void PhysicsManager::EndContact(b2Contact* contact)
     // do nothing
 }
 
+bool PhysicsManager::ShouldCollide(b2Fixture* fixtureA, b2Fixture* fixtureB)
+{
+    if (!b2ContactFilter::ShouldCollide(fixtureA, fixtureB))
+        return false;
+
+    // objects are paired only with walls of the layer where they are located,
+    // walls of other layers never get into narrow phase
+    b2Fixture* objectFixture = fixtureB;
+    int mapLayer = GetMapFixtureLayer(fixtureA);
+    if (mapLayer < 0)
+    {
+        objectFixture = fixtureA;
+        mapLayer = GetMapFixtureLayer(fixtureB);
+    }
+
+    if (mapLayer < 0)
+        return true;
+
+    PhysicsBody* physicsBody = b2Fixture_get_physics_body(objectFixture);
+    if (physicsBody == nullptr)
+        return true;
+
+    return GetMapLayer(physicsBody) == mapLayer;
+}
+
 void PhysicsManager::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
 {
     b2Fixture* fixtureA = contact->GetFixtureA();
@@ -327,7 +866,7 @@ void PhysicsManager::PostSolve(b2Contact* contact, const b2ContactImpulse* impul
     }
 }
 
-void PhysicsManager::UpdateHeightPosition(PhysicsBody* physicsBody)
+void PhysicsManager::UpdateHeightPosition(PhysicsBody* physicsBody, float groundHeight)
 {
     GameObject* gameObject = physicsBody->mGameObject;
     debug_assert(gameObject);
@@ -341,8 +880,6 @@ void PhysicsManager::UpdateHeightPosition(PhysicsBody* physicsBody)
     if (physicsBody->mWaterContact)
         return;
 
-    float groundHeight = gGameMap.GetHeightAtPosition(physicsBody->GetPosition(), false);
-
     float prevHeight = physicsBody->mPositionY;
     if (physicsBody->mFalling)
     {
@@ -481,6 +1018,63 @@ void PhysicsManager::QueryObjectsWithinBox(const glm::vec2& center, const glm::v
     mBox2World->QueryAABB(&query_callback, aabb);
 }
 
+void PhysicsManager::QueryObjectsWithinRadius(const glm::vec2& center, float radius, std::vector<PhysicsBody*>& outputBodies, CollisionGroup collisionMask) const
+{
+    outputBodies.clear();
+
+    collisionMask = collisionMask & ~(CollisionGroup_MapBlock | CollisionGroup_Wall); // ignore map
+    if (collisionMask == CollisionGroup_None)
+        return;
+
+    struct _query_callback: public b2QueryCallback
+    {
+    public:
+        _query_callback(std::vector<PhysicsBody*>& out, const glm::vec2& center, float radius, CollisionGroup collisionMask)
+            : mOutput(out)
+            , mCenter(center)
+            , mRadius2(radius * radius)
+            , mCollisionMask(collisionMask)
+        {
+        }
+        bool ReportFixture(b2Fixture* fixture) override
+        {
+            const b2Filter& filterData = fixture->GetFilterData();
+            if ((filterData.categoryBits & mCollisionMask) > 0)
+            {
+                PhysicsBody* physicsBody = b2Fixture_get_physics_body(fixture);
+                if (physicsBody && (glm::distance2(mCenter, physicsBody->GetPosition2()) < mRadius2))
+                {
+                    mOutput.push_back(physicsBody);
+                }
+            }
+            return true;
+        }
+    public:
+        std::vector<PhysicsBody*>& mOutput;
+        glm::vec2 mCenter;
+        float mRadius2;
+        CollisionGroup mCollisionMask;
+    };
+    _query_callback query_callback {outputBodies, center, radius, collisionMask};
+
+    b2AABB aabb;
+    aabb.lowerBound.x = (center.x - radius);
+    aabb.lowerBound.y = (center.y - radius);
+    aabb.upperBound.x = (center.x + radius);
+    aabb.upperBound.y = (center.y + radius);
+    mBox2World->QueryAABB(&query_callback, aabb);
+
+    // body with multiple colliders is reported per each of them, broadphase order is not stable either
+    std::sort(outputBodies.begin(), outputBodies.end(), [](const PhysicsBody* lhs, const PhysicsBody* rhs)
+    {
+        if (lhs->mGameObject->mObjectID != rhs->mGameObject->mObjectID)
+            return lhs->mGameObject->mObjectID < rhs->mGameObject->mObjectID;
+
+        return lhs < rhs;
+    });
+    outputBodies.erase(std::unique(outputBodies.begin(), outputBodies.end()), outputBodies.end());
+}
+
 bool PhysicsManager::IsSimulationStepInProgress() const
 {
     return mBox2World->IsLocked();
@@ -500,13 +1094,13 @@ bool PhysicsManager::ShouldCollide_ObjectWithMap(b2Contact* contact, b2Fixture*
     if (gameObject->mPhysicsBody->CheckFlags(PhysicsBodyFlags_Disabled))
         return false;
 
-    float height = gGameMap.GetHeightAtPosition(gameObject->mPhysicsBody->GetPosition());
-    int mapLayer = (int) (Convert::MetersToMapUnits(height) + 0.5f);
-
-    // todo: this is temporary implementation
+    // walls of other layers are already rejected by contact filter
+    if (mapFixture->GetBody() != mBox2MapColumns)
+        return true;
 
+    // box per block column, check block on layer where object is currently located
     b2FixtureData_map fxdata = (b2FixtureData_map*) mapFixture->GetUserData().pointer;
-    const MapBlockInfo* blockData = gGameMap.GetBlockInfo(fxdata.mX, fxdata.mZ, mapLayer);
+    const MapBlockInfo* blockData = gGameMap.GetBlockInfo(fxdata.mMinX, fxdata.mMinZ, GetMapLayer(gameObject->mPhysicsBody));
     return (blockData->mGroundType == eGroundType_Building);
 }
 
@@ -566,115 +1160,123 @@ void PhysicsManager::HandleCollision_ObjectWithMap(b2Fixture* objectFixture, b2F
     GameObject* gameObject = b2Fixture_get_game_object(objectFixture);
     debug_assert(gameObject);
 
-    float height = gGameMap.GetHeightAtPosition(gameObject->mPhysicsBody->GetPosition());
-    int mapLayer = (int) (Convert::MetersToMapUnits(height) + 0.5f);
+    int mapLayer = GetMapFixtureLayer(mapFixture);
+    if (mapLayer < 0)
+    {
+        debug_assert(mapFixture->GetBody() == mBox2MapColumns);
+        mapLayer = GetMapLayer(gameObject->mPhysicsBody);
+    }
 
+    // find wall block at contact point, point is moved slightly into wall shape
     b2FixtureData_map fxdata = (b2FixtureData_map*) mapFixture->GetUserData().pointer;
 
+    b2WorldManifold wmanifold;
+    contact->GetWorldManifold(&wmanifold);
+
+    // normal points from fixture A to fixture B
+    b2Vec2 normalIntoWall = (contact->GetFixtureA() == mapFixture) ? -wmanifold.normal : wmanifold.normal;
+    glm::vec2 wallPoint = Convert::MetersToMapUnits(convert_vec2(wmanifold.points[0] + 0.01f * normalIntoWall));
+
+    int blockx = glm::clamp((int) floorf(wallPoint.x), (int) fxdata.mMinX, (int) fxdata.mMaxX);
+    int blockz = glm::clamp((int) floorf(wallPoint.y), (int) fxdata.mMinZ, (int) fxdata.mMaxZ);
+
     // queue collision event
     mObjectsCollisionList.emplace_back();
 
     CollisionEvent& collisionEvent = mObjectsCollisionList.back();
-    collisionEvent.mBox2Impulse = *impulse;
-    collisionEvent.mBox2Contact = contact;
-    collisionEvent.mBox2FixtureA = objectFixture;
-    collisionEvent.mMapBlockInfo = gGameMap.GetBlockInfo(fxdata.mX, fxdata.mZ, mapLayer);
+    collisionEvent.mColliderA = b2Fixture_get_collider(objectFixture);
+    collisionEvent.mClassA = gameObject->mClassID;
+    collisionEvent.mObjectIdA = gameObject->mObjectID;
+    collisionEvent.mContactPoint = convert_vec2(wmanifold.points[0]);
+    collisionEvent.mNormal = convert_vec2(normalIntoWall);
+    collisionEvent.mSeparation = wmanifold.separations[0];
+    collisionEvent.mMapBlockInfo = gGameMap.GetBlockInfo(blockx, blockz, mapLayer);
     debug_assert(collisionEvent.mMapBlockInfo);
 
-    if (Vehicle* carObject = ToVehicle(gameObject))
+    for (int icurr = 0; icurr < impulse->count; ++icurr)
     {
-        HandleCollision_CarVsMap(carObject, contact, impulse);
-        return;
+        collisionEvent.mImpulse += impulse->normalImpulses[icurr];
     }
 }
 
 void PhysicsManager::HandleCollision_Objects(b2Fixture* fixtureA, b2Fixture* fixtureB, b2Contact* contact, const b2ContactImpulse* impulse)
 {
-    // queue collision event
-    mObjectsCollisionList.emplace_back();
-
-    CollisionEvent& collisionEvent = mObjectsCollisionList.back();
-    collisionEvent.mBox2Impulse = *impulse;
-    collisionEvent.mBox2Contact = contact;
-    collisionEvent.mBox2FixtureA = fixtureA;
-    collisionEvent.mBox2FixtureB = fixtureB;
-
-    // handle collision
     GameObject* objectA = b2Fixture_get_game_object(fixtureA);
     GameObject* objectB = b2Fixture_get_game_object(fixtureB);
     debug_assert(objectA && objectB);
 
-    if (IsSameClass(objectA, objectB, eGameObjectClass_Car))
+    b2WorldManifold wmanifold;
+    contact->GetWorldManifold(&wmanifold);
+
+    glm::vec2 normal = convert_vec2(wmanifold.normal);
+
+    // order pair so that events of same classes go together
+    if (std::make_pair(objectB->mClassID, objectB->mObjectID) < std::make_pair(objectA->mClassID, objectA->mObjectID))
     {
-        Vehicle* carA = ToVehicle(objectA);
-        Vehicle* carB = ToVehicle(objectB);
+        std::swap(objectA, objectB);
+        std::swap(fixtureA, fixtureB);
+        normal = -normal;
+    }
 
-        HandleCollision_CarVsCar(carA, carB, contact, impulse);
-        return;
+    // queue collision event
+    mObjectsCollisionList.emplace_back();
+
+    CollisionEvent& collisionEvent = mObjectsCollisionList.back();
+    collisionEvent.mColliderA = b2Fixture_get_collider(fixtureA);
+    collisionEvent.mColliderB = b2Fixture_get_collider(fixtureB);
+    collisionEvent.mClassA = objectA->mClassID;
+    collisionEvent.mClassB = objectB->mClassID;
+    collisionEvent.mObjectIdA = objectA->mObjectID;
+    collisionEvent.mObjectIdB = objectB->mObjectID;
+    collisionEvent.mContactPoint = convert_vec2(wmanifold.points[0]);
+    collisionEvent.mNormal = normal;
+    collisionEvent.mSeparation = wmanifold.separations[0];
+
+    for (int icurr = 0; icurr < impulse->count; ++icurr)
+    {
+        collisionEvent.mImpulse += impulse->normalImpulses[icurr];
     }
 }
 
-void PhysicsManager::HandleCollision_CarVsCar(Vehicle* carA, Vehicle* carB, b2Contact* contact, const b2ContactImpulse* impulse)
+void PhysicsManager::HandleCollision_CarVsCar(const CollisionEvent* events, int eventsCount)
 {
-    debug_assert(carA && carB);
+    if (!gParticleManager.IsCarSparksEffectEnabled())
+        return;
 
-    if (gParticleManager.IsCarSparksEffectEnabled())
+    for (int icurr = 0; icurr < eventsCount; ++icurr)
     {
-        int pointCount = contact->GetManifold()->pointCount;
-        float impact = 0.0f;
-        for (int i = 0; i < pointCount; ++i)
+        const CollisionEvent& currEvent = events[icurr];
+        if (currEvent.mImpulse > gGameParams.mSparksOnCarsContactThreshold)
         {
-            impact = b2Max(impact, impulse->normalImpulses[i]);
-        }
-        b2WorldManifold wmanifold;
-        contact->GetWorldManifold(&wmanifold);
+            PhysicsBody* bodyA = currEvent.mColliderA->mPhysicsBody;
+            PhysicsBody* bodyB = currEvent.mColliderB->mPhysicsBody;
 
-        if (impact > gGameParams.mSparksOnCarsContactThreshold)
-        {
-            glm::vec3 contactPoint(wmanifold.points->x, carA->mPhysicsBody->mPositionY, wmanifold.points->y);
-            glm::vec2 velocity2 = glm::normalize(
-                carA->mPhysicsBody->GetLinearVelocity() +
-                carB->mPhysicsBody->GetLinearVelocity());
+            glm::vec3 contactPoint(currEvent.mContactPoint.x, bodyA->mPositionY, currEvent.mContactPoint.y);
+            glm::vec2 velocity2 = glm::normalize(bodyA->GetLinearVelocity() + bodyB->GetLinearVelocity());
             glm::vec3 velocity = -glm::vec3(velocity2.x, 0.0f, velocity2.y) * 1.8f;
             gParticleManager.StartCarSparks(contactPoint, velocity, 3);
         }
     }
 }
 
-void PhysicsManager::HandleCollision_CarVsMap(Vehicle* car, b2Contact* contact, const b2ContactImpulse* impulse)
+void PhysicsManager::HandleCollision_CarVsMap(const CollisionEvent* events, int eventsCount)
 {
-    debug_assert(car);
-
-    int pointCount = contact->GetManifold()->pointCount;
-    float impact = 0.0f;
-    for (int i = 0; i < pointCount; ++i)
-    {
-        impact = b2Max(impact, impulse->normalImpulses[i]);
-    }
+    if (!gParticleManager.IsCarSparksEffectEnabled())
+        return;
 
-    if (gParticleManager.IsCarSparksEffectEnabled())
+    for (int icurr = 0; icurr < eventsCount; ++icurr)
     {
-        b2WorldManifold wmanifold;
-        contact->GetWorldManifold(&wmanifold);
-
-        if (impact > gGameParams.mSparksOnCarsContactThreshold)
+        const CollisionEvent& currEvent = events[icurr];
+        if (currEvent.mImpulse > gGameParams.mSparksOnCarsContactThreshold)
         {
-            glm::vec3 contactPoint(wmanifold.points->x, car->mPhysicsBody->mPositionY, wmanifold.points->y);
-            glm::vec2 velocity2 = glm::normalize(car->mPhysicsBody->GetLinearVelocity());
+            PhysicsBody* carBody = currEvent.mColliderA->mPhysicsBody;
+
+            glm::vec3 contactPoint(currEvent.mContactPoint.x, carBody->mPositionY, currEvent.mContactPoint.y);
+            glm::vec2 velocity2 = glm::normalize(carBody->GetLinearVelocity());
             glm::vec3 velocity = -glm::vec3(velocity2.x, 0.0f, velocity2.y) * 1.8f;
             gParticleManager.StartCarSparks(contactPoint, velocity, 3);
         }
     }
-
-
-    // sound
-    if (impact > 700.0f)
-    {
-        //gAudioManager.StartSound(eSfxSampleType_Level, SfxLevel_CarCrash4, SfxFlags_RandomPitch, car->mTransform.mPosition);
-    }
-
-    // bounce
-
 }
 
 void PhysicsManager::ProcessInterpolation()
@@ -693,27 +1295,165 @@ void PhysicsManager::ProcessInterpolation()
 
 void PhysicsManager::DispatchCollisionEvents()
 {
-    for (const CollisionEvent& currCollision: mObjectsCollisionList)
+    double dispatchStartTime = gSystem.GetSystemSeconds();
+
+    mWorldStats.mCollisionContacts = (int) mObjectsCollisionList.size();
+
+    // contacts order depends on bodies creation history, so events are sorted by objects classes and identifiers
+    // to make handlers order stable, collisions with map go before collisions between objects
+    std::stable_sort(mObjectsCollisionList.begin(), mObjectsCollisionList.end(), 
+        [](const CollisionEvent& lhs, const CollisionEvent& rhs)
+        {
+            bool lhsObjects = (lhs.mColliderB != nullptr);
+            bool rhsObjects = (rhs.mColliderB != nullptr);
+            if (lhsObjects != rhsObjects)
+                return rhsObjects;
+
+            if (lhs.mClassA != rhs.mClassA)
+                return lhs.mClassA < rhs.mClassA;
+
+            if (lhs.mClassB != rhs.mClassB)
+                return lhs.mClassB < rhs.mClassB;
+
+            if (lhs.mObjectIdA != rhs.mObjectIdA)
+                return lhs.mObjectIdA < rhs.mObjectIdA;
+
+            return lhs.mObjectIdB < rhs.mObjectIdB;
+        });
+
+    // coalesce contacts between same objects, strongest contact is kept
+    // static geometry has no identifier, so separate wall hits are never merged
+    auto isSamePair = [](const CollisionEvent& lhs, const CollisionEvent& rhs)
     {
-        if (currCollision.mMapBlockInfo)
+        if ((lhs.mColliderB == nullptr) || (rhs.mColliderB == nullptr))
+            return false;
+
+        if ((lhs.mObjectIdA == GAMEOBJECT_ID_NULL) || (lhs.mObjectIdB == GAMEOBJECT_ID_NULL))
+            return false;
+
+        return (lhs.mColliderA->mGameObject == rhs.mColliderA->mGameObject) &&
+            (lhs.mColliderB->mGameObject == rhs.mColliderB->mGameObject);
+    };
+
+    int eventsCount = 0;
+    for (const CollisionEvent& currEvent: mObjectsCollisionList)
+    {
+        if (eventsCount > 0 && isSamePair(mObjectsCollisionList[eventsCount - 1], currEvent))
         {
-            MapCollision collisionInfo;
+            CollisionEvent& pairEvent = mObjectsCollisionList[eventsCount - 1];
+            if (currEvent.mImpulse > pairEvent.mImpulse)
+            {
+                pairEvent = currEvent;
+            }
+            continue;
+        }
+        mObjectsCollisionList[eventsCount++] = currEvent;
+    }
+    mObjectsCollisionList.resize(eventsCount);
+    mWorldStats.mCollisionEvents = eventsCount;
 
-            collisionInfo.SetupWithBox2Data(currCollision.mBox2Contact, currCollision.mBox2FixtureA, currCollision.mMapBlockInfo, &currCollision.mBox2Impulse);
-            collisionInfo.mThisObject->HandleCollisionWithMap(collisionInfo);
+    // dispatch events with same objects classes at once
+    for (int ibegin = 0; ibegin < eventsCount; )
+    {
+        const CollisionEvent& firstEvent = mObjectsCollisionList[ibegin];
+
+        int iend = ibegin + 1;
+        for (; iend < eventsCount; ++iend)
+        {
+            const CollisionEvent& currEvent = mObjectsCollisionList[iend];
+            if ((currEvent.mColliderB == nullptr) != (firstEvent.mColliderB == nullptr) ||
+                (currEvent.mClassA != firstEvent.mClassA) || 
+                (currEvent.mClassB != firstEvent.mClassB))
+            {
+                break;
+            }
         }
-        else
+        DispatchCollisionEventsGroup(&mObjectsCollisionList[ibegin], iend - ibegin);
+        ibegin = iend;
+    }
+    mObjectsCollisionList.clear();
+
+    mWorldStats.mCollisionDispatchTimeMs = (float) ((gSystem.GetSystemSeconds() - dispatchStartTime) * 1000.0);
+}
+
+void PhysicsManager::DispatchCollisionEventsGroup(const CollisionEvent* events, int eventsCount)
+{
+    debug_assert(events && eventsCount > 0);
+
+    eGameObjectClass classA = events[0].mClassA;
+    eGameObjectClass classB = events[0].mClassB;
+
+    // object vs map
+    if (events[0].mMapBlockInfo)
+    {
+        switch (classA)
         {
-            Collision collisionInfo;
+            case eGameObjectClass_Car: 
+                HandleCollision_CarVsMap(events, eventsCount);
+                DispatchMapCollisions<Vehicle>(events, eventsCount); 
+            break;
+            case eGameObjectClass_Pedestrian: DispatchMapCollisions<Pedestrian>(events, eventsCount); break;
+            case eGameObjectClass_Projectile: DispatchMapCollisions<Projectile>(events, eventsCount); break;
+            case eGameObjectClass_Obstacle: DispatchMapCollisions<Obstacle>(events, eventsCount); break;
+            default: DispatchMapCollisions<GameObject>(events, eventsCount); break;
+        }
+        return;
+    }
 
-            collisionInfo.SetupWithBox2Data(currCollision.mBox2Contact, currCollision.mBox2FixtureA, currCollision.mBox2FixtureB, &currCollision.mBox2Impulse);
-            collisionInfo.mContactInfo.mThisObject->HandleCollision(collisionInfo);
+    // object vs object
+    if (classA == eGameObjectClass_Car && classB == eGameObjectClass_Car)
+    {
+        HandleCollision_CarVsCar(events, eventsCount);
+    }
 
-            collisionInfo.SetupWithBox2Data(currCollision.mBox2Contact, currCollision.mBox2FixtureB, currCollision.mBox2FixtureA, &currCollision.mBox2Impulse);
-            collisionInfo.mContactInfo.mThisObject->HandleCollision(collisionInfo);
+    for (bool thatSide: {false, true})
+    {
+        switch (thatSide ? classB : classA)
+        {
+            case eGameObjectClass_Car: DispatchObjectsCollisions<Vehicle>(events, eventsCount, thatSide); break;
+            case eGameObjectClass_Pedestrian: DispatchObjectsCollisions<Pedestrian>(events, eventsCount, thatSide); break;
+            case eGameObjectClass_Projectile: DispatchObjectsCollisions<Projectile>(events, eventsCount, thatSide); break;
+            case eGameObjectClass_Obstacle: DispatchObjectsCollisions<Obstacle>(events, eventsCount, thatSide); break;
+            default: DispatchObjectsCollisions<GameObject>(events, eventsCount, thatSide); break;
         }
     }
-    mObjectsCollisionList.clear();
+}
+
+template<typename TObject>
+void PhysicsManager::DispatchObjectsCollisions(const CollisionEvent* events, int eventsCount, bool thatSide)
+{
+    Collision collisionInfo;
+    for (int icurr = 0; icurr < eventsCount; ++icurr)
+    {
+        const CollisionEvent& currEvent = events[icurr];
+        if (thatSide)
+        {
+            collisionInfo.SetupWithContactPoint(currEvent.mColliderB, currEvent.mColliderA, currEvent.mContactPoint, currEvent.mNormal, 
+                currEvent.mSeparation, currEvent.mImpulse);
+        }
+        else
+        {
+            collisionInfo.SetupWithContactPoint(currEvent.mColliderA, currEvent.mColliderB, currEvent.mContactPoint, currEvent.mNormal, 
+                currEvent.mSeparation, currEvent.mImpulse);
+        }
+        TObject* gameObject = static_cast<TObject*>(collisionInfo.mContactInfo.mThisObject);
+        gameObject->HandleCollision(collisionInfo);
+    }
+}
+
+template<typename TObject>
+void PhysicsManager::DispatchMapCollisions(const CollisionEvent* events, int eventsCount)
+{
+    MapCollision collisionInfo;
+    for (int icurr = 0; icurr < eventsCount; ++icurr)
+    {
+        const CollisionEvent& currEvent = events[icurr];
+        collisionInfo.SetupWithContactPoint(currEvent.mColliderA, currEvent.mMapBlockInfo, currEvent.mContactPoint, currEvent.mNormal, 
+            currEvent.mSeparation, currEvent.mImpulse);
+
+        TObject* gameObject = static_cast<TObject*>(collisionInfo.mThisObject);
+        gameObject->HandleCollisionWithMap(collisionInfo);
+    }
 }
 
 void PhysicsManager::HandleFallingStarts(PhysicsBody* physicsBody)
@@ -781,3 +1521,8 @@ float PhysicsManager::GetSimulationStepTime() const
 {
     return mSimulationStepTime;
 }
+
+float PhysicsManager::GetSimulationStepScale() const
+{
+    return mSimulationStepTime / mBaseSimulationStepTime;
+}
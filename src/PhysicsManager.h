@@ -2,14 +2,45 @@
 
 #include "PhysicsDefs.h"
 #include "GameDefs.h"
+#include "VehicleDynamics.h"
 
 // note that the physics only works with meter units (Mt) not map units
 
+// Physics world statistics
+struct PhysicsWorldStats
+{
+public:
+    int mMapShapes = 0; // merged map wall shapes, all layers
+    int mMapWallBlocks = 0; // map blocks covered by wall shapes, all layers
+    int mMapColumnShapes = 0; // number of shapes with single box per block column
+    int mBodiesCount = 0;
+    int mProxiesCount = 0; // broadphase proxies
+    int mContactsCount = 0; // broadphase pairs
+    float mStepTimeMs = 0.0f; // last simulation step duration
+    float mBodiesPhaseTimeMs = 0.0f; // per-body simulation and height queries, parallel part of step
+    int mWorkerThreadsCount = 0; // threads limit for per-body step phases
+    // frame stepping
+    int mFrameSubsteps = 0; // simulation steps done during last frame
+    float mFrameStepsTimeMs = 0.0f; // all simulation steps duration during last frame
+    float mSimulationStepTimeMs = 0.0f; // current step size, may be increased with adaptive step
+    float mTimeDilation = 1.0f; // simulated time to frame time ratio for last frame
+    float mDroppedTime = 0.0f; // total simulation time dropped by catch-up limits, seconds
+    int mCatchUpLimitHits = 0; // number of frames where catch-up limits were hit
+    // collisions
+    int mCollisionContacts = 0; // contacts reported during last step
+    int mCollisionEvents = 0; // collision events dispatched after last step, one per colliding pair
+    float mCollisionDispatchTimeMs = 0.0f; // collision handlers duration after last step
+};
+
 // this class manages physics and collision detections for map and objects
-class PhysicsManager final: private b2ContactListener
+class PhysicsManager final: private b2ContactListener, private b2ContactFilter
 {
     friend class PhysicsBody;
 
+public:
+    // readonly
+    PhysicsWorldStats mWorldStats;
+
 public:
     PhysicsManager();
 
@@ -18,6 +49,8 @@ public:
     void UpdateFrame();
 
     float GetSimulationStepTime() const;
+    // Get simulation step time to base step time ratio, greater than one while adaptive step is active
+    float GetSimulationStepScale() const;
     bool IsSimulationStepInProgress() const;
 
     // Create physical body for game object
@@ -37,6 +70,33 @@ public:
     void QueryObjectsLinecast(const glm::vec2& pointA, const glm::vec2& pointB, PhysicsQueryResult& outputResult, CollisionGroup collisionMask) const;
     void QueryObjectsWithinBox(const glm::vec2& center, const glm::vec2& extents, PhysicsQueryResult& outputResult, CollisionGroup collisionMask) const;
 
+    // Find all physics objects which origin is within circle area, results count is not limited
+    // @param center, radius: Circle area
+    // @param outputBodies: Output objects, each reported once in order of game object id
+    void QueryObjectsWithinRadius(const glm::vec2& center, float radius, std::vector<PhysicsBody*>& outputBodies, CollisionGroup collisionMask) const;
+
+    // Run simulation steps with current bodies using from 1 to max worker threads, results are printed to log
+    // @param stepsCount: Number of simulation steps per threads count
+    void RunStepBenchmark(int stepsCount);
+
+    // Run simulation steps with current bodies, first with box per block column map walls and then with merged walls,
+    // results are printed to log
+    // @param stepsCount: Number of simulation steps per walls layout
+    void RunMapShapesBenchmark(int stepsCount);
+
+    // Run physics frames with fixed frame delta to check catch-up limits, results are printed to log
+    // @param framesCount: Number of frames
+    // @param frameDelta: Frame time, seconds
+    void RunFrameTimeBenchmark(int framesCount, float frameDelta);
+
+    // Compare batched vehicle dynamics against per-vehicle model and measure both, results are printed to log
+    // Vehicles state is restored afterwards
+    // @param iterationsCount: Number of runs per vehicles count
+    void RunVehicleDynamicsBenchmark(int iterationsCount);
+
+    // Run simulation steps with current bodies and measure collision events throughput, results are printed to log
+    void RunCollisionEventsBenchmark(int stepsCount);
+
 private:
     // override b2ContactListener
     void BeginContact(b2Contact* contact) override;
@@ -44,24 +104,50 @@ private:
     void PreSolve(b2Contact* contact, const b2Manifold* oldManifold) override;
     void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse) override;
 
+    // override b2ContactFilter
+    bool ShouldCollide(b2Fixture* fixtureA, b2Fixture* fixtureB) override;
+
     bool ShouldCollide_ObjectWithMap(b2Contact* contact, b2Fixture* objectFixture, b2Fixture* mapFixture) const;
     bool ShouldCollide_Objects(b2Contact* contact, b2Fixture* fixtureA, b2Fixture* fixtureB) const;
 
     void HandleCollision_ObjectWithMap(b2Fixture* objectFixture, b2Fixture* mapFixture, b2Contact* contact, const b2ContactImpulse* impulse);
     void HandleCollision_Objects(b2Fixture* fixtureA, b2Fixture* fixtureB, b2Contact* contact, const b2ContactImpulse* impulse);
 
-    // collision handlers
-    void HandleCollision_CarVsCar(Vehicle* carA, Vehicle* carB, b2Contact* contact, const b2ContactImpulse* impulse);
-    void HandleCollision_CarVsMap(Vehicle* car, b2Contact* contact, const b2ContactImpulse* impulse);
+    struct CollisionEvent;
 
-    // create level map body, used internally
+    // collision handlers, called for group of events with same objects classes
+    void HandleCollision_CarVsCar(const CollisionEvent* events, int eventsCount);
+    void HandleCollision_CarVsMap(const CollisionEvent* events, int eventsCount);
+
+    // create level map bodies, one per map layer, used internally
     void CreateMapCollisionShape();
+    // create single level map body with box per block column, used for comparison in benchmark
+    void CreateMapColumnsCollisionShape();
+    void CreateMapWallFixture(b2Body* mapBody, int minx, int minz, int endx, int endz);
+    void DestroyMapCollisionShape();
+
+    // Get map layer of wall fixture
+    // @returns -1 if fixture does not belong to map
+    int GetMapFixtureLayer(const b2Fixture* mapFixture) const;
+    // Get map layer which walls are collided with body
+    int GetMapLayer(PhysicsBody* physicsBody) const;
 
     void ProcessInterpolation();
+    void ProcessFrameSteps(float frameDelta);
     void ProcessSimulationStep();
-    void UpdateHeightPosition(PhysicsBody* physicsBody);
+    void ProcessBodiesSimulationStep(int threadsCount);
+    void UpdateHeightPosition(PhysicsBody* physicsBody, float groundHeight);
+    void UpdateHeightPositions(int threadsCount);
 
     void DispatchCollisionEvents();
+    void DispatchCollisionEventsGroup(const CollisionEvent* events, int eventsCount);
+
+    // notify objects of specific class about collisions, TObject is used to avoid virtual calls for final classes
+    // @param thatSide: Objects B of events are notified if set, objects A otherwise
+    template<typename TObject>
+    void DispatchObjectsCollisions(const CollisionEvent* events, int eventsCount, bool thatSide);
+    template<typename TObject>
+    void DispatchMapCollisions(const CollisionEvent* events, int eventsCount);
 
     void HandleFallingStarts(PhysicsBody* physicsBody);
     void HandleFallsOnGround(PhysicsBody* physicsBody);
@@ -69,6 +155,7 @@ private:
 
 private:
 
+    // compact collision record, contacts of same objects pair are coalesced into single event per step
     struct CollisionEvent
     {
     public:
@@ -76,25 +163,40 @@ private:
 
         // object vs map
         const MapBlockInfo* mMapBlockInfo = nullptr;
-        // object vs object
-        b2Fixture* mBox2FixtureA = nullptr;
-        b2Fixture* mBox2FixtureB = nullptr;
-        // common
-        b2Contact* mBox2Contact = nullptr;
-        b2ContactImpulse mBox2Impulse;
+        // common, pair is ordered by objects class and identifier
+        Collider* mColliderA = nullptr;
+        Collider* mColliderB = nullptr; // null for map collision
+        eGameObjectClass mClassA = eGameObjectClass_COUNT;
+        eGameObjectClass mClassB = eGameObjectClass_COUNT;
+        GameObjectID mObjectIdA = GAMEOBJECT_ID_NULL;
+        GameObjectID mObjectIdB = GAMEOBJECT_ID_NULL;
+        // strongest contact
+        glm::vec2 mContactPoint;
+        glm::vec2 mNormal; // points from A to B
+        float mSeparation = 0.0f;
+        float mImpulse = 0.0f; // total normal impulse
     };
 
 private:
 
-    b2Body* mBox2MapBody;
+    b2Body* mBox2MapLayers[MAP_LAYERS_COUNT];
+    b2Body* mBox2MapColumns; // exists only while map shapes benchmark runs
     b2World* mBox2World;
+    unsigned int mSimulationStepIndex = 0;
 
     float mSimulationTimeAccumulator;
     float mSimulationStepTime;
+    float mBaseSimulationStepTime; // step time from physics framerate
 
     float mGravity; // meters per second
     std::vector<PhysicsBody*> mBodiesList;
 
+    // per-body step phases data
+    std::vector<PhysicsBody*> mParallelStepBodies;
+    std::vector<float> mBodiesGroundHeight; // same order as bodies list
+    VehicleDynamics mVehicleDynamics;
+    int mWorkerThreadsLimit = 0; // overrides g_physicsThreads while benchmark runs
+
     std::vector<CollisionEvent> mObjectsCollisionList;
 };
 
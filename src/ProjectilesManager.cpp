@@ -0,0 +1,450 @@
+#include "stdafx.h"
+#include "ProjectilesManager.h"
+#include "GameObjectsManager.h"
+#include "GameObjectHelpers.h"
+#include "GameMapManager.h"
+#include "PhysicsManager.h"
+#include "SpriteManager.h"
+#include "SpriteBatch.h"
+#include "TimeManager.h"
+#include "AudioManager.h"
+#include "cvars.h"
+
+ProjectilesManager gProjectilesManager;
+
+//////////////////////////////////////////////////////////////////////////
+// cvars
+//////////////////////////////////////////////////////////////////////////
+
+CvarBoolean gCvarLightweightProjectiles("g_lightweightProjectiles", true, "Simulate projectiles without physics bodies", CvarFlags_Archive);
+
+//////////////////////////////////////////////////////////////////////////
+
+// same as legacy projectile animation speed
+static const float ProjectileAnimationFps = 24.0f;
+
+// objects farther than that by height are not hit, same as physics objects collision filter
+static const float ProjectileHitMaxHeightDifference = 2.0f;
+
+// path is not split further when linecast results overflow on shorter segments
+static const float ProjectileTraceMinSplitDistance = 0.05f;
+
+void ProjectilesManager::EnterWorld()
+{
+    mProjectiles.clear();
+    mStats = ProjectilesStats();
+}
+
+void ProjectilesManager::ClearWorld()
+{
+    mProjectiles.clear();
+    mStats = ProjectilesStats();
+}
+
+bool ProjectilesManager::IsLightweightProjectilesEnabled() const
+{
+    return gCvarLightweightProjectiles.mValue;
+}
+
+void ProjectilesManager::CreateProjectile(const glm::vec3& position, cxx::angle_t heading, WeaponInfo* weaponInfo, Pedestrian* shooter)
+{
+    if (weaponInfo == nullptr)
+    {
+        debug_assert(false);
+        return;
+    }
+
+    mProjectiles.emplace_back();
+
+    ProjectileRecord& projectile = mProjectiles.back();
+    projectile.mWeaponInfo = weaponInfo;
+    projectile.mShooter = shooter;
+    projectile.mPosition = position;
+    projectile.mHeading = heading;
+    float headingRadians = heading.to_radians();
+    projectile.mDirection = glm::vec2(cos(headingRadians), sin(headingRadians));
+
+    StyleData& cityStyle = gGameMap.mStyleData;
+
+    int objectindex = weaponInfo->mProjectileObject;
+    if (objectindex > 0 && objectindex < (int) cityStyle.mObjects.size())
+    {
+        GameObjectInfo& objectInfo = cityStyle.mObjects[objectindex];
+        debug_assert(objectInfo.mClassID == eGameObjectClass_Projectile);
+        if (objectInfo.mAnimationData.GetFramesCount() > 0)
+        {
+            projectile.mObjectInfo = &objectInfo;
+        }
+    }
+    projectile.mDrawSprite.mDrawOrder = eSpriteDrawOrder_Projectiles;
+    UpdateProjectileSprite(projectile);
+
+    ++mStats.mSpawnedCount;
+    mStats.mActiveCount = (int) mProjectiles.size();
+}
+
+void ProjectilesManager::UpdateFrame()
+{
+    UpdateProjectiles(gTimeManager.mGameFrameDelta);
+}
+
+void ProjectilesManager::UpdateProjectiles(float deltaTime)
+{
+    double updateStartTime = gSystem.GetSystemSeconds();
+
+    for (size_t icurr = 0; icurr < mProjectiles.size(); )
+    {
+        if (UpdateProjectile(mProjectiles[icurr], deltaTime))
+        {
+            ++icurr;
+            continue;
+        }
+        // finished projectile is replaced with last one
+        if (icurr + 1 < mProjectiles.size())
+        {
+            mProjectiles[icurr] = mProjectiles.back();
+        }
+        mProjectiles.pop_back();
+    }
+
+    mStats.mActiveCount = (int) mProjectiles.size();
+    mStats.mUpdateTimeMs = (float) ((gSystem.GetSystemSeconds() - updateStartTime) * 1000.0);
+}
+
+bool ProjectilesManager::UpdateProjectile(ProjectileRecord& projectile, float deltaTime)
+{
+    WeaponInfo* weaponInfo = projectile.mWeaponInfo;
+    debug_assert(weaponInfo);
+
+    float remainingRange = weaponInfo->mBaseHitRange - projectile.mTraveledDistance;
+    if (remainingRange <= 0.0f)
+        return false;
+
+    float sweepDistance = std::min(weaponInfo->mProjectileSpeed * deltaTime, remainingRange);
+
+    glm::vec2 pointA (projectile.mPosition.x, projectile.mPosition.z);
+    glm::vec2 pointB = pointA + projectile.mDirection * sweepDistance;
+
+    // map blocks on current layer
+    bool hitWall = false;
+    glm::vec2 wallPoint;
+    if (sweepDistance > 0.0f)
+    {
+        int mapLayer = (int) (Convert::MetersToMapUnits(projectile.mPosition.y) + 0.5f);
+        mapLayer = glm::clamp(mapLayer, 0, MAP_LAYERS_COUNT - 1);
+
+        glm::vec2 mapPoint;
+        if (gGameMap.TraceSegment2D(Convert::MetersToMapUnits(pointA), Convert::MetersToMapUnits(pointB), (float) mapLayer, mapPoint))
+        {
+            hitWall = true;
+            wallPoint = Convert::MapUnitsToMeters(mapPoint);
+            // objects behind wall are not reachable
+            pointB = wallPoint;
+        }
+    }
+
+    // objects along path up to wall
+    glm::vec2 objectPoint;
+    GameObject* hitObject = nullptr;
+    if (pointA != pointB)
+    {
+        hitObject = TraceObjects(projectile, pointA, pointB, objectPoint);
+    }
+
+    if (hitObject || hitWall)
+    {
+        glm::vec2 hitPoint = hitObject ? objectPoint : wallPoint;
+        glm::vec3 hitPosition (hitPoint.x, projectile.mPosition.y, hitPoint.y);
+        HandleHit(projectile, hitObject, hitPosition);
+        return false;
+    }
+
+    projectile.mPosition.x = pointB.x;
+    projectile.mPosition.z = pointB.y;
+    projectile.mTraveledDistance += sweepDistance;
+    projectile.mLifeTime += deltaTime;
+    UpdateProjectileSprite(projectile);
+
+    return projectile.mTraveledDistance < weaponInfo->mBaseHitRange;
+}
+
+void ProjectilesManager::UpdateProjectileSprite(ProjectileRecord& projectile)
+{
+    Sprite2D& drawSprite = projectile.mDrawSprite;
+    if (projectile.mObjectInfo)
+    {
+        const SpriteAnimData& animData = projectile.mObjectInfo->mAnimationData;
+
+        int framesCount = animData.GetFramesCount();
+        int frameCursor = (int) (projectile.mLifeTime * ProjectileAnimationFps);
+        // fire is looped, other projectiles stop at last frame
+        if (projectile.mWeaponInfo->IsFireDamage())
+        {
+            frameCursor = frameCursor % framesCount;
+        }
+        else
+        {
+            frameCursor = std::min(frameCursor, framesCount - 1);
+        }
+
+        int spriteIndex = animData.mFrames[frameCursor].mSprite;
+        if (projectile.mSpriteIndex != spriteIndex)
+        {
+            projectile.mSpriteIndex = spriteIndex;
+            gSpriteManager.GetSpriteTexture(spriteIndex, 0, drawSprite);
+        }
+    }
+
+    drawSprite.mRotateAngle = projectile.mHeading + cxx::angle_t::from_degrees(SPRITE_ZERO_ANGLE);
+    drawSprite.mPosition.x = projectile.mPosition.x;
+    drawSprite.mPosition.y = projectile.mPosition.z;
+    drawSprite.mHeight = projectile.mPosition.y;
+}
+
+GameObject* ProjectilesManager::TraceObjects(const ProjectileRecord& projectile, const glm::vec2& pointA, const glm::vec2& pointB, glm::vec2& outPoint) const
+{
+    PhysicsQueryResult queryResult;
+    gPhysics.QueryObjectsLinecast(pointA, pointB, queryResult, CollisionGroup_Pedestrian | CollisionGroup_Car | CollisionGroup_Obstacle);
+
+    // query result capacity is limited so nearest object may be missing, trace halves of path instead, nearest one first
+    if (queryResult.IsFull() && (glm::distance(pointA, pointB) > ProjectileTraceMinSplitDistance))
+    {
+        glm::vec2 midPoint = (pointA + pointB) * 0.5f;
+        if (GameObject* nearestObject = TraceObjects(projectile, pointA, midPoint, outPoint))
+            return nearestObject;
+
+        return TraceObjects(projectile, midPoint, pointB, outPoint);
+    }
+
+    // query results are not ordered by distance
+    GameObject* nearestObject = nullptr;
+    float nearestDistance2 = 0.0f;
+    for (int icurr = 0; icurr < queryResult.mElementsCount; ++icurr)
+    {
+        const PhysicsQueryElement& currElement = queryResult.mElements[icurr];
+
+        GameObject* currObject = currElement.mPhysicsObject->mGameObject;
+        if (!ShouldHitObject(projectile, currObject))
+            continue;
+
+        float distance2 = glm::distance2(pointA, currElement.mIntersectionPoint);
+        if (nearestObject && (distance2 >= nearestDistance2))
+            continue;
+
+        nearestObject = currObject;
+        nearestDistance2 = distance2;
+        outPoint = currElement.mIntersectionPoint;
+    }
+    return nearestObject;
+}
+
+bool ProjectilesManager::ShouldHitObject(const ProjectileRecord& projectile, GameObject* gameObject) const
+{
+    if ((gameObject == nullptr) || gameObject->IsMarkedForDeletion())
+        return false;
+
+    PhysicsBody* physicsBody = gameObject->mPhysicsBody;
+    if ((physicsBody == nullptr) || physicsBody->CheckFlags(PhysicsBodyFlags_Disabled))
+        return false;
+
+    if (fabs(physicsBody->mPositionY - projectile.mPosition.y) > ProjectileHitMaxHeightDifference)
+        return false;
+
+    // same filtering as legacy projectile contacts
+    if (Pedestrian* otherPedestrian = ToPedestrian(gameObject))
+    {
+        if (projectile.mShooter && (projectile.mShooter == otherPedestrian)) // ignore shooter ped
+            return false;
+
+        if (otherPedestrian->IsDead() || otherPedestrian->IsAttachedToObject())
+            return false;
+
+        if (projectile.mWeaponInfo->IsFireDamage() && otherPedestrian->IsBurn())
+            return false;
+    }
+
+    if (Vehicle* otherCar = ToVehicle(gameObject))
+    {
+        if (projectile.mWeaponInfo->IsFireDamage() && otherCar->IsWrecked())
+            return false;
+    }
+    return true;
+}
+
+void ProjectilesManager::HandleHit(const ProjectileRecord& projectile, GameObject* hitObject, const glm::vec3& hitPosition)
+{
+    WeaponInfo* weaponInfo = projectile.mWeaponInfo;
+    ++mStats.mHitsCount;
+
+    if (mHarmlessHits)
+        return;
+
+    if (hitObject)
+    {
+        // shooter is damage causer
+        DamageInfo damageInfo;
+        damageInfo.SetDamage(*weaponInfo, projectile.mShooter);
+
+        hitObject->ReceiveDamage(damageInfo);
+    }
+
+    glm::vec3 effectPosition = hitPosition;
+    if (weaponInfo->IsExplosionDamage())
+    {
+        if (hitObject == nullptr)
+        {
+            effectPosition.y += Convert::MapUnitsToMeters(1.0f);
+        }
+
+        Explosion* explosion = gGameObjectsManager.CreateExplosion(hitObject, projectile.mShooter, eExplosionType_Rocket, effectPosition);
+        debug_assert(explosion);
+    }
+
+    if (weaponInfo->mProjectileHitEffect > GameObjectType_Null)
+    {
+        GameObjectInfo& objectInfo = gGameMap.mStyleData.mObjects[weaponInfo->mProjectileHitEffect];
+        Decoration* hitEffect = gGameObjectsManager.CreateDecoration(effectPosition, cxx::angle_t(), &objectInfo);
+        debug_assert(hitEffect);
+
+        if (hitEffect)
+        {
+            hitEffect->SetDrawOrder(eSpriteDrawOrder_Projectiles);
+            hitEffect->SetLifeDuration(1);
+        }
+    }
+
+    if (weaponInfo->mProjectileHitObjectSound != -1)
+    {
+        gAudioManager.StartSound(eSfxSampleType_Level, weaponInfo->mProjectileHitObjectSound, SfxFlags_RandomPitch, effectPosition);
+    }
+}
+
+int ProjectilesManager::DrawProjectiles(SpriteBatch& spriteBatch, const cxx::aabbox2d_t* screenAreas, int screenAreasCount) const
+{
+    int spritesDrawn = 0;
+
+    cxx::aabbox2d_t spriteBounds;
+    for (const ProjectileRecord& currProjectile: mProjectiles)
+    {
+        if (!currProjectile.mDrawSprite)
+            continue;
+
+        currProjectile.mDrawSprite.GetApproximateBounds(spriteBounds);
+
+        unsigned int viewsMask = 0;
+        for (int iarea = 0; iarea < screenAreasCount; ++iarea)
+        {
+            if (screenAreas[iarea].contains(spriteBounds))
+            {
+                viewsMask |= (1U << iarea);
+            }
+        }
+        if (viewsMask == 0)
+            continue;
+
+        spriteBatch.DrawSprite(currProjectile.mDrawSprite, viewsMask);
+        ++spritesDrawn;
+    }
+    return spritesDrawn;
+}
+
+void ProjectilesManager::RunUpdateBenchmark(Pedestrian* shooter, WeaponInfo* weaponInfo, int projectilesCount, int framesCount)
+{
+    debug_assert(shooter);
+    debug_assert(weaponInfo);
+
+    projectilesCount = std::max(projectilesCount, 1);
+    framesCount = std::max(framesCount, 1);
+
+    const float FrameDelta = 1.0f / 60.0f;
+
+    std::vector<ProjectileRecord> savedProjectiles;
+    savedProjectiles.swap(mProjectiles);
+    ProjectilesStats savedStats = mStats;
+
+    // hits are only counted, objects around shooter must survive benchmark
+    mHarmlessHits = true;
+
+    glm::vec3 spawnPosition = shooter->mTransform.mPosition;
+    // local random sequence, game one is reserved for simulation
+    cxx::randomizer spawnRand;
+
+    double spawnTime = 0.0;
+    double updateTime = 0.0;
+    int spawnedCount = 0;
+    long long projectileUpdatesCount = 0;
+    for (int iframe = 0; iframe < framesCount; ++iframe)
+    {
+        // keep projectiles count constant, finished ones are replaced with new ones
+        double spawnStartTime = gSystem.GetSystemSeconds();
+        while ((int) mProjectiles.size() < projectilesCount)
+        {
+            cxx::angle_t heading { 360.0f * spawnRand.generate_float(), cxx::angle_t::units::degrees };
+            CreateProjectile(spawnPosition, heading, weaponInfo, shooter);
+            ++spawnedCount;
+        }
+        spawnTime += gSystem.GetSystemSeconds() - spawnStartTime;
+
+        projectileUpdatesCount += (long long) mProjectiles.size();
+        UpdateProjectiles(FrameDelta);
+        updateTime += mStats.mUpdateTimeMs / 1000.0;
+    }
+
+    mHarmlessHits = false;
+
+    gConsole.LogMessage(eLogMessage_Info, "Projectiles benchmark: %d projectiles, %d frames, weapon %s", projectilesCount, framesCount, cxx::enum_to_string(weaponInfo->mWeaponID));
+    gConsole.LogMessage(eLogMessage_Info, "    update: %.3f ms per frame, %.3f us per projectile",
+        (updateTime * 1000.0) / framesCount, (updateTime * 1000000.0) / std::max(projectileUpdatesCount, 1LL));
+    gConsole.LogMessage(eLogMessage_Info, "    spawn: %d projectiles, %.3f us per projectile, %d hits",
+        spawnedCount, (spawnTime * 1000000.0) / std::max(spawnedCount, 1), mStats.mHitsCount - savedStats.mHitsCount);
+
+    // compare with projectiles as game objects with physics bodies
+    std::vector<Projectile*> legacyProjectiles;
+    legacyProjectiles.reserve(projectilesCount);
+
+    double legacyStartTime = gSystem.GetSystemSeconds();
+    for (int icurr = 0; icurr < projectilesCount; ++icurr)
+    {
+        cxx::angle_t heading { 360.0f * spawnRand.generate_float(), cxx::angle_t::units::degrees };
+        if (Projectile* projectile = gGameObjectsManager.CreateProjectile(spawnPosition, heading, weaponInfo, shooter))
+        {
+            legacyProjectiles.push_back(projectile);
+        }
+    }
+    double legacySpawnTime = gSystem.GetSystemSeconds() - legacyStartTime;
+
+    for (Projectile* currProjectile: legacyProjectiles)
+    {
+        currProjectile->MarkForDeletion();
+    }
+    gConsole.LogMessage(eLogMessage_Info, "    legacy spawn: %.3f us per projectile",
+        (legacySpawnTime * 1000000.0) / std::max((int) legacyProjectiles.size(), 1));
+
+    // restore game state
+    mProjectiles.swap(savedProjectiles);
+    mStats.mActiveCount = (int) mProjectiles.size();
+}
+
+unsigned long long ProjectilesManager::ComputeStateHash(unsigned long long hashValue) const
+{
+    // fnv-1a, same as objects state hash
+    auto hash_bytes = [&hashValue](const void* data, size_t dataLength)
+    {
+        const unsigned char* bytes = (const unsigned char*) data;
+        for (size_t ibyte = 0; ibyte < dataLength; ++ibyte)
+        {
+            hashValue ^= bytes[ibyte];
+            hashValue *= 1099511628211ULL;
+        }
+    };
+
+    // projectiles order only depends on simulation
+    for (const ProjectileRecord& currProjectile: mProjectiles)
+    {
+        hash_bytes(&currProjectile.mWeaponInfo->mWeaponID, sizeof(currProjectile.mWeaponInfo->mWeaponID));
+        hash_bytes(&currProjectile.mPosition, sizeof(currProjectile.mPosition));
+        hash_bytes(&currProjectile.mDirection, sizeof(currProjectile.mDirection));
+        hash_bytes(&currProjectile.mTraveledDistance, sizeof(currProjectile.mTraveledDistance));
+    }
+    return hashValue;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "WeaponInfo.h"
+#include "GameObject.h"
+
+class SpriteBatch;
+
+// lightweight projectiles statistics
+struct ProjectilesStats
+{
+public:
+    ProjectilesStats() = default;
+public:
+    int mActiveCount = 0;
+    int mSpawnedCount = 0; // total since world enter
+    int mHitsCount = 0; // total since world enter
+    float mUpdateTimeMs = 0.0f; // last frame
+};
+
+// Simulates projectiles without physics bodies
+// Projectiles are plain records advanced with swept linecasts against objects and dda walk over map blocks
+class ProjectilesManager final: public cxx::noncopyable
+{
+public:
+    // readonly
+    ProjectilesStats mStats;
+
+public:
+    void EnterWorld();
+    void ClearWorld();
+    void UpdateFrame();
+
+    // Create new projectile, same as GameObjectsManager::CreateProjectile but without game object
+    // @param position: Start position, meters
+    // @param heading: Direction of flight
+    // @param weaponInfo: Weapon properties, must be range weapon
+    // @param shooter: Optional pedestrian that fired projectile, it cannot be hit by own projectile
+    void CreateProjectile(const glm::vec3& position, cxx::angle_t heading, WeaponInfo* weaponInfo, Pedestrian* shooter);
+
+    // Add projectiles sprites visible within screen areas to sprite batch
+    // @param screenAreas: Areas of render views, sprites get view mask bit per area
+    // @param screenAreasCount: Number of render views
+    // @returns Number of sprites drawn
+    int DrawProjectiles(SpriteBatch& spriteBatch, const cxx::aabbox2d_t* screenAreas, int screenAreasCount) const;
+
+    // Whether projectiles are created as lightweight records rather than game objects
+    bool IsLightweightProjectilesEnabled() const;
+
+    // Keep specified number of projectiles flying from shooter in random directions and measure update time, results are printed to log
+    // @param shooter: Pedestrian to spawn projectiles from
+    // @param weaponInfo: Range weapon
+    void RunUpdateBenchmark(Pedestrian* shooter, WeaponInfo* weaponInfo, int projectilesCount, int framesCount);
+
+    // Continue hash of objects state with active projectiles, used to compare simulation runs in lockstep mode
+    // @param hashValue: Hash value to continue
+    unsigned long long ComputeStateHash(unsigned long long hashValue) const;
+
+private:
+    struct ProjectileRecord
+    {
+        WeaponInfo* mWeaponInfo = nullptr;
+        GameObjectInfo* mObjectInfo = nullptr; // projectile animation, optional
+        PedestrianHandle mShooter;
+        glm::vec3 mPosition;
+        glm::vec2 mDirection;
+        cxx::angle_t mHeading;
+        float mTraveledDistance = 0.0f;
+        float mLifeTime = 0.0f;
+        int mSpriteIndex = -1; // current animation frame sprite
+        Sprite2D mDrawSprite;
+    };
+
+    // advance projectile and detect hits along its path
+    // @returns false if projectile is finished
+    bool UpdateProjectile(ProjectileRecord& projectile, float deltaTime);
+    void UpdateProjectileSprite(ProjectileRecord& projectile);
+    void UpdateProjectiles(float deltaTime);
+
+    // find nearest object intersecting projectile path
+    GameObject* TraceObjects(const ProjectileRecord& projectile, const glm::vec2& pointA, const glm::vec2& pointB, glm::vec2& outPoint) const;
+    bool ShouldHitObject(const ProjectileRecord& projectile, GameObject* gameObject) const;
+
+    void HandleHit(const ProjectileRecord& projectile, GameObject* hitObject, const glm::vec3& hitPosition);
+
+private:
+    std::vector<ProjectileRecord> mProjectiles;
+    bool mHarmlessHits = false; // set while benchmark runs, hits do not damage objects or spawn effects
+};
+
+extern ProjectilesManager gProjectilesManager;
@@ -9,6 +9,7 @@
 #include "ParticleEffectsManager.h"
 #include "ParticleRenderdata.h"
 #include "CarnageGame.h"
+#include "cvars.h"
 
 RenderingManager gRenderManager;
 
@@ -16,9 +17,13 @@ RenderingManager::RenderingManager()
     : mDefaultTexColorProgram("shaders/texture_color.glsl")
     , mGuiTexColorProgram("shaders/gui.glsl")
     , mCityMeshProgram("shaders/city_mesh.glsl")
+    , mCityMeshPackedProgram("shaders/city_mesh_packed.glsl")
     , mSpritesProgram("shaders/sprites.glsl")
+    , mSpritesInstancedProgram("shaders/sprites_instanced.glsl")
     , mDebugProgram("shaders/debug.glsl")
     , mParticleProgram("shaders/particle.glsl")
+    , mStreamingVertices(eBufferContent_Vertices)
+    , mStreamingIndices(eBufferContent_Indices)
 {
 }
 
@@ -26,6 +31,14 @@ bool RenderingManager::Initialize()
 {
     InitRenderPrograms();
 
+    const unsigned int StreamingVerticesPerFrame = 4 * 1024 * 1024;
+    const unsigned int StreamingIndicesPerFrame = 1024 * 1024;
+    if (!mStreamingVertices.Initialize(StreamingVerticesPerFrame) || !mStreamingIndices.Initialize(StreamingIndicesPerFrame))
+    {
+        Deinit();
+        return false;
+    }
+
     if (!mMapRenderer.Initialize())
     {
         Deinit();
@@ -47,6 +60,8 @@ void RenderingManager::Deinit()
     mActiveRenderViews.clear();
     mDebugRenderer.Deinit();
     mMapRenderer.Deinit();
+    mStreamingVertices.Deinit();
+    mStreamingIndices.Deinit();
     gSpriteManager.Cleanup();
 
     FreeRenderPrograms();
@@ -55,13 +70,34 @@ void RenderingManager::Deinit()
 void RenderingManager::RenderFrame()
 {
     gGraphicsDevice.ClearScreen();
+    mStreamingVertices.FrameBegin();
+    mStreamingIndices.FrameBegin();
     gSpriteManager.RenderFrameBegin();
     mMapRenderer.RenderFrameBegin();
 
+    RenderGameViews();
+
+    gGuiManager.RenderFrame();
+
+    mMapRenderer.mRenderStats.mStreamingUploadBytes = mStreamingVertices.mUploadBytes + mStreamingIndices.mUploadBytes;
+    mMapRenderer.RenderFrameEnd();
+    mStreamingVertices.FrameEnd();
+    mStreamingIndices.FrameEnd();
+    gSpriteManager.RenderFrameEnd();
+    gGraphicsDevice.Present();
+}
+
+void RenderingManager::RenderGameViews()
+{
+    for (GameCamera* currRenderview: mActiveRenderViews)
+    {
+        currRenderview->ComputeMatricesAndFrustum();
+    }
+    mMapRenderer.PrepareRenderViews(mActiveRenderViews);
+
     Rect prevScreenRect = gGraphicsDevice.mViewportRect;
     for (GameCamera* currRenderview: mActiveRenderViews)
     {
-        currRenderview->ComputeMatricesAndFrustum();
         gGraphicsDevice.SetViewportRect(currRenderview->mViewportRect);
 
         mMapRenderer.RenderFrame(currRenderview);
@@ -79,20 +115,88 @@ void RenderingManager::RenderFrame()
         }
     }
     gGraphicsDevice.SetViewportRect(prevScreenRect);
+}
 
-    gGuiManager.RenderFrame();
+void RenderingManager::RunRenderCallsBenchmark(int framesCount)
+{
+    if (mActiveRenderViews.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Render calls benchmark: no active render views");
+        return;
+    }
 
-    mMapRenderer.RenderFrameEnd();
-    gSpriteManager.RenderFrameEnd();
-    gGraphicsDevice.Present();
+    framesCount = std::max(framesCount, 1);
+    gConsole.LogMessage(eLogMessage_Info, "Render calls benchmark: %d views, %d frames, gui is not drawn", 
+        static_cast<int>(mActiveRenderViews.size()), framesCount);
+
+    // finish counting of current frame, it will be reported partially
+    gGraphicsDevice.ResetFrameStats();
+    GraphicsCallsStats prevFrameStats = gGraphicsDevice.mLastFrameStats;
+
+    const bool stateCacheEnabled = gCvarGraphicsStateCache.mValue;
+    for (bool currStateCache: {false, true})
+    {
+        gCvarGraphicsStateCache.mValue = currStateCache;
+
+        // warm up, first frame reconciles state left by previous mode
+        const int WarmupFrames = 1;
+
+        double totalTime = 0.0;
+        long long issuedCalls = 0;
+        long long skippedCalls = 0;
+        long long uniformUploads = 0;
+        long long attributeCalls = 0;
+        long long drawCalls = 0;
+        for (int iframe = 0; iframe < (framesCount + WarmupFrames); ++iframe)
+        {
+            double startTime = gSystem.GetSystemSeconds();
+
+            gGraphicsDevice.ClearScreen();
+            mStreamingVertices.FrameBegin();
+            mStreamingIndices.FrameBegin();
+            mMapRenderer.RenderFrameBegin();
+            RenderGameViews();
+            mMapRenderer.RenderFrameEnd();
+            mStreamingVertices.FrameEnd();
+            mStreamingIndices.FrameEnd();
+
+            double frameTime = gSystem.GetSystemSeconds() - startTime;
+
+            gGraphicsDevice.ResetFrameStats();
+            if (iframe < WarmupFrames)
+                continue;
+
+            const GraphicsCallsStats& frameStats = gGraphicsDevice.mLastFrameStats;
+            totalTime += frameTime;
+            issuedCalls += frameStats.GetIssuedCallsCount();
+            skippedCalls += frameStats.GetSkippedCallsCount();
+            uniformUploads += frameStats.mUniformUploads;
+            attributeCalls += frameStats.mAttributeCalls;
+            drawCalls += frameStats.mDrawCalls;
+        }
+
+        const double framesInv = 1.0 / framesCount;
+        gConsole.LogMessage(eLogMessage_Info, " - state cache %s: %.1f api calls per frame (uniforms %.1f, attributes %.1f, draws %.1f), %.1f skipped, cpu avg %.3f ms", 
+            currStateCache ? "on" : "off",
+            issuedCalls * framesInv, 
+            uniformUploads * framesInv, 
+            attributeCalls * framesInv, 
+            drawCalls * framesInv, 
+            skippedCalls * framesInv, 
+            totalTime * framesInv * 1000.0);
+    }
+    gCvarGraphicsStateCache.mValue = stateCacheEnabled;
+    gGraphicsDevice.mLastFrameStats = prevFrameStats;
 }
 
 void RenderingManager::FreeRenderPrograms()
 {
     mDefaultTexColorProgram.Deinit();
     mCityMeshProgram.Deinit();
+    mCityMeshPackedProgram.Deinit();
     mGuiTexColorProgram.Deinit();
     mSpritesProgram.Deinit();
+    mSpritesInstancedProgram.Deinit();
     mParticleProgram.Deinit();
     mDebugProgram.Deinit();
 }
@@ -102,7 +206,9 @@ bool RenderingManager::InitRenderPrograms()
     mDefaultTexColorProgram.Initialize();
     mGuiTexColorProgram.Initialize();
     mCityMeshProgram.Initialize(); 
+    mCityMeshPackedProgram.Initialize();
     mSpritesProgram.Initialize();
+    mSpritesInstancedProgram.Initialize();
     mParticleProgram.Initialize();
     mDebugProgram.Initialize();
 
@@ -117,8 +223,10 @@ void RenderingManager::ReloadRenderPrograms()
     mGuiTexColorProgram.Reinitialize();
     mDebugProgram.Reinitialize();
     mSpritesProgram.Reinitialize();
+    mSpritesInstancedProgram.Reinitialize();
     mParticleProgram.Reinitialize();
     mCityMeshProgram.Reinitialize();
+    mCityMeshPackedProgram.Reinitialize();
 }
 
 void RenderingManager::AttachRenderView(GameCamera* renderview)
@@ -174,7 +282,6 @@ void RenderingManager::UnregisterParticleEffect(ParticleEffect* particleEffect)
     ParticleRenderdata* renderdata = particleEffect->mRenderdata;
     if (renderdata)
     {
-        renderdata->DestroyVertexbuffer();
         delete renderdata;
     }
     particleEffect->SetRenderdata(nullptr);
@@ -231,24 +338,19 @@ void RenderingManager::RenderParticleEffect(GameCamera* renderview, ParticleEffe
     if (NumParticles == 0)
         return;
 
-    // update vertices
-    if (renderdata->mIsInvalidated)
+    // update vertices, streaming buffer range must be reallocated each frame
+    if (renderdata->mIsInvalidated || renderdata->mVerticesFrame != mStreamingVertices.mFramesCounter)
     {
         renderdata->ResetInvalidated();
-        if (!renderdata->PrepareVertexbuffer(particleEffect->mParticles.size() * Sizeof_ParticleVertex))
+        void* verticesData = mStreamingVertices.Allocate(NumParticles * Sizeof_ParticleVertex, renderdata->mVertices);
+        if (verticesData == nullptr)
         {
             debug_assert(false);
             return;
         }
+        renderdata->mVerticesFrame = mStreamingVertices.mFramesCounter;
 
-        GpuBuffer* vertexbuffer = renderdata->mVertexBuffer;
-        debug_assert(vertexbuffer);
-        ParticleVertex* vertices = vertexbuffer->LockData<ParticleVertex>(BufferAccess_UnsynchronizedWrite | BufferAccess_InvalidateBuffer);
-        if (vertices == nullptr)
-        {
-            debug_assert(false);
-            return;
-        }
+        ParticleVertex* vertices = static_cast<ParticleVertex*>(verticesData);
 
         for (int icurrParticle = 0; icurrParticle < NumParticles; ++icurrParticle)
         {
@@ -261,20 +363,17 @@ void RenderingManager::RenderParticleEffect(GameCamera* renderview, ParticleEffe
             particleVertex.mColor = srcParticle.mColor;
         }
 
-        if (!vertexbuffer->Unlock())
-        {
-            debug_assert(false);
-            return;
-        }
+        mStreamingVertices.Commit(renderdata->mVertices);
     }
 
-    if (renderdata->mVertexBuffer == nullptr)
+    if (renderdata->mVertices.mBuffer == nullptr)
     {
         debug_assert(false);
         return;
     }
 
     ParticleVertex_Format vFormat;
-    gGraphicsDevice.BindVertexBuffer(renderdata->mVertexBuffer, vFormat);
+    vFormat.mBaseOffset = renderdata->mVertices.mOffset;
+    gGraphicsDevice.BindVertexBuffer(renderdata->mVertices.mBuffer, vFormat);
     gGraphicsDevice.RenderPrimitives(ePrimitiveType_Points, 0, NumParticles);
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "MapRenderer.h"
 #include "DebugRenderer.h"
 #include "ParticleEffect.h"
+#include "GpuRingBuffer.h"
 
 // master render system, it is intended to manage rendering pipeline of the game
 class RenderingManager final: public cxx::noncopyable
@@ -12,13 +13,19 @@ class RenderingManager final: public cxx::noncopyable
 public:
     RenderProgram mDefaultTexColorProgram;
     RenderProgram mCityMeshProgram;
+    RenderProgram mCityMeshPackedProgram;
     RenderProgram mGuiTexColorProgram;
     RenderProgram mSpritesProgram;
+    RenderProgram mSpritesInstancedProgram;
     RenderProgram mDebugProgram;
     RenderProgram mParticleProgram;
 
     MapRenderer mMapRenderer;
 
+    // dynamic geometry is sub-allocated from these buffers, ranges are valid until end of frame
+    GpuRingBuffer mStreamingVertices;
+    GpuRingBuffer mStreamingIndices;
+
     std::vector<GameCamera*> mActiveRenderViews;
 
 public:
@@ -36,6 +43,10 @@ public:
     // Render game frame routine
     void RenderFrame();
 
+    // Render game views multiple times with state cache disabled and enabled and count issued graphics api calls, 
+    // results are printed to log, frames are not presented
+    void RunRenderCallsBenchmark(int framesCount);
+
     // Force reload all render programs
     void ReloadRenderPrograms();
     
@@ -47,6 +58,7 @@ public:
     void UnregisterParticleEffect(ParticleEffect* particleEffect);
 
 private:
+    void RenderGameViews();
     void RenderParticleEffects(GameCamera* renderview);
     void RenderParticleEffect(GameCamera* renderview, ParticleEffect* particleEffect);
 
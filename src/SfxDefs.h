@@ -26,6 +26,7 @@ enum SfxFlags
     SfxFlags_None        = 0,
     SfxFlags_Loop        = BIT(0),
     SfxFlags_RandomPitch = BIT(1), // randomize pitch a bit
+    SfxFlags_HighPriority = BIT(2), // prefer this sound when hardware audio sources are limited
 };
 
 decl_enum_as_flags(SfxFlags);
@@ -38,7 +38,21 @@ void SfxEmitter::ReleaseEmitter(bool stopSounds)
 {
     if (!stopSounds)
     {
-        mAudioChannels.clear();
+        // detach from owner and let non-looped sounds finish, emitter will be released by audio manager
+        mGameObject = nullptr;
+        for (SfxChannel& currChannel: mAudioChannels)
+        {
+            if (currChannel.mVoiceActive && ((currChannel.mSfxFlags & SfxFlags_Loop) > 0))
+            {
+                FinishVoice(currChannel);
+            }
+        }
+
+        if (IsActiveEmitter())
+        {
+            mEmitterFlags = (mEmitterFlags | SfxEmitterFlags_Autorelease);
+            return;
+        }
     }
     gAudioManager.DestroyEmitter(this);
 }
@@ -46,28 +60,68 @@ void SfxEmitter::ReleaseEmitter(bool stopSounds)
 void SfxEmitter::UpdateEmitterParams(const glm::vec3& emitterPosition)
 {
     mEmitterPosition = emitterPosition;
+    mPositionChanged = true;
+
+    UploadEmitterParams();
+}
 
+void SfxEmitter::SetEmitterPosition(const glm::vec3& emitterPosition)
+{
+    if (mEmitterPosition == emitterPosition)
+        return;
+
+    mEmitterPosition = emitterPosition;
+    mPositionChanged = true;
+}
+
+void SfxEmitter::UploadEmitterParams()
+{
+    if (!mPositionChanged)
+        return;
+
+    mPositionChanged = false;
     for (SfxChannel& currChannel: mAudioChannels)
     {
         if (currChannel.mHardwareSource)
         {
-            currChannel.mHardwareSource->SetPosition3D(emitterPosition.x, emitterPosition.y, emitterPosition.z);
+            currChannel.mHardwareSource->SetPosition3D(mEmitterPosition.x, mEmitterPosition.y, mEmitterPosition.z);
         }
     }
 }
 
-void SfxEmitter::UpdateSounds()
+void SfxEmitter::ResetAudibility()
+{
+    mListenerDistance = 0.0f;
+    mAudible = true;
+}
+
+void SfxEmitter::UpdateSounds(float deltaTime)
 {
     for (SfxChannel& currChannel: mAudioChannels)
     {
-        if (currChannel.mHardwareSource == nullptr)
+        if (!currChannel.mVoiceActive || currChannel.mVoicePaused)
             continue;
 
-        if (currChannel.mHardwareSource->IsStopped())
+        currChannel.mPlaybackTime += (deltaTime * currChannel.mPlaybackPitch);
+
+        if (currChannel.mHardwareSource)
         {
-            currChannel.mHardwareSource = nullptr;
+            if (currChannel.mHardwareSource->IsStopped())
+            {
+                FinishVoice(currChannel);
+            }
             continue;
         }
+
+        // virtual voice completes when its sample duration is out
+        if ((currChannel.mSfxFlags & SfxFlags_Loop) == 0)
+        {
+            float sampleDuration = currChannel.mSfxSample->mSampleBuffer->GetBufferDurationSeconds();
+            if (currChannel.mPlaybackTime >= sampleDuration)
+            {
+                FinishVoice(currChannel);
+            }
+        }
     }
 }
 
@@ -75,33 +129,26 @@ void SfxEmitter::StopAllSounds()
 {
     for (SfxChannel& currChannel: mAudioChannels)
     {
-        if (currChannel.mHardwareSource)
+        if (currChannel.mVoiceActive)
         {
-            currChannel.mHardwareSource->Stop();
-            currChannel.mHardwareSource = nullptr;
+            FinishVoice(currChannel);
         }
     }
 }
 
 void SfxEmitter::PauseAllSounds()
 {
-    for (SfxChannel& currChannel: mAudioChannels)
+    for (int ichannel = 0; ichannel < (int) mAudioChannels.size(); ++ichannel)
     {
-        if (currChannel.mHardwareSource)
-        {
-            currChannel.mHardwareSource->Pause();
-        }
+        PauseSound(ichannel);
     }
 }
 
 void SfxEmitter::ResumeAllSounds()
 {
-    for (SfxChannel& currChannel: mAudioChannels)
+    for (int ichannel = 0; ichannel < (int) mAudioChannels.size(); ++ichannel)
     {
-        if (currChannel.mHardwareSource)
-        {
-            currChannel.mHardwareSource->Resume();
-        }
+        ResumeSound(ichannel);
     }
 }
 
@@ -119,49 +166,35 @@ bool SfxEmitter::StartSound(int ichannel, SfxSample* sfxSample, SfxFlags sfxFlag
     }
 
     SfxChannel& channel = mAudioChannels[ichannel];
-    if (channel.mHardwareSource)
-    {
-        channel.mHardwareSource->Stop();
-    }
-    if (channel.mHardwareSource == nullptr)
+    if (channel.mVoiceActive)
     {
-        channel.mHardwareSource = gAudioManager.GetFreeAudioSource();
-        if (channel.mHardwareSource == nullptr)
-            return false; // out of audio sources
+        FinishVoice(channel);
     }
 
     channel.mSfxFlags = sfxFlags;
     channel.mSfxSample = sfxSample;
+    channel.mPlaybackTime = 0.0f;
+    channel.mVoiceActive = true;
+    channel.mVoicePaused = false;
 
-    channel.mHardwareSource->Stop();
-    if (!channel.mHardwareSource->SetSampleBuffer(sfxSample->mSampleBuffer))
-    {
-        debug_assert(false);
-    }
-
-    float pitchValue = 1.0f;
     if ((sfxFlags & SfxFlags_RandomPitch) > 0)
     {
-        pitchValue = gAudioManager.NextRandomPitch();
+        channel.mPlaybackPitch = gAudioManager.NextRandomPitch();
     }
     else
     {
-        pitchValue = channel.mPitchValue;
-    }
-    if (!channel.mHardwareSource->SetPitch(pitchValue) ||
-        !channel.mHardwareSource->SetGain(channel.mGainValue * gAudioManager.mSoundsGain)) 
-    {
-        debug_assert(false);
+        channel.mPlaybackPitch = channel.mPitchValue;
     }
 
-    if (!channel.mHardwareSource->SetPosition3D(mEmitterPosition.x, mEmitterPosition.y, mEmitterPosition.z))
+    // voice stays virtual if all hardware sources are busy or emitter is out of hearing range,
+    // audio manager will decide whether it should be heard
+    if (mAudible)
     {
-        debug_assert(false);
-    }
-
-    if (!channel.mHardwareSource->Start((sfxFlags & SfxFlags_Loop) > 0))
-    {
-        debug_assert(false);
+        AudioSource* audioSource = gAudioManager.AcquireAudioSource();
+        if (audioSource)
+        {
+            BindHardwareSource(channel, audioSource);
+        }
     }
     gAudioManager.RegisterActiveEmitter(this);
     return true;
@@ -173,10 +206,9 @@ bool SfxEmitter::StopSound(int ichannel)
         return false;
 
     SfxChannel& channel = mAudioChannels[ichannel];
-    if (channel.mHardwareSource)
+    if (channel.mVoiceActive)
     {
-        channel.mHardwareSource->Stop();
-        channel.mHardwareSource = nullptr;
+        FinishVoice(channel);
     }
     return true;
 }
@@ -187,19 +219,14 @@ bool SfxEmitter::IsPlaying(int ichannel) const
         return false;
 
     const SfxChannel& channel = mAudioChannels[ichannel];
-    if (channel.mHardwareSource)
-    {
-        return channel.mHardwareSource->IsPlaying();
-    }
-
-    return false;
+    return channel.mVoiceActive && !channel.mVoicePaused;
 }
 
 bool SfxEmitter::IsActiveEmitter() const
 {
     for (const SfxChannel& currChannel: mAudioChannels)
     {
-        if (currChannel.mHardwareSource && currChannel.mHardwareSource)
+        if (currChannel.mVoiceActive)
             return true;
     }
     return false;
@@ -211,12 +238,7 @@ bool SfxEmitter::IsPaused(int ichannel) const
         return false;
 
     const SfxChannel& channel = mAudioChannels[ichannel];
-    if (channel.mHardwareSource)
-    {
-        return channel.mHardwareSource->IsPaused();
-    }
-
-    return false;
+    return channel.mVoiceActive && channel.mVoicePaused;
 }
 
 bool SfxEmitter::PauseSound(int ichannel)
@@ -225,12 +247,16 @@ bool SfxEmitter::PauseSound(int ichannel)
         return false;
 
     SfxChannel& channel = mAudioChannels[ichannel];
+    if (!channel.mVoiceActive)
+        return false;
+
+    channel.mVoicePaused = true;
     if (channel.mHardwareSource)
     {
         return channel.mHardwareSource->Pause();
     }
 
-    return false;
+    return true;
 }
 
 bool SfxEmitter::ResumeSound(int ichannel)
@@ -239,12 +265,16 @@ bool SfxEmitter::ResumeSound(int ichannel)
         return false;
 
     SfxChannel& channel = mAudioChannels[ichannel];
+    if (!channel.mVoiceActive)
+        return false;
+
+    channel.mVoicePaused = false;
     if (channel.mHardwareSource)
     {
         return channel.mHardwareSource->Resume();
     }
 
-    return false;
+    return true;
 }
 
 bool SfxEmitter::SetPitch(int ichannel, float pitchValue)
@@ -253,13 +283,18 @@ bool SfxEmitter::SetPitch(int ichannel, float pitchValue)
         return false;
 
     SfxChannel& channel = mAudioChannels[ichannel];
-    if (channel.mHardwareSource)
+    if (channel.mVoiceActive)
     {
         if (channel.mPitchValue == pitchValue)
             return true;
 
         channel.mPitchValue = pitchValue;
-        return channel.mHardwareSource->SetPitch(pitchValue);
+        channel.mPlaybackPitch = pitchValue;
+        if (channel.mHardwareSource)
+        {
+            return channel.mHardwareSource->SetPitch(pitchValue);
+        }
+        return true;
     }
 
     return false;
@@ -271,13 +306,17 @@ bool SfxEmitter::SetGain(int ichannel, float gainValue)
         return false;
 
     SfxChannel& channel = mAudioChannels[ichannel];
-    if (channel.mHardwareSource)
+    if (channel.mVoiceActive)
     {
         if (channel.mGainValue == gainValue)
             return true;
 
         channel.mGainValue = gainValue;
-        return channel.mHardwareSource->SetGain(gainValue * gAudioManager.mSoundsGain);
+        if (channel.mHardwareSource)
+        {
+            return channel.mHardwareSource->SetGain(gainValue * gAudioManager.mSoundsGain);
+        }
+        return true;
     }
 
     return false;
@@ -287,3 +326,70 @@ bool SfxEmitter::IsAutoreleaseEmitter() const
 {
     return (mEmitterFlags & SfxEmitterFlags_Autorelease) > 0;
 }
+
+bool SfxEmitter::BindHardwareSource(SfxChannel& channel, AudioSource* audioSource)
+{
+    debug_assert(channel.mVoiceActive);
+    debug_assert(channel.mHardwareSource == nullptr);
+    debug_assert(audioSource);
+
+    channel.mHardwareSource = audioSource;
+
+    if (!audioSource->SetSampleBuffer(channel.mSfxSample->mSampleBuffer))
+    {
+        debug_assert(false);
+    }
+
+    if (!audioSource->SetPitch(channel.mPlaybackPitch) ||
+        !audioSource->SetGain(channel.mGainValue * gAudioManager.mSoundsGain)) 
+    {
+        debug_assert(false);
+    }
+
+    if (!audioSource->SetPosition3D(mEmitterPosition.x, mEmitterPosition.y, mEmitterPosition.z))
+    {
+        debug_assert(false);
+    }
+
+    bool isLooped = (channel.mSfxFlags & SfxFlags_Loop) > 0;
+    if (!audioSource->Start(isLooped))
+    {
+        debug_assert(false);
+    }
+
+    // continue from the position where virtual voice is currently at
+    if (channel.mPlaybackTime > 0.0f)
+    {
+        float sampleDuration = channel.mSfxSample->mSampleBuffer->GetBufferDurationSeconds();
+        float playbackOffset = isLooped ? fmodf(channel.mPlaybackTime, sampleDuration) : channel.mPlaybackTime;
+        if ((sampleDuration > 0.0f) && (playbackOffset < sampleDuration))
+        {
+            audioSource->SetPlaybackOffset(playbackOffset);
+        }
+    }
+
+    if (channel.mVoicePaused)
+    {
+        audioSource->Pause();
+    }
+    return true;
+}
+
+void SfxEmitter::UnbindHardwareSource(SfxChannel& channel)
+{
+    if (channel.mHardwareSource)
+    {
+        channel.mHardwareSource->Stop();
+        gAudioManager.ReleaseAudioSource(channel.mHardwareSource);
+        channel.mHardwareSource = nullptr;
+    }
+}
+
+void SfxEmitter::FinishVoice(SfxChannel& channel)
+{
+    UnbindHardwareSource(channel);
+
+    channel.mVoiceActive = false;
+    channel.mVoicePaused = false;
+    channel.mPlaybackTime = 0.0f;
+}
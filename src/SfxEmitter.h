@@ -38,12 +38,16 @@ private:
     // virtual audio channel state
     struct SfxChannel
     {
-        AudioSource* mHardwareSource = nullptr; // channel is only active when source set
+        AudioSource* mHardwareSource = nullptr; // bound hardware source, null when voice is virtualized
         SfxSample* mSfxSample = nullptr;
         SfxFlags mSfxFlags = SfxFlags_None;
         // audio params
         float mPitchValue = 1.0f;
         float mGainValue = 1.0f;
+        float mPlaybackPitch = 1.0f; // actual pitch, includes random variation
+        float mPlaybackTime = 0.0f; // seconds played since start, advances even when voice is virtualized
+        bool mVoiceActive = false; // channel is playing or paused, with or without hardware source
+        bool mVoicePaused = false;
     };
 
     //////////////////////////////////////////////////////////////////////////
@@ -59,8 +63,9 @@ public:
     // Free emitter
     void ReleaseEmitter(bool stopSounds);
 
+    // Set position and immediately sync it with hardware sources
     void UpdateEmitterParams(const glm::vec3& emitterPosition);
-    void UpdateSounds();
+    void UpdateSounds(float deltaTime);
 
     void StopAllSounds();
     void PauseAllSounds();
@@ -79,8 +84,26 @@ public:
     bool IsAutoreleaseEmitter() const;
     bool IsActiveEmitter() const;
 
+private:
+    // Set position, hardware sources will be synced on next audio manager update
+    void SetEmitterPosition(const glm::vec3& emitterPosition);
+    void UploadEmitterParams();
+
+    // Restore spatial culling state to its initial value when emitter stops being active,
+    // audio manager only updates it for active emitters
+    void ResetAudibility();
+
+    // Attach hardware source to virtual voice and continue playback from current position
+    bool BindHardwareSource(SfxChannel& channel, AudioSource* audioSource);
+    void UnbindHardwareSource(SfxChannel& channel);
+    void FinishVoice(SfxChannel& channel);
+
 private:
     std::vector<SfxChannel> mAudioChannels;
     glm::vec3 mEmitterPosition;
     SfxEmitterFlags mEmitterFlags = SfxEmitterFlags_None;
+    // spatial culling state, updated by audio manager
+    float mListenerDistance = 0.0f; // distance to nearest listener, xz plane only
+    bool mAudible = true; // within audible distance of any listener
+    bool mPositionChanged = false; // hardware sources are not yet synced
 };
\ No newline at end of file
@@ -14,6 +14,8 @@ void Sprite2D::Clear()
     mHeight = 0.0f;
     mScale = MAP_SPRITE_SCALE;
     mPaletteIndex = 0;
+    mDeltaBase = 0;
+    mDeltaBits = 0;
 
     mRotateAngle.set_zero();
 }
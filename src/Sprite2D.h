@@ -57,6 +57,8 @@ public:
     float mScale = MAP_SPRITE_SCALE;
 
     unsigned short mPaletteIndex = 0;
+    unsigned short mDeltaBase = 0; // first entry of sprite in deltas table
+    SpriteDeltaBits mDeltaBits = 0; // deltas applied at sample time
 
     eSpriteOriginMode mOriginMode = eSpriteOrigin_Center;
     eSpriteDrawOrder mDrawOrder = eSpriteDrawOrder_Background;
@@ -3,10 +3,37 @@
 #include "RenderingManager.h"
 #include "SpriteManager.h"
 #include "GpuTexture2D.h"
+#include "cvars.h"
+
+CvarBoolean gCvarGraphicsInstancedSprites("r_instancedSprites", true, "Draw map sprites as instances of unit quad which corners are computed in shader", CvarFlags_Archive);
 
 const unsigned int NumVerticesPerSprite = 4;
 const unsigned int NumIndicesPerSprite = 6;
 
+inline void SetupSpriteInstance(const Sprite2D& sprite, bool depthAxisZ, SpriteInstance3D& spriteInstance)
+{
+    spriteInstance.mPosition = sprite.mPosition;
+    spriteInstance.mHeight = sprite.mHeight;
+    spriteInstance.mScale = sprite.mScale;
+    spriteInstance.mTextureRect[0] = static_cast<unsigned short>(sprite.mTextureRegion.mRectangle.x);
+    spriteInstance.mTextureRect[1] = static_cast<unsigned short>(sprite.mTextureRegion.mRectangle.y);
+    spriteInstance.mTextureRect[2] = static_cast<unsigned short>(sprite.mTextureRegion.mRectangle.w);
+    spriteInstance.mTextureRect[3] = static_cast<unsigned short>(sprite.mTextureRegion.mRectangle.h);
+
+    float turns = sprite.mRotateAngle.to_degrees() / 360.0f;
+    turns -= floorf(turns);
+    spriteInstance.mRotation = static_cast<unsigned short>(
+        static_cast<unsigned int>(turns * SpriteInstance3D::RotationSteps + 0.5f) & (SpriteInstance3D::RotationSteps - 1));
+
+    spriteInstance.mPaletteIndex = sprite.mPaletteIndex;
+    spriteInstance.mDrawOrder = static_cast<unsigned char>(sprite.mDrawOrder);
+    spriteInstance.mFlags = (sprite.mOriginMode == eSpriteOrigin_Center ? SpriteInstance3D::Flags_OriginCenter : 0) |
+        (depthAxisZ ? SpriteInstance3D::Flags_DepthAxisZ : 0);
+    spriteInstance.mDeltaBase = sprite.mDeltaBase;
+    spriteInstance.mDeltaBits[0] = static_cast<unsigned short>(sprite.mDeltaBits & 0xFFFF);
+    spriteInstance.mDeltaBits[1] = static_cast<unsigned short>(sprite.mDeltaBits >> 16);
+}
+
 bool SpriteBatch::Initialize()
 {
     mSpritesList.reserve(1024);
@@ -22,12 +49,16 @@ void SpriteBatch::Deinit()
 void SpriteBatch::Clear()
 {
     mSpritesList.clear();
+    mSpritesViewsMask.clear();
+    mSpritesOrder.clear();
     mDrawVertices.clear();
     mDrawIndices.clear();
+    mDrawInstances.clear();
     mBatchesList.clear();
+    mViewsList.clear();
 }
 
-void SpriteBatch::DrawSprite(const Sprite2D& sourceSprite)
+void SpriteBatch::DrawSprite(const Sprite2D& sourceSprite, unsigned int viewsMask)
 {
     if (sourceSprite.mTexture == nullptr)
     {
@@ -35,64 +66,184 @@ void SpriteBatch::DrawSprite(const Sprite2D& sourceSprite)
         return;
     }
     mSpritesList.push_back(sourceSprite);
+    mSpritesViewsMask.push_back(viewsMask);
 }
 
 void SpriteBatch::Flush()
 {
     if (!mSpritesList.empty())
     {
-        SortSprites();
-        GenerateSpritesBatches();
-        RenderSpritesBatches();
+        BuildViews(1);
+        UploadViews();
+        RenderView(0);
     }
     Clear();
 }
 
-void SpriteBatch::GenerateSpritesBatches()
+void SpriteBatch::BuildViews(int viewsCount)
+{
+    debug_assert(viewsCount > 0 && viewsCount <= 32);
+
+    mDrawVertices.clear();
+    mDrawIndices.clear();
+    mDrawInstances.clear();
+    mBatchesList.clear();
+    mViewsList.clear();
+
+    mInstancedViews = mInstancingAllowed && gCvarGraphicsInstancedSprites.mValue;
+    if (!mSpritesList.empty())
+    {
+        SortSprites();
+        if (!mInstancedViews)
+        {
+            GenerateSpritesVertices();
+        }
+    }
+    GenerateViewsBatches(viewsCount);
+}
+
+void SpriteBatch::UploadViews()
+{
+    if (mInstancedViews)
+    {
+        if (!mDrawInstances.empty())
+        {
+            mTrimeshBuffer.SetVertices(Sizeof_SpriteInstance3D * mDrawInstances.size(), mDrawInstances.data());
+        }
+        return;
+    }
+
+    if (mDrawIndices.empty())
+        return;
+
+    mTrimeshBuffer.SetVertices(Sizeof_SpriteVertex3D * mDrawVertices.size(), mDrawVertices.data());
+    mTrimeshBuffer.SetIndices(Sizeof_DrawIndex * mDrawIndices.size(), mDrawIndices.data());
+}
+
+int SpriteBatch::RenderView(int viewIndex)
+{
+    if (viewIndex < 0 || viewIndex >= static_cast<int>(mViewsList.size()))
+    {
+        debug_assert(false);
+        return 0;
+    }
+
+    const DrawViewBatches& viewBatches = mViewsList[viewIndex];
+    if (viewBatches.mBatchesCount == 0)
+        return 0;
+
+    if (mInstancedViews)
+    {
+        // unit quad corners are computed from vertex id, instances are offset with vertex format base offset
+        SpriteInstance3D_Format instanceFormat;
+        for (unsigned int ibatch = 0; ibatch < viewBatches.mBatchesCount; ++ibatch)
+        {
+            const DrawSpriteBatch& currBatch = mBatchesList[viewBatches.mFirstBatch + ibatch];
+            gGraphicsDevice.BindTexture(eTextureUnit_0, currBatch.mSpriteTexture);
+
+            instanceFormat.mBaseOffset = mTrimeshBuffer.mVertices.mOffset + Sizeof_SpriteInstance3D * currBatch.mFirstInstance;
+            gGraphicsDevice.BindVertexBuffer(mTrimeshBuffer.mVertices.mBuffer, instanceFormat);
+            gGraphicsDevice.RenderPrimitivesInstanced(ePrimitiveType_TriangleStrip, 0, NumVerticesPerSprite, currBatch.mInstanceCount);
+        }
+        return viewBatches.mSpritesCount;
+    }
+
+    SpriteVertex3D_Format vFormat;
+    mTrimeshBuffer.Bind(vFormat);
+
+    for (unsigned int ibatch = 0; ibatch < viewBatches.mBatchesCount; ++ibatch)
+    {
+        const DrawSpriteBatch& currBatch = mBatchesList[viewBatches.mFirstBatch + ibatch];
+        gGraphicsDevice.BindTexture(eTextureUnit_0, currBatch.mSpriteTexture);
+
+        unsigned int idxBufferOffset = mTrimeshBuffer.GetIndicesOffset() + Sizeof_DrawIndex * currBatch.mFirstIndex;
+        gGraphicsDevice.RenderIndexedPrimitives(ePrimitiveType_Triangles, eIndicesType_i32, idxBufferOffset, currBatch.mIndexCount);
+    }
+    return viewBatches.mSpritesCount;
+}
+
+void SpriteBatch::GenerateViewsBatches(int viewsCount)
+{
+    // sprites vertices are stored in sorted order, so index ranges of each view keep that order
+    // instanced views get own copy of instance per sprite, which is cheaper than four vertices
+    const int numSprites = mSpritesList.size();
+    const bool depthAxisZ = (mDepthAxis == DepthAxis_Z);
+    if (mInstancedViews)
+    {
+        mDrawInstances.reserve(numSprites);
+    }
+    for (int iview = 0; iview < viewsCount; ++iview)
+    {
+        const unsigned int viewBit = (1U << iview);
+
+        DrawViewBatches viewBatches;
+        viewBatches.mFirstBatch = mBatchesList.size();
+        viewBatches.mBatchesCount = 0;
+        viewBatches.mSpritesCount = 0;
+
+        DrawSpriteBatch* currentBatch = nullptr;
+        for (int isprite = 0; isprite < numSprites; ++isprite)
+        {
+            const unsigned int spriteIndex = mSpritesOrder[isprite];
+            if ((mSpritesViewsMask[spriteIndex] & viewBit) == 0)
+                continue;
+
+            const Sprite2D& sprite = mSpritesList[spriteIndex];
+            // start new batch
+            if (currentBatch == nullptr || sprite.mTexture != currentBatch->mSpriteTexture)
+            {
+                DrawSpriteBatch newBatch;
+                newBatch.mFirstVertex = isprite * NumVerticesPerSprite;
+                newBatch.mFirstIndex = mDrawIndices.size();
+                newBatch.mVertexCount = 0;
+                newBatch.mIndexCount = 0;
+                newBatch.mFirstInstance = mDrawInstances.size();
+                newBatch.mInstanceCount = 0;
+                newBatch.mSpriteTexture = sprite.mTexture;
+                mBatchesList.push_back(newBatch);
+                currentBatch = &mBatchesList.back();
+            }
+
+            ++viewBatches.mSpritesCount;
+            if (mInstancedViews)
+            {
+                ++currentBatch->mInstanceCount;
+                mDrawInstances.emplace_back();
+                SetupSpriteInstance(sprite, depthAxisZ, mDrawInstances.back());
+                continue;
+            }
+
+            currentBatch->mVertexCount += NumVerticesPerSprite;
+            currentBatch->mIndexCount += NumIndicesPerSprite;
+
+            // setup indices
+            const DrawIndex vertexOffset = isprite * NumVerticesPerSprite;
+            mDrawIndices.push_back(vertexOffset + 0);
+            mDrawIndices.push_back(vertexOffset + 1);
+            mDrawIndices.push_back(vertexOffset + 2);
+            mDrawIndices.push_back(vertexOffset + 1);
+            mDrawIndices.push_back(vertexOffset + 2);
+            mDrawIndices.push_back(vertexOffset + 3);
+        }
+        viewBatches.mBatchesCount = mBatchesList.size() - viewBatches.mFirstBatch;
+        mViewsList.push_back(viewBatches);
+    }
+}
+
+void SpriteBatch::GenerateSpritesVertices()
 {
     int numSprites = mSpritesList.size();
 
     int totalVertexCount = numSprites * NumVerticesPerSprite; 
     debug_assert(totalVertexCount > 0);
 
-    int totalIndexCount = numSprites * NumIndicesPerSprite; 
-    debug_assert(totalIndexCount > 0);
-
     // allocate memory for mesh data
     mDrawVertices.resize(totalVertexCount);
     SpriteVertex3D* vertexData = mDrawVertices.data();
 
-    mDrawIndices.resize(totalIndexCount);
-    DrawIndex* indexData = mDrawIndices.data();
-
-    // initial batch
-    mBatchesList.clear();
-    mBatchesList.emplace_back();
-    DrawSpriteBatch* currentBatch = &mBatchesList.back();
-    currentBatch->mFirstVertex = 0;
-    currentBatch->mFirstIndex = 0;
-    currentBatch->mVertexCount = 0;
-    currentBatch->mIndexCount = 0;
-    currentBatch->mSpriteTexture = mSpritesList[0].mTexture;
-
     for (int isprite = 0; isprite < numSprites; ++isprite)
     {
-        const Sprite2D& sprite = mSpritesList[isprite];
-        // start new batch
-        if (sprite.mTexture != currentBatch->mSpriteTexture)
-        {
-            DrawSpriteBatch newBatch;
-            newBatch.mFirstVertex = currentBatch->mVertexCount + currentBatch->mFirstVertex;
-            newBatch.mFirstIndex = currentBatch->mIndexCount + currentBatch->mFirstIndex;
-            newBatch.mVertexCount = 0;
-            newBatch.mIndexCount = 0;
-            newBatch.mSpriteTexture = sprite.mTexture;
-            mBatchesList.push_back(newBatch);
-            currentBatch = &mBatchesList.back();
-        }
-
-        currentBatch->mVertexCount += NumVerticesPerSprite;   
-        currentBatch->mIndexCount += NumIndicesPerSprite;
+        const Sprite2D& sprite = mSpritesList[mSpritesOrder[isprite]];
 
         int vertexOffset = isprite * NumVerticesPerSprite;
 
@@ -120,6 +271,9 @@ void SpriteBatch::GenerateSpritesBatches()
                 vertexData[vertexOffset + i].mPosition.y = sprite.mHeight;
                 // common part
                 vertexData[vertexOffset + i].mClutIndex = sprite.mPaletteIndex;
+                vertexData[vertexOffset + i].mDeltaBase = sprite.mDeltaBase;
+                vertexData[vertexOffset + i].mDeltaBits[0] = static_cast<unsigned short>(sprite.mDeltaBits & 0xFFFF);
+                vertexData[vertexOffset + i].mDeltaBits[1] = static_cast<unsigned short>(sprite.mDeltaBits >> 16);
                 vertexData[vertexOffset + i].mTextureSize[0] = sprite.mTexture->mSize.x;
                 vertexData[vertexOffset + i].mTextureSize[1] = sprite.mTexture->mSize.y;
             }
@@ -133,58 +287,70 @@ void SpriteBatch::GenerateSpritesBatches()
                 vertexData[vertexOffset + i].mPosition.z = sprite.mHeight;
                 // common part
                 vertexData[vertexOffset + i].mClutIndex = sprite.mPaletteIndex;
+                vertexData[vertexOffset + i].mDeltaBase = sprite.mDeltaBase;
+                vertexData[vertexOffset + i].mDeltaBits[0] = static_cast<unsigned short>(sprite.mDeltaBits & 0xFFFF);
+                vertexData[vertexOffset + i].mDeltaBits[1] = static_cast<unsigned short>(sprite.mDeltaBits >> 16);
                 vertexData[vertexOffset + i].mTextureSize[0] = sprite.mTexture->mSize.x;
                 vertexData[vertexOffset + i].mTextureSize[1] = sprite.mTexture->mSize.y;
             }
         }
-
-        // setup indices
-        int indexOffset = isprite * NumIndicesPerSprite;
-        indexData[indexOffset + 0] = vertexOffset + 0;
-        indexData[indexOffset + 1] = vertexOffset + 1;
-        indexData[indexOffset + 2] = vertexOffset + 2;
-        indexData[indexOffset + 3] = vertexOffset + 1;
-        indexData[indexOffset + 4] = vertexOffset + 2;
-        indexData[indexOffset + 5] = vertexOffset + 3;
     }
 }
 
-void SpriteBatch::RenderSpritesBatches()
+void SpriteBatch::BeginBatch(DepthAxis depthAxis, eSpritesSortMode sortMode)
 {
-    SpriteVertex3D_Format vFormat;
-    mTrimeshBuffer.SetVertices(Sizeof_SpriteVertex3D * mDrawVertices.size(), mDrawVertices.data());
-    mTrimeshBuffer.SetIndices(Sizeof_DrawIndex * mDrawIndices.size(), mDrawIndices.data());
-    mTrimeshBuffer.Bind(vFormat);
+    Clear();
 
-    for (const DrawSpriteBatch& currBatch: mBatchesList)
-    {
-        gGraphicsDevice.BindTexture(eTextureUnit_0, currBatch.mSpriteTexture);
+    mDepthAxis = depthAxis;
+    mSortMode = sortMode;
+}
 
-        unsigned int idxBufferOffset = Sizeof_DrawIndex * currBatch.mFirstIndex;
-        gGraphicsDevice.RenderIndexedPrimitives(ePrimitiveType_Triangles, eIndicesType_i32, idxBufferOffset, currBatch.mIndexCount);
-    }
+void SpriteBatch::SetInstancingAllowed(bool isAllowed)
+{
+    mInstancingAllowed = isAllowed;
 }
 
-void SpriteBatch::BeginBatch(DepthAxis depthAxis, eSpritesSortMode sortMode)
+bool SpriteBatch::IsInstancedViews() const
 {
-    Clear();
+    return mInstancedViews;
+}
 
-    mDepthAxis = depthAxis;
-    mSortMode = sortMode;
+unsigned int SpriteBatch::GetViewsDataBytes() const
+{
+    if (mInstancedViews)
+        return Sizeof_SpriteInstance3D * mDrawInstances.size();
+
+    return (Sizeof_SpriteVertex3D * mDrawVertices.size()) + (Sizeof_DrawIndex * mDrawIndices.size());
 }
 
 void SpriteBatch::SortSprites()
 {
+    // sprites are sorted by indices, stable sort gives same order as sorting sprites itself
+    const unsigned int numSprites = mSpritesList.size();
+    mSpritesOrder.resize(numSprites);
+    for (unsigned int isprite = 0; isprite < numSprites; ++isprite)
+    {
+        mSpritesOrder[isprite] = isprite;
+    }
+
     if (mSortMode == eSpritesSortMode_None)
         return;
 
+    auto SortSpritesOrder = [this](auto sortProc)
+    {
+        std::stable_sort(mSpritesOrder.begin(), mSpritesOrder.end(), [this, &sortProc](unsigned int lhs, unsigned int rhs)
+        {
+            return sortProc(mSpritesList[lhs], mSpritesList[rhs]);
+        });
+    };
+
     if (mSortMode == eSpritesSortMode_Height)
     {
         static auto SortProc = [](const Sprite2D& lhs, const Sprite2D& rhs)
         {
             return lhs.mHeight < rhs.mHeight;
         };
-        std::stable_sort(mSpritesList.begin(), mSpritesList.end(), SortProc);
+        SortSpritesOrder(SortProc);
         return;
     }
 
@@ -194,7 +360,7 @@ void SpriteBatch::SortSprites()
         {
             return lhs.mDrawOrder < rhs.mDrawOrder;
         };
-        std::stable_sort(mSpritesList.begin(), mSpritesList.end(), SortProc);
+        SortSpritesOrder(SortProc);
         return;
     }
 
@@ -208,7 +374,7 @@ void SpriteBatch::SortSprites()
             }
             return (lhs.mDrawOrder < rhs.mDrawOrder);
         };  
-        std::stable_sort(mSpritesList.begin(), mSpritesList.end(), SortProc);
+        SortSpritesOrder(SortProc);
         return;
     }
 }
@@ -33,11 +33,35 @@ public:
 
     // add sprite to batch but does not draw it immediately
     // @param sourceSprite: Source sprite data
-    void DrawSprite(const Sprite2D& sourceSprite);
+    // @param viewsMask: Views in which sprite is visible, bit per view index
+    void DrawSprite(const Sprite2D& sourceSprite, unsigned int viewsMask = 1);
+
+    // sort all batched sprites once and generate geometry shared by multiple views
+    // each view gets own index range that contains only sprites visible in it
+    // @param viewsCount: Number of views, see DrawSprite viewsMask
+    void BuildViews(int viewsCount);
+
+    // upload geometry generated by BuildViews to video memory
+    void UploadViews();
+
+    // render sprites of single view, geometry must be built and uploaded
+    // @param viewIndex: View index
+    // @returns Number of sprites drawn
+    int RenderView(int viewIndex);
+
+    // allow to build sprites as instances of unit quad instead of vertices, it is also controlled by r_instancedSprites
+    // instanced views must be rendered with sprites instanced program
+    void SetInstancingAllowed(bool isAllowed);
+
+    // whether geometry built by BuildViews is per sprite instances
+    bool IsInstancedViews() const;
+
+    // get size of geometry built by BuildViews, bytes
+    unsigned int GetViewsDataBytes() const;
 
 private:
-    void GenerateSpritesBatches();
-    void RenderSpritesBatches();
+    void GenerateSpritesVertices();
+    void GenerateViewsBatches(int viewsCount);
     void SortSprites();
 
 private:
@@ -48,18 +72,33 @@ private:
         unsigned int mFirstIndex;
         unsigned int mVertexCount;
         unsigned int mIndexCount;
+        unsigned int mFirstInstance; // instanced views only
+        unsigned int mInstanceCount;
         GpuTexture2D* mSpriteTexture;
     };
+    // index range of batches for single view
+    struct DrawViewBatches
+    {
+        unsigned int mFirstBatch;
+        unsigned int mBatchesCount;
+        unsigned int mSpritesCount;
+    };
     // all sprites stored as is until they needs to be flushed
     std::vector<Sprite2D> mSpritesList;
+    std::vector<unsigned int> mSpritesViewsMask;
+    std::vector<unsigned int> mSpritesOrder; // sorted sprites indices
 
     // draw data buffers
     std::vector<SpriteVertex3D> mDrawVertices;
     std::vector<DrawIndex> mDrawIndices;
+    std::vector<SpriteInstance3D> mDrawInstances; // sprite instances of each view are stored sequentially
 
     std::vector<DrawSpriteBatch> mBatchesList;
+    std::vector<DrawViewBatches> mViewsList;
     TrimeshBuffer mTrimeshBuffer;
 
     DepthAxis mDepthAxis = DepthAxis_Y;
     eSpritesSortMode mSortMode = eSpritesSortMode_None;
+    bool mInstancingAllowed = false;
+    bool mInstancedViews = false;
 };
\ No newline at end of file
@@ -10,7 +10,14 @@
 
 const int ObjectsTextureSizeX = 2048;
 const int ObjectsTextureSizeY = 1024;
+const int ObjectsSpritesheetMaxPages = 4;
 const int SpritesSpacing = 4;
+const int SpriteDeltasLayerSize = 256;
+const int SpriteDeltasTableWidth = 512; // entries per row
+
+// bitmaps decoding is split between threads in chunks no smaller than this
+const int MinSpritesPerThread = 64;
+const int MinBlocksPerThread = 32;
 
 SpriteManager gSpriteManager;
 
@@ -19,11 +26,13 @@ bool SpriteManager::InitLevelSprites()
     Cleanup();
     debug_assert(gGameMap.mStyleData.IsLoaded());
 
+    double blocksStartTime = gSystem.GetSystemSeconds();
     if (!InitBlocksTexture())
     {
         gConsole.LogMessage(eLogMessage_Warning, "Cannot create blocks texture");
         return false;
     }
+    double blocksTime = gSystem.GetSystemSeconds() - blocksStartTime;
 
     if (!InitBlocksIndicesTable())
     {
@@ -31,11 +40,29 @@ bool SpriteManager::InitLevelSprites()
         return false;
     }
 
+    double spritesStartTime = gSystem.GetSystemSeconds();
     if (!InitObjectsSpritesheet())
     {
         gConsole.LogMessage(eLogMessage_Warning, "Cannot create objects spritesheet");
         return false;
     }
+    double spritesTime = gSystem.GetSystemSeconds() - spritesStartTime;
+
+    double deltasStartTime = gSystem.GetSystemSeconds();
+    if (!InitSpriteDeltas())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot create sprite deltas texture");
+        return false;
+    }
+    double deltasTime = gSystem.GetSystemSeconds() - deltasStartTime;
+
+    gConsole.LogMessage(eLogMessage_Info, "Style %03d: %d block textures built in %.2f ms, %d sprites in %d atlas pages built in %.2f ms",
+        gGameMap.mStyleFileNumber,
+        gGameMap.mStyleData.GetBlockTexturesCount(), blocksTime * 1000.0,
+        (int) mObjectsSpritesheet.mEntries.size(), (int) mObjectsSpritesheet.mPageTextures.size(), spritesTime * 1000.0);
+    gConsole.LogMessage(eLogMessage_Info, "Style %03d: sprite deltas in %d layers built in %.2f ms",
+        gGameMap.mStyleFileNumber,
+        mSpriteDeltasTextureArray ? mSpriteDeltasTextureArray->mLayersCount : 0, deltasTime * 1000.0);
 
     InitPalettesTable();
     InitBlocksAnimations();
@@ -45,8 +72,6 @@ bool SpriteManager::InitLevelSprites()
 
 void SpriteManager::Cleanup()
 {
-    FlushSpritesCache();
-    DestroySpriteTextures();
     FreeExplosionFrames();
     mIndicesTableChanged = false;
     if (mBlocksTextureArray)
@@ -61,10 +86,9 @@ void SpriteManager::Cleanup()
         mBlocksIndicesTable = nullptr;
     }
 
-    if (mObjectsSpritesheet.mSpritesheetTexture)
+    for (GpuTexture2D* currTexture: mObjectsSpritesheet.mPageTextures)
     {
-        gGraphicsDevice.DestroyTexture(mObjectsSpritesheet.mSpritesheetTexture);
-        mObjectsSpritesheet.mSpritesheetTexture = nullptr;
+        gGraphicsDevice.DestroyTexture(currTexture);
     }
 
     if (mPalettesTable)
@@ -79,9 +103,22 @@ void SpriteManager::Cleanup()
         mPaletteIndicesTable = nullptr;
     }
 
+    if (mSpriteDeltasTable)
+    {
+        gGraphicsDevice.DestroyTexture(mSpriteDeltasTable);
+        mSpriteDeltasTable = nullptr;
+    }
+
+    if (mSpriteDeltasTextureArray)
+    {
+        gGraphicsDevice.DestroyTexture(mSpriteDeltasTextureArray);
+        mSpriteDeltasTextureArray = nullptr;
+    }
+
+    mSpriteDeltasBase.clear();
     mBlocksIndices.clear();
     mBlocksAnimations.clear();
-    mObjectsSpritesheet.mEntries.clear();
+    mObjectsSpritesheet.Clear();
 }
 
 bool SpriteManager::InitObjectsSpritesheet()
@@ -99,25 +136,9 @@ bool SpriteManager::InitObjectsSpritesheet()
     debug_assert(ObjectsTextureSizeX > 0);
     debug_assert(ObjectsTextureSizeY > 0);
 
-    mObjectsSpritesheet.mSpritesheetTexture = gGraphicsDevice.CreateTexture2D(eTextureFormat_R8UI, ObjectsTextureSizeX, ObjectsTextureSizeY, nullptr);
-    debug_assert(mObjectsSpritesheet.mSpritesheetTexture);
-
-    if (mObjectsSpritesheet.mSpritesheetTexture == nullptr)
-        return false;
-
     mObjectsSpritesheet.mEntries.resize(totalSprites);
+    mObjectsSpritesheet.mEntriesPages.resize(totalSprites);
 
-    // allocate temporary bitmap
-    PixelsArray spritesBitmap;
-    if (!spritesBitmap.Create(eTextureFormat_R8UI, ObjectsTextureSizeX, ObjectsTextureSizeY, gMemoryManager.mFrameHeapAllocator))
-    {
-        debug_assert(false);
-        return false;
-    }
-
-    spritesBitmap.FillWithColor(0);
-
-    // detect total layers count
     std::vector<stbrp_node> stbrp_nodes(ObjectsTextureSizeX);
     std::vector<stbrp_rect> stbrp_rects(totalSprites);
 
@@ -131,29 +152,88 @@ bool SpriteManager::InitObjectsSpritesheet()
         ++icurr;
     }
 
-    float tcx = 1.0f / ObjectsTextureSizeX;
-    float tcy = 1.0f / ObjectsTextureSizeY;
+    // pack sprites, ones that did not fit are packed into next page
+    int numRemaining = totalSprites;
+    while (numRemaining > 0)
+    {
+        int pageIndex = (int) mObjectsSpritesheet.mPageTextures.size();
+        if (pageIndex == ObjectsSpritesheetMaxPages)
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Objects spritesheet pages limit reached, %d sprites not packed", numRemaining);
+            return false;
+        }
 
-    // pack sprites
-    bool all_done = false;
-    {
 		stbrp_context context;
 		stbrp_init_target(&context, ObjectsTextureSizeX, ObjectsTextureSizeY, stbrp_nodes.data(), stbrp_nodes.size());
-		all_done = stbrp_pack_rects(&context, stbrp_rects.data(), stbrp_rects.size()) > 0;
+		stbrp_pack_rects(&context, stbrp_rects.data(), numRemaining);
 
-        // write sprites to temporary bitmap
-        int numPacked = 0;
-        for (const stbrp_rect& curr_rc: stbrp_rects)
+        // packed rects are moved to the end of remaining range
+        auto packedRectsIter = std::stable_partition(stbrp_rects.begin(), stbrp_rects.begin() + numRemaining, 
+            [](const stbrp_rect& rc)
+            {
+                return rc.was_packed == 0;
+            });
+        const int firstPacked = (int) (packedRectsIter - stbrp_rects.begin());
+        const int numPacked = numRemaining - firstPacked;
+        if (numPacked == 0)
         {
-            if (curr_rc.was_packed == 0)
-                continue;
+            debug_assert(false); // sprite is larger than page
+            return false;
+        }
+        numRemaining = firstPacked;
 
-            ++numPacked;
-            if (!cityStyle.GetSpriteTexture(curr_rc.id, &spritesBitmap, curr_rc.x, curr_rc.y))
+        // shrink page to used height
+        int pageSizeY = 1;
+        for (int irect = firstPacked; irect < firstPacked + numPacked; ++irect)
+        {
+            pageSizeY = std::max(pageSizeY, stbrp_rects[irect].y + stbrp_rects[irect].h);
+        }
+        pageSizeY = std::min((int) cxx::get_next_pot(pageSizeY), ObjectsTextureSizeY);
+
+        // allocate temporary bitmap
+        PixelsArray spritesBitmap;
+        if (!spritesBitmap.Create(eTextureFormat_R8UI, ObjectsTextureSizeX, pageSizeY, gMemoryManager.mFrameHeapAllocator))
+        {
+            debug_assert(false);
+            return false;
+        }
+
+        spritesBitmap.FillWithColor(0);
+
+        // write sprites to temporary bitmap, each thread writes to its own rectangles
+        std::atomic<int> numFailed {0};
+        gWorkerPool.parallel_for(numPacked, MinSpritesPerThread, 0, [&](int ibegin, int iend)
             {
-                debug_assert(false);
-                return false;
-            }
+                for (int irect = firstPacked + ibegin; irect < firstPacked + iend; ++irect)
+                {
+                    const stbrp_rect& curr_rc = stbrp_rects[irect];
+                    if (!cityStyle.GetSpriteTexture(curr_rc.id, &spritesBitmap, curr_rc.x, curr_rc.y))
+                    {
+                        numFailed.fetch_add(1);
+                    }
+                }
+            });
+
+        if (numFailed > 0)
+        {
+            debug_assert(false);
+            return false;
+        }
+
+        // upload to texture
+        GpuTexture2D* pageTexture = gGraphicsDevice.CreateTexture2D(eTextureFormat_R8UI, ObjectsTextureSizeX, pageSizeY, spritesBitmap.mData);
+        debug_assert(pageTexture);
+
+        if (pageTexture == nullptr)
+            return false;
+
+        mObjectsSpritesheet.mPageTextures.push_back(pageTexture);
+
+        float tcx = 1.0f / ObjectsTextureSizeX;
+        float tcy = 1.0f / pageSizeY;
+        for (int irect = firstPacked; irect < firstPacked + numPacked; ++irect)
+        {
+            const stbrp_rect& curr_rc = stbrp_rects[irect];
 
             TextureRegion& spritesheetRecord = mObjectsSpritesheet.mEntries[curr_rc.id];
             spritesheetRecord.mRectangle.x = curr_rc.x;
@@ -164,22 +244,166 @@ bool SpriteManager::InitObjectsSpritesheet()
             spritesheetRecord.mV0 = spritesheetRecord.mRectangle.y * tcy;
             spritesheetRecord.mU1 = (spritesheetRecord.mRectangle.x + spritesheetRecord.mRectangle.w) * tcx;
             spritesheetRecord.mV1 = (spritesheetRecord.mRectangle.y + spritesheetRecord.mRectangle.h) * tcy;
+            mObjectsSpritesheet.mEntriesPages[curr_rc.id] = pageIndex;
         }
-
-        if (numPacked == 0)
-        {
-            debug_assert(false);
-            return false;
-        }
-
-        // upload to texture
-        if (!mObjectsSpritesheet.mSpritesheetTexture->Upload(spritesBitmap.mData))
-        {
-            debug_assert(false);
-        }
     }
-    debug_assert(all_done);
-    return all_done;
+    return true;
+}
+
+bool SpriteManager::InitSpriteDeltas()
+{
+    StyleData& cityStyle = gGameMap.mStyleData;
+
+    const int totalSprites = (int) cityStyle.mSprites.size();
+    mSpriteDeltasBase.resize(totalSprites);
+
+    // map delta entries to sprites
+    struct DeltaEntry
+    {
+        int mSpriteIndex;
+        int mDeltaIndex;
+        Rect mBounds; // within sprite
+    };
+    std::vector<DeltaEntry> deltaEntries;
+    for (int isprite = 0; isprite < totalSprites; ++isprite)
+    {
+        const SpriteInfo& sprite = cityStyle.mSprites[isprite];
+        mSpriteDeltasBase[isprite] = (unsigned short) deltaEntries.size();
+        for (int idelta = 0; idelta < sprite.mDeltaCount; ++idelta)
+        {
+            DeltaEntry deltaEntry;
+            deltaEntry.mSpriteIndex = isprite;
+            deltaEntry.mDeltaIndex = idelta;
+            if (!cityStyle.GetSpriteDeltaBounds(isprite, idelta, deltaEntry.mBounds))
+            {
+                debug_assert(false);
+                return false;
+            }
+            deltaEntries.push_back(deltaEntry);
+        }
+    }
+
+    const int totalDeltas = (int) deltaEntries.size();
+    if (totalDeltas == 0)
+    {
+        gConsole.LogMessage(eLogMessage_Info, "Skip building sprite deltas texture");
+        return true;
+    }
+    if (totalDeltas > 0xFFFF)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Too many sprite deltas: %d", totalDeltas);
+        return false;
+    }
+
+    // pack changed areas, ones that did not fit are packed into next layer
+    std::vector<stbrp_node> stbrp_nodes(SpriteDeltasLayerSize);
+    std::vector<stbrp_rect> stbrp_rects;
+    stbrp_rects.reserve(totalDeltas);
+    for (int ientry = 0; ientry < totalDeltas; ++ientry)
+    {
+        const Rect& bounds = deltaEntries[ientry].mBounds;
+        if (bounds.w == 0 || bounds.h == 0)
+            continue;
+
+        stbrp_rect rc {};
+        rc.id = ientry;
+        rc.w = bounds.w;
+        rc.h = bounds.h;
+        stbrp_rects.push_back(rc);
+    }
+
+    // table texels are zeroed so empty deltas do not cover anything
+    std::vector<unsigned short> tableTexels(cxx::get_next_pot((totalDeltas + SpriteDeltasTableWidth - 1) / SpriteDeltasTableWidth) * SpriteDeltasTableWidth * 8, 0);
+    std::vector<int> rectsLayers(stbrp_rects.size());
+
+    int layersCount = 0;
+    int numRemaining = (int) stbrp_rects.size();
+    while (numRemaining > 0)
+    {
+        stbrp_context context;
+        stbrp_init_target(&context, SpriteDeltasLayerSize, SpriteDeltasLayerSize, stbrp_nodes.data(), stbrp_nodes.size());
+        stbrp_pack_rects(&context, stbrp_rects.data(), numRemaining);
+
+        // packed rects are moved to the end of remaining range
+        auto packedRectsIter = std::stable_partition(stbrp_rects.begin(), stbrp_rects.begin() + numRemaining, 
+            [](const stbrp_rect& rc)
+            {
+                return rc.was_packed == 0;
+            });
+        const int firstPacked = (int) (packedRectsIter - stbrp_rects.begin());
+        if (firstPacked == numRemaining)
+        {
+            debug_assert(false); // delta is larger than layer
+            return false;
+        }
+
+        for (int irect = firstPacked; irect < numRemaining; ++irect)
+        {
+            rectsLayers[irect] = layersCount;
+        }
+        numRemaining = firstPacked;
+        ++layersCount;
+    }
+
+    // fill deltas table
+    for (int irect = 0, numRects = (int) stbrp_rects.size(); irect < numRects; ++irect)
+    {
+        const stbrp_rect& curr_rc = stbrp_rects[irect];
+        const DeltaEntry& deltaEntry = deltaEntries[curr_rc.id];
+        const Rect& spriteRect = mObjectsSpritesheet.mEntries[deltaEntry.mSpriteIndex].mRectangle;
+
+        unsigned short* entryTexels = &tableTexels[curr_rc.id * 8];
+        entryTexels[0] = spriteRect.x + deltaEntry.mBounds.x;
+        entryTexels[1] = spriteRect.y + deltaEntry.mBounds.y;
+        entryTexels[2] = deltaEntry.mBounds.w;
+        entryTexels[3] = deltaEntry.mBounds.h;
+        entryTexels[4] = curr_rc.x;
+        entryTexels[5] = curr_rc.y;
+        entryTexels[6] = rectsLayers[irect];
+    }
+
+    // allocate temporary bitmap for all layers, they are stored one after another, too large for frame heap
+    PixelsArray deltasBitmap;
+    if (!deltasBitmap.Create(eTextureFormat_R16UI, SpriteDeltasLayerSize, SpriteDeltasLayerSize * layersCount))
+    {
+        debug_assert(false);
+        return false;
+    }
+    ::memset(deltasBitmap.mData, 0, deltasBitmap.mSizex * deltasBitmap.mSizey * NumBytesPerPixel(deltasBitmap.mFormat));
+
+    // write deltas to temporary bitmap, each thread writes to its own rectangles
+    std::atomic<int> numFailed {0};
+    gWorkerPool.parallel_for((int) stbrp_rects.size(), MinSpritesPerThread, 0, [&](int ibegin, int iend)
+        {
+            for (int irect = ibegin; irect < iend; ++irect)
+            {
+                const stbrp_rect& curr_rc = stbrp_rects[irect];
+                const DeltaEntry& deltaEntry = deltaEntries[curr_rc.id];
+                if (!cityStyle.GetSpriteDeltaTexture(deltaEntry.mSpriteIndex, deltaEntry.mDeltaIndex, &deltasBitmap, 
+                    curr_rc.x, curr_rc.y + rectsLayers[irect] * SpriteDeltasLayerSize))
+                {
+                    numFailed.fetch_add(1);
+                }
+            }
+        });
+
+    if (numFailed > 0)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot read sprite deltas");
+        return false;
+    }
+
+    // upload all layers at once
+    mSpriteDeltasTextureArray = gGraphicsDevice.CreateTextureArray2D(eTextureFormat_R16UI, SpriteDeltasLayerSize, SpriteDeltasLayerSize, 
+        layersCount, deltasBitmap.mData);
+    debug_assert(mSpriteDeltasTextureArray);
+    if (mSpriteDeltasTextureArray == nullptr)
+        return false;
+
+    const int tableHeight = (int) tableTexels.size() / (SpriteDeltasTableWidth * 8);
+    mSpriteDeltasTable = gGraphicsDevice.CreateTexture2D(eTextureFormat_RGBA16UI, SpriteDeltasTableWidth * 2, tableHeight, tableTexels.data());
+    debug_assert(mSpriteDeltasTable);
+    return mSpriteDeltasTable != nullptr;
 }
 
 bool SpriteManager::InitBlocksTexture()
@@ -194,39 +418,55 @@ bool SpriteManager::InitBlocksTexture()
         return true;
     }
 
-    // allocate temporary bitmap
-    PixelsArray blockBitmap;
-    if (!blockBitmap.Create(eTextureFormat_R8, MAP_BLOCK_TEXTURE_DIMS, MAP_BLOCK_TEXTURE_DIMS, gMemoryManager.mFrameHeapAllocator))
+    // map texture layers to blocks
+    struct BlockLayer
     {
-        debug_assert(false);
-        return false;
-    }
-
-    mBlocksTextureArray = gGraphicsDevice.CreateTextureArray2D(eTextureFormat_R8UI, blockBitmap.mSizex, blockBitmap.mSizey, totalTextures, nullptr);
-    debug_assert(mBlocksTextureArray);
-    
-    int currentLayerIndex = 0;
+        eBlockType mBlockType;
+        int mBlockIndex;
+    };
+    std::vector<BlockLayer> blockLayers;
+    blockLayers.reserve(totalTextures);
     for (int iblockType = 0; iblockType < eBlockType_COUNT; ++iblockType)
     {
         int numTextures = cityStyle.GetBlockTexturesCount((eBlockType) iblockType);
         for (int itexture = 0; itexture < numTextures; ++itexture)
         {
-            if (!cityStyle.GetBlockTexture((eBlockType) iblockType, itexture, &blockBitmap, 0, 0, 0))
-            {
-                gConsole.LogMessage(eLogMessage_Warning, "Cannot read block texture: %d %d", iblockType, itexture);
-                return false;
-            }
+            blockLayers.push_back({(eBlockType) iblockType, itexture});
+        }
+    }
+    debug_assert((int) blockLayers.size() == totalTextures);
 
-            // upload bitmap to gpu
-            if (!mBlocksTextureArray->Upload(currentLayerIndex, 1, blockBitmap.mData))
+    // allocate temporary bitmap for all layers, they are stored one after another, too large for frame heap
+    PixelsArray blocksBitmap;
+    if (!blocksBitmap.Create(eTextureFormat_R8, MAP_BLOCK_TEXTURE_DIMS, MAP_BLOCK_TEXTURE_DIMS * totalTextures))
+    {
+        debug_assert(false);
+        return false;
+    }
+
+    std::atomic<int> numFailed {0};
+    gWorkerPool.parallel_for(totalTextures, MinBlocksPerThread, 0, [&](int ibegin, int iend)
+        {
+            for (int ilayer = ibegin; ilayer < iend; ++ilayer)
             {
-                debug_assert(false);
+                const BlockLayer& blockLayer = blockLayers[ilayer];
+                if (!cityStyle.GetBlockTexture(blockLayer.mBlockType, blockLayer.mBlockIndex, &blocksBitmap, 0, ilayer * MAP_BLOCK_TEXTURE_DIMS, 0))
+                {
+                    numFailed.fetch_add(1);
+                }
             }
-            
-            ++currentLayerIndex;
-        }
+        });
+
+    if (numFailed > 0)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot read block textures");
+        return false;
     }
-    return true;
+
+    // upload all layers at once
+    mBlocksTextureArray = gGraphicsDevice.CreateTextureArray2D(eTextureFormat_R8UI, MAP_BLOCK_TEXTURE_DIMS, MAP_BLOCK_TEXTURE_DIMS, totalTextures, blocksBitmap.mData);
+    debug_assert(mBlocksTextureArray);
+    return mBlocksTextureArray != nullptr;
 }
 
 bool SpriteManager::InitBlocksIndicesTable()
@@ -489,148 +729,20 @@ void SpriteManager::DumpSpriteDeltas(const std::string& outputLocation, int spri
     } // for
 }
 
-void SpriteManager::FlushSpritesCache()
-{
-    // move all textures to pool
-    for (SpriteCacheElement& currElement: mSpritesCache)
-    {
-        mFreeSpriteTextures.push_back(currElement.mTexture);
-    }
-
-    mSpritesCache.clear();
-}
-
-void SpriteManager::FlushSpritesCache(GameObjectID objectID)
+void SpriteManager::GetSpriteTexture(int spriteIndex, int remap, SpriteDeltaBits deltaBits, Sprite2D& sourceSprite)
 {
-    for (auto icurrent = mSpritesCache.begin(); icurrent != mSpritesCache.end(); )
-    {
-        if (icurrent->mObjectID == objectID)
-        {
-            // move texture to pool
-            mFreeSpriteTextures.push_back(icurrent->mTexture);
-
-            icurrent = mSpritesCache.erase(icurrent);
-            continue;
-        }
-        ++icurrent;
-    }
-}
-
-void SpriteManager::DestroySpriteTextures()
-{
-    for (GpuTexture2D* currTexture: mFreeSpriteTextures)
-    {
-        gGraphicsDevice.DestroyTexture(currTexture);
-    }
-    mFreeSpriteTextures.clear();
-}
-
-void SpriteManager::GetSpriteTexture(GameObjectID objectID, int spriteIndex, int remap, SpriteDeltaBits deltaBits, Sprite2D& sourceSprite)
-{
-    sourceSprite.mTexture = nullptr;
-    if (deltaBits == 0)
-    {
-        GetSpriteTexture(objectID, spriteIndex, remap, sourceSprite);
-        return;
-    }
-
-    debug_assert(spriteIndex < (int) mObjectsSpritesheet.mEntries.size());
+    GetSpriteTexture(spriteIndex, remap, sourceSprite);
 
     // filter out present delta bits
-    SpriteInfo& spriteStyle = gGameMap.mStyleData.mSprites[spriteIndex];
-    deltaBits &= spriteStyle.GetDeltaBits();
-
-    debug_assert(remap >= 0);
-    sourceSprite.mPaletteIndex = gGameMap.mStyleData.GetSpritePaletteIndex(spriteStyle.mClut, remap);
-
-    if (deltaBits == 0)
-    {
-        GetSpriteTexture(objectID, spriteIndex, remap, sourceSprite);
-        return;
-    }
-
-    // find sprite with deltas within cache
-    for (SpriteCacheElement& currElement: mSpritesCache)
-    {
-        if (currElement.mObjectID == objectID && currElement.mSpriteIndex == spriteIndex)
-        {
-            if (currElement.mSpriteDeltaBits == deltaBits)
-            {
-                sourceSprite.mTexture = currElement.mTexture;
-                sourceSprite.mTextureRegion = currElement.mTextureRegion;
-                return;
-            }
-            currElement.mSpriteDeltaBits = deltaBits;
-
-            // upload changes
-            PixelsArray pixels;
-            if (!pixels.Create(currElement.mTexture->mFormat, 
-                currElement.mTexture->mSize.x, 
-                currElement.mTexture->mSize.y, gMemoryManager.mFrameHeapAllocator))
-            {
-                debug_assert(false);
-            }
-
-            if (!gGameMap.mStyleData.GetSpriteTexture(spriteIndex, deltaBits, &pixels, 0, 0))
-            {
-                debug_assert(false);
-            }
-            sourceSprite.mTextureRegion = currElement.mTextureRegion;
-            sourceSprite.mTexture = currElement.mTexture;
-            sourceSprite.mTexture->Upload(pixels.mData);
-            return;
-        }
-    }
-    
-    // cache miss
-    Point dimensions;
-    dimensions.x = cxx::get_next_pot(spriteStyle.mWidth);
-    dimensions.y = cxx::get_next_pot(spriteStyle.mHeight);
-
-    sourceSprite.mTexture = GetFreeSpriteTexture(dimensions, eTextureFormat_R8UI);
-    if (sourceSprite.mTexture == nullptr)
-    {
-        debug_assert(false);
-    }
-
-    PixelsArray pixels;
-    if (!pixels.Create(eTextureFormat_R8UI, dimensions.x, dimensions.y, 
-        gMemoryManager.mFrameHeapAllocator))
+    const SpriteInfo& spriteStyle = gGameMap.mStyleData.mSprites[spriteIndex];
+    sourceSprite.mDeltaBits = (deltaBits & spriteStyle.GetDeltaBits());
+    if (sourceSprite.mDeltaBits)
     {
-        debug_assert(false);
-    }
-
-    pixels.FillWithCheckerBoard();
-
-    // combine soruce image with deltas
-    if (!gGameMap.mStyleData.GetSpriteTexture(spriteIndex, deltaBits, &pixels, 0, 0))
-    {
-        debug_assert(false);
+        sourceSprite.mDeltaBase = mSpriteDeltasBase[spriteIndex];
     }
-
-    // upload to texture
-    sourceSprite.mTexture->Upload(pixels.mData);
-
-    Rect srcRect;
-    srcRect.x = 0;
-    srcRect.y = 0;
-    srcRect.w = spriteStyle.mWidth;
-    srcRect.h = spriteStyle.mHeight;
-
-    sourceSprite.mTextureRegion.SetRegion(srcRect, dimensions);
-
-    // add to sprites cache
-    SpriteCacheElement spriteCacheElement;
-    spriteCacheElement.mObjectID = objectID;
-    spriteCacheElement.mSpriteIndex = spriteIndex;
-    spriteCacheElement.mSpriteDeltaBits = deltaBits;
-    spriteCacheElement.mTexture = sourceSprite.mTexture;
-    spriteCacheElement.mTextureRegion = sourceSprite.mTextureRegion;
-
-    mSpritesCache.push_back(spriteCacheElement);
 }
 
-void SpriteManager::GetSpriteTexture(GameObjectID objectID, int spriteIndex, int remap, Sprite2D& sourceSprite)
+void SpriteManager::GetSpriteTexture(int spriteIndex, int remap, Sprite2D& sourceSprite)
 {
     debug_assert(remap >= 0);
 
@@ -638,25 +750,10 @@ void SpriteManager::GetSpriteTexture(GameObjectID objectID, int spriteIndex, int
     SpriteInfo& spriteStyle = gGameMap.mStyleData.mSprites[spriteIndex];
 
     sourceSprite.mPaletteIndex = gGameMap.mStyleData.GetSpritePaletteIndex(spriteStyle.mClut, remap);
-    sourceSprite.mTexture = mObjectsSpritesheet.mSpritesheetTexture;
+    sourceSprite.mTexture = mObjectsSpritesheet.mPageTextures[mObjectsSpritesheet.mEntriesPages[spriteIndex]];
     sourceSprite.mTextureRegion = mObjectsSpritesheet.mEntries[spriteIndex];
-}
-
-GpuTexture2D* SpriteManager::GetFreeSpriteTexture(const Point& dimensions, eTextureFormat format)
-{
-    for (auto icurr = mFreeSpriteTextures.begin(); icurr != mFreeSpriteTextures.end(); )
-    {
-        GpuTexture2D* currTexture = *icurr;
-        if (currTexture->mSize == dimensions && currTexture->mFormat == format)
-        {
-            mFreeSpriteTextures.erase(icurr);
-            return currTexture;
-        }
-        ++icurr;
-    }
-
-    GpuTexture2D* texture = gGraphicsDevice.CreateTexture2D(format, dimensions.x, dimensions.y, nullptr);
-    return texture;
+    sourceSprite.mDeltaBits = 0;
+    sourceSprite.mDeltaBase = 0;
 }
 
 void SpriteManager::InitExplosionFrames()
@@ -729,6 +826,8 @@ bool SpriteManager::GetExplosionTexture(int frameIndex, Sprite2D& sourceSprite)
     {
         sourceSprite.mPaletteIndex = mExplosionPaletteIndex;
         sourceSprite.mTexture = mExplosionFrames[frameIndex];
+        sourceSprite.mDeltaBits = 0;
+        sourceSprite.mDeltaBase = 0;
         sourceSprite.mTextureRegion.SetRegion(sourceSprite.mTexture->mSize);
         return true;
     }
@@ -19,9 +19,15 @@ public:
     // all blocks are packed into single texture array, where each level is single 64x64 bitmap
     GpuTextureArray2D* mBlocksTextureArray = nullptr;
 
-    // all default objects bitmaps (with no deltas applied) are stored in single 2d texture
+    // all default objects bitmaps (with no deltas applied) are stored in 2d textures, usually in single one
     Spritesheet mObjectsSpritesheet;
 
+    // sprite deltas are applied in shader on top of default bitmaps,
+    // each delta entry is two texels: area within spritesheet page (x, y, w, h) and patch location (x, y, layer, 0)
+    GpuTexture2D* mSpriteDeltasTable = nullptr;
+    // changed pixels of all sprite deltas packed into layers, texel is color index with SpriteDeltaTexelCovered bit
+    GpuTextureArray2D* mSpriteDeltasTextureArray = nullptr;
+
 public:
     // preload sprite textures for current level
     bool InitLevelSprites();
@@ -34,18 +40,12 @@ public:
 
     void UpdateBlocksAnimations(float deltaTime);
 
-    // force drop cached sprites
-    // @param objectID: Specific object identifier
-    void FlushSpritesCache();
-    void FlushSpritesCache(GameObjectID objectID);
-
-    // Create sprite texture with deltas specified
-    // @param objectID: Game object that owns sprite or GAMEOBJECT_ID_NULL
+    // Get sprite texture with deltas specified, deltas are applied at sample time so sprite always refers objects spritesheet
     // @param spriteIndex: Sprite index, linear
     // @param deltaBits: Sprite delta bits
     // @param sourceSprite: Output sprite data
-    void GetSpriteTexture(GameObjectID objectID, int spriteIndex, int remap, SpriteDeltaBits deltaBits, Sprite2D& sourceSprite);
-    void GetSpriteTexture(GameObjectID objectID, int spriteIndex, int remap, Sprite2D& sourceSprite);
+    void GetSpriteTexture(int spriteIndex, int remap, SpriteDeltaBits deltaBits, Sprite2D& sourceSprite);
+    void GetSpriteTexture(int spriteIndex, int remap, Sprite2D& sourceSprite);
 
     // Get explosion sprite texture
     // @param frameIndex: Frame index
@@ -66,15 +66,13 @@ private:
     bool InitBlocksIndicesTable();
     bool InitBlocksTexture();
     bool InitObjectsSpritesheet();
+    bool InitSpriteDeltas();
     void InitPalettesTable();
     void InitBlocksAnimations();
 
     void InitExplosionFrames();
     void FreeExplosionFrames();
 
-    // find texture with required size and format or create new if nothing found
-    GpuTexture2D* GetFreeSpriteTexture(const Point& dimensions, eTextureFormat format);
-    void DestroySpriteTextures();
 
 private:
     // animation state for blocks sharing specific texture
@@ -88,25 +86,13 @@ private:
     std::vector<unsigned short> mBlocksIndices;
     bool mIndicesTableChanged;
 
-    // usused sprite textures
-    std::vector<GpuTexture2D*> mFreeSpriteTextures;
+    // index of first delta entry in deltas table for each sprite
+    std::vector<unsigned short> mSpriteDeltasBase;
 
     // explosion sprite is huge and it was originally split into four pieces, 
     // so it must be assembled in one piece again before use
     std::vector<GpuTexture2D*> mExplosionFrames;
     int mExplosionPaletteIndex = 0;
-
-    // cached sprite textures with deltas
-    struct SpriteCacheElement
-    {
-    public:
-        GameObjectID mObjectID; // object identifier which this sprite belongs to
-        int mSpriteIndex;
-        SpriteDeltaBits mSpriteDeltaBits; // all deltas applied to this sprite
-        GpuTexture2D* mTexture;
-        TextureRegion mTextureRegion;
-    };
-    std::vector<SpriteCacheElement> mSpritesCache;
 };
 
 extern SpriteManager gSpriteManager;
\ No newline at end of file
@@ -387,6 +387,17 @@ bool StyleData::GetBlockTexture(eBlockType blockType, int blockIndex, PixelsArra
 
     int palindex = GetBlockTexturePaletteIndex(blockType, blockIndex, remap);
 
+    if (bpp == 1) // color indices are copied as is
+    {
+        for (int iy = 0; iy < MAP_BLOCK_TEXTURE_DIMS; ++iy)
+        {
+            int destOffset = ((destPositionY + iy) * bitmap->mSizex) + destPositionX;
+            ::memcpy(bitmap->mData + destOffset, srcPixels, MAP_BLOCK_TEXTURE_DIMS);
+            srcPixels += 4 * MAP_BLOCK_TEXTURE_DIMS;
+        }
+        return true;
+    }
+
     for (int iy = 0; iy < MAP_BLOCK_TEXTURE_DIMS; ++iy)
     {
         for (int ix = 0; ix < MAP_BLOCK_TEXTURE_DIMS; ++ix)
@@ -457,27 +468,31 @@ bool StyleData::GetSpriteTexture(int spriteIndex, PixelsArray* bitmap, int destP
     debug_assert(bitmap->mSizex >= destPositionX + sprite.mWidth);
     debug_assert(bitmap->mSizey >= destPositionY + sprite.mHeight);
 
+    if (bpp == 1) // color indices are copied as is
+    {
+        for (int iy = 0; iy < sprite.mHeight; ++iy)
+        {
+            int destOffset = ((destPositionY + iy) * bitmap->mSizex) + destPositionX;
+            int srcOffset = ((sprite.mPageOffsetY + iy) * GTA_SPRITE_PAGE_DIMS) + sprite.mPageOffsetX;
+            ::memcpy(bitmap->mData + destOffset, srcPixels + srcOffset, sprite.mWidth);
+        }
+        return true;
+    }
+
+    const int palindex = mPaletteIndices[sprite.mClut + mTileClutsCount];
     for (int iy = 0; iy < sprite.mHeight; ++iy)
     for (int ix = 0; ix < sprite.mWidth; ++ix)
     {
         int destOffset = (((destPositionY + iy) * bitmap->mSizex) + (ix + destPositionX)) * bpp;
         int srcOffset = ((sprite.mPageOffsetY + iy) * GTA_SPRITE_PAGE_DIMS + (ix + sprite.mPageOffsetX));
-        int palindex = mPaletteIndices[sprite.mClut + mTileClutsCount];
         int palentry = srcPixels[srcOffset];
-        if (bpp == 1) // color index in palette
+        const Color32& color = mPalettes[palindex].mColors[palentry];
+        bitmap->mData[destOffset + 0] = color.mR;
+        bitmap->mData[destOffset + 1] = color.mG;
+        bitmap->mData[destOffset + 2] = color.mB;
+        if (bpp == 4)
         {
-            bitmap->mData[destOffset + 0] = palentry;
-        }
-        else
-        {
-            const Color32& color = mPalettes[palindex].mColors[palentry];
-            bitmap->mData[destOffset + 0] = color.mR;
-            bitmap->mData[destOffset + 1] = color.mG;
-            bitmap->mData[destOffset + 2] = color.mB;
-            if (bpp == 4)
-            {
-                bitmap->mData[destOffset + 3] = (palentry == 0) ? 0x00 : 0xFF;
-            }
+            bitmap->mData[destOffset + 3] = (palentry == 0) ? 0x00 : 0xFF;
         }
     }
     return true;
@@ -503,6 +518,107 @@ bool StyleData::GetSpriteTexture(int spriteIndex, SpriteDeltaBits deltas, Pixels
     return true;
 }
 
+// iterate pixel runs of sprite delta, run position is relative to sprite origin
+template<typename TRunFunc>
+inline void ForEachSpriteDeltaRun(const unsigned char* deltaData, int deltaSize, TRunFunc runFunc)
+{
+    const int HeaderSize = 3;
+    unsigned int dstPixelOffset = 0;
+
+    for (int curr_pos = 0; curr_pos < deltaSize; )
+    {
+        debug_assert(curr_pos + HeaderSize < deltaSize);
+
+        unsigned short destination_offset = ((unsigned short) deltaData[curr_pos + 0] | ((unsigned short) deltaData[curr_pos + 1] << 8));
+        unsigned char source_length = deltaData[curr_pos + 2];
+        debug_assert(source_length > 0);
+        curr_pos += HeaderSize;
+        debug_assert(curr_pos + source_length <= deltaSize);
+
+        // offsets are specified for page of GTA_SPRITE_PAGE_DIMS x GTA_SPRITE_PAGE_DIMS
+        dstPixelOffset += destination_offset;
+        runFunc(dstPixelOffset % GTA_SPRITE_PAGE_DIMS, dstPixelOffset / GTA_SPRITE_PAGE_DIMS, deltaData + curr_pos, source_length);
+
+        dstPixelOffset += source_length;
+        curr_pos += source_length;
+    }
+}
+
+bool StyleData::GetSpriteDeltaBounds(int spriteIndex, int deltaIndex, Rect& outBounds) const
+{
+    outBounds.SetNull();
+    if (spriteIndex < 0 || spriteIndex >= (int) mSprites.size())
+    {
+        debug_assert(false);
+        return false;
+    }
+
+    const SpriteInfo& sprite = mSprites[spriteIndex];
+    if (deltaIndex < 0 || deltaIndex >= sprite.mDeltaCount)
+    {
+        debug_assert(false);
+        return false;
+    }
+
+    const SpriteInfo::DeltaInfo& delta = sprite.mDeltas[deltaIndex];
+    int minx = sprite.mWidth;
+    int miny = sprite.mHeight;
+    int maxx = 0;
+    int maxy = 0;
+    ForEachSpriteDeltaRun(mSpriteGraphicsRaw.data() + delta.mOffset, delta.mSize, 
+        [&](int posx, int posy, const unsigned char* runPixels, int runLength)
+        {
+            // pixels outside of sprite are ignored
+            if (posy >= sprite.mHeight || posx >= sprite.mWidth)
+                return;
+
+            minx = std::min(minx, posx);
+            miny = std::min(miny, posy);
+            maxx = std::max(maxx, std::min(posx + runLength, sprite.mWidth));
+            maxy = std::max(maxy, posy + 1);
+        });
+
+    if (maxx > minx && maxy > miny)
+    {
+        outBounds.Set(minx, miny, maxx - minx, maxy - miny);
+    }
+    return true;
+}
+
+bool StyleData::GetSpriteDeltaTexture(int spriteIndex, int deltaIndex, PixelsArray* bitmap, int destPositionX, int destPositionY) const
+{
+    if (bitmap == nullptr || !bitmap->HasContent() || bitmap->mFormat != eTextureFormat_R16UI)
+    {
+        debug_assert(false);
+        return false;
+    }
+
+    Rect deltaBounds;
+    if (!GetSpriteDeltaBounds(spriteIndex, deltaIndex, deltaBounds))
+        return false;
+
+    debug_assert(bitmap->mSizex >= destPositionX + deltaBounds.w);
+    debug_assert(bitmap->mSizey >= destPositionY + deltaBounds.h);
+
+    const SpriteInfo& sprite = mSprites[spriteIndex];
+    const SpriteInfo::DeltaInfo& delta = sprite.mDeltas[deltaIndex];
+    unsigned short* dstTexels = reinterpret_cast<unsigned short*>(bitmap->mData);
+    ForEachSpriteDeltaRun(mSpriteGraphicsRaw.data() + delta.mOffset, delta.mSize, 
+        [&](int posx, int posy, const unsigned char* runPixels, int runLength)
+        {
+            if (posy >= sprite.mHeight)
+                return;
+
+            const int dstRow = (destPositionY + posy - deltaBounds.y) * bitmap->mSizex;
+            for (int ipixel = 0; ipixel < runLength && (posx + ipixel) < sprite.mWidth; ++ipixel)
+            {
+                const int dstOffset = dstRow + destPositionX + (posx + ipixel - deltaBounds.x);
+                dstTexels[dstOffset] = SpriteDeltaTexelCovered | runPixels[ipixel];
+            }
+        });
+    return true;
+}
+
 void StyleData::ApplySpriteDelta(SpriteInfo& sprite, SpriteInfo::DeltaInfo& spriteDelta, PixelsArray* bitmap, int positionX, int positionY)
 {
     unsigned char* srcData = mSpriteGraphicsRaw.data() + spriteDelta.mOffset;
@@ -85,6 +85,20 @@ public:
     // @param destPositionX, destPositionY: Location within destination texture where block will be placed
     bool GetSpriteTexture(int spriteIndex, SpriteDeltaBits deltas, PixelsArray* bitmap, int destPositionX, int destPositionY);
 
+    // Get area of sprite that gets changed by delta
+    // @param spriteIndex: Sprite index
+    // @param deltaIndex: Delta index within sprite
+    // @param outBounds: Area in sprite pixels, empty if delta changes nothing
+    bool GetSpriteDeltaBounds(int spriteIndex, int deltaIndex, Rect& outBounds) const;
+
+    // Read sprite delta pixels within its bounds to specific location at target R16UI bitmap
+    // Written texels are color indices with SpriteDeltaTexelCovered bit, texels that delta does not change are left as is
+    // @param spriteIndex: Sprite index
+    // @param deltaIndex: Delta index within sprite
+    // @param bitmap: Target bitmap, must be created
+    // @param destPositionX, destPositionY: Location within destination texture where delta bounds will be placed
+    bool GetSpriteDeltaTexture(int spriteIndex, int deltaIndex, PixelsArray* bitmap, int destPositionX, int destPositionY) const;
+
     // Map sprite type and id pair to sprite index
     // @param spriteType: Sprite type
     // @para spriteId: Sprite id
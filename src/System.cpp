@@ -40,6 +40,7 @@ CvarVoid gCvarSysListCvars("print_cvars", "Print all registered console variable
 //////////////////////////////////////////////////////////////////////////
 
 System gSystem;
+cxx::worker_pool gWorkerPool;
 
 void System::Initialize(int argc, char *argv[])
 {
@@ -69,6 +70,9 @@ void System::Initialize(int argc, char *argv[])
         Terminate();
     }
 
+    // calling thread processes its own part of work
+    gWorkerPool.initialize(cxx::get_parallel_threads_count() - 1);
+
     if (!gGraphicsDevice.Initialize())
     {
         gConsole.LogMessage(eLogMessage_Error, "Cannot initialize graphics device");
@@ -144,6 +148,7 @@ void System::Deinit(bool isTermination)
     }
     gRenderManager.Deinit();
     gGraphicsDevice.Deinit();
+    gWorkerPool.shutdown();
     gMemoryManager.Deinit();
     gFiles.Deinit();
     gConsole.Deinit();
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "parallel_utils.h"
+
 // Common system specific stuff collected in System class
 class System final: public cxx::noncopyable
 {
@@ -30,4 +32,7 @@ private:
     bool mQuitRequested;
 };
 
-extern System gSystem;
\ No newline at end of file
+extern System gSystem;
+
+// persistent worker threads shared by game subsystems, started on system initialization
+extern cxx::worker_pool gWorkerPool;
\ No newline at end of file
@@ -33,6 +33,7 @@ bool TimeManager::Initialize()
     mGameTime = 0.0f;
     mGameFrameDelta = 0.0f;
     mGameTimeScale = 1.0f;
+    mFixedGameFrameDelta = 0.0f;
 
     mUiTime = 0.0f;
     mUiFrameDelta = 0.0f;
@@ -89,6 +90,10 @@ void TimeManager::UpdateFrame()
     mSystemTime += mSystemFrameDelta;
 
     mGameFrameDelta = (float) (mGameTimeScale * frameDelta);
+    if (IsFixedGameFrameDelta())
+    {
+        mGameFrameDelta = mGameTimeScale * mFixedGameFrameDelta;
+    }
     mGameTime += mGameFrameDelta;
     
     mUiFrameDelta = (float) (mUiTimeScale * frameDelta);
@@ -97,6 +102,17 @@ void TimeManager::UpdateFrame()
     mLastFrameTimestamp = frameTimestamp;
 }
 
+void TimeManager::SetFixedGameFrameDelta(float frameDelta)
+{
+    debug_assert(frameDelta >= 0.0f);
+    mFixedGameFrameDelta = std::max(frameDelta, 0.0f);
+}
+
+bool TimeManager::IsFixedGameFrameDelta() const
+{
+    return mFixedGameFrameDelta > 0.0f;
+}
+
 void TimeManager::SetGameTimeScale(float timeScale)
 {
     debug_assert(timeScale >= 0.0f);
@@ -29,11 +29,17 @@ public:
     void SetMinFramerate(float framesPerSecond);
     void SetMaxFramerate(float framesPerSecond);
 
+    // Advance game time by same amount each frame, it makes simulation independent from frame timing
+    // @param frameDelta: Game frame delta in seconds, 0 to disable
+    void SetFixedGameFrameDelta(float frameDelta);
+    bool IsFixedGameFrameDelta() const;
+
     // Scale game time, timeScale to 1.0 means no scale applied
     void SetGameTimeScale(float timeScale);
     void SetUiTimeScale(float timeScale);
 
 private:
+    float mFixedGameFrameDelta = 0.0f; // game time step per frame regardless of real time, 0 means disabled
     double mMaxFrameDelta = 0.0f;
     double mMinFrameDelta = 0.0f;
     double mLastFrameTimestamp = 0.0f;
@@ -118,7 +118,7 @@ void TrafficManager::RemoveOffscreenPeds()
 
 void TrafficManager::GenerateTrafficPeds(int pedsCount, GameCamera& view)
 {
-    cxx::randomizer& random = gCarnageGame.mGameRand;
+    cxx::randomizer& random = gCarnageGame.GetRandStream(eGameRandStream_Traffic);
 
     int numPedsGenerated = 0;
 
@@ -316,7 +316,7 @@ void TrafficManager::GenerateCars()
 
 void TrafficManager::GenerateTrafficCars(int carsCount, GameCamera& view)
 {
-    cxx::randomizer& random = gCarnageGame.mGameRand;
+    cxx::randomizer& random = gCarnageGame.GetRandStream(eGameRandStream_Traffic);
 
     int numCarsGenerated = 0;
 
@@ -488,7 +488,7 @@ Vehicle* TrafficManager::GenerateRandomTrafficCar(int posx, int posy, int posz)
         return nullptr;
 
     // shuffle candidates
-    gCarnageGame.mGameRand.shuffle(models);
+    gCarnageGame.GetRandStream(eGameRandStream_Traffic).shuffle(models);
 
     Vehicle* vehicle = gGameObjectsManager.CreateVehicle(positions, carHeading, models.front());
     debug_assert(vehicle);
@@ -506,7 +506,7 @@ Vehicle* TrafficManager::GenerateRandomTrafficCar(int posx, int posy, int posz)
 
 Pedestrian* TrafficManager::GenerateRandomTrafficPedestrian(int posx, int posy, int posz)
 {
-    cxx::randomizer& random = gCarnageGame.mGameRand;
+    cxx::randomizer& random = gCarnageGame.GetRandStream(eGameRandStream_Traffic);
 
     // generate pedestrian
     glm::vec2 positionOffset(
@@ -536,7 +536,7 @@ Pedestrian* TrafficManager::GenerateRandomTrafficPedestrian(int posx, int posy,
 
 Pedestrian* TrafficManager::GenerateHareKrishnas(int posx, int posy, int posz)
 {
-    cxx::randomizer& random = gCarnageGame.mGameRand;
+    cxx::randomizer& random = gCarnageGame.GetRandStream(eGameRandStream_Traffic);
 
     glm::vec2 positionOffset(
         Convert::MapUnitsToMeters(random.generate_float() - 0.5f),
@@ -577,7 +577,7 @@ Pedestrian* TrafficManager::GenerateHareKrishnas(int posx, int posy, int posz)
 
 Pedestrian* TrafficManager::GenerateRandomTrafficCarDriver(Vehicle* car)
 {
-    cxx::randomizer& random = gCarnageGame.mGameRand;
+    cxx::randomizer& random = gCarnageGame.GetRandStream(eGameRandStream_Traffic);
 
     debug_assert(car);
 
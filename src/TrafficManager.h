@@ -6,6 +6,7 @@ class DebugRenderer;
 class TrafficManager final: public cxx::noncopyable
 {
     friend class GameCheatsWindow;
+    friend class CarnageGame;
 
 public:
     TrafficManager();
@@ -1,23 +1,10 @@
 #include "stdafx.h"
 #include "TrimeshBuffer.h"
-#include "GpuBuffer.h"
-
-TrimeshBuffer::~TrimeshBuffer()
-{
-    debug_assert(mIndexBuffer == nullptr);
-    debug_assert(mVertexBuffer == nullptr);
-}
+#include "RenderingManager.h"
 
 void TrimeshBuffer::SetVertices(unsigned int dataLength, const void* dataSource)
 {
-    if (mVertexBuffer == nullptr)
-    {
-        mVertexBuffer = gGraphicsDevice.CreateBuffer(eBufferContent_Vertices, eBufferUsage_Stream, dataLength, dataSource);
-        debug_assert(mVertexBuffer);
-        return;
-    }
-
-    if (!mVertexBuffer->Setup(eBufferUsage_Stream, dataLength, dataSource))
+    if (!gRenderManager.mStreamingVertices.Upload(dataLength, dataSource, mVertices))
     {
         debug_assert(false);
     }
@@ -25,14 +12,7 @@ void TrimeshBuffer::SetVertices(unsigned int dataLength, const void* dataSource)
 
 void TrimeshBuffer::SetIndices(unsigned int dataLength, const void* dataSource)
 {
-    if (mIndexBuffer == nullptr)
-    {
-        mIndexBuffer = gGraphicsDevice.CreateBuffer(eBufferContent_Indices, eBufferUsage_Stream, dataLength, dataSource);
-        debug_assert(mIndexBuffer);
-        return;
-    }
-
-    if (!mIndexBuffer->Setup(eBufferUsage_Stream, dataLength, dataSource))
+    if (!gRenderManager.mStreamingIndices.Upload(dataLength, dataSource, mIndices))
     {
         debug_assert(false);
     }
@@ -40,24 +20,19 @@ void TrimeshBuffer::SetIndices(unsigned int dataLength, const void* dataSource)
 
 void TrimeshBuffer::Bind(const VertexFormat& vertexFormat)
 {
-    debug_assert(mVertexBuffer);
-    if (mVertexBuffer == nullptr)
+    debug_assert(mVertices.mBuffer);
+    if (mVertices.mBuffer == nullptr)
         return;
 
-    gGraphicsDevice.BindVertexBuffer(mVertexBuffer, vertexFormat);
-    gGraphicsDevice.BindIndexBuffer(mIndexBuffer);
+    VertexFormat rangeVertexFormat = vertexFormat;
+    rangeVertexFormat.mBaseOffset += mVertices.mOffset;
+
+    gGraphicsDevice.BindVertexBuffer(mVertices.mBuffer, rangeVertexFormat);
+    gGraphicsDevice.BindIndexBuffer(mIndices.mBuffer);
 }
 
 void TrimeshBuffer::Deinit()
 {
-    if (mIndexBuffer)
-    {
-        gGraphicsDevice.DestroyBuffer(mIndexBuffer);
-        mIndexBuffer = nullptr;
-    }
-    if (mVertexBuffer)
-    {
-        gGraphicsDevice.DestroyBuffer(mVertexBuffer);
-        mVertexBuffer = nullptr;
-    }
+    mVertices = GpuBufferRange();
+    mIndices = GpuBufferRange();
 }
\ No newline at end of file
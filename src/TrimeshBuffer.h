@@ -1,17 +1,25 @@
 #pragma once
 
+#include "GpuRingBuffer.h"
+
+// dynamic geometry sub-allocated from render manager streaming buffers, valid until end of current frame
 class TrimeshBuffer final: public cxx::noncopyable
 {
 public:
     TrimeshBuffer() = default;
-    ~TrimeshBuffer();
 
     void SetVertices(unsigned int dataLength, const void* dataSource);
     void SetIndices(unsigned int dataLength, const void* dataSource);
     void Bind(const VertexFormat& vertexFormat);
     void Deinit();
 
+    // Get offset of uploaded indices within bound index buffer, it must be added to draw calls offset
+    inline unsigned int GetIndicesOffset() const
+    {
+        return mIndices.mOffset;
+    }
+
 public:
-    GpuBuffer* mVertexBuffer = nullptr;
-    GpuBuffer* mIndexBuffer = nullptr;
+    GpuBufferRange mVertices;
+    GpuBufferRange mIndices;
 };
\ No newline at end of file
@@ -10,6 +10,8 @@
 #include "TimeManager.h"
 #include "GameObjectsManager.h"
 #include "AudioManager.h"
+#include "VehicleDynamics.h"
+#include "ExplosionsManager.h"
 #include "Collider.h"
 
 Vehicle::Vehicle(GameObjectID id) : GameObject(eGameObjectClass_Car, id)
@@ -81,8 +83,6 @@ void Vehicle::HandleDespawn()
     // force stop sounds
     StopGameObjectSounds();
 
-    gSpriteManager.FlushSpritesCache(mObjectID);
-
     GameObject::HandleDespawn();
 }
 
@@ -97,12 +97,9 @@ void Vehicle::UpdateFrame()
     // check if car destroyed
     if (IsCriticalDamageState())
     {
-        if (mExplosionWaitTime > 0.0f)
-        {
-            mExplosionWaitTime -= gTimeManager.mGameFrameDelta;
-            if (mExplosionWaitTime > 0.0f)
-                return;
-        }
+        if (mChainExplosionScheduled)
+            return;
+
         SetWrecked();
         Explode();
         return;
@@ -113,19 +110,8 @@ void Vehicle::UpdateFrame()
 
 void Vehicle::SimulationStep()
 {
-    DriveCtlState currCtlState;
+    DriveCtlState currCtlState = GetDriveCtlState();
 
-    if (!IsWrecked())
-    {
-        Pedestrian* carDriver = GetCarDriver();
-        if (carDriver)
-        {
-            const PedestrianCtlState& ctlState = carDriver->GetCtlState();
-            currCtlState.mDriveDirection = ctlState.mAcceleration;
-            currCtlState.mSteerDirection = ctlState.mSteerDirection;
-            currCtlState.mHandBrake = ctlState.mHandBrake;
-        }
-    }
     UpdateFriction(currCtlState);
     UpdateDrive(currCtlState);
     UpdateSteer(currCtlState);
@@ -579,7 +565,7 @@ void Vehicle::Explode()
     {
         currentPed->DieFromDamage(damageInfo);
     }
-    mExplosionWaitTime = 0.0f;
+    mChainExplosionScheduled = false;
 }
 
 bool Vehicle::HasHardTop() const
@@ -636,7 +622,11 @@ bool Vehicle::ReceiveDamage(const DamageInfo& damageInfo)
 
         if (damageInfo.mDamageCause == eDamageCause_ExplosionChain) // delayed explosion
         {
-            mExplosionWaitTime = gGameParams.mCarExplosionChainDelayTime;
+            // cars closer to explosion center detonate earlier, delay is from half of base time
+            // at center to one and a half at edge of explosion radius, so base time is kept on average
+            float delayTime = gGameParams.mCarExplosionChainDelayTime * (1.5f - damageInfo.mExplosionFalloff);
+            gExplosionsManager.ScheduleCarDetonation(this, delayTime);
+            mChainExplosionScheduled = true;
         }
         mCurrentDamage = 100; // force max damage
         return true;
@@ -860,7 +850,7 @@ void Vehicle::Repair()
 
     mCurrentDamage = 0;
     mDamageDeltaBits = 0;
-    mExplosionWaitTime = 0.0f;
+    mChainExplosionScheduled = false;
 }
 
 int Vehicle::GetCurrentDamage() const
@@ -1034,10 +1024,28 @@ void Vehicle::GetTireCorners(eCarTire tireID, glm::vec2 corners[4]) const
     }
 }
 
+Vehicle::DriveCtlState Vehicle::GetDriveCtlState() const
+{
+    DriveCtlState currCtlState;
+
+    if (!IsWrecked())
+    {
+        Pedestrian* carDriver = GetCarDriver();
+        if (carDriver)
+        {
+            const PedestrianCtlState& ctlState = carDriver->GetCtlState();
+            currCtlState.mDriveDirection = ctlState.mAcceleration;
+            currCtlState.mSteerDirection = ctlState.mSteerDirection;
+            currCtlState.mHandBrake = ctlState.mHandBrake;
+        }
+    }
+    return currCtlState;
+}
+
 void Vehicle::UpdateSteer(const DriveCtlState& currCtlState)
 {
-    const float LockAngleRadians = glm::radians(30.0f);
-    const float TurnSpeedPerSec = glm::radians(270.0f * 1.0f);
+    const float LockAngleRadians = VehicleDynamicsParams::SteerLockAngleRadians;
+    const float TurnSpeedPerSec = VehicleDynamicsParams::SteerSpeedRadiansPerSec;
 
     float turnPerTimeStep = (TurnSpeedPerSec * gTimeManager.mGameFrameDelta);
     float desiredAngle = (LockAngleRadians * currCtlState.mSteerDirection);
@@ -1055,22 +1063,25 @@ void Vehicle::UpdateFriction(const DriveCtlState& currCtlState)
         linearSpeed = glm::length(linearVelocityVector);
     }
 
+    float stepScale = gPhysics.GetSimulationStepScale();
+    float lateralImpulseFactor = VehicleDynamicsParams::GetLateralImpulseFactor(stepScale);
+
     // kill lateral velocity front tire
     {
-        glm::vec2 impulse = mPhysicsBody->GetMass() * 0.20f * -GetTireLateralVelocity(eCarTire_Front);
+        glm::vec2 impulse = mPhysicsBody->GetMass() * lateralImpulseFactor * -GetTireLateralVelocity(eCarTire_Front);
         mPhysicsBody->ApplyLinearImpulse(impulse, GetTirePosition(eCarTire_Front));
     }
 
     // kill lateral velocity rear tire
     {
-        glm::vec2 impulse = mPhysicsBody->GetMass() * 0.20f * -GetTireLateralVelocity(eCarTire_Rear);
+        glm::vec2 impulse = mPhysicsBody->GetMass() * lateralImpulseFactor * -GetTireLateralVelocity(eCarTire_Rear);
         mPhysicsBody->ApplyLinearImpulse(impulse, GetTirePosition(eCarTire_Rear));
     }
 
     // rolling resistance
     if (linearSpeed > 0.0f)
     {
-        float rrCoef = 50.0f;
+        float rrCoef = VehicleDynamicsParams::GetRollingResistance(stepScale);
         mPhysicsBody->ApplyLinearImpulse(rrCoef * -linearVelocityVector, GetTirePosition(eCarTire_Front));
         mPhysicsBody->ApplyLinearImpulse(rrCoef * -linearVelocityVector, GetTirePosition(eCarTire_Rear));
     }
@@ -1078,7 +1089,7 @@ void Vehicle::UpdateFriction(const DriveCtlState& currCtlState)
     // apply drag force
     if (linearSpeed > 0.0f)
     {
-        float dragForceCoef = 102.0f;
+        float dragForceCoef = VehicleDynamicsParams::DragForceFactor;
         glm::vec2 dragForce = -dragForceCoef * linearSpeed * linearVelocityVector;
 
         mPhysicsBody->AddForce(dragForce);
@@ -1090,9 +1101,9 @@ void Vehicle::UpdateDrive(const DriveCtlState& currCtlState)
     if (currCtlState.mDriveDirection == 0.0f)
         return;
 
-    float driveForce = 100750.0f; // todo: magic numbers
+    float driveForce = VehicleDynamicsParams::DriveForce;
     float brakeForce = driveForce * mCarInfo->mHandbrakeFriction;
-    float reverseForce = driveForce * 0.75f;
+    float reverseForce = driveForce * VehicleDynamicsParams::ReverseForceFactor;
 
     float currentSpeed = GetCurrentSpeed();
     float engineForce = 0.0f;
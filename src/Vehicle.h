@@ -22,6 +22,8 @@ class Vehicle final: public GameObject, public SpriteAnimListener
     friend class GameObjectsManager;
     friend class GameCheatsWindow;
     friend class PhysicsManager;
+    friend class VehicleDynamics;
+    friend class ExplosionsManager;
 
 public:
     // public for convenience, should not be modified directly
@@ -143,6 +145,8 @@ private:
         bool mHandBrake = false;
     };
 
+    DriveCtlState GetDriveCtlState() const;
+
     void UpdateSteer(const DriveCtlState& currCtlState);
     void UpdateFriction(const DriveCtlState& currCtlState);
     void UpdateDrive(const DriveCtlState& currCtlState);
@@ -171,7 +175,7 @@ private:
     Decoration* mFireEffect = nullptr;
     float mBurnStartTime = 0.0f;
     float mStandingOnRailwaysTimer = 0.0f; // how long standing on tracks, seconds
-    float mExplosionWaitTime = 0.0f;
+    bool mChainExplosionScheduled = false; // waiting for detonation in explosions manager
 
     int mRemapIndex = NO_REMAP;
     int mSpriteIndex = 0;
@@ -0,0 +1,289 @@
+#include "stdafx.h"
+#include "VehicleDynamics.h"
+#include "Vehicle.h"
+#include "PhysicsBody.h"
+#include "GameObjectHelpers.h"
+#include "TimeManager.h"
+#include "PhysicsManager.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define VEHICLE_DYNAMICS_SSE2
+    #include <emmintrin.h>
+#endif
+
+// vehicles ranges smaller than that are not split between threads
+static const int ParallelMinVehicles = 64;
+
+//////////////////////////////////////////////////////////////////////////
+// lanes math, same kernel is compiled for single float and for four floats
+//////////////////////////////////////////////////////////////////////////
+
+inline float LoadLanes(const float* source, float)
+{
+    return *source;
+}
+
+inline void StoreLanes(float* destination, float value)
+{
+    *destination = value;
+}
+
+inline float LanesMin(float a, float b) { return std::min(a, b); }
+inline float LanesMax(float a, float b) { return std::max(a, b); }
+inline float LanesSqrt(float a) { return sqrtf(a); }
+inline float LanesSelect(bool condition, float a, float b) { return condition ? a : b; }
+
+#ifdef VEHICLE_DYNAMICS_SSE2
+
+struct Float4
+{
+    Float4() = default;
+    Float4(__m128 value): mValue(value) {}
+    Float4(float value): mValue(_mm_set1_ps(value)) {}
+
+    __m128 mValue;
+};
+
+inline Float4 operator + (Float4 a, Float4 b) { return _mm_add_ps(a.mValue, b.mValue); }
+inline Float4 operator - (Float4 a, Float4 b) { return _mm_sub_ps(a.mValue, b.mValue); }
+inline Float4 operator * (Float4 a, Float4 b) { return _mm_mul_ps(a.mValue, b.mValue); }
+inline Float4 operator - (Float4 a) { return _mm_sub_ps(_mm_setzero_ps(), a.mValue); }
+inline Float4 operator > (Float4 a, Float4 b) { return _mm_cmpgt_ps(a.mValue, b.mValue); }
+
+inline Float4 LoadLanes(const float* source, Float4)
+{
+    return _mm_loadu_ps(source);
+}
+
+inline void StoreLanes(float* destination, Float4 value)
+{
+    _mm_storeu_ps(destination, value.mValue);
+}
+
+inline Float4 LanesMin(Float4 a, Float4 b) { return _mm_min_ps(a.mValue, b.mValue); }
+inline Float4 LanesMax(Float4 a, Float4 b) { return _mm_max_ps(a.mValue, b.mValue); }
+inline Float4 LanesSqrt(Float4 a) { return _mm_sqrt_ps(a.mValue); }
+inline Float4 LanesSelect(Float4 condition, Float4 a, Float4 b)
+{
+    return _mm_or_ps(_mm_and_ps(condition.mValue, a.mValue), _mm_andnot_ps(condition.mValue, b.mValue));
+}
+
+#endif // VEHICLE_DYNAMICS_SSE2
+
+// mirrors Vehicle::UpdateFriction, Vehicle::UpdateDrive and Vehicle::UpdateSteer
+// impulses are applied to velocities in same order as box2d does
+template<typename TFloat>
+void VehicleDynamics::ComputeVehicleLanes(int index, float turnPerStep)
+{
+    using namespace VehicleDynamicsParams;
+
+    auto load = [this, index](eStream streamIndex)
+    {
+        return LoadLanes(mStreams[streamIndex] + index, TFloat());
+    };
+
+    TFloat rotationCos = load(eStream_RotationCos);
+    TFloat rotationSin = load(eStream_RotationSin);
+    TFloat positionX = load(eStream_PositionX);
+    TFloat positionY = load(eStream_PositionY);
+    TFloat centerX = load(eStream_CenterX);
+    TFloat centerY = load(eStream_CenterY);
+    TFloat velocityX = load(eStream_VelocityX);
+    TFloat velocityY = load(eStream_VelocityY);
+    TFloat angularVelocity = load(eStream_AngularVelocity);
+    TFloat mass = load(eStream_Mass);
+    TFloat invMass = load(eStream_InvMass);
+    TFloat invInertia = load(eStream_InvInertia);
+    TFloat frontOffset = load(eStream_FrontOffset);
+    TFloat rearOffset = load(eStream_RearOffset);
+    TFloat steerAngle = load(eStream_SteerAngle);
+    TFloat steerCos = load(eStream_SteerCos);
+    TFloat steerSin = load(eStream_SteerSin);
+    TFloat steerDirection = load(eStream_SteerDirection);
+    TFloat driveDirection = load(eStream_DriveDirection);
+    TFloat brakeForce = load(eStream_BrakeForce);
+
+    // tires positions relative to center of mass
+    TFloat frontArmX = positionX + rotationCos * frontOffset - centerX;
+    TFloat frontArmY = positionY + rotationSin * frontOffset - centerY;
+    TFloat rearArmX = positionX + rotationCos * rearOffset - centerX;
+    TFloat rearArmY = positionY + rotationSin * rearOffset - centerY;
+
+    // tires lateral directions, front tire is rotated by steering angle
+    TFloat frontLateralX = -rotationCos * steerSin - rotationSin * steerCos;
+    TFloat frontLateralY = -rotationSin * steerSin + rotationCos * steerCos;
+    TFloat rearLateralX = -rotationSin;
+    TFloat rearLateralY = rotationCos;
+
+    TFloat initialVelocityX = velocityX;
+    TFloat initialVelocityY = velocityY;
+    TFloat initialSpeed = LanesSqrt(velocityX * velocityX + velocityY * velocityY);
+
+    auto applyImpulse = [&](TFloat impulseX, TFloat impulseY, TFloat armX, TFloat armY)
+    {
+        velocityX = velocityX + invMass * impulseX;
+        velocityY = velocityY + invMass * impulseY;
+        angularVelocity = angularVelocity + invInertia * (armX * impulseY - armY * impulseX);
+    };
+
+    auto killLateralVelocity = [&](TFloat lateralX, TFloat lateralY, TFloat armX, TFloat armY)
+    {
+        TFloat pointVelocityX = velocityX - angularVelocity * armY;
+        TFloat pointVelocityY = velocityY + angularVelocity * armX;
+        TFloat lateralSpeed = lateralX * pointVelocityX + lateralY * pointVelocityY;
+        TFloat impulseScale = mass * TFloat(mLateralImpulseFactor);
+        applyImpulse(-(impulseScale * (lateralX * lateralSpeed)), -(impulseScale * (lateralY * lateralSpeed)), armX, armY);
+    };
+
+    killLateralVelocity(frontLateralX, frontLateralY, frontArmX, frontArmY);
+    killLateralVelocity(rearLateralX, rearLateralY, rearArmX, rearArmY);
+
+    // rolling resistance, zero when vehicle is not moving
+    TFloat rollingImpulseX = TFloat(mRollingResistance) * -initialVelocityX;
+    TFloat rollingImpulseY = TFloat(mRollingResistance) * -initialVelocityY;
+    applyImpulse(rollingImpulseX, rollingImpulseY, frontArmX, frontArmY);
+    applyImpulse(rollingImpulseX, rollingImpulseY, rearArmX, rearArmY);
+
+    // drag force
+    TFloat dragScale = -TFloat(DragForceFactor) * initialSpeed;
+    TFloat forceX = dragScale * initialVelocityX;
+    TFloat forceY = dragScale * initialVelocityY;
+
+    // drive force on rear tire, zero when there is no drive input
+    TFloat currentSpeed = rotationCos * velocityX + rotationSin * velocityY;
+    TFloat engineForce = LanesSelect(driveDirection > TFloat(0.0f), TFloat(DriveForce),
+        LanesSelect(currentSpeed > TFloat(0.0f), brakeForce, TFloat(DriveForce * ReverseForceFactor)));
+    TFloat driveForce = engineForce * driveDirection;
+    TFloat driveForceX = driveForce * rotationCos;
+    TFloat driveForceY = driveForce * rotationSin;
+    forceX = forceX + driveForceX;
+    forceY = forceY + driveForceY;
+    TFloat torque = rearArmX * driveForceY - rearArmY * driveForceX;
+
+    // steer
+    TFloat turnLimit = TFloat(turnPerStep);
+    TFloat angleToTurn = LanesMin(LanesMax(TFloat(SteerLockAngleRadians) * steerDirection - steerAngle, -turnLimit), turnLimit);
+    steerAngle = LanesMin(LanesMax(steerAngle + angleToTurn, TFloat(-SteerLockAngleRadians)), TFloat(SteerLockAngleRadians));
+
+    StoreLanes(mStreams[eStream_VelocityX] + index, velocityX);
+    StoreLanes(mStreams[eStream_VelocityY] + index, velocityY);
+    StoreLanes(mStreams[eStream_AngularVelocity] + index, angularVelocity);
+    StoreLanes(mStreams[eStream_SteerAngle] + index, steerAngle);
+    StoreLanes(mStreams[eStream_ForceX] + index, forceX);
+    StoreLanes(mStreams[eStream_ForceY] + index, forceY);
+    StoreLanes(mStreams[eStream_Torque] + index, torque);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void VehicleDynamics::ProcessVehicles(const std::vector<PhysicsBody*>& vehicleBodies, cxx::worker_pool& workerPool, int threadsCount)
+{
+    int vehiclesCount = (int) vehicleBodies.size();
+
+    mVehicles.resize(vehiclesCount);
+    for (int ivehicle = 0; ivehicle < vehiclesCount; ++ivehicle)
+    {
+        mVehicles[ivehicle] = ToVehicle(vehicleBodies[ivehicle]->mGameObject);
+        debug_assert(mVehicles[ivehicle]);
+    }
+
+    mStreamsData.resize(vehiclesCount * eStream_COUNT);
+    for (int istream = 0; istream < eStream_COUNT; ++istream)
+    {
+        mStreams[istream] = mStreamsData.data() + istream * vehiclesCount;
+    }
+
+    float stepScale = gPhysics.GetSimulationStepScale();
+    mLateralImpulseFactor = VehicleDynamicsParams::GetLateralImpulseFactor(stepScale);
+    mRollingResistance = VehicleDynamicsParams::GetRollingResistance(stepScale);
+
+    float turnPerStep = VehicleDynamicsParams::SteerSpeedRadiansPerSec * gTimeManager.mGameFrameDelta;
+    workerPool.parallel_for(vehiclesCount, ParallelMinVehicles, threadsCount, [this, turnPerStep](int ibegin, int iend)
+    {
+        GatherVehicles(ibegin, iend);
+        ComputeVehicles(ibegin, iend, turnPerStep);
+        ScatterVehicles(ibegin, iend);
+    });
+}
+
+void VehicleDynamics::GatherVehicles(int ibegin, int iend)
+{
+    for (int ivehicle = ibegin; ivehicle < iend; ++ivehicle)
+    {
+        Vehicle* vehicle = mVehicles[ivehicle];
+        const b2Body* body = vehicle->mPhysicsBody->mBox2Body;
+
+        const b2Transform& transform = body->GetTransform();
+        mStreams[eStream_PositionX][ivehicle] = transform.p.x;
+        mStreams[eStream_PositionY][ivehicle] = transform.p.y;
+        mStreams[eStream_RotationCos][ivehicle] = transform.q.c;
+        mStreams[eStream_RotationSin][ivehicle] = transform.q.s;
+
+        const b2Vec2& center = body->GetWorldCenter();
+        mStreams[eStream_CenterX][ivehicle] = center.x;
+        mStreams[eStream_CenterY][ivehicle] = center.y;
+
+        const b2Vec2& velocity = body->GetLinearVelocity();
+        mStreams[eStream_VelocityX][ivehicle] = velocity.x;
+        mStreams[eStream_VelocityY][ivehicle] = velocity.y;
+        mStreams[eStream_AngularVelocity][ivehicle] = body->GetAngularVelocity();
+
+        // box2d does not expose inverse inertia, it is computed from inertia about body origin
+        float mass = body->GetMass();
+        const b2Vec2& localCenter = body->GetLocalCenter();
+        float inertia = body->GetInertia() - mass * (localCenter.x * localCenter.x + localCenter.y * localCenter.y);
+        mStreams[eStream_Mass][ivehicle] = mass;
+        mStreams[eStream_InvMass][ivehicle] = (mass > 0.0f) ? (1.0f / mass) : 0.0f;
+        mStreams[eStream_InvInertia][ivehicle] = (inertia > 0.0f) ? (1.0f / inertia) : 0.0f;
+
+        mStreams[eStream_FrontOffset][ivehicle] = vehicle->mFrontTireOffset;
+        mStreams[eStream_RearOffset][ivehicle] = vehicle->mRearTireOffset;
+        mStreams[eStream_SteerAngle][ivehicle] = vehicle->mSteeringAngleRadians;
+        mStreams[eStream_SteerCos][ivehicle] = cosf(vehicle->mSteeringAngleRadians);
+        mStreams[eStream_SteerSin][ivehicle] = sinf(vehicle->mSteeringAngleRadians);
+
+        Vehicle::DriveCtlState ctlState = vehicle->GetDriveCtlState();
+        mStreams[eStream_SteerDirection][ivehicle] = ctlState.mSteerDirection;
+        mStreams[eStream_DriveDirection][ivehicle] = ctlState.mDriveDirection;
+        mStreams[eStream_BrakeForce][ivehicle] = VehicleDynamicsParams::DriveForce * vehicle->mCarInfo->mHandbrakeFriction;
+    }
+}
+
+void VehicleDynamics::ComputeVehicles(int ibegin, int iend, float turnPerStep)
+{
+    int ivehicle = ibegin;
+#ifdef VEHICLE_DYNAMICS_SSE2
+    for (; ivehicle + 4 <= iend; ivehicle += 4)
+    {
+        ComputeVehicleLanes<Float4>(ivehicle, turnPerStep);
+    }
+#endif
+    for (; ivehicle < iend; ++ivehicle)
+    {
+        ComputeVehicleLanes<float>(ivehicle, turnPerStep);
+    }
+}
+
+void VehicleDynamics::ScatterVehicles(int ibegin, int iend)
+{
+    for (int ivehicle = ibegin; ivehicle < iend; ++ivehicle)
+    {
+        Vehicle* vehicle = mVehicles[ivehicle];
+        b2Body* body = vehicle->mPhysicsBody->mBox2Body;
+
+        body->SetLinearVelocity(b2Vec2(mStreams[eStream_VelocityX][ivehicle], mStreams[eStream_VelocityY][ivehicle]));
+        body->SetAngularVelocity(mStreams[eStream_AngularVelocity][ivehicle]);
+
+        b2Vec2 force(mStreams[eStream_ForceX][ivehicle], mStreams[eStream_ForceY][ivehicle]);
+        if (force.x != 0.0f || force.y != 0.0f)
+        {
+            body->ApplyForceToCenter(force, true);
+        }
+        float torque = mStreams[eStream_Torque][ivehicle];
+        if (torque != 0.0f)
+        {
+            body->ApplyTorque(torque, true);
+        }
+        vehicle->mSteeringAngleRadians = mStreams[eStream_SteerAngle][ivehicle];
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+// vehicle tire model constants, shared by batched and per-vehicle implementations
+namespace VehicleDynamicsParams
+{
+    const float LateralImpulseFactor = 0.20f; // part of tire lateral velocity killed each step
+    const float RollingResistance = 50.0f;
+    const float DragForceFactor = 102.0f;
+    const float DriveForce = 100750.0f;
+    const float ReverseForceFactor = 0.75f;
+    const float SteerLockAngleRadians = 0.52359878f; // 30 degrees
+    const float SteerSpeedRadiansPerSec = 4.71238898f; // 270 degrees
+
+    // impulses are tuned for base physics step, adaptive step may process several base steps at once
+    // @param stepScale: Simulation step time to base step time ratio
+    inline float GetLateralImpulseFactor(float stepScale)
+    {
+        return 1.0f - powf(1.0f - LateralImpulseFactor, stepScale);
+    }
+    inline float GetRollingResistance(float stepScale)
+    {
+        return RollingResistance * stepScale;
+    }
+}
+
+// Computes tire friction, drive and steer for all vehicles at once
+// Body states are gathered into structure of arrays and processed with simd, results are scattered back to bodies
+class VehicleDynamics final: public cxx::noncopyable
+{
+public:
+    // Process simulation step for vehicles, same as Vehicle::SimulationStep for each of them
+    // @param vehicleBodies: Physics bodies of vehicles
+    // @param workerPool: Threads to split vehicles between
+    // @param threadsCount: Threads limit, zero or less means no limit
+    void ProcessVehicles(const std::vector<PhysicsBody*>& vehicleBodies, cxx::worker_pool& workerPool, int threadsCount);
+
+private:
+    // structure of arrays streams
+    enum eStream
+    {
+        eStream_PositionX,
+        eStream_PositionY,
+        eStream_RotationCos,
+        eStream_RotationSin,
+        eStream_CenterX,
+        eStream_CenterY,
+        eStream_VelocityX,
+        eStream_VelocityY,
+        eStream_AngularVelocity,
+        eStream_Mass,
+        eStream_InvMass,
+        eStream_InvInertia,
+        eStream_FrontOffset,
+        eStream_RearOffset,
+        eStream_SteerAngle,
+        eStream_SteerCos,
+        eStream_SteerSin,
+        eStream_SteerDirection,
+        eStream_DriveDirection,
+        eStream_BrakeForce,
+        eStream_ForceX,
+        eStream_ForceY,
+        eStream_Torque,
+        eStream_COUNT
+    };
+
+    void GatherVehicles(int ibegin, int iend);
+    void ComputeVehicles(int ibegin, int iend, float turnPerStep);
+    void ScatterVehicles(int ibegin, int iend);
+
+    // process one or four vehicles depending on lanes type
+    template<typename TFloat>
+    void ComputeVehicleLanes(int index, float turnPerStep);
+
+private:
+    std::vector<Vehicle*> mVehicles;
+    std::vector<float> mStreamsData;
+    float* mStreams[eStream_COUNT];
+    // impulse factors for current simulation step
+    float mLateralImpulseFactor = 0.0f;
+    float mRollingResistance = 0.0f;
+};
@@ -62,6 +62,84 @@ public:
     }
 };
 
+// defines quantized draw vertex of city mesh
+// positions are stored relative to the mesh chunk origin, it gets computed in shader from chunk cell
+// so chunks can be drawn together without per chunk uniforms
+struct CityPackedVertex3D
+{
+public:
+    CityPackedVertex3D() = default;
+
+    // setup vertex
+    // @param position: Coordinate in 3d space relative to chunk origin, must be non-negative
+    // @param texcoord: Texture coordinate, whole tiles
+    // @param tileIndex: Texture layer in texture array
+    void Set(const glm::vec3& position, const glm::vec2& texcoord, int tileIndex,
+        unsigned short remap, unsigned short transparency)
+    {
+        for (int icomponent = 0; icomponent < 3; ++icomponent)
+        {
+            float quantized = glm::round(position[icomponent] * PositionScale);
+            debug_assert(quantized >= 0.0f && quantized <= 65535.0f);
+            mPosition[icomponent] = static_cast<unsigned short>(quantized);
+        }
+        debug_assert(tileIndex >= 0 && tileIndex <= TileIndexMask);
+        debug_assert(texcoord.x >= 0.0f && texcoord.x <= 255.0f);
+        debug_assert(texcoord.y >= 0.0f && texcoord.y <= 255.0f);
+        mTileData = static_cast<unsigned short>((tileIndex & TileIndexMask) | ((remap & 3) << 12) | ((transparency & 1) << 14));
+        mTexcoord[0] = static_cast<unsigned char>(texcoord.x);
+        mTexcoord[1] = static_cast<unsigned char>(texcoord.y);
+        mTexcoord[2] = 0;
+        mTexcoord[3] = 0;
+    }
+    // @param cellx, celly: Mesh chunk position within chunks grid
+    inline void SetChunkCell(int cellx, int celly)
+    {
+        debug_assert(cellx >= 0 && cellx <= 255);
+        debug_assert(celly >= 0 && celly <= 255);
+        mTexcoord[2] = static_cast<unsigned char>(cellx);
+        mTexcoord[3] = static_cast<unsigned char>(celly);
+    }
+    inline bool operator == (const CityPackedVertex3D& rhs) const
+    {
+        return memcmp(this, &rhs, sizeof(CityPackedVertex3D)) == 0;
+    }
+public:
+    static constexpr float PositionScale = 64.0f; // steps per meter, must match city_mesh_packed.glsl
+    static constexpr int TileIndexMask = 0x0FFF;
+
+    unsigned short mPosition[3]; // 6 bytes
+    unsigned short mTileData; // 2 bytes, tile index 12 bits, remap 2 bits, transparency 1 bit
+    unsigned char mTexcoord[4]; // 4 bytes, u, v and chunk cell x, y
+};
+
+const unsigned int Sizeof_CityPackedVertex3D = sizeof(CityPackedVertex3D);
+
+// defines draw vertex format of quantized city mesh
+struct CityPackedVertex3D_Format: public VertexFormat
+{
+public:
+    CityPackedVertex3D_Format()
+    {
+        Setup();
+    }
+    // get format definition
+    static const CityPackedVertex3D_Format& Get() 
+    { 
+        static const CityPackedVertex3D_Format sDefinition; 
+        return sDefinition; 
+    }
+    using TVertexType = CityPackedVertex3D;
+    // initialzie definition
+    inline void Setup()
+    {
+        this->mDataStride = Sizeof_CityPackedVertex3D;
+        // position and tile data goes as single integer attribute
+        this->SetAttribute(eVertexAttribute_Position0, eVertexAttributeFormat_4US, offsetof(TVertexType, mPosition));
+        this->SetAttribute(eVertexAttribute_Texcoord0, eVertexAttributeFormat_4UB, offsetof(TVertexType, mTexcoord));
+    }
+};
+
 // defines draw vertex of sprite
 struct SpriteVertex3D
 {
@@ -79,12 +157,17 @@ public:
         mTexcoord.x = tcu;
         mTexcoord.y = tcv;
         mClutIndex = clutIndex;
+        mDeltaBase = 0;
+        mDeltaBits[0] = 0;
+        mDeltaBits[1] = 0;
     }
 public:
     glm::vec3 mPosition; // 12 bytes
     glm::vec2 mTexcoord; // 8 bytes
     unsigned short mTextureSize[2]; // sprite texture size in pixels
     unsigned short mClutIndex; // 2 bytes
+    unsigned short mDeltaBase; // first entry of sprite in deltas table
+    unsigned short mDeltaBits[2]; // low and high parts of sprite delta bits
 };
 
 const unsigned int Sizeof_SpriteVertex3D = sizeof(SpriteVertex3D);
@@ -110,7 +193,66 @@ public:
         this->mDataStride = Sizeof_SpriteVertex3D;
         this->SetAttribute(eVertexAttribute_Position0, eVertexAttributeFormat_3F, offsetof(TVertexType, mPosition));
         this->SetAttribute(eVertexAttribute_Texcoord0, eVertexAttributeFormat_2F, offsetof(TVertexType, mTexcoord));
-        this->SetAttribute(eVertexAttribute_Color0, eVertexAttributeFormat_1US, offsetof(TVertexType, mClutIndex));
+        // palette index, deltas base and delta bits
+        this->SetAttribute(eVertexAttribute_Color0, eVertexAttributeFormat_4US, offsetof(TVertexType, mClutIndex));
         this->SetAttribute(eVertexAttribute_TextureSize, eVertexAttributeFormat_2US, offsetof(TVertexType, mTextureSize));
     }
+};
+
+// defines per instance data of sprite, corners are computed in shader
+struct SpriteInstance3D
+{
+public:
+    SpriteInstance3D() = default;
+
+    enum
+    {
+        Flags_OriginCenter = BIT(0), // otherwise origin is at top left corner
+        Flags_DepthAxisZ = BIT(1), // otherwise height goes along y axis
+        RotationSteps = 65536, // per full turn
+    };
+public:
+    glm::vec2 mPosition; // 8 bytes
+    float mHeight; // 4 bytes
+    float mScale; // 4 bytes
+    unsigned short mTextureRect[4]; // texture region x, y, w, h in pixels
+    unsigned short mRotation; // RotationSteps per full turn
+    unsigned short mPaletteIndex; // 2 bytes
+    unsigned char mDrawOrder;
+    unsigned char mFlags;
+    unsigned short mDeltaBase; // first entry of sprite in deltas table
+    unsigned short mDeltaBits[2]; // low and high parts of sprite delta bits
+};
+
+const unsigned int Sizeof_SpriteInstance3D = sizeof(SpriteInstance3D);
+
+static_assert(Sizeof_SpriteInstance3D == 36, "Unexpected sprite instance size");
+
+// defines per instance format of sprite
+struct SpriteInstance3D_Format: public VertexFormat
+{
+public:
+    SpriteInstance3D_Format()
+    {
+        Setup();
+    }
+    // get format definition
+    static const SpriteInstance3D_Format& Get() 
+    { 
+        static const SpriteInstance3D_Format sDefinition; 
+        return sDefinition; 
+    }
+    using TVertexType = SpriteInstance3D;
+    // initialzie definition
+    inline void Setup()
+    {
+        this->mDataStride = Sizeof_SpriteInstance3D;
+        this->mInstanceDivisor = 1;
+        // position, height and scale
+        this->SetAttribute(eVertexAttribute_Position0, eVertexAttributeFormat_4F, offsetof(TVertexType, mPosition));
+        this->SetAttribute(eVertexAttribute_Texcoord0, eVertexAttributeFormat_4US, offsetof(TVertexType, mTextureRect));
+        // rotation, palette index, draw order and flags, deltas base
+        this->SetAttribute(eVertexAttribute_Color0, eVertexAttributeFormat_4US, offsetof(TVertexType, mRotation));
+        this->SetAttribute(eVertexAttribute_Color1, eVertexAttributeFormat_2US, offsetof(TVertexType, mDeltaBits));
+    }
 };
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "PhysicsManager.h"
 #include "AudioManager.h"
 #include "GameObjectHelpers.h"
+#include "ProjectilesManager.h"
 
 void Weapon::Setup(eWeaponID weaponID, int ammunition)
 {
@@ -81,8 +82,15 @@ bool Weapon::Fire(Pedestrian* shooter)
         }
 
         debug_assert(weaponInfo->mProjectileTypeID < eProjectileType_COUNT);
-        Projectile* projectile = gGameObjectsManager.CreateProjectile(projectilePos, shooter->mTransform.mOrientation, weaponInfo, shooter);
-        debug_assert(projectile);
+        if (gProjectilesManager.IsLightweightProjectilesEnabled())
+        {
+            gProjectilesManager.CreateProjectile(projectilePos, shooter->mTransform.mOrientation, weaponInfo, shooter);
+        }
+        else
+        {
+            Projectile* projectile = gGameObjectsManager.CreateProjectile(projectilePos, shooter->mTransform.mOrientation, weaponInfo, shooter);
+            debug_assert(projectile);
+        }
 
         if (weaponInfo->mShotSound != -1)
         {
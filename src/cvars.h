@@ -16,9 +16,20 @@ extern CvarPoint gCvarGraphicsScreenDims; // screen dimensions
 extern CvarBoolean gCvarGraphicsFullscreen; // is fullscreen mode enabled
 extern CvarBoolean gCvarGraphicsVSync; // is vertical synchronization enabled
 extern CvarBoolean gCvarGraphicsTexFiltering; // is texture filtering enabled
+extern CvarBoolean gCvarGraphicsPackedCityMesh; // is quantized city mesh vertex format enabled
+extern CvarBoolean gCvarGraphicsOptimizeCityMesh; // is hidden faces culling and lids merging enabled for city mesh
+extern CvarBoolean gCvarGraphicsMultiDrawIndirect; // is multi draw indirect enabled for city mesh
+extern CvarBoolean gCvarGraphicsInstancedSprites; // is instanced rendering enabled for map sprites
+extern CvarBoolean gCvarGraphicsSpritesOcclusion; // is culling of map sprites hidden under solid lids enabled
+extern CvarBoolean gCvarGraphicsStateCache; // is redundant graphics api calls filtering enabled
 
 // physics
 extern CvarFloat gCvarPhysicsFramerate; // physical world update framerate
+extern CvarInt gCvarPhysicsThreads; // max threads for per-body physics step phases
+extern CvarInt gCvarPhysicsMaxSubsteps; // max physics steps per frame
+extern CvarFloat gCvarPhysicsFrameBudget; // max physics steps duration per frame, ms
+extern CvarBoolean gCvarPhysicsBatchedVehicles; // process vehicles tire model for all cars at once
+extern CvarInt gCvarPhysicsAdaptiveStepBodies; // bodies count to switch physics to double step time
 
 // memory
 extern CvarBoolean gCvarMemEnableFrameHeapAllocator; // enable frame heap allocator
@@ -28,6 +39,8 @@ extern CvarBoolean gCvarAudioActive; // enable audio system
 extern CvarEnum<eGameMusicMode> gCvarGameMusicMode; // ingame music mode
 extern CvarInt gCvarMusicVolume; // ingame music volume in range [0-7]
 extern CvarInt gCvarSoundsVolume; // ingame effects volume in range [0-7]
+extern CvarInt gCvarSoundsSampleRate; // sound effects are resampled to this rate on load
+extern CvarFloat gCvarSoundsAudibleDistance; // sounds farther from all listeners are culled
 
 // game
 extern CvarString gCvarGtaDataPath; // config gta data location
@@ -36,12 +49,22 @@ extern CvarString gCvarCurrentBaseDir; // current gta data location
 extern CvarEnum<eGtaGameVersion> gCvarGameVersion; // current gta game version
 extern CvarString gCvarGameLanguage; // current game language
 extern CvarInt gCvarNumPlayers; // number of players in split screen mode
+extern CvarBoolean gCvarGameLockstep; // deterministic simulation mode
+extern CvarFloat gCvarGameLockstepFramerate; // fixed game frames per second in lockstep mode
+extern CvarInt gCvarGameLockstepSeed; // random seed in lockstep mode
+extern CvarBoolean gCvarGameLockstepHashLog; // print state hash of each frame in lockstep mode
+extern CvarString gCvarGameLockstepHashRecord; // file to write state hash of each frame in lockstep mode
+extern CvarString gCvarGameLockstepHashCompare; // file with reference state hashes to compare with in lockstep mode
 extern CvarBoolean gCvarWeatherActive; // whether weather effects enabled
 extern CvarEnum<eWeatherEffect> gCvarWeatherEffect; // currently active weather
 extern CvarBoolean gCvarCarSparksActive; // enable car sparks effect
+extern CvarBoolean gCvarLightweightProjectiles; // simulate projectiles without physics bodies
+extern CvarInt gCvarExplosionsChainBudget; // max chain explosions of vehicles per frame
+extern CvarBoolean gCvarPedestrianStateBuckets; // update pedestrians grouped by their current state after all other objects
 
 // ui
 extern CvarFloat gCvarUiScale; // ui elements scale factor
+extern CvarBoolean gCvarUiCache; // hud layout and text glyphs caching
 
 //////////////////////////////////////////////////////////////////////////
 // console commands
@@ -55,6 +78,20 @@ extern CvarVoid gCvarDbgDumpSpriteDeltas; // dump sprite deltas
 extern CvarVoid gCvarDbgDumpBlockTextures; // dump block textures
 extern CvarVoid gCvarDbgDumpSprites; // dump all sprites
 extern CvarVoid gCvarDbgDumpCarSprites; // dump car sprites
+extern CvarVoid gCvarDbgAudioMixerBenchmark; // software audio mixer benchmark
+extern CvarVoid gCvarDbgAudioDecodeBenchmark; // audio decoder and resampler benchmark
+extern CvarVoid gCvarDbgPhysicsBenchmark; // physics step scaling benchmark
+extern CvarVoid gCvarDbgVehicleDynamicsBenchmark; // batched vehicle dynamics benchmark
+extern CvarVoid gCvarDbgProjectilesBenchmark; // lightweight projectiles update benchmark
+extern CvarVoid gCvarDbgLineOfSightBenchmark; // map line of sight queries benchmark
+extern CvarVoid gCvarDbgCollisionEventsBenchmark; // collision events dispatch benchmark
+extern CvarVoid gCvarDbgExplosionChainBenchmark; // chain explosion frame cost benchmark
+extern CvarVoid gCvarDbgPedestriansBenchmark; // pedestrians update benchmark
+extern CvarVoid gCvarDbgSpritesBenchmark; // split screen sprites extraction benchmark
+extern CvarVoid gCvarDbgSpritesBuildBenchmark; // sprites geometry generation benchmark
+extern CvarVoid gCvarDbgSpritesOcclusionTest; // sprites occlusion self check
+extern CvarVoid gCvarDbgRenderCallsBenchmark; // graphics api calls count benchmark
+extern CvarVoid gCvarDbgHudBenchmark; // hud update and draw cpu time benchmark
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -65,7 +102,18 @@ inline void CvarsRegisterGlobal()
     gConsole.RegisterVariable(&gCvarGraphicsFullscreen);
     gConsole.RegisterVariable(&gCvarGraphicsVSync);
     gConsole.RegisterVariable(&gCvarGraphicsTexFiltering);
+    gConsole.RegisterVariable(&gCvarGraphicsPackedCityMesh);
+    gConsole.RegisterVariable(&gCvarGraphicsOptimizeCityMesh);
+    gConsole.RegisterVariable(&gCvarGraphicsMultiDrawIndirect);
+    gConsole.RegisterVariable(&gCvarGraphicsInstancedSprites);
+    gConsole.RegisterVariable(&gCvarGraphicsSpritesOcclusion);
+    gConsole.RegisterVariable(&gCvarGraphicsStateCache);
     gConsole.RegisterVariable(&gCvarPhysicsFramerate);
+    gConsole.RegisterVariable(&gCvarPhysicsThreads);
+    gConsole.RegisterVariable(&gCvarPhysicsMaxSubsteps);
+    gConsole.RegisterVariable(&gCvarPhysicsFrameBudget);
+    gConsole.RegisterVariable(&gCvarPhysicsAdaptiveStepBodies);
+    gConsole.RegisterVariable(&gCvarPhysicsBatchedVehicles);
     gConsole.RegisterVariable(&gCvarMemEnableFrameHeapAllocator);
     gConsole.RegisterVariable(&gCvarAudioActive);
     gConsole.RegisterVariable(&gCvarGtaDataPath);
@@ -74,14 +122,26 @@ inline void CvarsRegisterGlobal()
     gConsole.RegisterVariable(&gCvarGameVersion);
     gConsole.RegisterVariable(&gCvarGameLanguage);
     gConsole.RegisterVariable(&gCvarNumPlayers);
+    gConsole.RegisterVariable(&gCvarGameLockstep);
+    gConsole.RegisterVariable(&gCvarGameLockstepFramerate);
+    gConsole.RegisterVariable(&gCvarGameLockstepSeed);
+    gConsole.RegisterVariable(&gCvarGameLockstepHashLog);
+    gConsole.RegisterVariable(&gCvarGameLockstepHashRecord);
+    gConsole.RegisterVariable(&gCvarGameLockstepHashCompare);
     gConsole.RegisterVariable(&gCvarWeatherActive);
     gConsole.RegisterVariable(&gCvarWeatherEffect);
     gConsole.RegisterVariable(&gCvarGameMusicMode);
     gConsole.RegisterVariable(&gCvarCarSparksActive);
+    gConsole.RegisterVariable(&gCvarLightweightProjectiles);
+    gConsole.RegisterVariable(&gCvarExplosionsChainBudget);
+    gConsole.RegisterVariable(&gCvarPedestrianStateBuckets);
     gConsole.RegisterVariable(&gCvarMouseAiming);
     gConsole.RegisterVariable(&gCvarMusicVolume);
     gConsole.RegisterVariable(&gCvarSoundsVolume);
+    gConsole.RegisterVariable(&gCvarSoundsSampleRate);
+    gConsole.RegisterVariable(&gCvarSoundsAudibleDistance);
     gConsole.RegisterVariable(&gCvarUiScale);
+    gConsole.RegisterVariable(&gCvarUiCache);
     // commands
     gConsole.RegisterVariable(&gCvarSysQuit);
     gConsole.RegisterVariable(&gCvarSysListCvars);
@@ -89,4 +149,18 @@ inline void CvarsRegisterGlobal()
     gConsole.RegisterVariable(&gCvarDbgDumpBlockTextures);
     gConsole.RegisterVariable(&gCvarDbgDumpSprites);
     gConsole.RegisterVariable(&gCvarDbgDumpCarSprites);
+    gConsole.RegisterVariable(&gCvarDbgAudioMixerBenchmark);
+    gConsole.RegisterVariable(&gCvarDbgAudioDecodeBenchmark);
+    gConsole.RegisterVariable(&gCvarDbgPhysicsBenchmark);
+    gConsole.RegisterVariable(&gCvarDbgVehicleDynamicsBenchmark);
+    gConsole.RegisterVariable(&gCvarDbgProjectilesBenchmark);
+    gConsole.RegisterVariable(&gCvarDbgLineOfSightBenchmark);
+    gConsole.RegisterVariable(&gCvarDbgCollisionEventsBenchmark);
+    gConsole.RegisterVariable(&gCvarDbgExplosionChainBenchmark);
+    gConsole.RegisterVariable(&gCvarDbgPedestriansBenchmark);
+    gConsole.RegisterVariable(&gCvarDbgSpritesBenchmark);
+    gConsole.RegisterVariable(&gCvarDbgSpritesBuildBenchmark);
+    gConsole.RegisterVariable(&gCvarDbgSpritesOcclusionTest);
+    gConsole.RegisterVariable(&gCvarDbgRenderCallsBenchmark);
+    gConsole.RegisterVariable(&gCvarDbgHudBenchmark);
 }
\ No newline at end of file
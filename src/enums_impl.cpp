@@ -171,6 +171,7 @@ impl_enum_strings(eTextureFormat)
     {eTextureFormat_R8UI, "r8ui"},
     {eTextureFormat_RGBA8UI, "rgba8ui"},
     {eTextureFormat_R16UI, "r16ui"},
+    {eTextureFormat_RGBA16UI, "rgba16ui"},
 };
 
 impl_enum_strings(ePrimitiveType)
@@ -238,6 +239,7 @@ impl_enum_strings(eBufferContent)
 {
     {eBufferContent_Vertices, "vertices"},
     {eBufferContent_Indices, "indices"},
+    {eBufferContent_DrawIndirect, "draw_indirect"},
 };
 
 impl_enum_strings(eBufferUsage)
@@ -258,6 +260,8 @@ impl_enum_strings(eRenderUniform)
     {eRenderUniform_NormalMatrix, "normal_matrix"},
     {eRenderUniform_CameraPosition, "camera_position"},
     {eRenderUniform_EnableBiLinearFiltering, "enable_bilinear_filtering"},
+    {eRenderUniform_ChunkOrigin, "chunk_origin"},
+    {eRenderUniform_ChunkSize, "chunk_size"},
 };
 
 impl_enum_strings(eBlendMode)
@@ -0,0 +1,645 @@
+#include "stdafx.h"
+#include "flac_utils.h"
+
+namespace cxx
+{
+
+// flac stream marker "fLaC"
+const unsigned char FlacStreamMarker[4] = {0x66, 0x4C, 0x61, 0x43};
+
+// known metadata block types
+const unsigned int FlacMetadataBlock_StreamInfo = 0;
+
+// size of stream info block in bytes
+const int FlacStreamInfoLength = 34;
+
+// channel assignments for stereo decorrelation
+const unsigned int FlacChannels_LeftSide = 8;
+const unsigned int FlacChannels_SideRight = 9;
+const unsigned int FlacChannels_MidSide = 10;
+
+const int FlacReadBufferSize = 16384;
+const int FlacMaxLpcOrder = 32;
+
+inline int count_leading_zeros(unsigned long long value)
+{
+    debug_assert(value);
+#if defined(_MSC_VER)
+    unsigned long bitIndex = 0;
+    if (_BitScanReverse(&bitIndex, (unsigned long) (value >> 32)))
+        return 31 - (int) bitIndex;
+
+    _BitScanReverse(&bitIndex, (unsigned long) value);
+    return 63 - (int) bitIndex;
+#else
+    return __builtin_clzll(value);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+flac_reader::flac_reader(std::istream& inputStream)
+    : mInputStream(inputStream)
+    , mFramesStart()
+{
+}
+
+bool flac_reader::parse_audio()
+{
+    if (!mInputStream)
+        return false;
+
+    clear();
+
+    mInputStream.clear(); // force clear state after eof
+    mInputStream.seekg(0, std::ios::beg);
+
+    unsigned char streamMarker[4];
+    if (!mInputStream.read((char*) streamMarker, sizeof(streamMarker)) ||
+        (::memcmp(streamMarker, FlacStreamMarker, sizeof(streamMarker)) != 0))
+    {
+        return false;
+    }
+
+    bool hasStreamInfo = false;
+    for (;;)
+    {
+        unsigned char blockHeader[4];
+        if (!mInputStream.read((char*) blockHeader, sizeof(blockHeader)))
+            return false;
+
+        bool isLastBlock = (blockHeader[0] & 0x80) > 0;
+        unsigned int blockType = (blockHeader[0] & 0x7F);
+        unsigned int blockLength = (blockHeader[1] << 16) | (blockHeader[2] << 8) | blockHeader[3];
+
+        if ((blockType == FlacMetadataBlock_StreamInfo) && (blockLength == FlacStreamInfoLength))
+        {
+            unsigned char si[FlacStreamInfoLength];
+            if (!mInputStream.read((char*) si, sizeof(si)))
+                return false;
+
+            hasStreamInfo = true;
+            mMaxBlockSize = (si[2] << 8) | si[3];
+            mSampleRate = (si[10] << 12) | (si[11] << 4) | (si[12] >> 4);
+            mChannelsCount = ((si[12] >> 1) & 0x07) + 1;
+            mSourceSampleBits = (((si[12] & 0x01) << 4) | (si[13] >> 4)) + 1;
+
+            unsigned long long totalSamples = ((unsigned long long) (si[13] & 0x0F) << 32) |
+                ((unsigned int) si[14] << 24) | (si[15] << 16) | (si[16] << 8) | si[17];
+            mSamplesCount = (int) std::min(totalSamples, (unsigned long long) INT_MAX);
+        }
+        else
+        {
+            // skip unknown block
+            if (!mInputStream.seekg(blockLength, std::ios::cur))
+                return false;
+        }
+
+        if (isLastBlock)
+            break;
+    }
+
+    if (!hasStreamInfo)
+        return false;
+
+    // only formats which audio device can handle directly
+    if ((mChannelsCount > 2) || (mSourceSampleBits < 4) || (mSourceSampleBits > 24) || (mMaxBlockSize < 16) || (mSampleRate == 0))
+    {
+        clear();
+        return false;
+    }
+
+    mSampleBits = (mSourceSampleBits <= 8) ? 8 : 16;
+    mFramesStart = mInputStream.tellg();
+    mBlockSamples.resize(mMaxBlockSize * mChannelsCount);
+    mReadBuffer.resize(FlacReadBufferSize);
+
+    return audio_present();
+}
+
+bool flac_reader::audio_present() const
+{
+    return (mChannelsCount > 0) && (mSampleRate > 0) && (mSampleBits > 0);
+}
+
+int flac_reader::read_pcm_samples(int samplesCount, void* buffer)
+{
+    if (!audio_present())
+        return 0;
+
+    const int sourceShift = mSourceSampleBits - mSampleBits;
+    const int sourceScale = (sourceShift < 0) ? (1 << -sourceShift) : 1;
+
+    int samplesRead = 0;
+    while (samplesRead < samplesCount)
+    {
+        if (mBlockPosition == mBlockSize)
+        {
+            if (mStreamFinished || !decode_frame())
+            {
+                mStreamFinished = true;
+                break;
+            }
+            continue;
+        }
+
+        int copySamples = std::min(samplesCount - samplesRead, mBlockSize - mBlockPosition);
+        for (int ichannel = 0; ichannel < mChannelsCount; ++ichannel)
+        {
+            const int* sourceSamples = &mBlockSamples[ichannel * mBlockSize + mBlockPosition];
+            if (mSampleBits == 8)
+            {
+                unsigned char* outputSamples = static_cast<unsigned char*>(buffer) + samplesRead * mChannelsCount + ichannel;
+                for (int isample = 0; isample < copySamples; ++isample)
+                {
+                    outputSamples[isample * mChannelsCount] = (unsigned char) (sourceSamples[isample] * sourceScale + 128);
+                }
+            }
+            else
+            {
+                short* outputSamples = static_cast<short*>(buffer) + samplesRead * mChannelsCount + ichannel;
+                for (int isample = 0; isample < copySamples; ++isample)
+                {
+                    int sampleValue = (sourceShift > 0) ?
+                        (sourceSamples[isample] >> sourceShift) :
+                        (sourceSamples[isample] * sourceScale);
+                    outputSamples[isample * mChannelsCount] = (short) sampleValue;
+                }
+            }
+        }
+        mBlockPosition += copySamples;
+        samplesRead += copySamples;
+    }
+
+    mSamplesDecoded += samplesRead;
+    return samplesRead;
+}
+
+bool flac_reader::seek_pcm_beg(int samples)
+{
+    if (!audio_present() || (samples < 0))
+        return false;
+
+    reset_decoder();
+    return seek_pcm_cur(samples);
+}
+
+bool flac_reader::seek_pcm_end(int samples)
+{
+    if (!audio_present() || (mSamplesCount == 0))
+        return false;
+
+    return seek_pcm_beg(mSamplesCount + samples);
+}
+
+bool flac_reader::seek_pcm_cur(int samples)
+{
+    if (!audio_present())
+        return false;
+
+    if (samples < 0)
+        return seek_pcm_beg(mSamplesDecoded + samples);
+
+    while (samples > 0)
+    {
+        if (mBlockPosition == mBlockSize)
+        {
+            if (mStreamFinished || !decode_frame())
+            {
+                mStreamFinished = true;
+                return false;
+            }
+            continue;
+        }
+
+        int skipSamples = std::min(samples, mBlockSize - mBlockPosition);
+        mBlockPosition += skipSamples;
+        mSamplesDecoded += skipSamples;
+        samples -= skipSamples;
+    }
+    return true;
+}
+
+bool flac_reader::end_of_stream() const
+{
+    if (mStreamFinished)
+        return true;
+
+    return (mSamplesCount > 0) && (mSamplesDecoded >= mSamplesCount);
+}
+
+void flac_reader::clear()
+{
+    mChannelsCount = 0;
+    mSampleRate = 0;
+    mSampleBits = 0;
+    mSamplesCount = 0;
+    mSourceSampleBits = 0;
+    mMaxBlockSize = 0;
+    mFramesStart = std::streampos();
+    reset_decoder();
+}
+
+void flac_reader::reset_decoder()
+{
+    mBlockSize = 0;
+    mBlockPosition = 0;
+    mSamplesDecoded = 0;
+    mStreamFinished = false;
+
+    mReadBufferPosition = 0;
+    mReadBufferLength = 0;
+    mBitCache = 0;
+    mBitCacheCount = 0;
+    mReadError = false;
+
+    if (audio_present())
+    {
+        mInputStream.clear(); // force clear state after eof
+        mInputStream.seekg(mFramesStart, std::ios::beg);
+    }
+}
+
+bool flac_reader::decode_frame()
+{
+    mBlockSize = 0;
+    mBlockPosition = 0;
+
+    align_to_byte();
+
+    // find frame sync code
+    unsigned int prevByte = 0;
+    for (;;)
+    {
+        unsigned int currByte = read_bits(8);
+        if (mReadError)
+            return false;
+
+        if ((prevByte == 0xFF) && ((currByte & 0xFE) == 0xF8))
+            break;
+
+        prevByte = currByte;
+    }
+
+    unsigned int blockSizeCode = read_bits(4);
+    unsigned int sampleRateCode = read_bits(4);
+    unsigned int channelAssignment = read_bits(4);
+    unsigned int sampleSizeCode = read_bits(3);
+    read_bits(1); // reserved
+
+    // skip utf-8 coded frame or sample number
+    unsigned int codedNumber = read_bits(8);
+    int leadingOnes = 0;
+    while ((leadingOnes < 8) && (codedNumber & (0x80 >> leadingOnes)))
+    {
+        ++leadingOnes;
+    }
+    if ((leadingOnes == 1) || (leadingOnes == 8))
+        return false;
+
+    for (int ibyte = 1; ibyte < leadingOnes; ++ibyte)
+    {
+        read_bits(8);
+    }
+
+    int blockSize = 0;
+    switch (blockSizeCode)
+    {
+        case 0: return false;
+        case 1: blockSize = 192; break;
+        case 2: case 3: case 4: case 5: blockSize = 576 << (blockSizeCode - 2); break;
+        case 6: blockSize = read_bits(8) + 1; break;
+        case 7: blockSize = read_bits(16) + 1; break;
+        default: blockSize = 256 << (blockSizeCode - 8); break;
+    }
+
+    // frame sample rate is not used, but must be skipped
+    if (sampleRateCode == 12)
+    {
+        read_bits(8);
+    }
+    else if ((sampleRateCode == 13) || (sampleRateCode == 14))
+    {
+        read_bits(16);
+    }
+    else if (sampleRateCode == 15)
+        return false;
+
+    read_bits(8); // header crc
+
+    static const int frameSampleBits[8] = {0, 8, 12, 0, 16, 20, 24, 0};
+    int sampleBits = (sampleSizeCode == 0) ? mSourceSampleBits : frameSampleBits[sampleSizeCode];
+    if (sampleBits != mSourceSampleBits)
+        return false;
+
+    int channelsCount = (channelAssignment < FlacChannels_LeftSide) ? (int) channelAssignment + 1 : 2;
+    if ((channelAssignment > FlacChannels_MidSide) || (channelsCount != mChannelsCount))
+        return false;
+
+    if (mReadError)
+        return false;
+
+    mBlockSize = blockSize;
+    if ((int) mBlockSamples.size() < blockSize * channelsCount)
+    {
+        mBlockSamples.resize(blockSize * channelsCount);
+    }
+
+    for (int ichannel = 0; ichannel < channelsCount; ++ichannel)
+    {
+        // side channel has one extra bit
+        bool isSideChannel = ((channelAssignment == FlacChannels_LeftSide) && (ichannel == 1)) ||
+            ((channelAssignment == FlacChannels_SideRight) && (ichannel == 0)) ||
+            ((channelAssignment == FlacChannels_MidSide) && (ichannel == 1));
+
+        if (!decode_subframe(ichannel, isSideChannel ? sampleBits + 1 : sampleBits))
+        {
+            mBlockSize = 0;
+            return false;
+        }
+    }
+
+    align_to_byte();
+    read_bits(16); // frame crc
+
+    // stereo decorrelation
+    int* channel0 = &mBlockSamples[0];
+    int* channel1 = &mBlockSamples[mBlockSize];
+    if (channelAssignment == FlacChannels_LeftSide)
+    {
+        for (int isample = 0; isample < mBlockSize; ++isample)
+        {
+            channel1[isample] = channel0[isample] - channel1[isample];
+        }
+    }
+    else if (channelAssignment == FlacChannels_SideRight)
+    {
+        for (int isample = 0; isample < mBlockSize; ++isample)
+        {
+            channel0[isample] = channel0[isample] + channel1[isample];
+        }
+    }
+    else if (channelAssignment == FlacChannels_MidSide)
+    {
+        for (int isample = 0; isample < mBlockSize; ++isample)
+        {
+            int side = channel1[isample];
+            int mid = (channel0[isample] * 2) | (side & 1);
+            channel0[isample] = (mid + side) >> 1;
+            channel1[isample] = (mid - side) >> 1;
+        }
+    }
+    return true;
+}
+
+bool flac_reader::decode_subframe(int channelIndex, int sampleBits)
+{
+    int* samples = &mBlockSamples[channelIndex * mBlockSize];
+
+    if (read_bits(1) != 0) // zero padding
+        return false;
+
+    unsigned int subframeType = read_bits(6);
+
+    int wastedBits = 0;
+    if (read_bits(1))
+    {
+        wastedBits = read_unary() + 1;
+        sampleBits -= wastedBits;
+    }
+
+    if ((sampleBits <= 0) || mReadError)
+        return false;
+
+    if (subframeType == 0) // constant
+    {
+        int sampleValue = read_signed_bits(sampleBits);
+        std::fill(samples, samples + mBlockSize, sampleValue);
+    }
+    else if (subframeType == 1) // verbatim
+    {
+        for (int isample = 0; isample < mBlockSize; ++isample)
+        {
+            samples[isample] = read_signed_bits(sampleBits);
+        }
+    }
+    else if ((subframeType >= 8) && (subframeType <= 12)) // fixed predictor
+    {
+        int order = subframeType - 8;
+        if (order > mBlockSize)
+            return false;
+
+        for (int isample = 0; isample < order; ++isample)
+        {
+            samples[isample] = read_signed_bits(sampleBits);
+        }
+
+        if (!decode_residual(order, samples + order))
+            return false;
+
+        switch (order)
+        {
+            case 1:
+                for (int isample = 1; isample < mBlockSize; ++isample)
+                    samples[isample] += samples[isample - 1];
+            break;
+            case 2:
+                for (int isample = 2; isample < mBlockSize; ++isample)
+                    samples[isample] += 2 * samples[isample - 1] - samples[isample - 2];
+            break;
+            case 3:
+                for (int isample = 3; isample < mBlockSize; ++isample)
+                    samples[isample] += 3 * (samples[isample - 1] - samples[isample - 2]) + samples[isample - 3];
+            break;
+            case 4:
+                for (int isample = 4; isample < mBlockSize; ++isample)
+                    samples[isample] += 4 * (samples[isample - 1] + samples[isample - 3]) - 6 * samples[isample - 2] - samples[isample - 4];
+            break;
+        }
+    }
+    else if (subframeType >= 32) // linear predictor
+    {
+        int order = (subframeType & 0x1F) + 1;
+        if (order > mBlockSize)
+            return false;
+
+        for (int isample = 0; isample < order; ++isample)
+        {
+            samples[isample] = read_signed_bits(sampleBits);
+        }
+
+        int coefPrecision = read_bits(4) + 1;
+        int coefShift = read_signed_bits(5);
+        if ((coefPrecision == 16) || (coefShift < 0))
+            return false;
+
+        int coefs[FlacMaxLpcOrder];
+        for (int icoef = 0; icoef < order; ++icoef)
+        {
+            coefs[icoef] = read_signed_bits(coefPrecision);
+        }
+
+        if (!decode_residual(order, samples + order))
+            return false;
+
+        for (int isample = order; isample < mBlockSize; ++isample)
+        {
+            long long prediction = 0;
+            for (int icoef = 0; icoef < order; ++icoef)
+            {
+                prediction += (long long) coefs[icoef] * samples[isample - icoef - 1];
+            }
+            samples[isample] += (int) (prediction >> coefShift);
+        }
+    }
+    else
+    {
+        return false; // reserved
+    }
+
+    if (wastedBits > 0)
+    {
+        for (int isample = 0; isample < mBlockSize; ++isample)
+        {
+            samples[isample] *= (1 << wastedBits);
+        }
+    }
+
+    return !mReadError;
+}
+
+bool flac_reader::decode_residual(int predictorOrder, int* residual)
+{
+    unsigned int codingMethod = read_bits(2);
+    if (codingMethod > 1)
+        return false;
+
+    const int riceParamBits = (codingMethod == 0) ? 4 : 5;
+    const unsigned int riceEscapeCode = (codingMethod == 0) ? 15 : 31;
+
+    int partitionOrder = read_bits(4);
+    int partitionsCount = 1 << partitionOrder;
+    int partitionSamples = mBlockSize >> partitionOrder;
+    if (((partitionSamples << partitionOrder) != mBlockSize) || (partitionSamples < predictorOrder))
+        return false;
+
+    for (int ipartition = 0; ipartition < partitionsCount; ++ipartition)
+    {
+        int samplesCount = (ipartition == 0) ? (partitionSamples - predictorOrder) : partitionSamples;
+
+        unsigned int riceParam = read_bits(riceParamBits);
+        if (riceParam == riceEscapeCode)
+        {
+            int rawBits = read_bits(5);
+            for (int isample = 0; isample < samplesCount; ++isample)
+            {
+                residual[isample] = read_signed_bits(rawBits);
+            }
+        }
+        else
+        {
+            for (int isample = 0; isample < samplesCount; ++isample)
+            {
+                unsigned int quotient = read_unary();
+                unsigned int value = (quotient << riceParam) | read_bits(riceParam);
+                residual[isample] = (int) (value >> 1) ^ -(int) (value & 1);
+            }
+        }
+
+        if (mReadError)
+            return false;
+
+        residual += samplesCount;
+    }
+    return true;
+}
+
+bool flac_reader::refill_bits()
+{
+    while (mBitCacheCount <= 56)
+    {
+        if (mReadBufferPosition == mReadBufferLength)
+        {
+            if (!mInputStream)
+                break;
+
+            mInputStream.read((char*) mReadBuffer.data(), mReadBuffer.size());
+            mReadBufferLength = (int) mInputStream.gcount();
+            mReadBufferPosition = 0;
+            if (mReadBufferLength == 0)
+                break;
+        }
+        mBitCache |= (unsigned long long) mReadBuffer[mReadBufferPosition++] << (56 - mBitCacheCount);
+        mBitCacheCount += 8;
+    }
+    return mBitCacheCount > 0;
+}
+
+unsigned int flac_reader::read_bits(int bitsCount)
+{
+    debug_assert(bitsCount <= 32);
+    if (bitsCount == 0)
+        return 0;
+
+    if (mBitCacheCount < bitsCount)
+    {
+        refill_bits();
+        if (mBitCacheCount < bitsCount)
+        {
+            mReadError = true;
+            return 0;
+        }
+    }
+
+    unsigned int value = (unsigned int) (mBitCache >> (64 - bitsCount));
+    mBitCache <<= bitsCount;
+    mBitCacheCount -= bitsCount;
+    return value;
+}
+
+int flac_reader::read_signed_bits(int bitsCount)
+{
+    if (bitsCount == 0)
+        return 0;
+
+    unsigned int value = read_bits(bitsCount);
+    // sign extend
+    int shift = 32 - bitsCount;
+    return (int) (value << shift) >> shift;
+}
+
+unsigned int flac_reader::read_unary()
+{
+    unsigned int zerosCount = 0;
+    for (;;)
+    {
+        if ((mBitCacheCount == 0) && !refill_bits())
+        {
+            mReadError = true;
+            return 0;
+        }
+
+        if (mBitCache == 0)
+        {
+            // all cached bits are zeros
+            zerosCount += mBitCacheCount;
+            mBitCacheCount = 0;
+            continue;
+        }
+
+        int leadingZeros = count_leading_zeros(mBitCache);
+        zerosCount += leadingZeros;
+        // consume zeros and stop bit
+        mBitCache <<= leadingZeros;
+        mBitCache <<= 1;
+        mBitCacheCount -= (leadingZeros + 1);
+        return zerosCount;
+    }
+}
+
+void flac_reader::align_to_byte()
+{
+    read_bits(mBitCacheCount % 8);
+}
+
+} // namespace cxx
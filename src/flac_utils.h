@@ -0,0 +1,75 @@
+#pragma once
+
+namespace cxx
+{
+    // simple pcm audio data reader from native flac file
+    // supports mono and stereo streams up to 24 bits per sample, 24 bit data is converted to 16 bit
+    class flac_reader final: public noncopyable
+    {
+    public:
+        // readonly
+        int mChannelsCount = 0;
+        int mSampleRate = 0;
+        int mSampleBits = 0; // output bits per sample, 8 or 16
+        int mSamplesCount = 0; // may be zero if unknown
+
+    public:
+        flac_reader(std::istream& inputStream);
+
+        bool parse_audio();
+        bool audio_present() const;
+
+        // read pcm audio data
+        // @param samplesCount: samples count to read
+        // @parm buffer: Destination buffer
+        // @returns Samples count copied to buffer
+        int read_pcm_samples(int samplesCount, void* buffer);
+
+        // seeking is done by decoding stream from its start, so it is slow
+        // @param samples: Samples count
+        bool seek_pcm_beg(int samples);
+        bool seek_pcm_end(int samples);
+        bool seek_pcm_cur(int samples);
+
+        bool end_of_stream() const;
+
+    private:
+        void clear();
+        void reset_decoder();
+
+        // decode next frame into block buffer
+        bool decode_frame();
+        bool decode_subframe(int channelIndex, int sampleBits);
+        bool decode_residual(int predictorOrder, int* residual);
+
+        // bit reader
+        bool refill_bits();
+        unsigned int read_bits(int bitsCount);
+        int read_signed_bits(int bitsCount);
+        unsigned int read_unary();
+        void align_to_byte();
+
+    private:
+        std::istream& mInputStream;
+        std::streampos mFramesStart;
+
+        int mSourceSampleBits = 0;
+        int mMaxBlockSize = 0;
+
+        // decoded block, planar
+        std::vector<int> mBlockSamples;
+        int mBlockSize = 0;
+        int mBlockPosition = 0;
+        int mSamplesDecoded = 0; // total samples handed out to client
+        bool mStreamFinished = false;
+
+        // bit reader state
+        std::vector<unsigned char> mReadBuffer;
+        int mReadBufferPosition = 0;
+        int mReadBufferLength = 0;
+        unsigned long long mBitCache = 0; // left aligned
+        int mBitCacheCount = 0;
+        bool mReadError = false;
+    };
+
+} // namespace cxx
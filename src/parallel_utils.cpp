@@ -0,0 +1,182 @@
+#include "stdafx.h"
+#include "parallel_utils.h"
+
+namespace cxx
+{
+
+int get_parallel_threads_count()
+{
+    static const int threadsCount = std::max((int) std::thread::hardware_concurrency(), 1);
+    return threadsCount;
+}
+
+void parallel_for(int itemsCount, int minItemsPerThread, const parallel_range_proc& rangeProc)
+{
+    parallel_for(itemsCount, minItemsPerThread, 0, rangeProc);
+}
+
+void parallel_for(int itemsCount, int minItemsPerThread, int maxThreadsCount, const parallel_range_proc& rangeProc)
+{
+    if (itemsCount <= 0)
+        return;
+
+    minItemsPerThread = std::max(minItemsPerThread, 1);
+    if (maxThreadsCount <= 0)
+    {
+        maxThreadsCount = get_parallel_threads_count();
+    }
+
+    int threadsCount = std::min(maxThreadsCount, (itemsCount + minItemsPerThread - 1) / minItemsPerThread);
+    if (threadsCount < 2)
+    {
+        rangeProc(0, itemsCount);
+        return;
+    }
+
+    int itemsPerThread = itemsCount / threadsCount;
+    int itemsRemainder = itemsCount % threadsCount;
+
+    // first range is processed by calling thread
+    int firstRangeEnd = itemsPerThread + (itemsRemainder > 0 ? 1 : 0);
+
+    std::vector<std::thread> workerThreads;
+    workerThreads.reserve(threadsCount - 1);
+    for (int ithread = 1, ibegin = firstRangeEnd; ithread < threadsCount; ++ithread)
+    {
+        int iend = ibegin + itemsPerThread + (ithread < itemsRemainder ? 1 : 0);
+        workerThreads.emplace_back(rangeProc, ibegin, iend);
+        ibegin = iend;
+    }
+
+    rangeProc(0, firstRangeEnd);
+
+    for (std::thread& currThread: workerThreads)
+    {
+        currThread.join();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+worker_pool::~worker_pool()
+{
+    shutdown();
+}
+
+void worker_pool::initialize(int workersCount)
+{
+    shutdown();
+
+    workersCount = std::max(workersCount, 0);
+    mRanges.resize(workersCount);
+    mWorkers.reserve(workersCount);
+    for (int iworker = 0; iworker < workersCount; ++iworker)
+    {
+        mWorkers.emplace_back(&worker_pool::worker_proc, this, iworker, mDispatchIndex);
+    }
+}
+
+void worker_pool::shutdown()
+{
+    if (mWorkers.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mShutdown = true;
+    }
+    mWorkCondition.notify_all();
+
+    for (std::thread& currThread: mWorkers)
+    {
+        currThread.join();
+    }
+    mWorkers.clear();
+    mRanges.clear();
+    mShutdown = false;
+}
+
+int worker_pool::get_threads_count() const
+{
+    return (int) mWorkers.size() + 1;
+}
+
+void worker_pool::parallel_for(int itemsCount, int minItemsPerThread, int maxThreadsCount, const parallel_range_proc& rangeProc)
+{
+    if (itemsCount <= 0)
+        return;
+
+    minItemsPerThread = std::max(minItemsPerThread, 1);
+    if (maxThreadsCount <= 0)
+    {
+        maxThreadsCount = get_threads_count();
+    }
+
+    int threadsCount = std::min({maxThreadsCount, get_threads_count(), (itemsCount + minItemsPerThread - 1) / minItemsPerThread});
+    // nested dispatch from inside of range processing is done in place
+    if ((threadsCount < 2) || mBusy.exchange(true))
+    {
+        rangeProc(0, itemsCount);
+        return;
+    }
+
+    int itemsPerThread = itemsCount / threadsCount;
+    int itemsRemainder = itemsCount % threadsCount;
+
+    // first range is processed by calling thread
+    int firstRangeEnd = itemsPerThread + (itemsRemainder > 0 ? 1 : 0);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (int ithread = 1, ibegin = firstRangeEnd; ithread < threadsCount; ++ithread)
+        {
+            int iend = ibegin + itemsPerThread + (ithread < itemsRemainder ? 1 : 0);
+            mRanges[ithread - 1].mBegin = ibegin;
+            mRanges[ithread - 1].mEnd = iend;
+            ibegin = iend;
+        }
+        mRangeProc = &rangeProc;
+        mActiveWorkers = threadsCount - 1;
+        mPendingWorkers = mActiveWorkers;
+        ++mDispatchIndex;
+    }
+    mWorkCondition.notify_all();
+
+    rangeProc(0, firstRangeEnd);
+
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDoneCondition.wait(lock, [this]() { return mPendingWorkers == 0; });
+        mRangeProc = nullptr;
+        mActiveWorkers = 0;
+    }
+    mBusy = false;
+}
+
+void worker_pool::worker_proc(int workerIndex, unsigned int dispatchIndex)
+{
+    for (;;)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mWorkCondition.wait(lock, [this, dispatchIndex]() { return mShutdown || (mDispatchIndex != dispatchIndex); });
+        if (mShutdown)
+            break;
+
+        dispatchIndex = mDispatchIndex;
+        if (workerIndex >= mActiveWorkers)
+            continue;
+
+        const items_range range = mRanges[workerIndex];
+        const parallel_range_proc* rangeProc = mRangeProc;
+        lock.unlock();
+
+        (*rangeProc)(range.mBegin, range.mEnd);
+
+        lock.lock();
+        if (--mPendingWorkers == 0)
+        {
+            mDoneCondition.notify_one();
+        }
+    }
+}
+
+} // namespace cxx
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+
+namespace cxx
+{
+    using parallel_range_proc = std::function<void (int ibegin, int iend)>;
+
+    // get number of threads which may process parallel tasks, calling thread included
+    int get_parallel_threads_count();
+
+    // process items range on multiple threads, calling thread takes first part of range by itself
+    // returns when all items are processed
+    // @param itemsCount: Total number of items
+    // @param minItemsPerThread: Ranges smaller than that are not split further
+    // @param rangeProc: Items processing function, called for subrange [ibegin, iend)
+    void parallel_for(int itemsCount, int minItemsPerThread, const parallel_range_proc& rangeProc);
+
+    // process items range on limited number of threads
+    // @param maxThreadsCount: Threads limit including calling thread, zero or less means no limit
+    void parallel_for(int itemsCount, int minItemsPerThread, int maxThreadsCount, const parallel_range_proc& rangeProc);
+
+    // persistent worker threads for parallel work that repeats every frame
+    // workers are created once and sleep between dispatches, so there is no thread startup cost per call
+    class worker_pool final: public noncopyable
+    {
+    public:
+        ~worker_pool();
+
+        // start worker threads, previously started workers are stopped
+        // @param workersCount: Number of threads besides calling thread
+        void initialize(int workersCount);
+        void shutdown();
+
+        // get number of threads which may process parallel tasks, calling thread included
+        int get_threads_count() const;
+
+        // same as cxx::parallel_for but ranges are processed by pool workers
+        // work is processed on calling thread only if pool is not started or already busy
+        // @param maxThreadsCount: Threads limit including calling thread, zero or less means no limit
+        void parallel_for(int itemsCount, int minItemsPerThread, int maxThreadsCount, const parallel_range_proc& rangeProc);
+
+    private:
+        void worker_proc(int workerIndex, unsigned int dispatchIndex);
+
+    private:
+        struct items_range
+        {
+            int mBegin = 0;
+            int mEnd = 0;
+        };
+
+        std::vector<std::thread> mWorkers;
+        std::vector<items_range> mRanges; // per worker
+        const parallel_range_proc* mRangeProc = nullptr;
+        std::mutex mMutex;
+        std::condition_variable mWorkCondition;
+        std::condition_variable mDoneCondition;
+        unsigned int mDispatchIndex = 0; // incremented on each dispatch, wakes workers
+        int mActiveWorkers = 0; // workers that have range in current dispatch
+        int mPendingWorkers = 0; // workers that did not finish current dispatch yet
+        bool mShutdown = false;
+        std::atomic<bool> mBusy {false};
+    };
+
+} // namespace cxx
@@ -48,6 +48,7 @@
 #include <cctype>
 #include <chrono>
 #include <thread>
+#include <atomic>
 #include <functional>
 
 // opengl
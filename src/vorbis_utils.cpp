@@ -0,0 +1,1520 @@
+#include "stdafx.h"
+#include "vorbis_utils.h"
+
+namespace cxx
+{
+
+// ogg page header, followed by segments table
+const unsigned char OggPageMarker[4] = {0x4F, 0x67, 0x67, 0x53};
+const int OggPageHeaderLength = 27;
+const int OggMaxPageLength = OggPageHeaderLength + 255 + 255 * 255;
+
+// vorbis header packet types
+const unsigned int VorbisPacket_Identification = 1;
+const unsigned int VorbisPacket_Comment = 3;
+const unsigned int VorbisPacket_Setup = 5;
+
+const unsigned int VorbisCodebookSync = 0x564342;
+
+// extra zero bytes after packet data, so bit reader may look ahead without range checks
+const int VorbisPacketPadding = 8;
+
+// codewords up to this length are decoded with single table lookup
+const int VorbisFastTableBits = 10;
+
+// floor type 1 limits, 31 partitions of up to 8 values plus two end points
+const int VorbisFloorMaxValues = 2 + 31 * 8;
+const int VorbisFloorRanges[4] = {256, 128, 86, 64};
+
+inline int ilog(unsigned int value)
+{
+    int bitsCount = 0;
+    while (value)
+    {
+        ++bitsCount;
+        value >>= 1;
+    }
+    return bitsCount;
+}
+
+inline unsigned int bit_reverse(unsigned int value)
+{
+    value = ((value & 0xAAAAAAAA) >> 1) | ((value & 0x55555555) << 1);
+    value = ((value & 0xCCCCCCCC) >> 2) | ((value & 0x33333333) << 2);
+    value = ((value & 0xF0F0F0F0) >> 4) | ((value & 0x0F0F0F0F) << 4);
+    value = ((value & 0xFF00FF00) >> 8) | ((value & 0x00FF00FF) << 8);
+    return (value >> 16) | (value << 16);
+}
+
+// decode vorbis packed float value
+inline float float32_unpack(unsigned int value)
+{
+    double mantissa = (double) (value & 0x1FFFFF);
+    int exponent = (int) ((value & 0x7FE00000) >> 21);
+    if (value & 0x80000000)
+    {
+        mantissa = -mantissa;
+    }
+    return (float) ::ldexp(mantissa, exponent - 788);
+}
+
+// get largest integer which raised to dimensions power does not exceed entries count
+inline int lookup1_values(int entriesCount, int dimensions)
+{
+    int valuesCount = (int) ::floor(::pow((double) entriesCount, 1.0 / dimensions));
+    auto fits_entries = [entriesCount, dimensions](long long value)
+    {
+        long long product = 1;
+        for (int idim = 0; idim < dimensions; ++idim)
+        {
+            product *= value;
+            if (product > entriesCount)
+                return false;
+        }
+        return true;
+    };
+    while (fits_entries(valuesCount + 1))
+    {
+        ++valuesCount;
+    }
+    while ((valuesCount > 0) && !fits_entries(valuesCount))
+    {
+        --valuesCount;
+    }
+    return valuesCount;
+}
+
+inline int render_point(int x0, int y0, int x1, int y1, int x)
+{
+    int dy = y1 - y0;
+    int adx = x1 - x0;
+    int offset = (std::abs(dy) * (x - x0)) / adx;
+    return (dy < 0) ? (y0 - offset) : (y0 + offset);
+}
+
+inline void render_line(int x0, int y0, int x1, int y1, int* curve, int curveLength)
+{
+    int dy = y1 - y0;
+    int adx = x1 - x0;
+    int base = dy / adx;
+    int sy = (dy < 0) ? (base - 1) : (base + 1);
+    int ady = std::abs(dy) - std::abs(base) * adx;
+    int y = y0;
+    int error = 0;
+    if (x0 < curveLength)
+    {
+        curve[x0] = y;
+    }
+    for (int x = x0 + 1; (x < x1) && (x < curveLength); ++x)
+    {
+        error += ady;
+        if (error >= adx)
+        {
+            error -= adx;
+            y += sy;
+        }
+        else
+        {
+            y += base;
+        }
+        curve[x] = y;
+    }
+}
+
+// floor amplitudes for each of 256 curve levels, step is about 0.55 dB
+static const float* get_inverse_db_table()
+{
+    static const std::vector<float> inverseDbTable = []()
+    {
+        std::vector<float> table(256);
+        for (int ivalue = 0; ivalue < 256; ++ivalue)
+        {
+            table[ivalue] = (float) ::pow(1.0649863e-07, (255 - ivalue) / 255.0);
+        }
+        return table;
+    }();
+    return inverseDbTable.data();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+vorbis_reader::vorbis_reader(std::istream& inputStream)
+    : mInputStream(inputStream)
+    , mAudioStart()
+{
+}
+
+bool vorbis_reader::parse_audio()
+{
+    if (!mInputStream)
+        return false;
+
+    clear();
+
+    mInputStream.clear(); // force clear state after eof
+    mInputStream.seekg(0, std::ios::beg);
+
+    // first page starts logical stream
+    if (!read_page())
+        return false;
+
+    mStreamSerial = mPageSerial;
+
+    // identification header
+    if (!read_packet() || !read_header_signature(VorbisPacket_Identification))
+        return false;
+
+    unsigned int vorbisVersion = read_bits(32);
+    int channelsCount = read_bits(8);
+    int sampleRate = (int) read_bits(32);
+    read_bits(32); // bitrate maximum
+    read_bits(32); // bitrate nominal
+    read_bits(32); // bitrate minimum
+    int blockSizeShort = read_bits(4);
+    int blockSizeLong = read_bits(4);
+    if ((read_bits(1) == 0) || mPacketEnd)
+        return false;
+
+    // only formats which audio device can handle directly
+    if ((vorbisVersion != 0) || (channelsCount < 1) || (channelsCount > 2) || (sampleRate <= 0) ||
+        (blockSizeShort < 6) || (blockSizeShort > blockSizeLong) || (blockSizeLong > 13))
+    {
+        return false;
+    }
+
+    mBlockSizes[0] = 1 << blockSizeShort;
+    mBlockSizes[1] = 1 << blockSizeLong;
+
+    // comment header is not used
+    if (!read_packet() || !read_header_signature(VorbisPacket_Comment))
+        return false;
+
+    if (!read_packet() || !read_header_signature(VorbisPacket_Setup))
+        return false;
+
+    // setup needs channels count
+    mChannelsCount = channelsCount;
+    if (!parse_setup_header())
+    {
+        clear();
+        return false;
+    }
+
+    // audio packets must start on fresh page
+    if (mPageSegmentIndex != mPageSegmentsCount)
+    {
+        clear();
+        return false;
+    }
+
+    mSampleRate = sampleRate;
+    mSampleBits = 16;
+    mAudioStart = mInputStream.tellg();
+
+    long long lastGranule = 0;
+    if (read_last_granule(lastGranule))
+    {
+        mSamplesCount = (int) std::min(lastGranule, (long long) INT_MAX);
+    }
+
+    setup_transform(0);
+    setup_transform(1);
+
+    const int longHalfSize = mBlockSizes[1] / 2;
+    mFloorY.resize(mChannelsCount * mFloorMaxValues);
+    mFloorCurve.resize(longHalfSize);
+    mSpectrum.resize(mChannelsCount * longHalfSize);
+    mResidueInterleaved.resize(mChannelsCount * longHalfSize);
+    mTransformBuffer.resize(mBlockSizes[1]);
+    mTransformOutput.resize(mBlockSizes[1]);
+    mOverlap.resize(mChannelsCount * longHalfSize);
+    mBlockSamples.resize(mChannelsCount * longHalfSize);
+
+    reset_decoder();
+    return audio_present();
+}
+
+bool vorbis_reader::audio_present() const
+{
+    return (mChannelsCount > 0) && (mSampleRate > 0) && (mSampleBits > 0);
+}
+
+int vorbis_reader::read_pcm_samples(int samplesCount, void* buffer)
+{
+    if (!audio_present())
+        return 0;
+
+    int samplesRead = 0;
+    while (samplesRead < samplesCount)
+    {
+        if (mBlockPosition == mBlockSize)
+        {
+            if (mStreamFinished || !decode_packet())
+            {
+                mStreamFinished = true;
+                break;
+            }
+            continue;
+        }
+
+        int copySamples = std::min(samplesCount - samplesRead, mBlockSize - mBlockPosition);
+        ::memcpy(static_cast<short*>(buffer) + samplesRead * mChannelsCount,
+            &mBlockSamples[mBlockPosition * mChannelsCount], copySamples * mChannelsCount * sizeof(short));
+        mBlockPosition += copySamples;
+        samplesRead += copySamples;
+    }
+
+    mSamplesDecoded += samplesRead;
+    return samplesRead;
+}
+
+bool vorbis_reader::seek_pcm_beg(int samples)
+{
+    if (!audio_present() || (samples < 0))
+        return false;
+
+    reset_decoder();
+    return seek_pcm_cur(samples);
+}
+
+bool vorbis_reader::seek_pcm_end(int samples)
+{
+    if (!audio_present() || (mSamplesCount == 0))
+        return false;
+
+    return seek_pcm_beg(mSamplesCount + samples);
+}
+
+bool vorbis_reader::seek_pcm_cur(int samples)
+{
+    if (!audio_present())
+        return false;
+
+    if (samples < 0)
+        return seek_pcm_beg(mSamplesDecoded + samples);
+
+    while (samples > 0)
+    {
+        if (mBlockPosition == mBlockSize)
+        {
+            if (mStreamFinished || !decode_packet())
+            {
+                mStreamFinished = true;
+                return false;
+            }
+            continue;
+        }
+
+        int skipSamples = std::min(samples, mBlockSize - mBlockPosition);
+        mBlockPosition += skipSamples;
+        mSamplesDecoded += skipSamples;
+        samples -= skipSamples;
+    }
+    return true;
+}
+
+bool vorbis_reader::end_of_stream() const
+{
+    if (mStreamFinished)
+        return true;
+
+    return (mSamplesCount > 0) && (mSamplesDecoded >= mSamplesCount);
+}
+
+void vorbis_reader::clear()
+{
+    mChannelsCount = 0;
+    mSampleRate = 0;
+    mSampleBits = 0;
+    mSamplesCount = 0;
+    mAudioStart = std::streampos();
+    mStreamSerial = 0;
+    mBlockSizes[0] = 0;
+    mBlockSizes[1] = 0;
+    mCodebooks.clear();
+    mFloors.clear();
+    mResidues.clear();
+    mMappings.clear();
+    mModes.clear();
+    mFloorMaxValues = 0;
+    reset_decoder();
+}
+
+void vorbis_reader::reset_decoder()
+{
+    mPageSegmentsCount = 0;
+    mPageSegmentIndex = 0;
+    mPageDataPosition = 0;
+    mPacketLength = 0;
+    mPacketBitPosition = 0;
+    mPacketEnd = false;
+
+    mPrevBlockSize = 0;
+    mBlockSize = 0;
+    mBlockPosition = 0;
+    mSamplesDecoded = 0;
+    mSamplesProduced = 0;
+    mStreamFinished = false;
+
+    if (audio_present())
+    {
+        mInputStream.clear(); // force clear state after eof
+        mInputStream.seekg(mAudioStart, std::ios::beg);
+    }
+}
+
+bool vorbis_reader::read_page()
+{
+    mPageSegmentsCount = 0;
+    mPageSegmentIndex = 0;
+    mPageDataPosition = 0;
+
+    unsigned char header[OggPageHeaderLength];
+    if (!mInputStream.read((char*) header, sizeof(header)) ||
+        (::memcmp(header, OggPageMarker, sizeof(OggPageMarker)) != 0) || (header[4] != 0))
+    {
+        return false;
+    }
+
+    mPageSerial = header[14] | (header[15] << 8) | (header[16] << 16) | ((unsigned int) header[17] << 24);
+
+    int segmentsCount = header[26];
+    if (!mInputStream.read((char*) mPageSegments, segmentsCount))
+        return false;
+
+    int dataLength = 0;
+    for (int isegment = 0; isegment < segmentsCount; ++isegment)
+    {
+        dataLength += mPageSegments[isegment];
+    }
+
+    mPageData.resize(dataLength);
+    if ((dataLength > 0) && !mInputStream.read((char*) mPageData.data(), dataLength))
+        return false;
+
+    mPageSegmentsCount = segmentsCount;
+    return true;
+}
+
+bool vorbis_reader::read_packet()
+{
+    mPacketLength = 0;
+    mPacketBitPosition = 0;
+    mPacketEnd = false;
+
+    for (;;)
+    {
+        if (mPageSegmentIndex == mPageSegmentsCount)
+        {
+            if (!read_page())
+                return false;
+
+            // skip pages of other logical streams
+            if (mPageSerial != mStreamSerial)
+            {
+                mPageSegmentsCount = 0;
+            }
+            continue;
+        }
+
+        int segmentLength = mPageSegments[mPageSegmentIndex++];
+        if ((int) mPacket.size() < mPacketLength + segmentLength + VorbisPacketPadding)
+        {
+            mPacket.resize(mPacketLength + segmentLength + VorbisPacketPadding);
+        }
+        if (segmentLength > 0)
+        {
+            ::memcpy(&mPacket[mPacketLength], &mPageData[mPageDataPosition], segmentLength);
+        }
+        mPageDataPosition += segmentLength;
+        mPacketLength += segmentLength;
+
+        // segment shorter than 255 bytes terminates packet
+        if (segmentLength < 255)
+            break;
+    }
+
+    if (mPacket.empty())
+    {
+        mPacket.resize(VorbisPacketPadding);
+    }
+    ::memset(&mPacket[mPacketLength], 0, VorbisPacketPadding);
+    return true;
+}
+
+bool vorbis_reader::read_last_granule(long long& granule)
+{
+    mInputStream.clear(); // force clear state after eof
+    if (!mInputStream.seekg(0, std::ios::end))
+        return false;
+
+    long long fileLength = (long long) mInputStream.tellg();
+    int scanLength = (int) std::min(fileLength, (long long) OggMaxPageLength);
+    if (scanLength < OggPageHeaderLength)
+        return false;
+
+    std::vector<unsigned char> fileTail(scanLength);
+    if (!mInputStream.seekg(fileLength - scanLength, std::ios::beg) || !mInputStream.read((char*) fileTail.data(), scanLength))
+        return false;
+
+    // granule position of last page is total samples count
+    bool granuleFound = false;
+    for (int iposition = 0; iposition + OggPageHeaderLength <= scanLength; ++iposition)
+    {
+        const unsigned char* header = &fileTail[iposition];
+        if ((::memcmp(header, OggPageMarker, sizeof(OggPageMarker)) != 0) || (header[4] != 0))
+            continue;
+
+        unsigned int pageSerial = header[14] | (header[15] << 8) | (header[16] << 16) | ((unsigned int) header[17] << 24);
+        if (pageSerial != mStreamSerial)
+            continue;
+
+        long long pageGranule = 0;
+        for (int ibyte = 0; ibyte < 8; ++ibyte)
+        {
+            pageGranule |= (long long) header[6 + ibyte] << (ibyte * 8);
+        }
+        // no packets finish on page
+        if (pageGranule < 0)
+            continue;
+
+        granule = pageGranule;
+        granuleFound = true;
+    }
+    return granuleFound;
+}
+
+bool vorbis_reader::read_header_signature(unsigned int packetType)
+{
+    if ((read_bits(8) != packetType) || mPacketEnd)
+        return false;
+
+    for (char signatureChar: {'v', 'o', 'r', 'b', 'i', 's'})
+    {
+        if (read_bits(8) != (unsigned int) signatureChar)
+            return false;
+    }
+    return !mPacketEnd;
+}
+
+bool vorbis_reader::parse_setup_header()
+{
+    mCodebooks.resize(read_bits(8) + 1);
+    for (codebook& book: mCodebooks)
+    {
+        if (!parse_codebook(book))
+            return false;
+    }
+
+    // time domain transforms are placeholders
+    int timesCount = read_bits(6) + 1;
+    for (int itime = 0; itime < timesCount; ++itime)
+    {
+        if (read_bits(16) != 0)
+            return false;
+    }
+
+    // floor type 0 is not supported, it is not produced by encoders for years
+    mFloors.resize(read_bits(6) + 1);
+    for (floor_setup& floor: mFloors)
+    {
+        if ((read_bits(16) != 1) || !parse_floor(floor))
+            return false;
+    }
+
+    mResidues.resize(read_bits(6) + 1);
+    for (residue_setup& residue: mResidues)
+    {
+        if (!parse_residue(residue))
+            return false;
+    }
+
+    mMappings.resize(read_bits(6) + 1);
+    for (mapping_setup& mapping: mMappings)
+    {
+        if ((read_bits(16) != 0) || !parse_mapping(mapping))
+            return false;
+    }
+
+    mModes.resize(read_bits(6) + 1);
+    for (mode_setup& mode: mModes)
+    {
+        mode.mLongBlock = read_bits(1) > 0;
+        unsigned int windowType = read_bits(16);
+        unsigned int transformType = read_bits(16);
+        mode.mMapping = read_bits(8);
+        if ((windowType != 0) || (transformType != 0) || (mode.mMapping >= (int) mMappings.size()))
+            return false;
+    }
+
+    // framing flag
+    return (read_bits(1) == 1) && !mPacketEnd;
+}
+
+bool vorbis_reader::parse_codebook(codebook& book)
+{
+    if (read_bits(24) != VorbisCodebookSync)
+        return false;
+
+    book.mDimensions = read_bits(16);
+    book.mEntries = read_bits(24);
+    if ((book.mDimensions == 0) || (book.mEntries == 0) || mPacketEnd)
+        return false;
+
+    // codeword lengths
+    book.mLengths.assign(book.mEntries, 0);
+    if (read_bits(1)) // ordered
+    {
+        int currentLength = read_bits(5) + 1;
+        for (int currentEntry = 0; currentEntry < book.mEntries; ++currentLength)
+        {
+            int lengthEntries = read_bits(ilog(book.mEntries - currentEntry));
+            if ((currentLength > 32) || (currentEntry + lengthEntries > book.mEntries) || mPacketEnd)
+                return false;
+
+            std::fill_n(book.mLengths.begin() + currentEntry, lengthEntries, (unsigned char) currentLength);
+            currentEntry += lengthEntries;
+        }
+    }
+    else
+    {
+        bool isSparse = read_bits(1) > 0;
+        for (unsigned char& codewordLength: book.mLengths)
+        {
+            if (!isSparse || read_bits(1))
+            {
+                codewordLength = (unsigned char) (read_bits(5) + 1);
+            }
+        }
+    }
+
+    if (mPacketEnd)
+        return false;
+
+    // assign codewords in entries order, each entry takes lowest available codeword of its length,
+    // codewords are built msb first and then reversed as packet bits are read from lowest
+    book.mCodewords.assign(book.mEntries, 0);
+    book.mUsedEntries = 0;
+
+    unsigned int availableCodewords[33] = {};
+    for (int ientry = 0; ientry < book.mEntries; ++ientry)
+    {
+        int codewordLength = book.mLengths[ientry];
+        if (codewordLength == 0)
+            continue;
+
+        if (book.mUsedEntries++ == 0)
+        {
+            for (int ilength = 1; ilength <= codewordLength; ++ilength)
+            {
+                availableCodewords[ilength] = 1U << (32 - ilength);
+            }
+            continue;
+        }
+
+        int branchLength = codewordLength;
+        while ((branchLength > 0) && (availableCodewords[branchLength] == 0))
+        {
+            --branchLength;
+        }
+        // overspecified tree
+        if (branchLength == 0)
+            return false;
+
+        unsigned int codeword = availableCodewords[branchLength];
+        availableCodewords[branchLength] = 0;
+        book.mCodewords[ientry] = bit_reverse(codeword);
+
+        for (int ilength = codewordLength; ilength > branchLength; --ilength)
+        {
+            availableCodewords[ilength] = codeword + (1U << (32 - ilength));
+        }
+    }
+
+    // decoding tables
+    const int fastTableSize = 1 << VorbisFastTableBits;
+    book.mFastTable.assign(fastTableSize, -1);
+    book.mLongEntries.clear();
+    for (int ientry = 0; ientry < book.mEntries; ++ientry)
+    {
+        int codewordLength = book.mLengths[ientry];
+        if (codewordLength == 0)
+            continue;
+
+        // single entry codebook matches any bits
+        if (book.mUsedEntries == 1)
+        {
+            std::fill(book.mFastTable.begin(), book.mFastTable.end(), ientry);
+            break;
+        }
+
+        if (codewordLength > VorbisFastTableBits)
+        {
+            book.mLongEntries.push_back(ientry);
+            continue;
+        }
+        for (int itable = book.mCodewords[ientry]; itable < fastTableSize; itable += (1 << codewordLength))
+        {
+            book.mFastTable[itable] = ientry;
+        }
+    }
+
+    // vector lookup
+    book.mValues.clear();
+
+    unsigned int lookupType = read_bits(4);
+    if (lookupType == 0)
+        return !mPacketEnd;
+
+    if (lookupType > 2)
+        return false;
+
+    float minValue = float32_unpack(read_bits(32));
+    float deltaValue = float32_unpack(read_bits(32));
+    int valueBits = read_bits(4) + 1;
+    bool sequenceP = read_bits(1) > 0;
+
+    long long lookupValues = (lookupType == 1) ?
+        lookup1_values(book.mEntries, book.mDimensions) :
+        (long long) book.mEntries * book.mDimensions;
+    if ((lookupValues <= 0) || (lookupValues > (long long) book.mEntries * book.mDimensions))
+        return false;
+
+    std::vector<unsigned int> multiplicands((size_t) lookupValues);
+    for (unsigned int& multiplicand: multiplicands)
+    {
+        multiplicand = read_bits(valueBits);
+    }
+
+    if (mPacketEnd)
+        return false;
+
+    book.mValues.resize(book.mEntries * book.mDimensions);
+    for (int ientry = 0; ientry < book.mEntries; ++ientry)
+    {
+        float lastValue = 0.0f;
+        long long indexDivisor = 1;
+        for (int idim = 0; idim < book.mDimensions; ++idim)
+        {
+            long long multiplicandOffset = (lookupType == 1) ?
+                ((ientry / indexDivisor) % lookupValues) :
+                ((long long) ientry * book.mDimensions + idim);
+
+            float value = multiplicands[(size_t) multiplicandOffset] * deltaValue + minValue + lastValue;
+            book.mValues[ientry * book.mDimensions + idim] = value;
+            if (sequenceP)
+            {
+                lastValue = value;
+            }
+            indexDivisor *= lookupValues;
+        }
+    }
+    return true;
+}
+
+bool vorbis_reader::parse_floor(floor_setup& floor)
+{
+    const int codebooksCount = (int) mCodebooks.size();
+
+    floor.mPartitionClasses.resize(read_bits(5));
+    int maxClass = -1;
+    for (int& partitionClass: floor.mPartitionClasses)
+    {
+        partitionClass = read_bits(4);
+        maxClass = std::max(maxClass, partitionClass);
+    }
+
+    for (int iclass = 0; iclass <= maxClass; ++iclass)
+    {
+        floor.mClassDimensions[iclass] = read_bits(3) + 1;
+        floor.mClassSubclasses[iclass] = read_bits(2);
+        floor.mClassMasterbooks[iclass] = 0;
+        if (floor.mClassSubclasses[iclass] > 0)
+        {
+            floor.mClassMasterbooks[iclass] = read_bits(8);
+            if (floor.mClassMasterbooks[iclass] >= codebooksCount)
+                return false;
+        }
+        for (int isubclass = 0; isubclass < (1 << floor.mClassSubclasses[iclass]); ++isubclass)
+        {
+            int subclassBook = (int) read_bits(8) - 1;
+            if (subclassBook >= codebooksCount)
+                return false;
+
+            floor.mSubclassBooks[iclass][isubclass] = subclassBook;
+        }
+    }
+
+    floor.mMultiplier = read_bits(2) + 1;
+
+    int rangeBits = read_bits(4);
+    floor.mXList.clear();
+    floor.mXList.push_back(0);
+    floor.mXList.push_back(1 << rangeBits);
+    for (int partitionClass: floor.mPartitionClasses)
+    {
+        for (int idim = 0; idim < floor.mClassDimensions[partitionClass]; ++idim)
+        {
+            floor.mXList.push_back(read_bits(rangeBits));
+        }
+    }
+
+    if (mPacketEnd)
+        return false;
+
+    const int valuesCount = (int) floor.mXList.size();
+    floor.mSortedOrder.resize(valuesCount);
+    for (int ivalue = 0; ivalue < valuesCount; ++ivalue)
+    {
+        floor.mSortedOrder[ivalue] = ivalue;
+    }
+    std::sort(floor.mSortedOrder.begin(), floor.mSortedOrder.end(), [&floor](int lhs, int rhs)
+        {
+            return floor.mXList[lhs] < floor.mXList[rhs];
+        });
+
+    // x values must be unique
+    for (int ivalue = 1; ivalue < valuesCount; ++ivalue)
+    {
+        if (floor.mXList[floor.mSortedOrder[ivalue - 1]] == floor.mXList[floor.mSortedOrder[ivalue]])
+            return false;
+    }
+
+    // for each point find closest preceding points in list with lower and higher x
+    floor.mLowNeighbors.assign(valuesCount, 0);
+    floor.mHighNeighbors.assign(valuesCount, 1);
+    for (int ivalue = 2; ivalue < valuesCount; ++ivalue)
+    {
+        const int currX = floor.mXList[ivalue];
+        int lowX = -1;
+        int highX = INT_MAX;
+        for (int iprev = 0; iprev < ivalue; ++iprev)
+        {
+            const int prevX = floor.mXList[iprev];
+            if ((prevX < currX) && (prevX > lowX))
+            {
+                lowX = prevX;
+                floor.mLowNeighbors[ivalue] = iprev;
+            }
+            if ((prevX > currX) && (prevX < highX))
+            {
+                highX = prevX;
+                floor.mHighNeighbors[ivalue] = iprev;
+            }
+        }
+    }
+
+    mFloorMaxValues = std::max(mFloorMaxValues, valuesCount);
+    return true;
+}
+
+bool vorbis_reader::parse_residue(residue_setup& residue)
+{
+    const int codebooksCount = (int) mCodebooks.size();
+
+    residue.mType = read_bits(16);
+    residue.mBegin = read_bits(24);
+    residue.mEnd = read_bits(24);
+    residue.mPartitionSize = read_bits(24) + 1;
+    residue.mClassifications = read_bits(6) + 1;
+    residue.mClassbook = read_bits(8);
+    if ((residue.mType > 2) || (residue.mClassbook >= codebooksCount))
+        return false;
+
+    unsigned int cascades[64];
+    for (int iclass = 0; iclass < residue.mClassifications; ++iclass)
+    {
+        unsigned int lowBits = read_bits(3);
+        unsigned int highBits = read_bits(1) ? read_bits(5) : 0;
+        cascades[iclass] = (highBits << 3) | lowBits;
+    }
+
+    residue.mBooks.assign(residue.mClassifications * 8, -1);
+    for (int iclass = 0; iclass < residue.mClassifications; ++iclass)
+    {
+        for (int ipass = 0; ipass < 8; ++ipass)
+        {
+            if ((cascades[iclass] & (1 << ipass)) == 0)
+                continue;
+
+            int bookIndex = read_bits(8);
+            // residue books are used in vector context
+            if ((bookIndex >= codebooksCount) || mCodebooks[bookIndex].mValues.empty())
+                return false;
+
+            residue.mBooks[iclass * 8 + ipass] = bookIndex;
+        }
+    }
+    return !mPacketEnd;
+}
+
+bool vorbis_reader::parse_mapping(mapping_setup& mapping)
+{
+    int submapsCount = read_bits(1) ? (read_bits(4) + 1) : 1;
+
+    mapping.mMagnitudeChannels.clear();
+    mapping.mAngleChannels.clear();
+    if (read_bits(1))
+    {
+        const int channelBits = ilog(mChannelsCount - 1);
+        int couplingSteps = read_bits(8) + 1;
+        for (int istep = 0; istep < couplingSteps; ++istep)
+        {
+            int magnitudeChannel = read_bits(channelBits);
+            int angleChannel = read_bits(channelBits);
+            if ((magnitudeChannel == angleChannel) || (magnitudeChannel >= mChannelsCount) || (angleChannel >= mChannelsCount))
+                return false;
+
+            mapping.mMagnitudeChannels.push_back(magnitudeChannel);
+            mapping.mAngleChannels.push_back(angleChannel);
+        }
+    }
+
+    if (read_bits(2) != 0) // reserved
+        return false;
+
+    mapping.mChannelSubmaps.assign(mChannelsCount, 0);
+    if (submapsCount > 1)
+    {
+        for (int& channelSubmap: mapping.mChannelSubmaps)
+        {
+            channelSubmap = read_bits(4);
+            if (channelSubmap >= submapsCount)
+                return false;
+        }
+    }
+
+    mapping.mSubmapFloors.resize(submapsCount);
+    mapping.mSubmapResidues.resize(submapsCount);
+    for (int isubmap = 0; isubmap < submapsCount; ++isubmap)
+    {
+        read_bits(8); // unused time configuration
+        mapping.mSubmapFloors[isubmap] = read_bits(8);
+        mapping.mSubmapResidues[isubmap] = read_bits(8);
+        if ((mapping.mSubmapFloors[isubmap] >= (int) mFloors.size()) || (mapping.mSubmapResidues[isubmap] >= (int) mResidues.size()))
+            return false;
+    }
+    return !mPacketEnd;
+}
+
+void vorbis_reader::setup_transform(int blockIndex)
+{
+    const int blockSize = mBlockSizes[blockIndex];
+    const int halfSize = blockSize / 2;
+    const int fftSize = blockSize / 4;
+    const double pi = 3.14159265358979323846;
+
+    // power complementary window slope
+    std::vector<float>& windowSlope = mWindowSlopes[blockIndex];
+    windowSlope.resize(halfSize);
+    for (int isample = 0; isample < halfSize; ++isample)
+    {
+        double slopeSin = ::sin((isample + 0.5) / halfSize * pi * 0.5);
+        windowSlope[isample] = (float) ::sin(pi * 0.5 * slopeSin * slopeSin);
+    }
+
+    // imdct is computed as dct-iv of half size, which is done with complex fft of quarter size,
+    // tables are pre-rotation, post-rotation and fft roots, all as complex values
+    std::vector<float>& twiddles = mTransformTwiddles[blockIndex];
+    twiddles.resize(fftSize * 2 + fftSize * 2 + fftSize);
+    for (int itwiddle = 0; itwiddle < fftSize; ++itwiddle)
+    {
+        double preAngle = -pi * itwiddle / halfSize;
+        twiddles[itwiddle * 2 + 0] = (float) ::cos(preAngle);
+        twiddles[itwiddle * 2 + 1] = (float) ::sin(preAngle);
+
+        double postAngle = -pi * (itwiddle + 0.25) / halfSize;
+        twiddles[fftSize * 2 + itwiddle * 2 + 0] = (float) ::cos(postAngle);
+        twiddles[fftSize * 2 + itwiddle * 2 + 1] = (float) ::sin(postAngle);
+    }
+    for (int itwiddle = 0; itwiddle < fftSize / 2; ++itwiddle)
+    {
+        double rootAngle = -2.0 * pi * itwiddle / fftSize;
+        twiddles[fftSize * 4 + itwiddle * 2 + 0] = (float) ::cos(rootAngle);
+        twiddles[fftSize * 4 + itwiddle * 2 + 1] = (float) ::sin(rootAngle);
+    }
+
+    std::vector<int>& bitReverse = mTransformBitReverse[blockIndex];
+    bitReverse.resize(fftSize);
+    const int fftBits = ilog(fftSize) - 1;
+    for (int iindex = 0; iindex < fftSize; ++iindex)
+    {
+        bitReverse[iindex] = (int) (bit_reverse(iindex) >> (32 - fftBits));
+    }
+}
+
+bool vorbis_reader::decode_packet()
+{
+    mBlockSize = 0;
+    mBlockPosition = 0;
+
+    for (;;)
+    {
+        if (!read_packet())
+            return false;
+
+        // skip corrupted packets
+        int outputSamples = 0;
+        if (!decode_audio_packet(outputSamples))
+            continue;
+
+        // first packet only fills overlap buffer
+        if (outputSamples == 0)
+            continue;
+
+        // last page granule position cuts padding of final block
+        if (mSamplesCount > 0)
+        {
+            outputSamples = std::min(outputSamples, mSamplesCount - mSamplesProduced);
+            if (outputSamples <= 0)
+                return false;
+        }
+
+        mSamplesProduced += outputSamples;
+        mBlockSize = outputSamples;
+        return true;
+    }
+}
+
+bool vorbis_reader::decode_audio_packet(int& outputSamples)
+{
+    outputSamples = 0;
+
+    if (read_bits(1) != 0) // not an audio packet
+        return false;
+
+    unsigned int modeIndex = read_bits(ilog((unsigned int) mModes.size() - 1));
+    if (modeIndex >= mModes.size())
+        return false;
+
+    const mode_setup& mode = mModes[modeIndex];
+    const mapping_setup& mapping = mMappings[mode.mMapping];
+    const int blockIndex = mode.mLongBlock ? 1 : 0;
+    const int blockSize = mBlockSizes[blockIndex];
+    const int halfSize = blockSize / 2;
+
+    // long block overlaps with short neighbours using short window slopes
+    bool prevLongWindow = mode.mLongBlock;
+    bool nextLongWindow = mode.mLongBlock;
+    if (mode.mLongBlock)
+    {
+        prevLongWindow = read_bits(1) > 0;
+        nextLongWindow = read_bits(1) > 0;
+    }
+
+    if (mPacketEnd)
+        return false;
+
+    // floors, channel without floor is silent
+    bool channelUsed[2] = {};
+    for (int ichannel = 0; ichannel < mChannelsCount; ++ichannel)
+    {
+        const floor_setup& floor = mFloors[mapping.mSubmapFloors[mapping.mChannelSubmaps[ichannel]]];
+        channelUsed[ichannel] = decode_floor(floor, &mFloorY[ichannel * mFloorMaxValues]);
+    }
+
+    // coupled channels are decoded together
+    const int couplingSteps = (int) mapping.mMagnitudeChannels.size();
+    for (int istep = 0; istep < couplingSteps; ++istep)
+    {
+        bool& magnitudeUsed = channelUsed[mapping.mMagnitudeChannels[istep]];
+        bool& angleUsed = channelUsed[mapping.mAngleChannels[istep]];
+        if (magnitudeUsed || angleUsed)
+        {
+            magnitudeUsed = true;
+            angleUsed = true;
+        }
+    }
+
+    // residues
+    const int spectrumStride = mBlockSizes[1] / 2;
+    for (int ichannel = 0; ichannel < mChannelsCount; ++ichannel)
+    {
+        std::fill_n(&mSpectrum[ichannel * spectrumStride], halfSize, 0.0f);
+    }
+
+    for (int isubmap = 0, submapsCount = (int) mapping.mSubmapResidues.size(); isubmap < submapsCount; ++isubmap)
+    {
+        float* vectors[2];
+        bool skipVectors[2];
+        int vectorsCount = 0;
+        for (int ichannel = 0; ichannel < mChannelsCount; ++ichannel)
+        {
+            if (mapping.mChannelSubmaps[ichannel] != isubmap)
+                continue;
+
+            vectors[vectorsCount] = &mSpectrum[ichannel * spectrumStride];
+            skipVectors[vectorsCount] = !channelUsed[ichannel];
+            ++vectorsCount;
+        }
+        if (vectorsCount > 0)
+        {
+            decode_residue(mResidues[mapping.mSubmapResidues[isubmap]], blockSize, vectorsCount, vectors, skipVectors);
+        }
+    }
+
+    // inverse square polar channel coupling
+    for (int istep = couplingSteps - 1; istep >= 0; --istep)
+    {
+        float* magnitudes = &mSpectrum[mapping.mMagnitudeChannels[istep] * spectrumStride];
+        float* angles = &mSpectrum[mapping.mAngleChannels[istep] * spectrumStride];
+        for (int isample = 0; isample < halfSize; ++isample)
+        {
+            const float magnitude = magnitudes[isample];
+            const float angle = angles[isample];
+            if (magnitude > 0.0f)
+            {
+                magnitudes[isample] = (angle > 0.0f) ? magnitude : (magnitude + angle);
+                angles[isample] = (angle > 0.0f) ? (magnitude - angle) : magnitude;
+            }
+            else
+            {
+                magnitudes[isample] = (angle > 0.0f) ? magnitude : (magnitude - angle);
+                angles[isample] = (angle > 0.0f) ? (magnitude + angle) : magnitude;
+            }
+        }
+    }
+
+    // window slopes are centered at quarters of block
+    const int leftSlopeIndex = prevLongWindow ? 1 : 0;
+    const int rightSlopeIndex = nextLongWindow ? 1 : 0;
+    const int leftSlopeSize = mBlockSizes[leftSlopeIndex] / 2;
+    const int rightSlopeSize = mBlockSizes[rightSlopeIndex] / 2;
+    const int leftSlopeStart = blockSize / 4 - leftSlopeSize / 2;
+    const int rightSlopeStart = (blockSize * 3) / 4 - rightSlopeSize / 2;
+    const float* leftSlope = mWindowSlopes[leftSlopeIndex].data();
+    const float* rightSlope = mWindowSlopes[rightSlopeIndex].data();
+
+    // samples from center of previous block to center of current block are complete
+    if (mPrevBlockSize > 0)
+    {
+        outputSamples = mPrevBlockSize / 4 + blockSize / 4;
+    }
+
+    float* output = mTransformOutput.data();
+    for (int ichannel = 0; ichannel < mChannelsCount; ++ichannel)
+    {
+        float* spectrum = &mSpectrum[ichannel * spectrumStride];
+        if (channelUsed[ichannel])
+        {
+            const floor_setup& floor = mFloors[mapping.mSubmapFloors[mapping.mChannelSubmaps[ichannel]]];
+            render_floor(floor, &mFloorY[ichannel * mFloorMaxValues], blockSize, spectrum);
+        }
+        else
+        {
+            std::fill_n(spectrum, halfSize, 0.0f);
+        }
+
+        inverse_mdct(blockIndex, spectrum, output);
+
+        // apply window
+        std::fill_n(output, leftSlopeStart, 0.0f);
+        for (int isample = 0; isample < leftSlopeSize; ++isample)
+        {
+            output[leftSlopeStart + isample] *= leftSlope[isample];
+        }
+        for (int isample = 0; isample < rightSlopeSize; ++isample)
+        {
+            output[rightSlopeStart + isample] *= rightSlope[rightSlopeSize - 1 - isample];
+        }
+        std::fill(output + rightSlopeStart + rightSlopeSize, output + blockSize, 0.0f);
+
+        // overlap with right half of previous block
+        float* overlap = &mOverlap[ichannel * spectrumStride];
+        const int prevHalfSize = mPrevBlockSize / 2;
+        const int currOffset = blockSize / 4 - mPrevBlockSize / 4;
+        for (int isample = 0; isample < outputSamples; ++isample)
+        {
+            float sampleValue = 0.0f;
+            if (isample < prevHalfSize)
+            {
+                sampleValue += overlap[isample];
+            }
+            if (isample + currOffset >= 0)
+            {
+                sampleValue += output[isample + currOffset];
+            }
+            sampleValue = std::min(std::max(sampleValue, -1.0f), 1.0f);
+            mBlockSamples[isample * mChannelsCount + ichannel] = (short) ::lrintf(sampleValue * 32767.0f);
+        }
+        std::copy(output + halfSize, output + blockSize, overlap);
+    }
+
+    mPrevBlockSize = blockSize;
+    return true;
+}
+
+bool vorbis_reader::decode_floor(const floor_setup& floor, int* floorY)
+{
+    if (read_bits(1) == 0)
+        return false;
+
+    const int rangeBits = ilog(VorbisFloorRanges[floor.mMultiplier - 1] - 1);
+    floorY[0] = read_bits(rangeBits);
+    floorY[1] = read_bits(rangeBits);
+
+    int valueIndex = 2;
+    for (int partitionClass: floor.mPartitionClasses)
+    {
+        const int classDimensions = floor.mClassDimensions[partitionClass];
+        const int classBits = floor.mClassSubclasses[partitionClass];
+        const int classMask = (1 << classBits) - 1;
+
+        int classValue = 0;
+        if (classBits > 0)
+        {
+            classValue = decode_codeword(mCodebooks[floor.mClassMasterbooks[partitionClass]]);
+        }
+        for (int idim = 0; idim < classDimensions; ++idim)
+        {
+            const int subclassBook = floor.mSubclassBooks[partitionClass][classValue & classMask];
+            classValue >>= classBits;
+            floorY[valueIndex++] = (subclassBook >= 0) ? decode_codeword(mCodebooks[subclassBook]) : 0;
+        }
+    }
+
+    // packet ended before floor, channel is unused
+    return !mPacketEnd;
+}
+
+void vorbis_reader::render_floor(const floor_setup& floor, const int* floorY, int blockSize, float* spectrum)
+{
+    const int range = VorbisFloorRanges[floor.mMultiplier - 1];
+    const int valuesCount = (int) floor.mXList.size();
+
+    // amplitude values are coded as offsets from line between neighbour points
+    int finalY[VorbisFloorMaxValues];
+    bool pointUsed[VorbisFloorMaxValues];
+    finalY[0] = floorY[0];
+    finalY[1] = floorY[1];
+    pointUsed[0] = true;
+    pointUsed[1] = true;
+    for (int ivalue = 2; ivalue < valuesCount; ++ivalue)
+    {
+        const int lowIndex = floor.mLowNeighbors[ivalue];
+        const int highIndex = floor.mHighNeighbors[ivalue];
+        const int predicted = render_point(floor.mXList[lowIndex], finalY[lowIndex], floor.mXList[highIndex], finalY[highIndex], floor.mXList[ivalue]);
+        const int value = floorY[ivalue];
+        if (value == 0)
+        {
+            pointUsed[ivalue] = false;
+            finalY[ivalue] = predicted;
+            continue;
+        }
+
+        const int highRoom = range - predicted;
+        const int lowRoom = predicted;
+        const int room = std::min(highRoom, lowRoom) * 2;
+        if (value >= room)
+        {
+            finalY[ivalue] = (highRoom > lowRoom) ?
+                (value - lowRoom + predicted) :
+                (predicted - value + highRoom - 1);
+        }
+        else
+        {
+            finalY[ivalue] = (value & 1) ?
+                (predicted - (value + 1) / 2) :
+                (predicted + value / 2);
+        }
+        pointUsed[lowIndex] = true;
+        pointUsed[highIndex] = true;
+        pointUsed[ivalue] = true;
+    }
+
+    // render curve through used points
+    const int halfSize = blockSize / 2;
+    int* curve = mFloorCurve.data();
+    int lastX = 0;
+    int lastY = finalY[floor.mSortedOrder[0]] * floor.mMultiplier;
+    for (int ivalue = 1; ivalue < valuesCount; ++ivalue)
+    {
+        const int pointIndex = floor.mSortedOrder[ivalue];
+        if (!pointUsed[pointIndex])
+            continue;
+
+        const int pointX = floor.mXList[pointIndex];
+        const int pointY = finalY[pointIndex] * floor.mMultiplier;
+        render_line(lastX, lastY, pointX, pointY, curve, halfSize);
+        lastX = pointX;
+        lastY = pointY;
+    }
+    if (lastX < halfSize)
+    {
+        render_line(lastX, lastY, halfSize, lastY, curve, halfSize);
+    }
+
+    const float* inverseDbTable = get_inverse_db_table();
+    for (int isample = 0; isample < halfSize; ++isample)
+    {
+        spectrum[isample] *= inverseDbTable[std::min(std::max(curve[isample], 0), 255)];
+    }
+}
+
+void vorbis_reader::decode_residue(const residue_setup& residue, int blockSize, int vectorsCount, float** vectors, const bool* skipVectors)
+{
+    const int halfSize = blockSize / 2;
+    if (residue.mType != 2)
+    {
+        decode_residue_partitions(residue, halfSize, vectorsCount, vectors, skipVectors);
+        return;
+    }
+
+    // type 2 decodes all channels interleaved into single vector
+    bool anyVectorUsed = false;
+    for (int ivector = 0; ivector < vectorsCount; ++ivector)
+    {
+        anyVectorUsed = anyVectorUsed || !skipVectors[ivector];
+    }
+    if (!anyVectorUsed)
+        return;
+
+    const int interleavedSize = halfSize * vectorsCount;
+    float* interleaved = mResidueInterleaved.data();
+    std::fill_n(interleaved, interleavedSize, 0.0f);
+
+    const bool skipInterleaved = false;
+    decode_residue_partitions(residue, interleavedSize, 1, &interleaved, &skipInterleaved);
+
+    for (int isample = 0; isample < halfSize; ++isample)
+    {
+        for (int ivector = 0; ivector < vectorsCount; ++ivector)
+        {
+            vectors[ivector][isample] = interleaved[isample * vectorsCount + ivector];
+        }
+    }
+}
+
+void vorbis_reader::decode_residue_partitions(const residue_setup& residue, int vectorSize, int vectorsCount, float** vectors, const bool* skipVectors)
+{
+    const int limitBegin = std::min(residue.mBegin, vectorSize);
+    const int limitEnd = std::min(residue.mEnd, vectorSize);
+    const int partitionSize = residue.mPartitionSize;
+    const int partitionsCount = (limitEnd - limitBegin) / partitionSize;
+    if (partitionsCount <= 0)
+        return;
+
+    const codebook& classbook = mCodebooks[residue.mClassbook];
+    const int classwordsPerCodeword = classbook.mDimensions;
+
+    // classification of each partition is decoded on first pass
+    const int classificationsStride = partitionsCount + classwordsPerCodeword;
+    if ((int) mResidueClassifications.size() < vectorsCount * classificationsStride)
+    {
+        mResidueClassifications.resize(vectorsCount * classificationsStride);
+    }
+
+    for (int ipass = 0; ipass < 8; ++ipass)
+    {
+        for (int ipartition = 0; ipartition < partitionsCount; )
+        {
+            if (ipass == 0)
+            {
+                for (int ivector = 0; ivector < vectorsCount; ++ivector)
+                {
+                    if (skipVectors[ivector])
+                        continue;
+
+                    int classword = decode_codeword(classbook);
+                    if (classword < 0)
+                        return;
+
+                    int* classifications = &mResidueClassifications[ivector * classificationsStride + ipartition];
+                    for (int iclass = classwordsPerCodeword - 1; iclass >= 0; --iclass)
+                    {
+                        classifications[iclass] = classword % residue.mClassifications;
+                        classword /= residue.mClassifications;
+                    }
+                }
+            }
+
+            for (int iclassword = 0; (iclassword < classwordsPerCodeword) && (ipartition < partitionsCount); ++iclassword, ++ipartition)
+            {
+                for (int ivector = 0; ivector < vectorsCount; ++ivector)
+                {
+                    if (skipVectors[ivector])
+                        continue;
+
+                    const int classification = mResidueClassifications[ivector * classificationsStride + ipartition];
+                    const int bookIndex = residue.mBooks[classification * 8 + ipass];
+                    if (bookIndex < 0)
+                        continue;
+
+                    const codebook& book = mCodebooks[bookIndex];
+                    const int dimensions = book.mDimensions;
+                    float* partition = vectors[ivector] + limitBegin + ipartition * partitionSize;
+                    if (residue.mType == 0)
+                    {
+                        // vector values are spread across partition
+                        const int step = partitionSize / dimensions;
+                        for (int istep = 0; istep < step; ++istep)
+                        {
+                            int entry = decode_codeword(book);
+                            if (entry < 0)
+                                return;
+
+                            const float* values = &book.mValues[entry * dimensions];
+                            for (int idim = 0; idim < dimensions; ++idim)
+                            {
+                                partition[istep + idim * step] += values[idim];
+                            }
+                        }
+                    }
+                    else
+                    {
+                        for (int isample = 0; isample < partitionSize; )
+                        {
+                            int entry = decode_codeword(book);
+                            if (entry < 0)
+                                return;
+
+                            const float* values = &book.mValues[entry * dimensions];
+                            for (int idim = 0; (idim < dimensions) && (isample < partitionSize); ++idim)
+                            {
+                                partition[isample++] += values[idim];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+int vorbis_reader::decode_codeword(const codebook& book)
+{
+    const int remainingBits = mPacketLength * 8 - mPacketBitPosition;
+
+    // look ahead 32 bits, padding past packet end reads as zeros
+    const unsigned char* packetBytes = &mPacket[mPacketBitPosition >> 3];
+    unsigned long long lookaheadBits = 0;
+    for (int ibyte = 0; ibyte < 5; ++ibyte)
+    {
+        lookaheadBits |= (unsigned long long) packetBytes[ibyte] << (ibyte * 8);
+    }
+    const unsigned int codewordBits = (unsigned int) (lookaheadBits >> (mPacketBitPosition & 7));
+
+    int entry = (book.mUsedEntries > 0) ? book.mFastTable[codewordBits & ((1 << VorbisFastTableBits) - 1)] : -1;
+    if (entry < 0)
+    {
+        for (int longEntry: book.mLongEntries)
+        {
+            const int codewordLength = book.mLengths[longEntry];
+            const unsigned int codewordMask = (codewordLength == 32) ? 0xFFFFFFFF : ((1U << codewordLength) - 1);
+            if ((codewordBits & codewordMask) == book.mCodewords[longEntry])
+            {
+                entry = longEntry;
+                break;
+            }
+        }
+    }
+
+    if ((entry < 0) || (book.mLengths[entry] > remainingBits))
+    {
+        mPacketBitPosition = mPacketLength * 8;
+        mPacketEnd = true;
+        return -1;
+    }
+
+    mPacketBitPosition += book.mLengths[entry];
+    return entry;
+}
+
+void vorbis_reader::inverse_mdct(int blockIndex, const float* spectrum, float* output)
+{
+    const int blockSize = mBlockSizes[blockIndex];
+    const int halfSize = blockSize / 2;
+    const int fftSize = blockSize / 4;
+
+    const float* preTwiddles = &mTransformTwiddles[blockIndex][0];
+    const float* postTwiddles = &mTransformTwiddles[blockIndex][fftSize * 2];
+    const float* fftRoots = &mTransformTwiddles[blockIndex][fftSize * 4];
+    const int* bitReverse = mTransformBitReverse[blockIndex].data();
+
+    // pack even and reversed odd coefficients as complex values, rotate and store in bit reversed order
+    float* complexData = mTransformBuffer.data();
+    for (int iindex = 0; iindex < fftSize; ++iindex)
+    {
+        const float re = spectrum[iindex * 2];
+        const float im = spectrum[halfSize - 1 - iindex * 2];
+        const float twiddleRe = preTwiddles[iindex * 2 + 0];
+        const float twiddleIm = preTwiddles[iindex * 2 + 1];
+        float* destination = &complexData[bitReverse[iindex] * 2];
+        destination[0] = re * twiddleRe - im * twiddleIm;
+        destination[1] = re * twiddleIm + im * twiddleRe;
+    }
+
+    // radix-2 fft
+    for (int span = 1; span < fftSize; span *= 2)
+    {
+        const int rootStep = fftSize / (span * 2);
+        for (int groupStart = 0; groupStart < fftSize; groupStart += span * 2)
+        {
+            for (int iindex = 0; iindex < span; ++iindex)
+            {
+                const float rootRe = fftRoots[iindex * rootStep * 2 + 0];
+                const float rootIm = fftRoots[iindex * rootStep * 2 + 1];
+                float* first = &complexData[(groupStart + iindex) * 2];
+                float* second = &complexData[(groupStart + iindex + span) * 2];
+                const float re = second[0] * rootRe - second[1] * rootIm;
+                const float im = second[0] * rootIm + second[1] * rootRe;
+                second[0] = first[0] - re;
+                second[1] = first[1] - im;
+                first[0] += re;
+                first[1] += im;
+            }
+        }
+    }
+
+    // rotate back to get dct-iv output
+    float* dctOutput = mTransformBuffer.data() + halfSize;
+    for (int iindex = 0; iindex < fftSize; ++iindex)
+    {
+        const float re = complexData[iindex * 2 + 0];
+        const float im = complexData[iindex * 2 + 1];
+        const float twiddleRe = postTwiddles[iindex * 2 + 0];
+        const float twiddleIm = postTwiddles[iindex * 2 + 1];
+        dctOutput[iindex * 2] = re * twiddleRe - im * twiddleIm;
+        dctOutput[halfSize - 1 - iindex * 2] = -(re * twiddleIm + im * twiddleRe);
+    }
+
+    // unfold dct-iv output to full block using its symmetries
+    const int quarterSize = halfSize / 2;
+    for (int isample = 0; isample < quarterSize; ++isample)
+    {
+        output[isample] = dctOutput[isample + quarterSize];
+    }
+    for (int isample = quarterSize; isample < halfSize + quarterSize; ++isample)
+    {
+        output[isample] = -dctOutput[halfSize + quarterSize - 1 - isample];
+    }
+    for (int isample = halfSize + quarterSize; isample < blockSize; ++isample)
+    {
+        output[isample] = -dctOutput[isample - halfSize - quarterSize];
+    }
+}
+
+unsigned int vorbis_reader::read_bits(int bitsCount)
+{
+    debug_assert((bitsCount >= 0) && (bitsCount <= 32));
+
+    if (mPacketBitPosition + bitsCount > mPacketLength * 8)
+    {
+        mPacketBitPosition = mPacketLength * 8;
+        mPacketEnd = true;
+        return 0;
+    }
+
+    // packet bits are read starting from lowest bit of each byte
+    const unsigned char* packetBytes = &mPacket[mPacketBitPosition >> 3];
+    unsigned long long bits = 0;
+    for (int ibyte = 0; ibyte < 5; ++ibyte)
+    {
+        bits |= (unsigned long long) packetBytes[ibyte] << (ibyte * 8);
+    }
+    bits >>= (mPacketBitPosition & 7);
+    mPacketBitPosition += bitsCount;
+    return (unsigned int) (bits & ((1ULL << bitsCount) - 1));
+}
+
+} // namespace cxx
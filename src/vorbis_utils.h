@@ -0,0 +1,175 @@
+#pragma once
+
+namespace cxx
+{
+    // simple pcm audio data reader from ogg vorbis file
+    // supports mono and stereo streams with floor type 1, output is always 16 bit
+    class vorbis_reader final: public noncopyable
+    {
+    public:
+        // readonly
+        int mChannelsCount = 0;
+        int mSampleRate = 0;
+        int mSampleBits = 0; // output bits per sample, always 16
+        int mSamplesCount = 0; // may be zero if unknown
+
+    public:
+        vorbis_reader(std::istream& inputStream);
+
+        bool parse_audio();
+        bool audio_present() const;
+
+        // read pcm audio data
+        // @param samplesCount: samples count to read
+        // @parm buffer: Destination buffer
+        // @returns Samples count copied to buffer
+        int read_pcm_samples(int samplesCount, void* buffer);
+
+        // seeking is done by decoding stream from its start, so it is slow
+        // @param samples: Samples count
+        bool seek_pcm_beg(int samples);
+        bool seek_pcm_end(int samples);
+        bool seek_pcm_cur(int samples);
+
+        bool end_of_stream() const;
+
+    private:
+        struct codebook
+        {
+            int mDimensions = 0;
+            int mEntries = 0;
+            int mUsedEntries = 0;
+            std::vector<unsigned char> mLengths; // zero for unused entries
+            std::vector<unsigned int> mCodewords; // bit reversed, first bit of codeword is lowest
+            std::vector<int> mFastTable; // entry index for each combination of low codeword bits, or -1
+            std::vector<int> mLongEntries; // entries which do not fit fast table
+            std::vector<float> mValues; // vq vectors, empty if codebook has no value lookup
+        };
+
+        struct floor_setup
+        {
+            std::vector<int> mPartitionClasses;
+            int mClassDimensions[16];
+            int mClassSubclasses[16];
+            int mClassMasterbooks[16];
+            int mSubclassBooks[16][8];
+            int mMultiplier = 0;
+            std::vector<int> mXList;
+            std::vector<int> mSortedOrder; // x list indices sorted by x
+            std::vector<int> mLowNeighbors;
+            std::vector<int> mHighNeighbors;
+        };
+
+        struct residue_setup
+        {
+            int mType = 0;
+            int mBegin = 0;
+            int mEnd = 0;
+            int mPartitionSize = 0;
+            int mClassifications = 0;
+            int mClassbook = 0;
+            std::vector<int> mBooks; // 8 passes for each classification, -1 if unused
+        };
+
+        struct mapping_setup
+        {
+            std::vector<int> mMagnitudeChannels;
+            std::vector<int> mAngleChannels;
+            std::vector<int> mChannelSubmaps;
+            std::vector<int> mSubmapFloors;
+            std::vector<int> mSubmapResidues;
+        };
+
+        struct mode_setup
+        {
+            bool mLongBlock = false;
+            int mMapping = 0;
+        };
+
+    private:
+        void clear();
+        void reset_decoder();
+
+        // ogg container
+        bool read_page();
+        bool read_packet();
+        bool read_last_granule(long long& granule);
+
+        // header packets
+        bool read_header_signature(unsigned int packetType);
+        bool parse_setup_header();
+        bool parse_codebook(codebook& book);
+        bool parse_floor(floor_setup& floor);
+        bool parse_residue(residue_setup& residue);
+        bool parse_mapping(mapping_setup& mapping);
+        void setup_transform(int blockIndex);
+
+        // decode next audio packet into block buffer
+        bool decode_packet();
+        bool decode_audio_packet(int& outputSamples);
+        bool decode_floor(const floor_setup& floor, int* floorY);
+        void render_floor(const floor_setup& floor, const int* floorY, int blockSize, float* spectrum);
+        void decode_residue(const residue_setup& residue, int blockSize, int vectorsCount, float** vectors, const bool* skipVectors);
+        void decode_residue_partitions(const residue_setup& residue, int vectorSize, int vectorsCount, float** vectors, const bool* skipVectors);
+        int decode_codeword(const codebook& book);
+        void inverse_mdct(int blockIndex, const float* spectrum, float* output);
+
+        // packet bit reader
+        unsigned int read_bits(int bitsCount);
+
+    private:
+        std::istream& mInputStream;
+        std::streampos mAudioStart;
+
+        // logical stream which is being decoded, pages of other streams are skipped
+        unsigned int mStreamSerial = 0;
+
+        // current ogg page
+        std::vector<unsigned char> mPageData;
+        unsigned int mPageSerial = 0;
+        unsigned char mPageSegments[255];
+        int mPageSegmentsCount = 0;
+        int mPageSegmentIndex = 0;
+        int mPageDataPosition = 0;
+
+        // current packet and bit reader state
+        std::vector<unsigned char> mPacket; // padded with zeros past packet length
+        int mPacketLength = 0;
+        int mPacketBitPosition = 0;
+        bool mPacketEnd = false;
+
+        // stream setup
+        int mBlockSizes[2];
+        std::vector<codebook> mCodebooks;
+        std::vector<floor_setup> mFloors;
+        std::vector<residue_setup> mResidues;
+        std::vector<mapping_setup> mMappings;
+        std::vector<mode_setup> mModes;
+
+        // window slopes and imdct tables for short and long blocks
+        std::vector<float> mWindowSlopes[2];
+        std::vector<float> mTransformTwiddles[2];
+        std::vector<int> mTransformBitReverse[2];
+
+        // decoder state
+        std::vector<int> mFloorY; // decoded floor values per channel
+        std::vector<int> mFloorCurve;
+        int mFloorMaxValues = 0;
+        std::vector<float> mSpectrum; // planar, long block half size per channel
+        std::vector<float> mResidueInterleaved;
+        std::vector<int> mResidueClassifications;
+        std::vector<float> mTransformBuffer; // complex fft data followed by dct output
+        std::vector<float> mTransformOutput;
+        std::vector<float> mOverlap; // planar, right half of previous block per channel
+        int mPrevBlockSize = 0;
+
+        // decoded block, interleaved
+        std::vector<short> mBlockSamples;
+        int mBlockSize = 0;
+        int mBlockPosition = 0;
+        int mSamplesDecoded = 0; // total samples handed out to client
+        int mSamplesProduced = 0; // total samples produced by decoder
+        bool mStreamFinished = false;
+    };
+
+} // namespace cxx
@@ -10,6 +10,7 @@ namespace cxx
 const unsigned int WaveChunkID_RiffHeader = 0x46464952;
 const unsigned int WaveChunkID_Format = 0x020746d66;
 const unsigned int WaveChunkID_Data = 0x61746164;
+const unsigned int WaveChunkID_Fact = 0x74636166;
 
 // known riff format id's
 
@@ -18,6 +19,28 @@ const unsigned int RiffFormat_WAVE = 0x45564157;
 // known wave format id's
 
 const unsigned int WaveFormat_PCM = 1; // Pulse Code Modulation
+const unsigned int WaveFormat_IMA_ADPCM = 0x11; // 4 bit Intel/DVI ADPCM
+
+// ima adpcm tables
+
+const int ImaAdpcmIndexTable[16] =
+{
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8,
+};
+
+const int ImaAdpcmStepTable[89] =
+{
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
 
 // chunk header data
 struct wave_chunk_header
@@ -58,6 +81,9 @@ bool wave_reader::parse_audio()
     bool hasDataChunk = false;
 
     wave_pcm_format pcmFormat;
+    short waveFormat = 0;
+    unsigned short adpcmSamplesPerBlock = 0;
+    unsigned int factSamplesCount = 0;
 
     for (;;)
     {
@@ -86,14 +112,14 @@ bool wave_reader::parse_audio()
         {
             hasFormatChunk = true;
 
-            short waveFormat = 0;
+            std::streampos formatChunkStart = mInputStream.tellg();
             if (!read_from_stream(mInputStream, waveFormat))
             {
                 debug_assert(false);
                 return false;
             }
 
-            if (waveFormat != WaveFormat_PCM)
+            if ((waveFormat != WaveFormat_PCM) && (waveFormat != WaveFormat_IMA_ADPCM))
                 return false;
 
             if (!read_from_stream(mInputStream, pcmFormat.mNumChannels) ||
@@ -104,6 +130,34 @@ bool wave_reader::parse_audio()
             {
                 return false;
             }
+
+            if ((waveFormat == WaveFormat_IMA_ADPCM) && (chunkHeader.mLength >= 20))
+            {
+                unsigned short extraDataSize = 0;
+                if (!read_from_stream(mInputStream, extraDataSize) ||
+                    !read_from_stream(mInputStream, adpcmSamplesPerBlock))
+                {
+                    return false;
+                }
+            }
+
+            // format chunk may contain extra data
+            if (!mInputStream.seekg(formatChunkStart + (std::streamoff) chunkHeader.mLength, std::ios::beg))
+            {
+                debug_assert(false);
+                return false;
+            }
+            continue;
+        }
+
+        if (chunkHeader.mID == WaveChunkID_Fact)
+        {
+            std::streampos factChunkStart = mInputStream.tellg();
+            if (!read_from_stream(mInputStream, factSamplesCount) ||
+                !mInputStream.seekg(factChunkStart + (std::streamoff) chunkHeader.mLength, std::ios::beg))
+            {
+                return false;
+            }
             continue;
         }
 
@@ -142,15 +196,56 @@ bool wave_reader::parse_audio()
 
     mChannelsCount = pcmFormat.mNumChannels;
     mSampleRate = pcmFormat.mSampleRate;
-    mSampleBits = pcmFormat.mBitsPerSample;
-    mSamplesCount = mAudioDataLength / (mChannelsCount * mSampleBits / 8);
     mAudioDataEnd = mAudioDataStart + (std::streamoff) mAudioDataLength;
 
+    if (waveFormat == WaveFormat_IMA_ADPCM)
+    {
+        // each channel block starts with 4 bytes header
+        const int blockHeaderLength = 4 * mChannelsCount;
+        if ((pcmFormat.mBitsPerSample != 4) || (mChannelsCount < 1) || (mChannelsCount > 2) || (pcmFormat.mBlockAlign <= blockHeaderLength))
+        {
+            clear();
+            return false;
+        }
+
+        mAdpcmEncoded = true;
+        mBlockAlign = pcmFormat.mBlockAlign;
+        mSamplesPerBlock = ((mBlockAlign - blockHeaderLength) * 2) / mChannelsCount + 1;
+        if ((adpcmSamplesPerBlock > 0) && (adpcmSamplesPerBlock < mSamplesPerBlock))
+        {
+            mSamplesPerBlock = adpcmSamplesPerBlock;
+        }
+
+        int blocksCount = mAudioDataLength / mBlockAlign;
+        int lastBlockLength = mAudioDataLength % mBlockAlign;
+        mSamplesCount = blocksCount * mSamplesPerBlock;
+        if (lastBlockLength > blockHeaderLength)
+        {
+            mSamplesCount += ((lastBlockLength - blockHeaderLength) * 2) / mChannelsCount + 1;
+        }
+        if ((factSamplesCount > 0) && ((int) factSamplesCount < mSamplesCount))
+        {
+            mSamplesCount = factSamplesCount;
+        }
+
+        mSampleBits = 16;
+        mEncodedBlock.resize(mBlockAlign);
+        mDecodedBlock.resize(mSamplesPerBlock * mChannelsCount);
+    }
+    else
+    {
+        mSampleBits = pcmFormat.mBitsPerSample;
+        mSamplesCount = mAudioDataLength / (mChannelsCount * mSampleBits / 8);
+    }
+
     return audio_present();
 }
 
 int wave_reader::read_pcm_samples(int samples, void* buffer)
 {
+    if (mAdpcmEncoded)
+        return read_adpcm_samples(samples, buffer);
+
     if (audio_present())
     {
         std::streampos currStreamPos = mInputStream.tellg();
@@ -172,6 +267,9 @@ int wave_reader::read_pcm_samples(int samples, void* buffer)
 
 bool wave_reader::seek_pcm_beg(int samples)
 {
+    if (mAdpcmEncoded)
+        return seek_adpcm_samples(samples);
+
     if (audio_present())
     {
         std::streamoff dataOffset = (mChannelsCount * (mSampleBits / 8)) * samples;
@@ -187,6 +285,9 @@ bool wave_reader::seek_pcm_beg(int samples)
 
 bool wave_reader::seek_pcm_end(int samples)
 {
+    if (mAdpcmEncoded)
+        return seek_adpcm_samples(mSamplesCount + samples);
+
     if (audio_present())
     {
         std::streamoff dataOffset = (mChannelsCount * (mSampleBits / 8)) * samples;
@@ -202,6 +303,9 @@ bool wave_reader::seek_pcm_end(int samples)
 
 bool wave_reader::seek_pcm_cur(int samples)
 {
+    if (mAdpcmEncoded)
+        return seek_adpcm_samples(mAdpcmSamplePosition + samples);
+
     if (audio_present())
     {
         std::streamoff dataOffset = (mChannelsCount * (mSampleBits / 8)) * samples;
@@ -217,6 +321,9 @@ bool wave_reader::seek_pcm_cur(int samples)
 
 bool wave_reader::end_of_stream() const
 {
+    if (mAdpcmEncoded)
+        return mAdpcmSamplePosition >= mSamplesCount;
+
     std::streampos currStreampos = mInputStream.tellg();
     return currStreampos >= mAudioDataEnd;
 }
@@ -235,6 +342,203 @@ void wave_reader::clear()
     mAudioDataLength = 0;
     mAudioDataStart = 0;
     mAudioDataEnd = 0;
+    mAdpcmEncoded = false;
+    mBlockAlign = 0;
+    mSamplesPerBlock = 0;
+    mAdpcmSamplePosition = 0;
+    mDecodedBlockPosition = 0;
+    mDecodedBlockSamples = 0;
+}
+
+int wave_reader::read_adpcm_samples(int samples, void* buffer)
+{
+    short* outputSamples = static_cast<short*>(buffer);
+
+    int samplesRead = 0;
+    while ((samplesRead < samples) && (mAdpcmSamplePosition < mSamplesCount))
+    {
+        if (mDecodedBlockPosition == mDecodedBlockSamples)
+        {
+            if (!decode_adpcm_block())
+                break;
+
+            continue;
+        }
+
+        int copySamples = std::min(samples - samplesRead, mDecodedBlockSamples - mDecodedBlockPosition);
+        copySamples = std::min(copySamples, mSamplesCount - mAdpcmSamplePosition);
+
+        ::memcpy(outputSamples + samplesRead * mChannelsCount, &mDecodedBlock[mDecodedBlockPosition * mChannelsCount], 
+            copySamples * mChannelsCount * sizeof(short));
+
+        mDecodedBlockPosition += copySamples;
+        mAdpcmSamplePosition += copySamples;
+        samplesRead += copySamples;
+    }
+    return samplesRead;
+}
+
+bool wave_reader::seek_adpcm_samples(int samplePosition)
+{
+    if (!audio_present() || (samplePosition < 0) || (samplePosition > mSamplesCount))
+        return false;
+
+    int blockIndex = samplePosition / mSamplesPerBlock;
+
+    mInputStream.clear(); // force clear state after eof
+    if (!mInputStream.seekg(mAudioDataStart + (std::streamoff) blockIndex * mBlockAlign, std::ios::beg))
+        return false;
+
+    mDecodedBlockPosition = 0;
+    mDecodedBlockSamples = 0;
+    mAdpcmSamplePosition = blockIndex * mSamplesPerBlock;
+
+    int skipSamples = samplePosition - mAdpcmSamplePosition;
+    if (skipSamples > 0)
+    {
+        if (!decode_adpcm_block() || (skipSamples > mDecodedBlockSamples))
+            return false;
+
+        mDecodedBlockPosition = skipSamples;
+        mAdpcmSamplePosition = samplePosition;
+    }
+    return true;
+}
+
+bool wave_reader::decode_adpcm_block()
+{
+    const int blockHeaderLength = 4 * mChannelsCount;
+
+    std::streamoff remainingLength = mAudioDataEnd - mInputStream.tellg();
+    int blockLength = (int) std::min<std::streamoff>(mBlockAlign, remainingLength);
+    if (blockLength <= blockHeaderLength)
+        return false;
+
+    if (!mInputStream.read((char*) mEncodedBlock.data(), blockLength))
+        return false;
+
+    const int dataLength = blockLength - blockHeaderLength;
+    const unsigned char* blockData = &mEncodedBlock[blockHeaderLength];
+
+    int blockSamples = std::min(mSamplesPerBlock, (dataLength * 2) / mChannelsCount + 1);
+    for (int ichannel = 0; ichannel < mChannelsCount; ++ichannel)
+    {
+        const unsigned char* channelHeader = &mEncodedBlock[ichannel * 4];
+        int predictor = (short) (channelHeader[0] | (channelHeader[1] << 8));
+        int stepIndex = std::min((int) channelHeader[2], 88);
+
+        // first sample is stored in header
+        mDecodedBlock[ichannel] = (short) predictor;
+
+        for (int isample = 1; isample < blockSamples; ++isample)
+        {
+            // channels data is interleaved by 4 bytes, 8 samples each
+            int nibbleIndex = isample - 1;
+            int byteIndex = ((nibbleIndex / 8) * mChannelsCount + ichannel) * 4 + (nibbleIndex % 8) / 2;
+            if (byteIndex >= dataLength)
+            {
+                blockSamples = isample;
+                break;
+            }
+
+            int nibble = (blockData[byteIndex] >> ((nibbleIndex & 1) * 4)) & 0x0F;
+
+            int step = ImaAdpcmStepTable[stepIndex];
+            int difference = step >> 3;
+            if (nibble & 1) difference += (step >> 2);
+            if (nibble & 2) difference += (step >> 1);
+            if (nibble & 4) difference += step;
+            if (nibble & 8) difference = -difference;
+
+            predictor = std::min(std::max(predictor + difference, -32768), 32767);
+            stepIndex = std::min(std::max(stepIndex + ImaAdpcmIndexTable[nibble], 0), 88);
+
+            mDecodedBlock[isample * mChannelsCount + ichannel] = (short) predictor;
+        }
+    }
+
+    mDecodedBlockPosition = 0;
+    mDecodedBlockSamples = blockSamples;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+wave_writer::wave_writer(std::ostream& outputStream)
+    : mOutputStream(outputStream)
+    , mHeaderStart()
+{
+}
+
+bool wave_writer::write_header(int channelsCount, int sampleRate, int sampleBits)
+{
+    if (!mOutputStream)
+        return false;
+
+    mChannelsCount = channelsCount;
+    mSampleRate = sampleRate;
+    mSampleBits = sampleBits;
+    mSamplesCount = 0;
+    mHeaderStart = mOutputStream.tellp();
+
+    const short waveFormat = WaveFormat_PCM;
+
+    wave_pcm_format pcmFormat;
+    pcmFormat.mNumChannels = (short) channelsCount;
+    pcmFormat.mSampleRate = sampleRate;
+    pcmFormat.mByteRate = sampleRate * channelsCount * (sampleBits / 8);
+    pcmFormat.mBlockAlign = (short) (channelsCount * (sampleBits / 8));
+    pcmFormat.mBitsPerSample = (short) sampleBits;
+
+    wave_chunk_header riffHeader { WaveChunkID_RiffHeader, 0 };
+    wave_chunk_header formatHeader { WaveChunkID_Format, 16 };
+    wave_chunk_header dataHeader { WaveChunkID_Data, 0 };
+
+    mOutputStream.write((const char*) &riffHeader, sizeof(riffHeader));
+    mOutputStream.write((const char*) &RiffFormat_WAVE, sizeof(RiffFormat_WAVE));
+    mOutputStream.write((const char*) &formatHeader, sizeof(formatHeader));
+    mOutputStream.write((const char*) &waveFormat, sizeof(waveFormat));
+    mOutputStream.write((const char*) &pcmFormat.mNumChannels, sizeof(pcmFormat.mNumChannels));
+    mOutputStream.write((const char*) &pcmFormat.mSampleRate, sizeof(pcmFormat.mSampleRate));
+    mOutputStream.write((const char*) &pcmFormat.mByteRate, sizeof(pcmFormat.mByteRate));
+    mOutputStream.write((const char*) &pcmFormat.mBlockAlign, sizeof(pcmFormat.mBlockAlign));
+    mOutputStream.write((const char*) &pcmFormat.mBitsPerSample, sizeof(pcmFormat.mBitsPerSample));
+    mOutputStream.write((const char*) &dataHeader, sizeof(dataHeader));
+
+    return !!mOutputStream;
+}
+
+bool wave_writer::write_pcm_samples(int samplesCount, const void* buffer)
+{
+    debug_assert(mChannelsCount && mSampleBits);
+
+    int dataLength = (mChannelsCount * (mSampleBits / 8)) * samplesCount;
+    if (mOutputStream.write((const char*) buffer, dataLength))
+    {
+        mSamplesCount += samplesCount;
+        return true;
+    }
+    return false;
+}
+
+bool wave_writer::finalize()
+{
+    const unsigned int headerLength = 44;
+
+    unsigned int dataLength = (mChannelsCount * (mSampleBits / 8)) * mSamplesCount;
+    unsigned int riffLength = dataLength + headerLength - sizeof(wave_chunk_header);
+
+    std::streampos streamEnd = mOutputStream.tellp();
+
+    // riff chunk length
+    mOutputStream.seekp(mHeaderStart + (std::streamoff) sizeof(unsigned int), std::ios::beg);
+    mOutputStream.write((const char*) &riffLength, sizeof(riffLength));
+    // data chunk length
+    mOutputStream.seekp(mHeaderStart + (std::streamoff) (headerLength - sizeof(unsigned int)), std::ios::beg);
+    mOutputStream.write((const char*) &dataLength, sizeof(dataLength));
+
+    mOutputStream.seekp(streamEnd, std::ios::beg);
+    return !!mOutputStream;
 }
 
 } // namespace cxx
\ No newline at end of file
@@ -3,15 +3,17 @@
 namespace cxx
 {
     // simple pcm audio data reader from wave file
+    // ima adpcm encoded data is decoded to 16 bit pcm on the fly
     class wave_reader final: public noncopyable
     {
     public:
         // readonly
         int mChannelsCount = 0;
         int mSampleRate = 0;
-        int mSampleBits = 0;
+        int mSampleBits = 0; // output bits per sample
         int mSamplesCount = 0;
         unsigned int mAudioDataLength = 0; // in bytes
+        bool mAdpcmEncoded = false;
 
     public:
         wave_reader(std::istream& inputStream);
@@ -35,10 +37,53 @@ namespace cxx
     private:
         void clear();
 
+        // ima adpcm
+        int read_adpcm_samples(int samplesCount, void* buffer);
+        bool seek_adpcm_samples(int samplePosition);
+        bool decode_adpcm_block();
+
     private:
         std::istream& mInputStream;
         std::streampos mAudioDataStart;
         std::streampos mAudioDataEnd;
+
+        // ima adpcm decoder state
+        int mBlockAlign = 0;
+        int mSamplesPerBlock = 0;
+        int mAdpcmSamplePosition = 0; // next sample to read
+        int mDecodedBlockPosition = 0;
+        int mDecodedBlockSamples = 0;
+        std::vector<unsigned char> mEncodedBlock;
+        std::vector<short> mDecodedBlock; // interleaved
+    };
+
+    // simple pcm audio data writer to wave file
+    class wave_writer final: public noncopyable
+    {
+    public:
+        // readonly
+        int mChannelsCount = 0;
+        int mSampleRate = 0;
+        int mSampleBits = 0;
+        int mSamplesCount = 0;
+
+    public:
+        wave_writer(std::ostream& outputStream);
+
+        // write wave header with placeholder sizes, must be called before any samples written
+        bool write_header(int channelsCount, int sampleRate, int sampleBits);
+
+        // write pcm audio data
+        // @param samplesCount: samples count to write
+        // @param buffer: Source buffer
+        bool write_pcm_samples(int samplesCount, const void* buffer);
+
+        // patch chunk sizes in header, should be called after all samples written
+        bool finalize();
+
+    private:
+        std::ostream& mOutputStream;
+        std::streampos mHeaderStart;
     };
 
 } // namespace cxx
\ No newline at end of file